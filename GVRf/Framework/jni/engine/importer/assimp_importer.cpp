@@ -19,19 +19,23 @@
 
 #include "assimp_importer.h"
 
+#include "objects/components/render_data.h"
 #include "objects/mesh.h"
+#include "objects/mesh_optimizer.h"
 
 namespace gvr {
 Mesh* AssimpImporter::getMesh(int index) {
-    Mesh* mesh = new Mesh();
+    if (mesh_cache_ != 0) {
+        return mesh_cache_->getMesh(index);
+    }
 
-    if (assimp_importer_->GetScene() == 0) {
+    if (getAssimpScene() == 0) {
         LOGE("_ASSIMP_SCENE_NOT_FOUND_");
-        delete mesh;
         return 0;
     }
 
-    aiMesh* ai_mesh = assimp_importer_->GetScene()->mMeshes[index];
+    Mesh* mesh = new Mesh();
+    aiMesh* ai_mesh = getAssimpScene()->mMeshes[index];
 
     std::vector<glm::vec3> vertices;
     for (int i = 0; i < ai_mesh->mNumVertices; ++i) {
@@ -79,6 +83,175 @@ Mesh* AssimpImporter::getMesh(int index) {
     }
     mesh->set_triangles(std::move(triangles));
 
+    // imported meshes are drawn as they are, so they are worth reordering
+    MeshOptimizer mesh_optimizer(*mesh);
+    mesh_optimizer.optimize();
+    LOGD("AssimpImporter::getMesh() : mesh %d ACMR %.3f -> %.3f", index,
+            mesh_optimizer.acmr_before(), mesh_optimizer.acmr_after());
+
+    // copied before the caller can upload the mesh and drop its vertices
+    if (!mesh_cache_path_.empty()) {
+        MeshCache::MeshStreams streams;
+        MeshCache::copyStreams(*mesh, streams);
+        std::lock_guard<std::mutex> lock(mesh_streams_mutex_);
+        mesh_streams_[index].swap(streams);
+    }
+
     return mesh;
 }
+
+void AssimpImporter::set_mesh_cache_path(const std::string& path) {
+    std::lock_guard<std::mutex> lock(mesh_streams_mutex_);
+    mesh_cache_path_ = path;
+    mesh_streams_.clear();
+    mesh_streams_.resize(getNumberOfMeshes());
+}
+
+bool AssimpImporter::writeMeshCache() {
+    std::lock_guard<std::mutex> lock(mesh_streams_mutex_);
+    if (mesh_cache_path_.empty()) {
+        return false;
+    }
+    bool written = MeshCache::write(mesh_cache_path_, getAssimpScene(),
+            mesh_streams_);
+    if (!written) {
+        LOGE("AssimpImporter::writeMeshCache() : cannot write %s",
+                mesh_cache_path_.c_str());
+    }
+    mesh_cache_path_.clear();
+    std::vector<MeshCache::MeshStreams>().swap(mesh_streams_);
+    return written;
+}
+
+Mesh* AssimpImporter::getNodeMesh(const char* node_name, int index) {
+    int mesh_index = getNodeMeshIndex(node_name, index);
+    if (mesh_index < 0) {
+        LOGE("AssimpImporter::getNodeMesh() : no mesh %d in node %s", index,
+                node_name);
+        return 0;
+    }
+    return getMesh(mesh_index);
+}
+
+int AssimpImporter::getNodeMeshIndex(const char* node_name, int index) {
+    if (mesh_cache_ != 0) {
+        return mesh_cache_->getNodeMeshIndex(node_name, index);
+    }
+
+    if (getAssimpScene() == 0) {
+        LOGE("_ASSIMP_SCENE_NOT_FOUND_");
+        return -1;
+    }
+    aiNode* node = getAssimpScene()->mRootNode->FindNode(node_name);
+    if (node == 0 || index < 0
+            || static_cast<unsigned int>(index) >= node->mNumMeshes) {
+        return -1;
+    }
+    return node->mMeshes[index];
+}
+
+aiMaterial* AssimpImporter::getMeshMaterial(int mesh_index) {
+    if (mesh_cache_ != 0) {
+        return mesh_cache_->getMeshMaterial(mesh_index);
+    }
+
+    const aiScene* scene = getAssimpScene();
+    if (scene == 0 || mesh_index < 0
+            || static_cast<unsigned int>(mesh_index) >= scene->mNumMeshes) {
+        LOGE("AssimpImporter::getMeshMaterial() : no mesh %d", mesh_index);
+        return 0;
+    }
+    aiMaterial* material = new aiMaterial();
+    aiMaterial::CopyPropertyList(material,
+            scene->mMaterials[scene->mMeshes[mesh_index]->mMaterialIndex]);
+    return material;
+}
+
+void AssimpImporter::createSceneGraph(const std::vector<Mesh*>& meshes,
+        std::vector<SceneNode>& nodes) {
+    nodes.clear();
+    int root = newSceneNode(-1, nodes);
+
+    if (mesh_cache_ != 0) {
+        // cached nodes come parents first, so each parent is already made
+        std::vector<int> scene_nodes(mesh_cache_->getNumberOfNodes());
+        for (size_t i = 0; i < scene_nodes.size(); ++i) {
+            int parent = mesh_cache_->getNodeParent(i);
+            scene_nodes[i] = addSceneNode(
+                    parent < 0 ? root : scene_nodes[parent],
+                    mesh_cache_->getNodeName(i),
+                    mesh_cache_->getNodeTransform(i),
+                    mesh_cache_->getNodeMeshIndices(i),
+                    mesh_cache_->getNodeNumberOfMeshes(i), meshes, nodes);
+        }
+        return;
+    }
+
+    const aiScene* scene = getAssimpScene();
+    if (scene != 0 && scene->mRootNode != 0) {
+        addSceneNodes(scene->mRootNode, root, meshes, nodes);
+    }
+}
+
+void AssimpImporter::addSceneNodes(const aiNode* node, int parent,
+        const std::vector<Mesh*>& meshes, std::vector<SceneNode>& nodes) {
+    // Assimp matrices are row-major
+    const aiMatrix4x4& m = node->mTransformation;
+    glm::mat4 model_matrix(m.a1, m.b1, m.c1, m.d1, m.a2, m.b2, m.c2, m.d2,
+            m.a3, m.b3, m.c3, m.d3, m.a4, m.b4, m.c4, m.d4);
+    int self = addSceneNode(parent, node->mName.C_Str(), model_matrix,
+            node->mMeshes, node->mNumMeshes, meshes, nodes);
+
+    for (unsigned int i = 0; i < node->mNumChildren; ++i) {
+        addSceneNodes(node->mChildren[i], self, meshes, nodes);
+    }
+}
+
+int AssimpImporter::addSceneNode(int parent, const std::string& name,
+        const glm::mat4& model_matrix, const unsigned int* mesh_indices,
+        unsigned int mesh_count, const std::vector<Mesh*>& meshes,
+        std::vector<SceneNode>& nodes) {
+    int self = newSceneNode(parent, nodes);
+
+    if (mesh_count == 1) {
+        attachMesh(nodes[self], meshes[mesh_indices[0]], mesh_indices[0]);
+    } else {
+        for (unsigned int i = 0; i < mesh_count; ++i) {
+            int child = newSceneNode(self, nodes);
+            nodes[child].scene_object->set_name(name);
+            attachMesh(nodes[child], meshes[mesh_indices[i]],
+                    mesh_indices[i]);
+        }
+    }
+
+    nodes[self].transform->setModelMatrix(model_matrix);
+    nodes[self].scene_object->set_name(name);
+    return self;
+}
+
+int AssimpImporter::newSceneNode(int parent, std::vector<SceneNode>& nodes) {
+    SceneNode scene_node;
+    scene_node.scene_object = new SceneObject();
+    scene_node.transform = new Transform();
+    scene_node.parent = parent;
+    scene_node.render_data = 0;
+    scene_node.mesh_index = -1;
+    scene_node.scene_object->attachTransform(scene_node.scene_object,
+            scene_node.transform);
+    if (parent >= 0) {
+        SceneObject* parent_object = nodes[parent].scene_object;
+        parent_object->addChildObject(parent_object, scene_node.scene_object);
+    }
+    nodes.push_back(scene_node);
+    return nodes.size() - 1;
+}
+
+void AssimpImporter::attachMesh(SceneNode& scene_node, Mesh* mesh,
+        int mesh_index) {
+    scene_node.render_data = new RenderData();
+    scene_node.render_data->set_mesh(mesh);
+    scene_node.mesh_index = mesh_index;
+    scene_node.scene_object->attachRenderData(scene_node.scene_object,
+            scene_node.render_data);
+}
 }
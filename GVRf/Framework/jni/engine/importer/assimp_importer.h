@@ -25,6 +25,7 @@
 #include <vector>
 #include <string>
 #include <map>
+#include <mutex>
 
 #include "objects/components/perspective_camera.h"
 #include "objects/components/camera_rig.h"
@@ -44,36 +45,106 @@
 #include "assimp/cimport.h"
 
 #include "jassimp.h"
+#include "engine/importer/mesh_cache.h"
 
 namespace gvr {
 class Mesh;
+class RenderData;
 
 class AssimpImporter: public HybridObject {
 public:
     AssimpImporter(Assimp::Importer* assimp_importer) :
-            assimp_importer_(assimp_importer) {
+            assimp_importer_(assimp_importer), mesh_cache_(0) {
+    }
+
+    // Meshes, nodes and materials all come from the cache, and the source
+    // is never parsed.
+    AssimpImporter(MeshCache* mesh_cache) :
+            assimp_importer_(0), mesh_cache_(mesh_cache) {
     }
 
     ~AssimpImporter() {
+        delete mesh_cache_;
         delete assimp_importer_;
     }
 
     unsigned int getNumberOfMeshes() {
-        if (assimp_importer_->GetScene() != 0) {
-            return assimp_importer_->GetScene()->mNumMeshes;
+        if (mesh_cache_ != 0) {
+            return mesh_cache_->getNumberOfMeshes();
+        }
+        if (getAssimpScene() != 0) {
+            return getAssimpScene()->mNumMeshes;
         }
         LOGE("_ASSIMP_SCENE_NOT_FOUND_");
         return 0;
     }
 
     Mesh* getMesh(int index);
+    Mesh* getNodeMesh(const char* node_name, int index);
+
+    // the index of the index-th mesh of the named node, or -1
+    int getNodeMeshIndex(const char* node_name, int index);
 
+    // the material of a mesh, as a new aiMaterial for the caller to delete
+    aiMaterial* getMeshMaterial(int mesh_index);
+
+    // Null when everything comes from a mesh cache. getMesh() and
+    // getNodeMesh() only read the scene, so meshes can be converted in
+    // parallel.
     const aiScene* getAssimpScene() {
+        if (assimp_importer_ == 0) {
+            return 0;
+        }
         return assimp_importer_->GetScene();
     }
 
+    // One scene object of a model, as createSceneGraph() builds it
+    struct SceneNode {
+        SceneObject* scene_object;
+        Transform* transform;
+        int parent;
+        RenderData* render_data;
+        int mesh_index;
+    };
+
+    // Builds the scene objects of the whole model, with their names,
+    // transforms and hierarchy, under an unnamed root, as
+    // GVRContext.getAssimpModel() would. The nodes come from the mesh cache
+    // when there is one, and from the Assimp scene otherwise. A node with
+    // one mesh gets render data drawing it; a node with several gets a child
+    // with render data for each. nodes is in depth-first order, parents
+    // first; render data draw meshes[mesh_index] and have no render pass yet.
+    void createSceneGraph(const std::vector<Mesh*>& meshes,
+            std::vector<SceneNode>& nodes);
+
+    // Has getMesh() keep a copy of each mesh it converts, for
+    // writeMeshCache() to write to path once all are converted.
+    void set_mesh_cache_path(const std::string& path);
+
+    // false if there is no cache to write, or a mesh was not converted
+    bool writeMeshCache();
+
+private:
+    AssimpImporter(const AssimpImporter& assimp_importer);
+    AssimpImporter(AssimpImporter&& assimp_importer);
+    AssimpImporter& operator=(const AssimpImporter& assimp_importer);
+    AssimpImporter& operator=(AssimpImporter&& assimp_importer);
+
+    void addSceneNodes(const aiNode* node, int parent,
+            const std::vector<Mesh*>& meshes, std::vector<SceneNode>& nodes);
+    static int addSceneNode(int parent, const std::string& name,
+            const glm::mat4& model_matrix, const unsigned int* mesh_indices,
+            unsigned int mesh_count, const std::vector<Mesh*>& meshes,
+            std::vector<SceneNode>& nodes);
+    static int newSceneNode(int parent, std::vector<SceneNode>& nodes);
+    static void attachMesh(SceneNode& scene_node, Mesh* mesh, int mesh_index);
+
 private:
     Assimp::Importer* assimp_importer_;
+    MeshCache* mesh_cache_;
+    std::string mesh_cache_path_;
+    std::vector<MeshCache::MeshStreams> mesh_streams_;
+    std::mutex mesh_streams_mutex_;
 };
 }
 #endif
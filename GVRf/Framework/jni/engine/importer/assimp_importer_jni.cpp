@@ -39,6 +39,26 @@ Java_org_gearvrf_NativeAssimpImporter_getNodeMesh(JNIEnv * env,
 JNIEXPORT jobject JNICALL
 Java_org_gearvrf_NativeAssimpImporter_getMeshMaterial(JNIEnv * env,
         jobject obj, jlong jassimp_importer, jstring jnode_name, jint index);
+JNIEXPORT jobject JNICALL
+Java_org_gearvrf_NativeAssimpImporter_getMaterial(JNIEnv * env,
+        jobject obj, jlong jassimp_importer, jint mesh_index);
+JNIEXPORT jlongArray JNICALL
+Java_org_gearvrf_NativeAssimpImporter_createSceneGraph(JNIEnv * env,
+        jobject obj, jlong jassimp_importer, jlongArray jmeshes);
+JNIEXPORT jboolean JNICALL
+Java_org_gearvrf_NativeAssimpImporter_writeMeshCache(JNIEnv * env,
+        jobject obj, jlong jassimp_importer);
+}
+
+static jobject new_material(JNIEnv * env, AssimpImporter* assimp_importer,
+        int mesh_index) {
+    aiMaterial* material = assimp_importer->getMeshMaterial(mesh_index);
+    if (material == 0) {
+        return NULL;
+    }
+    jobject jmaterial = mesh_material(env, material);
+    delete material;
+    return jmaterial;
 }
 
 JNIEXPORT jint JNICALL
@@ -64,6 +84,10 @@ Java_org_gearvrf_NativeAssimpImporter_getAssimpScene(
             reinterpret_cast<AssimpImporter*>(jassimp_importer);
     jobject jassimp_scene = NULL;
     const aiScene *assimp_scene = assimp_importer->getAssimpScene();
+    if (assimp_scene == 0) {
+        LOGE("_ASSIMP_SCENE_NOT_FOUND_");
+        return NULL;
+    }
     create_instance(env, "org/gearvrf/jassimp/AiScene", jassimp_scene);
     load_scene_graph(env, assimp_scene, jassimp_scene);
     return reinterpret_cast<jobject>(jassimp_scene);
@@ -75,11 +99,9 @@ Java_org_gearvrf_NativeAssimpImporter_getNodeMesh(JNIEnv * env,
     AssimpImporter* assimp_importer =
             reinterpret_cast<AssimpImporter*>(jassimp_importer);
     const char *node_name = env->GetStringUTFChars(jnode_name, 0);
-    aiNode* root_node = assimp_importer->getAssimpScene()->mRootNode;
-    aiNode* current_node = root_node->FindNode(node_name);
+    Mesh* mesh = assimp_importer->getNodeMesh(node_name, index);
     env->ReleaseStringUTFChars(jnode_name, node_name);
-    return reinterpret_cast<jlong>(assimp_importer->getMesh(current_node->mMeshes[index]));
-
+    return reinterpret_cast<jlong>(mesh);
 }
 
 JNIEXPORT jobject JNICALL
@@ -88,10 +110,58 @@ Java_org_gearvrf_NativeAssimpImporter_getMeshMaterial(JNIEnv * env,
     AssimpImporter* assimp_importer =
             reinterpret_cast<AssimpImporter*>(jassimp_importer);
     const char *node_name = env->GetStringUTFChars(jnode_name, 0);
-    aiNode* root_node = assimp_importer->getAssimpScene()->mRootNode;
-    aiNode* current_node = root_node->FindNode(node_name);
+    int mesh_index = assimp_importer->getNodeMeshIndex(node_name, index);
     env->ReleaseStringUTFChars(jnode_name, node_name);
-    const aiScene *assimp_scene = assimp_importer->getAssimpScene();
-    return reinterpret_cast<jobject>(mesh_material(env, assimp_scene, current_node->mMeshes[index]));
+    return new_material(env, assimp_importer, mesh_index);
+}
+
+JNIEXPORT jobject JNICALL
+Java_org_gearvrf_NativeAssimpImporter_getMaterial(JNIEnv * env,
+        jobject obj, jlong jassimp_importer, jint mesh_index) {
+    AssimpImporter* assimp_importer =
+            reinterpret_cast<AssimpImporter*>(jassimp_importer);
+    return new_material(env, assimp_importer, mesh_index);
+}
+
+JNIEXPORT jlongArray JNICALL
+Java_org_gearvrf_NativeAssimpImporter_createSceneGraph(JNIEnv * env,
+        jobject obj, jlong jassimp_importer, jlongArray jmeshes) {
+    AssimpImporter* assimp_importer =
+            reinterpret_cast<AssimpImporter*>(jassimp_importer);
+
+    int mesh_count = static_cast<int>(env->GetArrayLength(jmeshes));
+    std::vector<jlong> mesh_pointers(mesh_count);
+    env->GetLongArrayRegion(jmeshes, 0, mesh_count, mesh_pointers.data());
+    std::vector<Mesh*> meshes(mesh_count);
+    for (int i = 0; i < mesh_count; ++i) {
+        meshes[i] = reinterpret_cast<Mesh*>(mesh_pointers[i]);
+    }
+
+    std::vector<AssimpImporter::SceneNode> nodes;
+    assimp_importer->createSceneGraph(meshes, nodes);
+
+    // the layout GVRAssimpImporter.createSceneGraph() reads
+    const int stride = 5;
+    std::vector<jlong> handles(nodes.size() * stride);
+    for (size_t i = 0; i < nodes.size(); ++i) {
+        jlong* record = &handles[i * stride];
+        record[0] = reinterpret_cast<jlong>(nodes[i].scene_object);
+        record[1] = reinterpret_cast<jlong>(nodes[i].transform);
+        record[2] = nodes[i].parent;
+        record[3] = reinterpret_cast<jlong>(nodes[i].render_data);
+        record[4] = nodes[i].mesh_index;
+    }
+
+    jlongArray jhandles = env->NewLongArray(handles.size());
+    env->SetLongArrayRegion(jhandles, 0, handles.size(), handles.data());
+    return jhandles;
+}
+
+JNIEXPORT jboolean JNICALL
+Java_org_gearvrf_NativeAssimpImporter_writeMeshCache(JNIEnv * env,
+        jobject obj, jlong jassimp_importer) {
+    AssimpImporter* assimp_importer =
+            reinterpret_cast<AssimpImporter*>(jassimp_importer);
+    return assimp_importer->writeMeshCache();
 }
 }
@@ -23,7 +23,36 @@ namespace gvr {
 AssimpImporter* Importer::readFileFromAssets(char* buffer, long size,
         const char * filename, int settings) {
     Assimp::Importer* importer = new Assimp::Importer();
-    char* hint = 0;
+    importer->ReadFileFromMemory(buffer, size, settings, getHint(filename));
+
+    return new AssimpImporter(importer);
+}
+
+AssimpImporter* Importer::readFileCached(char* buffer, long size,
+        const char * filename, int settings, const std::string& cache_dir) {
+    if (cache_dir.empty()) {
+        return readFileFromAssets(buffer, size, filename, settings);
+    }
+
+    std::string path = MeshCache::path(cache_dir, buffer, size, settings);
+    MeshCache* mesh_cache = MeshCache::open(path);
+    if (mesh_cache != 0) {
+        LOGD("Importer::readFileCached() : %s from %s", filename, path.c_str());
+        return new AssimpImporter(mesh_cache);
+    }
+
+    // the meshes are converted by whoever asks for them, possibly on
+    // several threads, and the cache is written from their copies after
+    AssimpImporter* assimp_importer = readFileFromAssets(buffer, size,
+            filename, settings);
+    if (assimp_importer->getAssimpScene() != 0) {
+        assimp_importer->set_mesh_cache_path(path);
+    }
+    return assimp_importer;
+}
+
+const char* Importer::getHint(const char * filename) {
+    const char* hint = 0;
 
     if (filename != 0) {
         hint = strrchr(filename, '.');
@@ -31,9 +60,7 @@ AssimpImporter* Importer::readFileFromAssets(char* buffer, long size,
             hint = hint + 1;
         }
     }
-    importer->ReadFileFromMemory(buffer, size, settings, hint);
-
-    return new AssimpImporter(importer);
+    return hint;
 }
 
 AssimpImporter* Importer::readFileFromSDCard(const char * filename, int settings) {
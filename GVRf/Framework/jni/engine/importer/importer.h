@@ -21,6 +21,7 @@
 #define IMPORTER_H_
 
 #include <memory>
+#include <string>
 
 #include "assimp/scene.h"
 #include "assimp/Importer.hpp"
@@ -37,6 +38,16 @@ public:
 
     static AssimpImporter* readFileFromAssets(char* buffer, long size, const char * filename, int settings);
     static AssimpImporter* readFileFromSDCard(const char * filename, int settings);
+
+    // As readFileFromAssets(), but takes the meshes from a cache in cache_dir
+    // when this file was imported with these settings before. When it was
+    // not, AssimpImporter::writeMeshCache() writes one once every mesh has
+    // been converted.
+    static AssimpImporter* readFileCached(char* buffer, long size,
+            const char * filename, int settings, const std::string& cache_dir);
+
+private:
+    static const char* getHint(const char * filename);
 };
 }
 #endif
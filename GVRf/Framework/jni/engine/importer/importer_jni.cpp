@@ -30,18 +30,31 @@ namespace gvr {
 extern "C" {
 JNIEXPORT jlong JNICALL
 Java_org_gearvrf_NativeImporter_readFileFromAssets(JNIEnv * env,
-        jobject obj, jobject asset_manager, jstring filename, jint settings);
+        jobject obj, jobject asset_manager, jstring filename, jint settings,
+        jstring cache_dir);
 JNIEXPORT jlong JNICALL
 Java_org_gearvrf_NativeImporter_readFileFromSDCard(JNIEnv * env,
         jobject obj, jstring filename, jint settings);
 JNIEXPORT jlong JNICALL
 Java_org_gearvrf_NativeImporter_readFromByteArray(JNIEnv * env,
-        jobject obj, jbyteArray bytes, jstring filename, jint settings);
+        jobject obj, jbyteArray bytes, jstring filename, jint settings,
+        jstring cache_dir);
+}
+
+static std::string getCacheDir(JNIEnv * env, jstring cache_dir) {
+    if (cache_dir == 0) {
+        return std::string();
+    }
+    const char* native_cache_dir = env->GetStringUTFChars(cache_dir, 0);
+    std::string dir(native_cache_dir);
+    env->ReleaseStringUTFChars(cache_dir, native_cache_dir);
+    return dir;
 }
 
 JNIEXPORT jlong JNICALL
 Java_org_gearvrf_NativeImporter_readFileFromAssets(JNIEnv * env,
-        jobject obj, jobject asset_manager, jstring filename, jint settings) {
+        jobject obj, jobject asset_manager, jstring filename, jint settings,
+        jstring cache_dir) {
     const char* native_string = env->GetStringUTFChars(filename, 0);
     AAssetManager* mgr = AAssetManager_fromJava(env, asset_manager);
     AAsset* asset = AAssetManager_open(mgr, native_string, AASSET_MODE_UNKNOWN);
@@ -53,8 +66,9 @@ Java_org_gearvrf_NativeImporter_readFileFromAssets(JNIEnv * env,
     char* buffer = (char*) malloc(sizeof(char) * size);
     AAsset_read(asset, buffer, size);
 
-    AssimpImporter* assimp_scene = Importer::readFileFromAssets(
-            buffer, size, native_string, static_cast<int>(settings));
+    AssimpImporter* assimp_scene = Importer::readFileCached(buffer, size,
+            native_string, static_cast<int>(settings),
+            getCacheDir(env, cache_dir));
 
     AAsset_close(asset);
 
@@ -67,15 +81,17 @@ Java_org_gearvrf_NativeImporter_readFileFromAssets(JNIEnv * env,
 
 JNIEXPORT jlong JNICALL
 Java_org_gearvrf_NativeImporter_readFromByteArray(JNIEnv * env,jobject obj,
-        jbyteArray bytes, jstring filename, jint settings) {
+        jbyteArray bytes, jstring filename, jint settings,
+        jstring cache_dir) {
     jbyte* data = env->GetByteArrayElements(bytes, 0);
     int length = static_cast<int>(env->GetArrayLength(bytes));
     const char* native_string = env->GetStringUTFChars(filename, 0);
 
-    AssimpImporter* assimp_scene = Importer::readFileFromAssets(
-            (char*)data, length, native_string, static_cast<int>(settings));
+    AssimpImporter* assimp_scene = Importer::readFileCached((char*) data,
+            length, native_string, static_cast<int>(settings),
+            getCacheDir(env, cache_dir));
 
-    env->ReleaseByteArrayElements(bytes, data, 0);
+    env->ReleaseByteArrayElements(bytes, data, JNI_ABORT);
     env->ReleaseStringUTFChars(filename, native_string);
 
     return reinterpret_cast<jlong>(assimp_scene);
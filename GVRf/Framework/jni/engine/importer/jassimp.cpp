@@ -34,6 +34,8 @@
 
 #include "jassimp.h"
 
+#include <mutex>
+
 namespace gvr {
 
 class DeleteLocalRef {
@@ -54,6 +56,114 @@ public:
 };
 
 
+/*
+ * The classes, methods and fields the scene graph and materials are built
+ * with, looked up once rather than for every node and property. Classes are
+ * kept as global references, so the IDs stay valid; they are looked up from
+ * a call made from Java, where FindClass() sees the application's classes.
+ */
+struct JassimpIds {
+    jclass jassimp_class;
+    jmethodID wrap_matrix;
+    jmethodID wrap_scene_node;
+    jmethodID wrap_color4;
+
+    jclass material_class;
+    jmethodID material_constructor;
+    jmethodID set_texture_number;
+    jfieldID material_properties;
+
+    jclass property_class;
+    jmethodID property_object_constructor;
+    jmethodID property_buffer_constructor;
+    jfieldID property_data;
+
+    jclass float_class;
+    jmethodID float_constructor;
+    jclass integer_class;
+    jmethodID integer_constructor;
+
+    jmethodID list_add;
+};
+
+static JassimpIds jassimp_ids;
+static bool jassimp_ids_found = false;
+static std::mutex jassimp_ids_mutex;
+
+static jclass find_global_class(JNIEnv *env, const char* class_name) {
+    jclass java_class = env->FindClass(class_name);
+    if (NULL == java_class) {
+        return NULL;
+    }
+    jclass global_class = (jclass) env->NewGlobalRef(java_class);
+    env->DeleteLocalRef(java_class);
+    return global_class;
+}
+
+static const JassimpIds* get_jassimp_ids(JNIEnv *env) {
+    std::lock_guard<std::mutex> lock(jassimp_ids_mutex);
+    if (jassimp_ids_found) {
+        return &jassimp_ids;
+    }
+
+    JassimpIds& ids = jassimp_ids;
+    ids.jassimp_class = find_global_class(env, "org/gearvrf/jassimp/Jassimp");
+    ids.material_class = find_global_class(env,
+            "org/gearvrf/jassimp/AiMaterial");
+    ids.property_class = find_global_class(env,
+            "org/gearvrf/jassimp/AiMaterial$Property");
+    ids.float_class = find_global_class(env, "java/lang/Float");
+    ids.integer_class = find_global_class(env, "java/lang/Integer");
+    jclass list_class = env->FindClass("java/util/List");
+    if (NULL == ids.jassimp_class || NULL == ids.material_class
+            || NULL == ids.property_class || NULL == ids.float_class
+            || NULL == ids.integer_class || NULL == list_class) {
+        LOGE("jassimp : classes not found");
+        return NULL;
+    }
+    DeleteLocalRef list_class_ref(env, list_class);
+
+    ids.wrap_matrix = env->GetStaticMethodID(ids.jassimp_class, "wrapMatrix",
+            "([F)Ljava/lang/Object;");
+    ids.wrap_scene_node = env->GetStaticMethodID(ids.jassimp_class,
+            "wrapSceneNode",
+            "(Ljava/lang/Object;Ljava/lang/Object;[ILjava/lang/String;)Ljava/lang/Object;");
+    ids.wrap_color4 = env->GetStaticMethodID(ids.jassimp_class, "wrapColor4",
+            "(FFFF)Ljava/lang/Object;");
+    ids.material_constructor = env->GetMethodID(ids.material_class, "<init>",
+            "()V");
+    ids.set_texture_number = env->GetMethodID(ids.material_class,
+            "setTextureNumber", "(II)V");
+    ids.material_properties = env->GetFieldID(ids.material_class,
+            "m_properties", "Ljava/util/List;");
+    ids.property_object_constructor = env->GetMethodID(ids.property_class,
+            "<init>", "(Ljava/lang/String;IIILjava/lang/Object;)V");
+    ids.property_buffer_constructor = env->GetMethodID(ids.property_class,
+            "<init>", "(Ljava/lang/String;IIII)V");
+    ids.property_data = env->GetFieldID(ids.property_class, "m_data",
+            "Ljava/lang/Object;");
+    ids.float_constructor = env->GetMethodID(ids.float_class, "<init>",
+            "(F)V");
+    ids.integer_constructor = env->GetMethodID(ids.integer_class, "<init>",
+            "(I)V");
+    ids.list_add = env->GetMethodID(list_class, "add",
+            "(Ljava/lang/Object;)Z");
+    if (NULL == ids.wrap_matrix || NULL == ids.wrap_scene_node
+            || NULL == ids.wrap_color4 || NULL == ids.material_constructor
+            || NULL == ids.set_texture_number
+            || NULL == ids.material_properties
+            || NULL == ids.property_object_constructor
+            || NULL == ids.property_buffer_constructor
+            || NULL == ids.property_data || NULL == ids.float_constructor
+            || NULL == ids.integer_constructor || NULL == ids.list_add) {
+        LOGE("jassimp : methods not found");
+        return NULL;
+    }
+
+    jassimp_ids_found = true;
+    return &jassimp_ids;
+}
+
 bool create_instance(JNIEnv *env, const char* class_name,
         jobject& new_instance) {
     jclass java_class = env->FindClass(class_name);
@@ -203,62 +313,55 @@ bool call_static_object(JNIEnv *env, const char* type_name,
 
 bool load_scene_node(JNIEnv *env, const aiNode *assimp_node, jobject parent,
         jobject* loaded_node) {
+    const JassimpIds* ids = get_jassimp_ids(env);
+    if (NULL == ids) {
+        return false;
+    }
+
     /* wrap matrix */
     jfloatArray jassimp_wrap_matrix = env->NewFloatArray(16);
     env->SetFloatArrayRegion(jassimp_wrap_matrix, 0, 16,
             (jfloat*) &assimp_node->mTransformation);
-
-    jvalue wrap_matrix_params[1];
-    wrap_matrix_params[0].l = jassimp_wrap_matrix;
-    jobject jassimp_matrix;
     DeleteLocalRef jassimp_wrap_matrix_ref(env, jassimp_wrap_matrix);
 
-    if (!call_static_object(env, "org/gearvrf/jassimp/Jassimp", "wrapMatrix",
-            "([F)Ljava/lang/Object;", wrap_matrix_params, jassimp_matrix)) {
+    jobject jassimp_matrix = env->CallStaticObjectMethod(ids->jassimp_class,
+            ids->wrap_matrix, jassimp_wrap_matrix);
+    DeleteLocalRef jassimp_matrix_ref(env, jassimp_matrix);
+    if (env->ExceptionCheck()) {
         return false;
     }
 
     /* create mesh references array */
     jintArray jassimp_mesh_ref_arr = env->NewIntArray(assimp_node->mNumMeshes);
-    jint *temp = (jint*) malloc(sizeof(jint) * assimp_node->mNumMeshes);
-
-    for (unsigned int i = 0; i < assimp_node->mNumMeshes; i++) {
-        temp[i] = assimp_node->mMeshes[i];
-    }
     env->SetIntArrayRegion(jassimp_mesh_ref_arr, 0, assimp_node->mNumMeshes,
-            (jint*) temp);
-
-    free(temp);
+            (const jint*) assimp_node->mMeshes);
+    DeleteLocalRef jassimp_mesh_ref_arr_ref(env, jassimp_mesh_ref_arr);
 
     /* convert name */
     jstring jassimp_node_name = env->NewStringUTF(assimp_node->mName.C_Str());
-    /* wrap scene node */
-    jvalue wrap_node_params[4];
-    wrap_node_params[0].l = parent;
-    wrap_node_params[1].l = jassimp_matrix;
-    wrap_node_params[2].l = jassimp_mesh_ref_arr;
-    wrap_node_params[3].l = jassimp_node_name;
-
-    DeleteLocalRef jassimp_matrix_ref(env, jassimp_matrix);
-    DeleteLocalRef jassimp_mesh_ref_arr_ref(env, jassimp_mesh_ref_arr);
     DeleteLocalRef jassimp_node_name_ref(env, jassimp_node_name);
 
-    jobject jassimp_node;
-    if (!call_static_object(env, "org/gearvrf/jassimp/Jassimp", "wrapSceneNode",
-            "(Ljava/lang/Object;Ljava/lang/Object;[ILjava/lang/String;)Ljava/lang/Object;",
-            wrap_node_params, jassimp_node)) {
+    /* wrap scene node */
+    jobject jassimp_node = env->CallStaticObjectMethod(ids->jassimp_class,
+            ids->wrap_scene_node, parent, jassimp_matrix,
+            jassimp_mesh_ref_arr, jassimp_node_name);
+    if (env->ExceptionCheck()) {
         return false;
     }
 
-    /* and recurse */
+    /* and recurse; the children hold on to their parent, so the local
+     * reference can go before the next sibling, however big the graph */
     for (unsigned int c = 0; c < assimp_node->mNumChildren; c++) {
         if (!load_scene_node(env, assimp_node->mChildren[c], jassimp_node)) {
+            env->DeleteLocalRef(jassimp_node);
             return false;
         }
     }
 
     if (NULL != loaded_node) {
         *loaded_node = jassimp_node;
+    } else {
+        env->DeleteLocalRef(jassimp_node);
     }
 
     return true;
@@ -267,7 +370,7 @@ bool load_scene_node(JNIEnv *env, const aiNode *assimp_node, jobject parent,
 bool load_scene_graph(JNIEnv *env, const aiScene* assimp_scene,
         jobject& jassimp_scene) {
     if (NULL != assimp_scene->mRootNode) {
-        jobject jassimp_root;
+        jobject jassimp_root = NULL;
         DeleteLocalRef ref(env, jassimp_root);
 
         if (!load_scene_node(env, assimp_scene->mRootNode, NULL,
@@ -283,14 +386,46 @@ bool load_scene_graph(JNIEnv *env, const aiScene* assimp_scene,
     return true;
 }
 
-jobject mesh_material(JNIEnv *env, const aiScene *assimp_scene, int index) {
-    aiMesh* assimp_mesh = assimp_scene->mMeshes[index];
-    aiMaterial* assimp_material =
-            assimp_scene->mMaterials[assimp_mesh->mMaterialIndex];
-    jobject jassimp_material = NULL;
+static jobject new_property_data(JNIEnv *env, const JassimpIds* ids,
+        const aiMaterialProperty* assimp_material_property) {
+    const float* float_data = (const float*) assimp_material_property->mData;
+
+    /* special case conversion for color3 and color4 */
+    if (NULL != strstr(assimp_material_property->mKey.C_Str(), "clr")
+            && assimp_material_property->mType == aiPTI_Float
+            && (assimp_material_property->mDataLength == 3 * sizeof(float)
+                    || assimp_material_property->mDataLength
+                            == 4 * sizeof(float))) {
+        float alpha =
+                assimp_material_property->mDataLength == 4 * sizeof(float) ?
+                        float_data[3] : 1.0f;
+        return env->CallStaticObjectMethod(ids->jassimp_class,
+                ids->wrap_color4, float_data[0], float_data[1],
+                float_data[2], alpha);
+    } else if (assimp_material_property->mType == aiPTI_Float
+            && assimp_material_property->mDataLength == sizeof(float)) {
+        return env->NewObject(ids->float_class, ids->float_constructor,
+                float_data[0]);
+    } else if (assimp_material_property->mType == aiPTI_Integer
+            && assimp_material_property->mDataLength == sizeof(int)) {
+        return env->NewObject(ids->integer_class, ids->integer_constructor,
+                ((const int*) assimp_material_property->mData)[0]);
+    } else if (assimp_material_property->mType == aiPTI_String) {
+        /* skip length prefix */
+        return env->NewStringUTF(assimp_material_property->mData + 4);
+    }
+    return NULL;
+}
+
+jobject mesh_material(JNIEnv *env, const aiMaterial *assimp_material) {
+    const JassimpIds* ids = get_jassimp_ids(env);
+    if (NULL == ids) {
+        return NULL;
+    }
 
-    if (!create_instance(env, "org/gearvrf/jassimp/AiMaterial",
-            jassimp_material)) {
+    jobject jassimp_material = env->NewObject(ids->material_class,
+            ids->material_constructor);
+    if (NULL == jassimp_material) {
         return NULL;
     }
 
@@ -302,150 +437,53 @@ jobject mesh_material(JNIEnv *env, const aiScene *assimp_scene, int index) {
 
         unsigned int total_textures = assimp_material->GetTextureCount(
                 texture_type);
-        jvalue set_number_params[2];
-        set_number_params[0].i = texture_type_index;
-        set_number_params[1].i = total_textures;
+        env->CallVoidMethod(jassimp_material, ids->set_texture_number,
+                texture_type_index, total_textures);
+    }
 
-        if (!call_void_method(env, jassimp_material,
-                "org/gearvrf/jassimp/AiMaterial", "setTextureNumber", "(II)V",
-                set_number_params)) {
-            return NULL;
-        }
+    jobject jassimp_properties = env->GetObjectField(jassimp_material,
+            ids->material_properties);
+    DeleteLocalRef jassimp_properties_ref(env, jassimp_properties);
+    if (env->ExceptionCheck() || NULL == jassimp_properties) {
+        return NULL;
     }
 
     for (unsigned int p = 0; p < assimp_material->mNumProperties; p++) {
         const aiMaterialProperty* assimp_material_property =
                 assimp_material->mProperties[p];
-        jobject jassimp_material_property = NULL;
-        jvalue constructor_params[5];
-        constructor_params[0].l = env->NewStringUTF(
+        jstring jassimp_key = env->NewStringUTF(
                 assimp_material_property->mKey.C_Str());
-        constructor_params[1].i = assimp_material_property->mSemantic;
-        constructor_params[2].i = assimp_material_property->mIndex;
-        constructor_params[3].i = assimp_material_property->mType;
-
-        /* special case conversion for color3 */
-        if (NULL != strstr(assimp_material_property->mKey.C_Str(), "clr")
-                && assimp_material_property->mType == aiPTI_Float
-                && assimp_material_property->mDataLength == 3 * sizeof(float)) {
-            jobject jassimp_data = NULL;
-
-            /* wrap color */
-            jvalue wrap_color_params[3];
-            wrap_color_params[0].f =
-                    ((float*) assimp_material_property->mData)[0];
-            wrap_color_params[1].f =
-                    ((float*) assimp_material_property->mData)[1];
-            wrap_color_params[2].f =
-                    ((float*) assimp_material_property->mData)[2];
-            if (!call_static_object(env, "org/gearvrf/jassimp/Jassimp",
-                    "wrapColor3", "(FFF)Ljava/lang/Object;", wrap_color_params,
-                    jassimp_data)) {
-                return NULL;
-            }
-
-            DeleteLocalRef jassimp_data_ref(env, jassimp_data);
-            constructor_params[4].l = jassimp_data;
-            if (!create_instance(env, "org/gearvrf/jassimp/AiMaterial$Property",
-                    "(Ljava/lang/String;IIILjava/lang/Object;)V",
-                    constructor_params, jassimp_material_property)) {
-                return NULL;
-            }
-        }
-        /* special case conversion for color4 */
-        else if (NULL != strstr(assimp_material_property->mKey.C_Str(), "clr")
-                && assimp_material_property->mType == aiPTI_Float
-                && assimp_material_property->mDataLength == 4 * sizeof(float)) {
-            jobject jassimp_data = NULL;
-
-            /* wrap color */
-            jvalue wrap_color_params[4];
-            wrap_color_params[0].f =
-                    ((float*) assimp_material_property->mData)[0];
-            wrap_color_params[1].f =
-                    ((float*) assimp_material_property->mData)[1];
-            wrap_color_params[2].f =
-                    ((float*) assimp_material_property->mData)[2];
-            wrap_color_params[3].f =
-                    ((float*) assimp_material_property->mData)[3];
-            if (!call_static_object(env, "org/gearvrf/jassimp/Jassimp",
-                    "wrapColor4", "(FFFF)Ljava/lang/Object;", wrap_color_params,
-                    jassimp_data)) {
-                return NULL;
-            }
-            DeleteLocalRef jassimp_data_ref(env, jassimp_data);
-
-            constructor_params[4].l = jassimp_data;
-            if (!create_instance(env, "org/gearvrf/jassimp/AiMaterial$Property",
-                    "(Ljava/lang/String;IIILjava/lang/Object;)V",
-                    constructor_params, jassimp_material_property)) {
-                return NULL;
-            }
-        } else if (assimp_material_property->mType == aiPTI_Float
-                && assimp_material_property->mDataLength == sizeof(float)) {
-            jobject jassimp_data = NULL;
-
-            jvalue new_float_params[1];
-            new_float_params[0].f =
-                    ((float*) assimp_material_property->mData)[0];
-            if (!create_instance(env, "java/lang/Float", "(F)V",
-                    new_float_params, jassimp_data)) {
-                return NULL;
-            }
-
-            DeleteLocalRef jassimp_data_ref(env, jassimp_data);
-            constructor_params[4].l = jassimp_data;
-            if (!create_instance(env, "org/gearvrf/jassimp/AiMaterial$Property",
-                    "(Ljava/lang/String;IIILjava/lang/Object;)V",
-                    constructor_params, jassimp_material_property)) {
-                return NULL;
-            }
-        } else if (assimp_material_property->mType == aiPTI_Integer
-                && assimp_material_property->mDataLength == sizeof(int)) {
-            jobject jassimp_data = NULL;
-
-            jvalue new_int_params[1];
-            new_int_params[0].i = ((int*) assimp_material_property->mData)[0];
-            if (!create_instance(env, "java/lang/Integer", "(I)V",
-                    new_int_params, jassimp_data)) {
-                return NULL;
-            }
-
-            DeleteLocalRef jassimp_data_ref(env, jassimp_data);
-            constructor_params[4].l = jassimp_data;
-            if (!create_instance(env, "org/gearvrf/jassimp/AiMaterial$Property",
-                    "(Ljava/lang/String;IIILjava/lang/Object;)V",
-                    constructor_params, jassimp_material_property)) {
-                return NULL;
-            }
-        } else if (assimp_material_property->mType == aiPTI_String) {
-            /* skip length prefix */
-            jobject jassimp_data = env->NewStringUTF(
-                    assimp_material_property->mData + 4);
-
-            DeleteLocalRef jassimp_data_ref(env, jassimp_data);
-            constructor_params[4].l = jassimp_data;
-            if (!create_instance(env, "org/gearvrf/jassimp/AiMaterial$Property",
-                    "(Ljava/lang/String;IIILjava/lang/Object;)V",
-                    constructor_params, jassimp_material_property)) {
-                return NULL;
-            }
+        DeleteLocalRef jassimp_key_ref(env, jassimp_key);
+
+        jobject jassimp_data = new_property_data(env, ids,
+                assimp_material_property);
+        DeleteLocalRef jassimp_data_ref(env, jassimp_data);
+
+        jobject jassimp_material_property;
+        if (NULL != jassimp_data) {
+            jassimp_material_property = env->NewObject(ids->property_class,
+                    ids->property_object_constructor, jassimp_key,
+                    assimp_material_property->mSemantic,
+                    assimp_material_property->mIndex,
+                    assimp_material_property->mType, jassimp_data);
         } else {
-            constructor_params[4].i = assimp_material_property->mDataLength;
-
             /* generic copy code, uses dump ByteBuffer on java side */
-            if (!create_instance(env, "org/gearvrf/jassimp/AiMaterial$Property",
-                    "(Ljava/lang/String;IIII)V", constructor_params,
-                    jassimp_material_property)) {
-                return NULL;
-            }
-
-            jobject jassimp_buffer = NULL;
+            jassimp_material_property = env->NewObject(ids->property_class,
+                    ids->property_buffer_constructor, jassimp_key,
+                    assimp_material_property->mSemantic,
+                    assimp_material_property->mIndex,
+                    assimp_material_property->mType,
+                    assimp_material_property->mDataLength);
+        }
+        DeleteLocalRef jassimp_material_property_ref(env,
+                jassimp_material_property);
+        if (env->ExceptionCheck() || NULL == jassimp_material_property) {
+            return NULL;
+        }
 
-            if (!get_field(env, jassimp_material_property, "m_data",
-                    "Ljava/lang/Object;", jassimp_buffer)) {
-                return NULL;
-            }
+        if (NULL == jassimp_data) {
+            jobject jassimp_buffer = env->GetObjectField(
+                    jassimp_material_property, ids->property_data);
             DeleteLocalRef jassimp_buffer_ref(env, jassimp_buffer);
 
             if (env->GetDirectBufferCapacity(jassimp_buffer)
@@ -467,19 +505,9 @@ jobject mesh_material(JNIEnv *env, const aiScene *assimp_scene, int index) {
         }
 
         /* add property */
-        jobject jassimp_properties = NULL;
-
-        if (!get_field(env, jassimp_material, "m_properties",
-                "Ljava/util/List;", jassimp_properties)) {
-            return NULL;
-        }
-
-        DeleteLocalRef jassimp_properties_ref(env, jassimp_properties);
-        DeleteLocalRef jassimp_material_property_ref(env, jassimp_material_property);
-        jvalue add_properties_params[1];
-        add_properties_params[0].l = jassimp_material_property;
-        if (!call_method(env, jassimp_properties, "java/util/Collection", "add",
-                "(Ljava/lang/Object;)Z", add_properties_params)) {
+        env->CallBooleanMethod(jassimp_properties, ids->list_add,
+                jassimp_material_property);
+        if (env->ExceptionCheck()) {
             return NULL;
         }
     }
@@ -79,7 +79,7 @@ bool load_scene_node(JNIEnv *env, const aiNode *node, jobject parent,
 
 bool load_scene_graph(JNIEnv *env, const aiScene* assimp_scene, jobject& scene);
 
-jobject mesh_material(JNIEnv *env, const aiScene *assimp_scene, int index);
+jobject mesh_material(JNIEnv *env, const aiMaterial *assimp_material);
 
 }
 #endif
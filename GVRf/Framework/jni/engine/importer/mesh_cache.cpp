@@ -0,0 +1,542 @@
+/* Copyright 2015 Samsung Electronics Co., LTD
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/***************************************************************************
+ * A binary file of the meshes of an imported scene.
+ ***************************************************************************/
+
+#include "mesh_cache.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <vector>
+
+#include "assimp/material.h"
+#include "assimp/scene.h"
+#include "glm/gtc/type_ptr.hpp"
+
+#include "objects/mesh.h"
+#include "util/gvr_log.h"
+
+namespace gvr {
+
+namespace {
+
+const uint32_t BYTE_ORDER_MARK = 0x01020304;
+const uint32_t ALIGNMENT = 16;
+
+uint32_t align(uint32_t offset) {
+    return (offset + ALIGNMENT - 1) & ~(ALIGNMENT - 1);
+}
+
+// FNV-1a, which is quick and spreads well enough to name files by
+void hash(uint64_t& h, const void* data, size_t size) {
+    const unsigned char* bytes = static_cast<const unsigned char*>(data);
+    for (size_t i = 0; i < size; ++i) {
+        h ^= bytes[i];
+        h *= 1099511628211ULL;
+    }
+}
+
+// appends a copy of data to file at the next aligned offset
+uint32_t append(std::vector<unsigned char>& file, const void* data,
+        size_t size) {
+    uint32_t offset = align(file.size());
+    file.resize(offset + size);
+    if (size > 0) {
+        memcpy(&file[offset], data, size);
+    }
+    return offset;
+}
+
+template<class T>
+void copyStream(const unsigned char* data, uint32_t size,
+        std::vector<T>& vector) {
+    const T* begin = reinterpret_cast<const T*>(data);
+    vector.assign(begin, begin + size / sizeof(T));
+}
+
+template<class T>
+void copyBytes(const std::vector<T>& vector,
+        std::vector<unsigned char>& bytes) {
+    const unsigned char* begin =
+            reinterpret_cast<const unsigned char*>(vector.data());
+    bytes.assign(begin, begin + vector.size() * sizeof(T));
+}
+
+}
+
+MeshCache::MeshCache(const unsigned char* data, size_t size) :
+        data_(data), size_(size) {
+}
+
+MeshCache::~MeshCache() {
+    munmap(const_cast<unsigned char*>(data_), size_);
+}
+
+std::string MeshCache::path(const std::string& cache_dir, const char* buffer,
+        long size, int settings) {
+    uint64_t h = 14695981039346656037ULL;
+    hash(h, buffer, size);
+    hash(h, &settings, sizeof(settings));
+
+    char name[64];
+    snprintf(name, sizeof(name), "%016llx-%08lx-v%u.mesh",
+            static_cast<unsigned long long>(h),
+            static_cast<unsigned long>(size), VERSION);
+    return cache_dir + "/" + name;
+}
+
+MeshCache* MeshCache::open(const std::string& path) {
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        return 0;
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) != 0
+            || st.st_size < static_cast<off_t>(sizeof(Header))) {
+        close(fd);
+        return 0;
+    }
+
+    void* data = mmap(0, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (data == MAP_FAILED) {
+        LOGE("MeshCache::open() : mmap of %s failed, errno %d", path.c_str(),
+                errno);
+        return 0;
+    }
+
+    MeshCache* mesh_cache = new MeshCache(
+            static_cast<const unsigned char*>(data), st.st_size);
+    if (!mesh_cache->isValid()) {
+        LOGD("MeshCache::open() : ignoring stale %s", path.c_str());
+        delete mesh_cache;
+        unlink(path.c_str());
+        return 0;
+    }
+    return mesh_cache;
+}
+
+/*
+ * Offsets and sizes are summed and multiplied in 64 bits by the callers, so
+ * no record from a corrupt file can wrap around into range.
+ */
+bool MeshCache::contains(uint64_t offset, uint64_t size) const {
+    return offset <= size_ && size <= size_ - offset;
+}
+
+bool MeshCache::isValid() const {
+    const Header* h = header();
+    if (memcmp(h->magic, "GVRM", 4) != 0 || h->version != VERSION
+            || h->byte_order != BYTE_ORDER_MARK || h->file_size != size_) {
+        return false;
+    }
+
+    uint64_t mesh_count = h->mesh_count;
+    uint64_t node_count = h->node_count;
+    uint64_t material_count = h->material_count;
+    if (!contains(sizeof(Header),
+            mesh_count * sizeof(MeshRecord) + node_count * sizeof(NodeRecord))
+            || h->materials_offset % ALIGNMENT != 0
+            || h->properties_offset % ALIGNMENT != 0
+            || !contains(h->materials_offset,
+                    material_count * sizeof(MaterialRecord))
+            || !contains(h->node_meshes_offset, 0)
+            || !contains(h->names_offset, 0)
+            || !contains(h->properties_offset, 0)
+            || !contains(h->property_data_offset, 0)) {
+        return false;
+    }
+
+    const MaterialRecord* material_records = materials();
+    for (uint32_t i = 0; i < h->material_count; ++i) {
+        if (!isValidMaterial(material_records[i])) {
+            return false;
+        }
+    }
+
+    const MeshRecord* mesh_records = meshes();
+    for (uint32_t i = 0; i < h->mesh_count; ++i) {
+        const MeshRecord& mesh = mesh_records[i];
+        uint64_t stream_count = mesh.stream_count;
+        if (mesh.material_index >= h->material_count
+                || mesh.stream_count > STREAM_KIND_COUNT
+                || mesh.streams_offset % ALIGNMENT != 0
+                || !contains(mesh.streams_offset,
+                        stream_count * sizeof(StreamRecord))) {
+            return false;
+        }
+        const StreamRecord* streams =
+                reinterpret_cast<const StreamRecord*>(data_
+                        + mesh.streams_offset);
+        for (uint32_t j = 0; j < mesh.stream_count; ++j) {
+            if (streams[j].kind >= STREAM_KIND_COUNT
+                    || streams[j].encoding != RAW
+                    || streams[j].offset % ALIGNMENT != 0
+                    || !contains(streams[j].offset, streams[j].size)) {
+                return false;
+            }
+        }
+    }
+
+    // parents come before their children, so a scene graph can be built in
+    // one pass over the nodes
+    const NodeRecord* node_records = nodes();
+    uint64_t names_offset = h->names_offset;
+    uint64_t node_meshes_offset = h->node_meshes_offset;
+    for (uint32_t i = 0; i < h->node_count; ++i) {
+        const NodeRecord& node = node_records[i];
+        uint64_t first_mesh = node.first_mesh;
+        uint64_t node_mesh_count = node.mesh_count;
+        if (node.parent < -1 || node.parent >= static_cast<int32_t>(i)
+                || !contains(names_offset + node.name_offset, node.name_length)
+                || !contains(
+                        node_meshes_offset + first_mesh * sizeof(uint32_t),
+                        node_mesh_count * sizeof(uint32_t))) {
+            return false;
+        }
+        const uint32_t* mesh_indices = nodeMeshes() + node.first_mesh;
+        for (uint32_t j = 0; j < node.mesh_count; ++j) {
+            if (mesh_indices[j] >= h->mesh_count) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+bool MeshCache::isValidMaterial(const MaterialRecord& material) const {
+    const Header* h = header();
+    uint64_t first_property = material.first_property;
+    uint64_t property_count = material.property_count;
+    uint64_t properties_offset = h->properties_offset;
+    if (!contains(properties_offset + first_property * sizeof(PropertyRecord),
+            property_count * sizeof(PropertyRecord))) {
+        return false;
+    }
+
+    const PropertyRecord* property_records = properties()
+            + material.first_property;
+    uint64_t names_offset = h->names_offset;
+    uint64_t property_data_offset = h->property_data_offset;
+    for (uint32_t i = 0; i < material.property_count; ++i) {
+        const PropertyRecord& property = property_records[i];
+        uint64_t key_offset = names_offset + property.key_offset;
+        uint64_t data_offset = property_data_offset + property.data_offset;
+        if (property.key_length >= MAXLEN
+                || !contains(key_offset, property.key_length)
+                || !contains(data_offset, property.data_length)) {
+            return false;
+        }
+        // strings are a length and the characters, read up to the nul
+        if (property.type == aiPTI_String
+                && (property.data_length <= sizeof(uint32_t)
+                        || data_[data_offset + property.data_length - 1]
+                                != '\0')) {
+            return false;
+        }
+    }
+    return true;
+}
+
+Mesh* MeshCache::getMesh(int index) const {
+    if (index < 0
+            || static_cast<uint32_t>(index) >= header()->mesh_count) {
+        LOGE("MeshCache::getMesh() : no mesh %d", index);
+        return 0;
+    }
+
+    const MeshRecord& record = meshes()[index];
+    const StreamRecord* streams =
+            reinterpret_cast<const StreamRecord*>(data_ + record.streams_offset);
+
+    Mesh* mesh = new Mesh();
+    for (uint32_t i = 0; i < record.stream_count; ++i) {
+        const unsigned char* data = data_ + streams[i].offset;
+        uint32_t size = streams[i].size;
+        switch (streams[i].kind) {
+        case POSITIONS: {
+            std::vector<glm::vec3> vertices;
+            copyStream(data, size, vertices);
+            mesh->set_vertices(std::move(vertices));
+            break;
+        }
+        case NORMALS: {
+            std::vector<glm::vec3> normals;
+            copyStream(data, size, normals);
+            mesh->set_normals(std::move(normals));
+            break;
+        }
+        case TEX_COORDS: {
+            std::vector<glm::vec2> tex_coords;
+            copyStream(data, size, tex_coords);
+            mesh->set_tex_coords(std::move(tex_coords));
+            break;
+        }
+        case TRIANGLES: {
+            std::vector<unsigned short> triangles;
+            copyStream(data, size, triangles);
+            mesh->set_triangles(std::move(triangles));
+            break;
+        }
+        }
+    }
+    return mesh;
+}
+
+aiMaterial* MeshCache::getMeshMaterial(int mesh_index) const {
+    const Header* h = header();
+    if (mesh_index < 0
+            || static_cast<uint32_t>(mesh_index) >= h->mesh_count) {
+        LOGE("MeshCache::getMeshMaterial() : no mesh %d", mesh_index);
+        return 0;
+    }
+
+    const MaterialRecord& record =
+            materials()[meshes()[mesh_index].material_index];
+    const PropertyRecord* property_records = properties()
+            + record.first_property;
+    const char* names = reinterpret_cast<const char*>(data_ + h->names_offset);
+
+    aiMaterial* material = new aiMaterial();
+    for (uint32_t i = 0; i < record.property_count; ++i) {
+        const PropertyRecord& property = property_records[i];
+        std::string key(names + property.key_offset, property.key_length);
+        material->AddBinaryProperty(
+                data_ + h->property_data_offset + property.data_offset,
+                property.data_length, key.c_str(), property.semantic,
+                property.index,
+                static_cast<aiPropertyTypeInfo>(property.type));
+    }
+    return material;
+}
+
+int MeshCache::getNodeMeshIndex(const char* node_name, int index) const {
+    const Header* h = header();
+    const NodeRecord* node_records = nodes();
+    const char* names = reinterpret_cast<const char*>(data_ + h->names_offset);
+    const uint32_t* node_meshes = nodeMeshes();
+    size_t length = strlen(node_name);
+
+    // the first match in depth-first order, as aiNode::FindNode()
+    for (uint32_t i = 0; i < h->node_count; ++i) {
+        const NodeRecord& node = node_records[i];
+        if (node.name_length == length
+                && memcmp(names + node.name_offset, node_name, length) == 0) {
+            if (index < 0
+                    || static_cast<uint32_t>(index) >= node.mesh_count) {
+                return -1;
+            }
+            return node_meshes[node.first_mesh + index];
+        }
+    }
+    return -1;
+}
+
+std::string MeshCache::getNodeName(int node) const {
+    const NodeRecord& record = nodes()[node];
+    const char* names = reinterpret_cast<const char*>(data_
+            + header()->names_offset);
+    return std::string(names + record.name_offset, record.name_length);
+}
+
+glm::mat4 MeshCache::getNodeTransform(int node) const {
+    // Assimp matrices are row-major
+    return glm::transpose(glm::make_mat4(nodes()[node].transform));
+}
+
+namespace {
+
+struct NodeEntry {
+    const aiNode* node;
+    int32_t parent;
+};
+
+}
+
+void MeshCache::copyStreams(const Mesh& mesh, MeshStreams& streams) {
+    streams.resize(STREAM_KIND_COUNT);
+    copyBytes(mesh.vertices(), streams[POSITIONS]);
+    copyBytes(mesh.normals(), streams[NORMALS]);
+    copyBytes(mesh.tex_coords(), streams[TEX_COORDS]);
+    copyBytes(mesh.triangles(), streams[TRIANGLES]);
+}
+
+bool MeshCache::write(const std::string& path, const aiScene* scene,
+        const std::vector<MeshStreams>& meshes) {
+    if (scene == 0 || meshes.size() != scene->mNumMeshes) {
+        return false;
+    }
+    for (auto it = meshes.begin(); it != meshes.end(); ++it) {
+        if (it->size() != STREAM_KIND_COUNT) {
+            return false;
+        }
+    }
+
+    // nodes in depth-first order, so the first found by name is the one
+    // aiNode::FindNode() would find
+    std::vector<NodeEntry> node_entries;
+    if (scene->mRootNode != 0) {
+        std::vector<NodeEntry> stack;
+        NodeEntry root = { scene->mRootNode, -1 };
+        stack.push_back(root);
+        while (!stack.empty()) {
+            NodeEntry entry = stack.back();
+            stack.pop_back();
+            int32_t self = node_entries.size();
+            node_entries.push_back(entry);
+            for (unsigned int i = entry.node->mNumChildren; i > 0; --i) {
+                NodeEntry child = { entry.node->mChildren[i - 1], self };
+                stack.push_back(child);
+            }
+        }
+    }
+
+    Header h;
+    memcpy(h.magic, "GVRM", 4);
+    h.version = VERSION;
+    h.byte_order = BYTE_ORDER_MARK;
+    h.mesh_count = scene->mNumMeshes;
+    h.node_count = node_entries.size();
+
+    std::vector<uint32_t> node_meshes;
+    std::string names;
+    std::vector<NodeRecord> node_records(node_entries.size());
+    for (size_t i = 0; i < node_entries.size(); ++i) {
+        const aiNode* node = node_entries[i].node;
+        NodeRecord& record = node_records[i];
+        memset(&record, 0, sizeof(record));
+        record.parent = node_entries[i].parent;
+        record.name_offset = names.size();
+        record.name_length = node->mName.length;
+        names.append(node->mName.data, node->mName.length);
+        record.first_mesh = node_meshes.size();
+        record.mesh_count = node->mNumMeshes;
+        node_meshes.insert(node_meshes.end(), node->mMeshes,
+                node->mMeshes + node->mNumMeshes);
+        memcpy(record.transform, &node->mTransformation,
+                sizeof(record.transform));
+    }
+
+    // every property of every material, whatever it is, so the materials
+    // made from the cache are those Assimp would make
+    h.material_count = scene->mNumMaterials;
+    std::vector<MaterialRecord> material_records(h.material_count);
+    std::vector<PropertyRecord> property_records;
+    std::vector<unsigned char> property_data;
+    for (uint32_t i = 0; i < h.material_count; ++i) {
+        const aiMaterial* material = scene->mMaterials[i];
+        MaterialRecord& record = material_records[i];
+        memset(&record, 0, sizeof(record));
+        record.first_property = property_records.size();
+        record.property_count = material->mNumProperties;
+        for (unsigned int j = 0; j < material->mNumProperties; ++j) {
+            const aiMaterialProperty* property = material->mProperties[j];
+            PropertyRecord property_record;
+            memset(&property_record, 0, sizeof(property_record));
+            property_record.key_offset = names.size();
+            property_record.key_length = property->mKey.length;
+            names.append(property->mKey.data, property->mKey.length);
+            property_record.semantic = property->mSemantic;
+            property_record.index = property->mIndex;
+            property_record.type = property->mType;
+            property_record.data_offset = property_data.size();
+            property_record.data_length = property->mDataLength;
+            property_data.insert(property_data.end(), property->mData,
+                    property->mData + property->mDataLength);
+            property_records.push_back(property_record);
+        }
+    }
+
+    std::vector<unsigned char> file(sizeof(Header));
+    std::vector<MeshRecord> mesh_records(h.mesh_count);
+    uint32_t mesh_records_offset = append(file, mesh_records.data(),
+            mesh_records.size() * sizeof(MeshRecord));
+    append(file, node_records.data(), node_records.size() * sizeof(NodeRecord));
+    h.node_meshes_offset = append(file, node_meshes.data(),
+            node_meshes.size() * sizeof(uint32_t));
+    h.names_offset = append(file, names.data(), names.size());
+    h.materials_offset = append(file, material_records.data(),
+            material_records.size() * sizeof(MaterialRecord));
+    h.properties_offset = append(file, property_records.data(),
+            property_records.size() * sizeof(PropertyRecord));
+    h.property_data_offset = append(file, property_data.data(),
+            property_data.size());
+
+    for (uint32_t i = 0; i < h.mesh_count; ++i) {
+        StreamRecord streams[STREAM_KIND_COUNT];
+        uint32_t stream_count = 0;
+        for (uint32_t kind = 0; kind < STREAM_KIND_COUNT; ++kind) {
+            const std::vector<unsigned char>& data = meshes[i][kind];
+            if (!data.empty()) {
+                StreamRecord& stream = streams[stream_count++];
+                stream.kind = kind;
+                stream.encoding = RAW;
+                stream.offset = append(file, data.data(), data.size());
+                stream.size = data.size();
+            }
+        }
+
+        MeshRecord record;
+        record.stream_count = stream_count;
+        record.streams_offset = append(file, streams,
+                stream_count * sizeof(StreamRecord));
+        record.material_index = scene->mMeshes[i]->mMaterialIndex;
+        record.reserved = 0;
+        memcpy(&file[mesh_records_offset + i * sizeof(MeshRecord)], &record,
+                sizeof(record));
+    }
+
+    h.file_size = file.size();
+    memcpy(&file[0], &h, sizeof(h));
+
+    // written aside and renamed, so a half-written file is never opened; the
+    // temporary file is unique, as two loads of a model may write at once
+    std::vector<char> temp_path(path.begin(), path.end());
+    const char suffix[] = ".XXXXXX";
+    temp_path.insert(temp_path.end(), suffix, suffix + sizeof(suffix));
+    int fd = mkstemp(&temp_path[0]);
+    if (fd < 0) {
+        LOGE("MeshCache::write() : cannot create %s, errno %d", &temp_path[0],
+                errno);
+        return false;
+    }
+    FILE* out = fdopen(fd, "wb");
+    if (out == 0) {
+        LOGE("MeshCache::write() : cannot open %s, errno %d", &temp_path[0],
+                errno);
+        close(fd);
+        unlink(&temp_path[0]);
+        return false;
+    }
+    bool written = fwrite(&file[0], 1, file.size(), out) == file.size();
+    written = fclose(out) == 0 && written;
+    if (!written || rename(&temp_path[0], path.c_str()) != 0) {
+        LOGE("MeshCache::write() : cannot write %s", path.c_str());
+        unlink(&temp_path[0]);
+        return false;
+    }
+    return true;
+}
+
+}
@@ -0,0 +1,231 @@
+/* Copyright 2015 Samsung Electronics Co., LTD
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/***************************************************************************
+ * A binary file of the meshes of an imported scene.
+ ***************************************************************************/
+
+#ifndef MESH_CACHE_H_
+#define MESH_CACHE_H_
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+#include "glm/glm.hpp"
+
+struct aiMaterial;
+struct aiScene;
+
+namespace gvr {
+class Mesh;
+
+/*
+ * The meshes of an imported file, as AssimpImporter::getMesh() makes them,
+ * the nodes that use them, and the material properties of each mesh, so
+ * that later imports of the same file with the same settings never parse
+ * the source. The file is named after a hash of the source file and the
+ * settings, and mapped into memory to read; each mesh stream is copied
+ * into its vector in one go.
+ *
+ * The layout is little-endian, with every array 16-byte aligned:
+ *
+ *   Header
+ *   MeshRecord[mesh_count]
+ *   NodeRecord[node_count]
+ *   uint32_t node mesh indices
+ *   node names and material property keys
+ *   MaterialRecord[material_count]
+ *   PropertyRecord[] of all materials
+ *   property data of all materials
+ *   StreamRecord[] and data of each mesh
+ *
+ * Files of another version, byte order, or size than expected are ignored,
+ * and written again on the next import.
+ */
+class MeshCache {
+public:
+    ~MeshCache();
+
+    // where the cache of a source file imported with settings goes
+    static std::string path(const std::string& cache_dir, const char* buffer,
+            long size, int settings);
+
+    // null if there is no usable cache at path
+    static MeshCache* open(const std::string& path);
+
+    // A converted mesh as it goes in the file, one byte vector per stream.
+    // The threads converting meshes copy them out as they go, so the file
+    // can be written once all are done without converting them again.
+    typedef std::vector<std::vector<unsigned char> > MeshStreams;
+
+    static void copyStreams(const Mesh& mesh, MeshStreams& streams);
+
+    // writes the nodes and materials of a freshly imported scene, and its
+    // meshes, as copyStreams() copied each of them
+    static bool write(const std::string& path, const aiScene* scene,
+            const std::vector<MeshStreams>& meshes);
+
+    unsigned int getNumberOfMeshes() const {
+        return header()->mesh_count;
+    }
+
+    Mesh* getMesh(int index) const;
+
+    // the material of a mesh, as a new aiMaterial for the caller to delete
+    aiMaterial* getMeshMaterial(int mesh_index) const;
+
+    // the index of the index-th mesh of the named node, or -1
+    int getNodeMeshIndex(const char* node_name, int index) const;
+
+    // Nodes are numbered in depth-first order, parents before children,
+    // from the root at 0, whose parent is -1.
+    unsigned int getNumberOfNodes() const {
+        return header()->node_count;
+    }
+
+    int getNodeParent(int node) const {
+        return nodes()[node].parent;
+    }
+
+    std::string getNodeName(int node) const;
+    glm::mat4 getNodeTransform(int node) const;
+
+    unsigned int getNodeNumberOfMeshes(int node) const {
+        return nodes()[node].mesh_count;
+    }
+
+    const uint32_t* getNodeMeshIndices(int node) const {
+        return nodeMeshes() + nodes()[node].first_mesh;
+    }
+
+private:
+    MeshCache(const unsigned char* data, size_t size);
+    MeshCache(const MeshCache& mesh_cache);
+    MeshCache(MeshCache&& mesh_cache);
+    MeshCache& operator=(const MeshCache& mesh_cache);
+    MeshCache& operator=(MeshCache&& mesh_cache);
+
+    static const uint32_t VERSION = 2;
+
+    enum StreamKind {
+        POSITIONS = 0, NORMALS, TEX_COORDS, TRIANGLES, STREAM_KIND_COUNT
+    };
+
+    // Only raw streams are written for now; the field leaves room for
+    // compressed ones without a new version.
+    enum StreamEncoding {
+        RAW = 0
+    };
+
+    struct Header {
+        char magic[4];
+        uint32_t version;
+        uint32_t byte_order;
+        uint32_t file_size;
+        uint32_t mesh_count;
+        uint32_t node_count;
+        uint32_t node_meshes_offset;
+        uint32_t names_offset;
+        uint32_t material_count;
+        uint32_t materials_offset;
+        uint32_t properties_offset;
+        uint32_t property_data_offset;
+    };
+
+    struct MeshRecord {
+        uint32_t stream_count;
+        uint32_t streams_offset;
+        uint32_t material_index;
+        uint32_t reserved;
+    };
+
+    struct StreamRecord {
+        uint32_t kind;
+        uint32_t encoding;
+        uint32_t offset;
+        uint32_t size;
+    };
+
+    // transform is row-major, as in Assimp; parent is -1 for the root
+    struct NodeRecord {
+        int32_t parent;
+        uint32_t name_offset;
+        uint32_t name_length;
+        uint32_t first_mesh;
+        uint32_t mesh_count;
+        uint32_t reserved[3];
+        float transform[16];
+    };
+
+    struct MaterialRecord {
+        uint32_t first_property;
+        uint32_t property_count;
+        uint32_t reserved[2];
+    };
+
+    // an aiMaterialProperty; the key is with the node names, and the data
+    // are its bytes as Assimp keeps them
+    struct PropertyRecord {
+        uint32_t key_offset;
+        uint32_t key_length;
+        uint32_t semantic;
+        uint32_t index;
+        uint32_t type;
+        uint32_t data_offset;
+        uint32_t data_length;
+        uint32_t reserved;
+    };
+
+    const Header* header() const {
+        return reinterpret_cast<const Header*>(data_);
+    }
+
+    const MeshRecord* meshes() const {
+        return reinterpret_cast<const MeshRecord*>(data_ + sizeof(Header));
+    }
+
+    const NodeRecord* nodes() const {
+        return reinterpret_cast<const NodeRecord*>(data_ + sizeof(Header)
+                + header()->mesh_count * sizeof(MeshRecord));
+    }
+
+    const uint32_t* nodeMeshes() const {
+        return reinterpret_cast<const uint32_t*>(data_
+                + header()->node_meshes_offset);
+    }
+
+    const MaterialRecord* materials() const {
+        return reinterpret_cast<const MaterialRecord*>(data_
+                + header()->materials_offset);
+    }
+
+    const PropertyRecord* properties() const {
+        return reinterpret_cast<const PropertyRecord*>(data_
+                + header()->properties_offset);
+    }
+
+    bool isValid() const;
+    bool isValidMaterial(const MaterialRecord& material) const;
+    bool contains(uint64_t offset, uint64_t size) const;
+
+private:
+    const unsigned char* data_;
+    size_t size_;
+};
+
+}
+#endif
@@ -66,6 +66,18 @@ void GlDelete::queueProgram(GLuint program) {
     unlock();
 }
 
+void GlDelete::queueQuery(GLuint query) {
+    if (query == GVR_INVALID) {
+        logInvalidParameter(__func__);
+        return;
+    }
+
+    lock();
+    queries_.push_back(query);
+    dirty = true;
+    unlock();
+}
+
 void GlDelete::queueRenderBuffer(GLuint buffer) {
     if (buffer == GVR_INVALID) {
         logInvalidParameter(__func__);
@@ -145,6 +157,10 @@ void GlDelete::processQueues() {
             }
             programs_.clear();
         }
+        if (queries_.size() > 0) {
+            glDeleteQueries(queries_.size(), queries_.data());
+            queries_.clear();
+        }
         if (render_buffers_.size() > 0) {
             glDeleteRenderbuffers(render_buffers_.size(),
                     render_buffers_.data());
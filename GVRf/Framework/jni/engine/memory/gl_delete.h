@@ -39,6 +39,7 @@ public:
     void queueBuffer(GLuint buffer);
     void queueFrameBuffer(GLuint buffer);
     void queueProgram(GLuint program);
+    void queueQuery(GLuint query);
     void queueRenderBuffer(GLuint buffer);
     void queueShader(GLuint shader);
     void queueTexture(GLuint texture);
@@ -63,6 +64,7 @@ private:
     std::vector<GLuint> buffers_;
     std::vector<GLuint> frame_buffers_;
     std::vector<GLuint> programs_;
+    std::vector<GLuint> queries_;
     std::vector<GLuint> render_buffers_;
     std::vector<GLuint> shaders_;
     std::vector<GLuint> textures_;
@@ -30,6 +30,7 @@
 #include "objects/scene_object.h"
 #include "objects/components/camera_rig.h"
 #include "objects/components/eye_pointee_holder.h"
+#include "util/gvr_profiler.h"
 
 namespace gvr {
 
@@ -41,6 +42,7 @@ Picker::~Picker() {
 
 std::vector<EyePointeeHolder*> Picker::pickScene(Scene* scene, float ox,
         float oy, float oz, float dx, float dy, float dz) {
+    GVR_PROFILE("pick");
     std::vector<SceneObject*> scene_objects = scene->getWholeSceneObjects();
     std::vector<EyePointeeHolder*> eye_pointee_holders;
     for (auto it = scene_objects.begin(); it != scene_objects.end(); ++it) {
@@ -0,0 +1,242 @@
+/* Copyright 2015 Samsung Electronics Co., LTD
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/***************************************************************************
+ * Batch frustum culling of world-space bounding boxes.
+ ***************************************************************************/
+
+#include "frustum_culler.h"
+
+#include <float.h>
+#include <math.h>
+
+#if defined(__ARM_NEON__) || defined(__ARM_NEON)
+#include <arm_neon.h>
+#define GVR_CULL_NEON 1
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#define GVR_CULL_SSE 1
+#endif
+
+#include "objects/bounding_volume.h"
+
+namespace gvr {
+
+FrustumCuller::FrustumCuller() :
+        box_count_(0), center_x_(), center_y_(), center_z_(), extent_x_(), extent_y_(), extent_z_(), visibility_mask_() {
+    for (int p = 0; p < PLANE_COUNT; ++p) {
+        plane_x_[p] = 0.0f;
+        plane_y_[p] = 0.0f;
+        plane_z_[p] = 0.0f;
+        plane_w_[p] = 1.0f;
+    }
+}
+
+void FrustumCuller::set_frustum(const float frustum[6][4]) {
+    for (int p = 0; p < PLANE_COUNT; ++p) {
+        plane_x_[p] = frustum[p][0];
+        plane_y_[p] = frustum[p][1];
+        plane_z_[p] = frustum[p][2];
+        plane_w_[p] = frustum[p][3];
+    }
+}
+
+/*
+ * Classifies one world-space box against the planes whose bits are set in
+ * plane_mask. Planes the box is entirely in front of are cleared from the
+ * mask, so whatever is inside the box needs not test them again.
+ */
+FrustumCuller::Containment FrustumCuller::classifyBox(
+        const BoundingVolume& world_volume, int& plane_mask) const {
+    if (world_volume.is_empty()) {
+        return Outside;
+    }
+
+    glm::vec3 center = (world_volume.min_corner() + world_volume.max_corner())
+            * 0.5f;
+    glm::vec3 extent = (world_volume.max_corner() - world_volume.min_corner())
+            * 0.5f;
+
+    for (int p = 0; p < PLANE_COUNT; ++p) {
+        if (!(plane_mask & (1 << p))) {
+            continue;
+        }
+        float d = plane_x_[p] * center.x + plane_y_[p] * center.y
+                + plane_z_[p] * center.z + plane_w_[p];
+        float r = fabsf(plane_x_[p]) * extent.x + fabsf(plane_y_[p]) * extent.y
+                + fabsf(plane_z_[p]) * extent.z;
+        if (d + r <= 0.0f) {
+            return Outside;
+        }
+        if (d - r > 0.0f) {
+            plane_mask &= ~(1 << p);
+        }
+    }
+
+    return plane_mask == 0 ? Inside : Intersecting;
+}
+
+void FrustumCuller::clear() {
+    box_count_ = 0;
+    center_x_.clear();
+    center_y_.clear();
+    center_z_.clear();
+    extent_x_.clear();
+    extent_y_.clear();
+    extent_z_.clear();
+}
+
+int FrustumCuller::addBox(const glm::vec3& center, const glm::vec3& extent) {
+    center_x_.push_back(center.x);
+    center_y_.push_back(center.y);
+    center_z_.push_back(center.z);
+    extent_x_.push_back(extent.x);
+    extent_y_.push_back(extent.y);
+    extent_z_.push_back(extent.z);
+    return box_count_++;
+}
+
+/*
+ * Transforms the local box into a world-space box:
+ *     center' = M * center
+ *     extent' = |M3x3| * extent
+ * An empty volume gets a negative extent so it never passes a plane test.
+ */
+int FrustumCuller::addBox(const BoundingVolume& bounding_volume,
+        const glm::mat4& model_matrix) {
+    const glm::vec3& min_corner = bounding_volume.min_corner();
+    const glm::vec3& max_corner = bounding_volume.max_corner();
+
+    if (min_corner.x > max_corner.x || min_corner.y > max_corner.y
+            || min_corner.z > max_corner.z) {
+        return addBox(glm::vec3(0.0f), glm::vec3(-FLT_MAX));
+    }
+
+    glm::vec3 center = (min_corner + max_corner) * 0.5f;
+    glm::vec3 extent = (max_corner - min_corner) * 0.5f;
+
+    glm::vec3 world_center(model_matrix * glm::vec4(center, 1.0f));
+    glm::vec3 world_extent;
+    for (int i = 0; i < 3; ++i) {
+        world_extent[i] = fabsf(model_matrix[0][i]) * extent.x
+                + fabsf(model_matrix[1][i]) * extent.y
+                + fabsf(model_matrix[2][i]) * extent.z;
+    }
+
+    return addBox(world_center, world_extent);
+}
+
+/*
+ * A box is outside a plane when its most positive corner is still behind it,
+ * i.e. dot(n, center) + w + dot(|n|, extent) <= 0. This is the same test
+ * the eight-corner loop used to do, evaluated once per box.
+ */
+void FrustumCuller::cull() {
+    beginCull();
+    cull(0, box_count_);
+}
+
+void FrustumCuller::beginCull() {
+    visibility_mask_.assign((box_count_ + 31) >> 5, 0);
+}
+
+void FrustumCuller::cull(int first_box, int last_box) {
+    int simd_end = first_box;
+
+#if GVR_CULL_NEON
+    simd_end = first_box + ((last_box - first_box) & ~3);
+    static const uint32_t lane_bits_array[4] = { 1, 2, 4, 8 };
+    const uint32x4_t lane_bits = vld1q_u32(lane_bits_array);
+    const float32x4_t zero = vdupq_n_f32(0.0f);
+
+    for (int i = first_box; i < simd_end; i += 4) {
+        float32x4_t cx = vld1q_f32(&center_x_[i]);
+        float32x4_t cy = vld1q_f32(&center_y_[i]);
+        float32x4_t cz = vld1q_f32(&center_z_[i]);
+        float32x4_t ex = vld1q_f32(&extent_x_[i]);
+        float32x4_t ey = vld1q_f32(&extent_y_[i]);
+        float32x4_t ez = vld1q_f32(&extent_z_[i]);
+        uint32x4_t inside = vdupq_n_u32(0xffffffff);
+
+        for (int p = 0; p < PLANE_COUNT; ++p) {
+            float32x4_t d = vdupq_n_f32(plane_w_[p]);
+            d = vmlaq_n_f32(d, cx, plane_x_[p]);
+            d = vmlaq_n_f32(d, cy, plane_y_[p]);
+            d = vmlaq_n_f32(d, cz, plane_z_[p]);
+            d = vmlaq_n_f32(d, ex, fabsf(plane_x_[p]));
+            d = vmlaq_n_f32(d, ey, fabsf(plane_y_[p]));
+            d = vmlaq_n_f32(d, ez, fabsf(plane_z_[p]));
+            inside = vandq_u32(inside, vcgtq_f32(d, zero));
+        }
+
+        uint32x4_t bits = vandq_u32(inside, lane_bits);
+        uint32x2_t sum = vadd_u32(vget_low_u32(bits), vget_high_u32(bits));
+        unsigned int mask = vget_lane_u32(vpadd_u32(sum, sum), 0);
+        visibility_mask_[i >> 5] |= mask << (i & 31);
+    }
+#elif GVR_CULL_SSE
+    simd_end = first_box + ((last_box - first_box) & ~3);
+    const __m128 abs_mask = _mm_castsi128_ps(_mm_set1_epi32(0x7fffffff));
+    const __m128 zero = _mm_setzero_ps();
+
+    for (int i = first_box; i < simd_end; i += 4) {
+        __m128 cx = _mm_loadu_ps(&center_x_[i]);
+        __m128 cy = _mm_loadu_ps(&center_y_[i]);
+        __m128 cz = _mm_loadu_ps(&center_z_[i]);
+        __m128 ex = _mm_loadu_ps(&extent_x_[i]);
+        __m128 ey = _mm_loadu_ps(&extent_y_[i]);
+        __m128 ez = _mm_loadu_ps(&extent_z_[i]);
+        __m128 inside = _mm_cmpeq_ps(zero, zero);
+
+        for (int p = 0; p < PLANE_COUNT; ++p) {
+            __m128 px = _mm_set1_ps(plane_x_[p]);
+            __m128 py = _mm_set1_ps(plane_y_[p]);
+            __m128 pz = _mm_set1_ps(plane_z_[p]);
+            __m128 d = _mm_add_ps(_mm_set1_ps(plane_w_[p]),
+                    _mm_add_ps(_mm_mul_ps(cx, px),
+                            _mm_add_ps(_mm_mul_ps(cy, py),
+                                    _mm_mul_ps(cz, pz))));
+            __m128 r = _mm_add_ps(_mm_mul_ps(ex, _mm_and_ps(px, abs_mask)),
+                    _mm_add_ps(_mm_mul_ps(ey, _mm_and_ps(py, abs_mask)),
+                            _mm_mul_ps(ez, _mm_and_ps(pz, abs_mask))));
+            inside = _mm_and_ps(inside, _mm_cmpgt_ps(_mm_add_ps(d, r), zero));
+        }
+
+        unsigned int mask = _mm_movemask_ps(inside);
+        visibility_mask_[i >> 5] |= mask << (i & 31);
+    }
+#endif
+
+    cullScalar(simd_end, last_box);
+}
+
+void FrustumCuller::cullScalar(int first_box, int last_box) {
+    for (int i = first_box; i < last_box; ++i) {
+        bool inside = true;
+        for (int p = 0; p < PLANE_COUNT && inside; ++p) {
+            float d = plane_x_[p] * center_x_[i] + plane_y_[p] * center_y_[i]
+                    + plane_z_[p] * center_z_[i] + plane_w_[p];
+            float r = fabsf(plane_x_[p]) * extent_x_[i]
+                    + fabsf(plane_y_[p]) * extent_y_[i]
+                    + fabsf(plane_z_[p]) * extent_z_[i];
+            inside = d + r > 0.0f;
+        }
+        if (inside) {
+            visibility_mask_[i >> 5] |= 1u << (i & 31);
+        }
+    }
+}
+
+}
@@ -0,0 +1,108 @@
+/* Copyright 2015 Samsung Electronics Co., LTD
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/***************************************************************************
+ * Batch frustum culling of world-space bounding boxes.
+ ***************************************************************************/
+
+#ifndef FRUSTUM_CULLER_H_
+#define FRUSTUM_CULLER_H_
+
+#include <vector>
+
+#include "glm/glm.hpp"
+
+namespace gvr {
+class BoundingVolume;
+
+/*
+ * Tests many axis aligned boxes against one set of frustum planes.
+ *
+ * The planes are set once per camera. The boxes are kept as world-space
+ * center/extent pairs in structure-of-arrays form so that the SSE/NEON
+ * kernel can test four boxes per plane per iteration. The result is a
+ * bitmask with one bit per box, in the order the boxes were added.
+ */
+class FrustumCuller {
+public:
+    enum Containment {
+        Outside = 0, Intersecting, Inside
+    };
+
+    static const int ALL_PLANES = 0x3f;
+
+    FrustumCuller();
+    ~FrustumCuller() {
+    }
+
+    // planes as produced by Renderer::build_frustum(), normals pointing inside
+    void set_frustum(const float frustum[6][4]);
+
+    Containment classifyBox(const BoundingVolume& world_volume,
+            int& plane_mask) const;
+
+    void clear();
+    int addBox(const glm::vec3& center, const glm::vec3& extent);
+    int addBox(const BoundingVolume& bounding_volume,
+            const glm::mat4& model_matrix);
+
+    int box_count() const {
+        return box_count_;
+    }
+
+    void cull();
+
+    // Culling split in ranges, which may run on different threads as long as
+    // every range starts on a multiple of VISIBILITY_WORD_BITS
+    static const int VISIBILITY_WORD_BITS = 32;
+    void beginCull();
+    void cull(int first_box, int last_box);
+
+    bool is_visible(int index) const {
+        return (visibility_mask_[index >> 5] >> (index & 31)) & 1;
+    }
+
+    const std::vector<unsigned int>& visibility_mask() const {
+        return visibility_mask_;
+    }
+
+private:
+    FrustumCuller(const FrustumCuller& frustum_culler);
+    FrustumCuller(FrustumCuller&& frustum_culler);
+    FrustumCuller& operator=(const FrustumCuller& frustum_culler);
+    FrustumCuller& operator=(FrustumCuller&& frustum_culler);
+
+    void cullScalar(int first_box, int last_box);
+
+private:
+    static const int PLANE_COUNT = 6;
+
+    float plane_x_[PLANE_COUNT];
+    float plane_y_[PLANE_COUNT];
+    float plane_z_[PLANE_COUNT];
+    float plane_w_[PLANE_COUNT];
+
+    int box_count_;
+    std::vector<float> center_x_;
+    std::vector<float> center_y_;
+    std::vector<float> center_z_;
+    std::vector<float> extent_x_;
+    std::vector<float> extent_y_;
+    std::vector<float> extent_z_;
+    std::vector<unsigned int> visibility_mask_;
+};
+
+}
+#endif
@@ -0,0 +1,352 @@
+/* Copyright 2015 Samsung Electronics Co., LTD
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/***************************************************************************
+ * Occlusion culling against a software rasterized depth buffer.
+ ***************************************************************************/
+
+#include "occlusion_culler.h"
+
+#include <float.h>
+#include <math.h>
+#include <algorithm>
+
+#if defined(__ARM_NEON__) || defined(__ARM_NEON)
+#include <arm_neon.h>
+#define GVR_CULL_NEON 1
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#define GVR_CULL_SSE 1
+#endif
+
+#include "objects/bounding_volume.h"
+
+namespace gvr {
+
+// vertices closer to the eye than this, in clip w, are not rasterized
+static const float MIN_W = 1.0e-3f;
+
+OcclusionCuller::OcclusionCuller() :
+        vp_matrix_(), triangles_(), clip_vertices_(), tile_depth_(),
+        layer_depth_(), layer_mask_() {
+}
+
+void OcclusionCuller::clear(const glm::mat4& vp_matrix) {
+    vp_matrix_ = vp_matrix;
+    triangles_.clear();
+    tile_depth_.assign(TILE_COLUMNS * TILE_ROWS, 0.0f);
+    layer_depth_.assign(TILE_COLUMNS * TILE_ROWS, FLT_MAX);
+    layer_mask_.assign(TILE_COLUMNS * TILE_ROWS, 0);
+}
+
+void OcclusionCuller::addOccluder(const glm::mat4& model_matrix,
+        const std::vector<glm::vec3>& vertices,
+        const std::vector<unsigned short>& triangles) {
+    glm::mat4 mvp_matrix(vp_matrix_ * model_matrix);
+    int vertex_count = vertices.size();
+    clip_vertices_.resize(vertex_count);
+    for (int i = 0; i < vertex_count; ++i) {
+        clip_vertices_[i] = mvp_matrix * glm::vec4(vertices[i], 1.0f);
+    }
+
+    for (size_t i = 0; i + 2 < triangles.size(); i += 3) {
+        if (triangles[i] >= vertex_count || triangles[i + 1] >= vertex_count
+                || triangles[i + 2] >= vertex_count) {
+            continue;
+        }
+        setupTriangle(clip_vertices_[triangles[i]],
+                clip_vertices_[triangles[i + 1]],
+                clip_vertices_[triangles[i + 2]]);
+    }
+}
+
+void OcclusionCuller::setupTriangle(const glm::vec4& v0, const glm::vec4& v1,
+        const glm::vec4& v2) {
+    if (v0.w < MIN_W || v1.w < MIN_W || v2.w < MIN_W) {
+        return;
+    }
+
+    float x[3] = { (v0.x / v0.w * 0.5f + 0.5f) * WIDTH, (v1.x / v1.w * 0.5f
+            + 0.5f) * WIDTH, (v2.x / v2.w * 0.5f + 0.5f) * WIDTH };
+    float y[3] = { (v0.y / v0.w * 0.5f + 0.5f) * HEIGHT, (v1.y / v1.w * 0.5f
+            + 0.5f) * HEIGHT, (v2.y / v2.w * 0.5f + 0.5f) * HEIGHT };
+    float d[3] = { 1.0f / v0.w, 1.0f / v1.w, 1.0f / v2.w };
+
+    float min_x = std::min(x[0], std::min(x[1], x[2]));
+    float max_x = std::max(x[0], std::max(x[1], x[2]));
+    float min_y = std::min(y[0], std::min(y[1], y[2]));
+    float max_y = std::max(y[0], std::max(y[1], y[2]));
+    if (max_x < 0.0f || min_x >= WIDTH || max_y < 0.0f || min_y >= HEIGHT) {
+        return;
+    }
+
+    // both windings occlude, so they are made counterclockwise
+    float area = (x[1] - x[0]) * (y[2] - y[0]) - (x[2] - x[0]) * (y[1] - y[0]);
+    if (area < 0.0f) {
+        std::swap(x[1], x[2]);
+        std::swap(y[1], y[2]);
+        std::swap(d[1], d[2]);
+        area = -area;
+    }
+    if (area < 1.0e-6f) {
+        return;
+    }
+
+    Triangle triangle;
+    for (int i = 0; i < 3; ++i) {
+        int j = (i + 1) % 3;
+        triangle.edge_a[i] = y[i] - y[j];
+        triangle.edge_b[i] = x[j] - x[i];
+        triangle.edge_c[i] = -(triangle.edge_a[i] * x[i]
+                + triangle.edge_b[i] * y[i]);
+    }
+
+    triangle.depth_a = ((d[1] - d[0]) * (y[2] - y[0])
+            - (d[2] - d[0]) * (y[1] - y[0])) / area;
+    triangle.depth_b = ((d[2] - d[0]) * (x[1] - x[0])
+            - (d[1] - d[0]) * (x[2] - x[0])) / area;
+    triangle.depth_c = d[0] - triangle.depth_a * x[0]
+            - triangle.depth_b * y[0];
+    triangle.min_depth = std::min(d[0], std::min(d[1], d[2]));
+
+    triangle.first_column = std::max(0, static_cast<int>(min_x) / TILE_WIDTH);
+    triangle.last_column = std::min(TILE_COLUMNS - 1,
+            static_cast<int>(max_x) / TILE_WIDTH);
+    triangle.first_row = std::max(0, static_cast<int>(min_y) / TILE_HEIGHT);
+    triangle.last_row = std::min(TILE_ROWS - 1,
+            static_cast<int>(max_y) / TILE_HEIGHT);
+    triangles_.push_back(triangle);
+}
+
+void OcclusionCuller::rasterize(int first_row, int last_row) {
+    for (auto it = triangles_.begin(); it != triangles_.end(); ++it) {
+        const Triangle& triangle = *it;
+        int row_begin = std::max(triangle.first_row, first_row);
+        int row_end = std::min(triangle.last_row + 1, last_row);
+
+        // the farthest point of the depth plane over a tile is at one of
+        // its corners
+        float tile_depth_offset = std::min(0.0f,
+                triangle.depth_a * TILE_WIDTH)
+                + std::min(0.0f, triangle.depth_b * TILE_HEIGHT);
+
+        for (int row = row_begin; row < row_end; ++row) {
+            float y = row * TILE_HEIGHT;
+            for (int column = triangle.first_column;
+                    column <= triangle.last_column; ++column) {
+                float x = column * TILE_WIDTH;
+                float depth = std::max(triangle.min_depth,
+                        triangle.depth_a * x + triangle.depth_b * y
+                                + triangle.depth_c + tile_depth_offset);
+
+                // a triangle behind what already covers the whole tile adds
+                // nothing
+                int tile = row * TILE_COLUMNS + column;
+                if (depth <= tile_depth_[tile]) {
+                    continue;
+                }
+
+                uint32_t mask = coverageMask(triangle, x, y);
+                if (mask != 0) {
+                    updateTile(tile, mask, depth);
+                }
+            }
+        }
+    }
+}
+
+/*
+ * One bit per pixel of the tile at (x, y), row by row, set where the pixel
+ * center is inside all three edges.
+ */
+uint32_t OcclusionCuller::coverageMask(const Triangle& triangle, float x,
+        float y) const {
+    uint32_t mask = 0;
+
+#if GVR_CULL_NEON
+    static const float lane_offsets_array[4] = { 0.5f, 1.5f, 2.5f, 3.5f };
+    static const uint32_t lane_bits_array[4] = { 1, 2, 4, 8 };
+    const float32x4_t lane_offsets = vld1q_f32(lane_offsets_array);
+    const uint32x4_t lane_bits = vld1q_u32(lane_bits_array);
+    const float32x4_t zero = vdupq_n_f32(0.0f);
+
+    float32x4_t row_values[3];
+    for (int e = 0; e < 3; ++e) {
+        float base = triangle.edge_a[e] * x
+                + triangle.edge_b[e] * (y + 0.5f) + triangle.edge_c[e];
+        row_values[e] = vmlaq_n_f32(vdupq_n_f32(base), lane_offsets,
+                triangle.edge_a[e]);
+    }
+    for (int row = 0; row < TILE_HEIGHT; ++row) {
+        for (int half = 0; half < TILE_WIDTH / 4; ++half) {
+            uint32x4_t inside = vdupq_n_u32(0xffffffff);
+            for (int e = 0; e < 3; ++e) {
+                float32x4_t values = vaddq_f32(row_values[e],
+                        vdupq_n_f32(triangle.edge_a[e] * 4.0f * half));
+                inside = vandq_u32(inside, vcgeq_f32(values, zero));
+            }
+            uint32x4_t bits = vandq_u32(inside, lane_bits);
+            uint32x2_t sum = vadd_u32(vget_low_u32(bits), vget_high_u32(bits));
+            mask |= vget_lane_u32(vpadd_u32(sum, sum), 0)
+                    << (row * TILE_WIDTH + half * 4);
+        }
+        for (int e = 0; e < 3; ++e) {
+            row_values[e] = vaddq_f32(row_values[e],
+                    vdupq_n_f32(triangle.edge_b[e]));
+        }
+    }
+#elif GVR_CULL_SSE
+    const __m128 lane_offsets = _mm_set_ps(3.5f, 2.5f, 1.5f, 0.5f);
+    const __m128 zero = _mm_setzero_ps();
+
+    __m128 row_values[3];
+    for (int e = 0; e < 3; ++e) {
+        float base = triangle.edge_a[e] * x
+                + triangle.edge_b[e] * (y + 0.5f) + triangle.edge_c[e];
+        row_values[e] = _mm_add_ps(_mm_set1_ps(base),
+                _mm_mul_ps(lane_offsets, _mm_set1_ps(triangle.edge_a[e])));
+    }
+    for (int row = 0; row < TILE_HEIGHT; ++row) {
+        for (int half = 0; half < TILE_WIDTH / 4; ++half) {
+            __m128 inside = _mm_cmpeq_ps(zero, zero);
+            for (int e = 0; e < 3; ++e) {
+                __m128 values = _mm_add_ps(row_values[e],
+                        _mm_set1_ps(triangle.edge_a[e] * 4.0f * half));
+                inside = _mm_and_ps(inside, _mm_cmpge_ps(values, zero));
+            }
+            mask |= static_cast<uint32_t>(_mm_movemask_ps(inside))
+                    << (row * TILE_WIDTH + half * 4);
+        }
+        for (int e = 0; e < 3; ++e) {
+            row_values[e] = _mm_add_ps(row_values[e],
+                    _mm_set1_ps(triangle.edge_b[e]));
+        }
+    }
+#else
+    for (int row = 0; row < TILE_HEIGHT; ++row) {
+        float pixel_y = y + row + 0.5f;
+        for (int column = 0; column < TILE_WIDTH; ++column) {
+            float pixel_x = x + column + 0.5f;
+            bool inside = true;
+            for (int e = 0; e < 3 && inside; ++e) {
+                inside = triangle.edge_a[e] * pixel_x
+                        + triangle.edge_b[e] * pixel_y + triangle.edge_c[e]
+                        >= 0.0f;
+            }
+            if (inside) {
+                mask |= 1u << (row * TILE_WIDTH + column);
+            }
+        }
+    }
+#endif
+
+    return mask;
+}
+
+void OcclusionCuller::updateTile(int tile, uint32_t mask, float depth) {
+    if (mask != FULL_MASK) {
+        mask |= layer_mask_[tile];
+        float layer_depth = std::min(layer_depth_[tile], depth);
+        if (mask != FULL_MASK) {
+            layer_mask_[tile] = mask;
+            layer_depth_[tile] = layer_depth;
+            return;
+        }
+        depth = layer_depth;
+        layer_depth_[tile] = FLT_MAX;
+        layer_mask_[tile] = 0;
+    }
+
+    tile_depth_[tile] = std::max(tile_depth_[tile], depth);
+
+    // a layer behind the covered depth can never make the tile nearer
+    if (layer_depth_[tile] <= tile_depth_[tile]) {
+        layer_mask_[tile] = 0;
+        layer_depth_[tile] = FLT_MAX;
+    }
+}
+
+bool OcclusionCuller::isVisible(const BoundingVolume& bounding_volume,
+        const glm::mat4& model_matrix) const {
+    glm::mat4 mvp_matrix(vp_matrix_ * model_matrix);
+    const glm::vec3& min_corner = bounding_volume.min_corner();
+    const glm::vec3& max_corner = bounding_volume.max_corner();
+
+    float min_x = FLT_MAX;
+    float max_x = -FLT_MAX;
+    float min_y = FLT_MAX;
+    float max_y = -FLT_MAX;
+    float max_depth = 0.0f;
+    for (int i = 0; i < 8; ++i) {
+        glm::vec4 corner(i & 1 ? max_corner.x : min_corner.x,
+                i & 2 ? max_corner.y : min_corner.y,
+                i & 4 ? max_corner.z : min_corner.z, 1.0f);
+        glm::vec4 clip(mvp_matrix * corner);
+        if (clip.w < MIN_W) {
+            return true;
+        }
+        float x = (clip.x / clip.w * 0.5f + 0.5f) * WIDTH;
+        float y = (clip.y / clip.w * 0.5f + 0.5f) * HEIGHT;
+        min_x = std::min(min_x, x);
+        max_x = std::max(max_x, x);
+        min_y = std::min(min_y, y);
+        max_y = std::max(max_y, y);
+        max_depth = std::max(max_depth, 1.0f / clip.w);
+    }
+    if (max_x < 0.0f || min_x >= WIDTH || max_y < 0.0f || min_y >= HEIGHT) {
+        return true;
+    }
+
+    int first_column = std::max(0, static_cast<int>(min_x) / TILE_WIDTH);
+    int last_column = std::min(TILE_COLUMNS - 1,
+            static_cast<int>(max_x) / TILE_WIDTH);
+    int first_row = std::max(0, static_cast<int>(min_y) / TILE_HEIGHT);
+    int last_row = std::min(TILE_ROWS - 1,
+            static_cast<int>(max_y) / TILE_HEIGHT);
+
+    for (int row = first_row; row <= last_row; ++row) {
+        const float* tile_depth = &tile_depth_[row * TILE_COLUMNS];
+        int column = first_column;
+#if GVR_CULL_NEON
+        const float32x4_t box_depth = vdupq_n_f32(max_depth);
+        for (; column + 3 <= last_column; column += 4) {
+            uint32x4_t behind = vcltq_f32(vld1q_f32(tile_depth + column),
+                    box_depth);
+            uint32x2_t any = vorr_u32(vget_low_u32(behind),
+                    vget_high_u32(behind));
+            if (vget_lane_u32(vpmax_u32(any, any), 0) != 0) {
+                return true;
+            }
+        }
+#elif GVR_CULL_SSE
+        const __m128 box_depth = _mm_set1_ps(max_depth);
+        for (; column + 3 <= last_column; column += 4) {
+            if (_mm_movemask_ps(
+                    _mm_cmplt_ps(_mm_loadu_ps(tile_depth + column), box_depth))
+                    != 0) {
+                return true;
+            }
+        }
+#endif
+        for (; column <= last_column; ++column) {
+            if (tile_depth[column] < max_depth) {
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+}
@@ -0,0 +1,129 @@
+/* Copyright 2015 Samsung Electronics Co., LTD
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/***************************************************************************
+ * Occlusion culling against a software rasterized depth buffer.
+ ***************************************************************************/
+
+#ifndef OCCLUSION_CULLER_H_
+#define OCCLUSION_CULLER_H_
+
+#include <stdint.h>
+#include <vector>
+
+#include "glm/glm.hpp"
+
+namespace gvr {
+class BoundingVolume;
+
+/*
+ * Rasterizes occluder triangles on the CPU into a small masked depth
+ * buffer and tests boxes against it, all within the frame being culled.
+ *
+ * The buffer is split in tiles of 8x4 pixels. A tile does not store the
+ * depth of each pixel but a coverage mask with one bit per pixel and two
+ * depths: the farthest depth of the pixels once the whole tile has been
+ * covered, and the farthest depth of the triangles covering the pixels
+ * set in the mask so far. When the mask fills up, the second depth is
+ * merged into the first and the mask starts over. Depths are 1/w, which
+ * is linear in screen space and grows towards the camera, and are kept
+ * conservative: a tile may claim to be farther than it is, never nearer.
+ *
+ * A box is visible unless every tile its screen rectangle touches is
+ * fully covered by occluders nearer than the nearest point of the box.
+ * Coverage masks and box tests run four lanes at a time with SSE or NEON.
+ *
+ * Nothing here touches GL, so occluders can be rasterized on the cull
+ * threads, one range of tile rows per thread.
+ */
+class OcclusionCuller {
+public:
+    static const int TILE_WIDTH = 8;
+    static const int TILE_HEIGHT = 4;
+    static const int TILE_COLUMNS = 32;
+    static const int TILE_ROWS = 32;
+    static const int WIDTH = TILE_WIDTH * TILE_COLUMNS;
+    static const int HEIGHT = TILE_HEIGHT * TILE_ROWS;
+
+    OcclusionCuller();
+    ~OcclusionCuller() {
+    }
+
+    // empties the buffer and the occluders for a new view-projection
+    void clear(const glm::mat4& vp_matrix);
+
+    // Sets up the triangles of an occluder mesh. Triangles crossing the near
+    // plane are dropped, which only loses occlusion.
+    void addOccluder(const glm::mat4& model_matrix,
+            const std::vector<glm::vec3>& vertices,
+            const std::vector<unsigned short>& triangles);
+
+    int triangle_count() const {
+        return triangles_.size();
+    }
+
+    // Rasterizes the occluders into tile rows [first_row, last_row). Ranges
+    // may run on different threads once all occluders have been added.
+    void rasterize(int first_row, int last_row);
+
+    // whether any part of the box may be in front of the occluders; safe to
+    // call from several threads once rasterized
+    bool isVisible(const BoundingVolume& bounding_volume,
+            const glm::mat4& model_matrix) const;
+
+private:
+    OcclusionCuller(const OcclusionCuller& occlusion_culler);
+    OcclusionCuller(OcclusionCuller&& occlusion_culler);
+    OcclusionCuller& operator=(const OcclusionCuller& occlusion_culler);
+    OcclusionCuller& operator=(OcclusionCuller&& occlusion_culler);
+
+    struct Triangle {
+        // edge functions a * x + b * y + c, not negative inside
+        float edge_a[3];
+        float edge_b[3];
+        float edge_c[3];
+        // the depth plane, 1/w = a * x + b * y + c
+        float depth_a;
+        float depth_b;
+        float depth_c;
+        // depth of the farthest vertex
+        float min_depth;
+        int first_column;
+        int last_column;
+        int first_row;
+        int last_row;
+    };
+
+    void setupTriangle(const glm::vec4& v0, const glm::vec4& v1,
+            const glm::vec4& v2);
+    uint32_t coverageMask(const Triangle& triangle, float x, float y) const;
+    void updateTile(int tile, uint32_t mask, float depth);
+
+private:
+    static const uint32_t FULL_MASK = 0xffffffff;
+
+    glm::mat4 vp_matrix_;
+    std::vector<Triangle> triangles_;
+    std::vector<glm::vec4> clip_vertices_;
+
+    // per tile: farthest depth of the fully covered layer, farthest depth
+    // and coverage of the layer being filled
+    std::vector<float> tile_depth_;
+    std::vector<float> layer_depth_;
+    std::vector<uint32_t> layer_mask_;
+};
+
+}
+#endif
@@ -0,0 +1,174 @@
+/* Copyright 2015 Samsung Electronics Co., LTD
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/***************************************************************************
+ * The renderable render data of a scene, kept in sorted order.
+ ***************************************************************************/
+
+#include "render_list.h"
+
+#include "engine/renderer/render_sorter.h"
+#include "objects/render_pass.h"
+#include "objects/scene_object.h"
+#include "objects/static_batch.h"
+#include "objects/components/render_data.h"
+#include "util/gvr_profiler.h"
+
+namespace gvr {
+
+/*
+ * Render data still in the scene keep their order, and the new ones are
+ * sorted among themselves and merged in by key. Render data no longer in
+ * the scene are only compared against, never dereferenced, since they may
+ * have been deleted already.
+ */
+void RenderList::update(const std::vector<SceneObject*>& scene_objects,
+        RenderSorter& render_sorter) {
+    collected_.clear();
+    for (auto it = scene_objects.begin(); it != scene_objects.end(); ++it) {
+        collect(*it, collected_);
+    }
+
+    clearVisible();
+    added_.clear();
+    for (auto it = collected_.begin(); it != collected_.end(); ++it) {
+        if (contains(*it)) {
+            setVisible(*it);
+        } else {
+            added_.push_back(*it);
+        }
+    }
+    render_sorter.sort(added_);
+
+    collected_.clear();
+    int added_count = added_.size();
+    int next_added = 0;
+    for (size_t word = 0; word < visible_.size(); ++word) {
+        for (uint32_t bits = visible_[word]; bits != 0; bits &= bits - 1) {
+            RenderData* render_data = render_data_[word * VISIBLE_WORD_BITS
+                    + __builtin_ctz(bits)];
+            uint64_t key = RenderSorter::makeKey(render_data);
+            while (next_added < added_count
+                    && RenderSorter::makeKey(added_[next_added]) < key) {
+                collected_.push_back(added_[next_added++]);
+            }
+            collected_.push_back(render_data);
+        }
+    }
+    collected_.insert(collected_.end(), added_.begin() + next_added,
+            added_.end());
+
+    render_data_.swap(collected_);
+    for (size_t i = 0; i < render_data_.size(); ++i) {
+        render_data_[i]->set_render_list_index(i);
+    }
+    clearVisible();
+}
+
+void RenderList::clearVisible() {
+    visible_.assign(
+            (render_data_.size() + VISIBLE_WORD_BITS - 1) / VISIBLE_WORD_BITS,
+            0);
+    unlisted_.clear();
+}
+
+void RenderList::setVisible(RenderData* render_data) {
+    if (!contains(render_data)) {
+        unlisted_.push_back(render_data);
+        return;
+    }
+    int slot = render_data->render_list_index();
+    visible_[slot / VISIBLE_WORD_BITS] |= 1u << (slot % VISIBLE_WORD_BITS);
+}
+
+void RenderList::getVisible(std::vector<RenderData*>& render_data_vector,
+        RenderSorter& render_sorter) {
+    GVR_PROFILE("sort");
+    render_data_vector.clear();
+    visible_slots_.clear();
+    for (size_t word = 0; word < visible_.size(); ++word) {
+        for (uint32_t bits = visible_[word]; bits != 0; bits &= bits - 1) {
+            int slot = word * VISIBLE_WORD_BITS + __builtin_ctz(bits);
+            render_data_vector.push_back(render_data_[slot]);
+            visible_slots_.push_back(slot);
+        }
+    }
+
+    // new slots at the end keep visible_slots_ ascending; render data set
+    // visible more than once are listed once
+    for (auto it = unlisted_.begin(); it != unlisted_.end(); ++it) {
+        if (contains(*it)) {
+            continue;
+        }
+        (*it)->set_render_list_index(render_data_.size());
+        visible_slots_.push_back(render_data_.size());
+        render_data_.push_back(*it);
+        render_data_vector.push_back(*it);
+    }
+    unlisted_.clear();
+
+    render_sorter.sortNearlySorted(render_data_vector);
+
+    for (size_t i = 0; i < render_data_vector.size(); ++i) {
+        int slot = visible_slots_[i];
+        render_data_[slot] = render_data_vector[i];
+        render_data_vector[i]->set_render_list_index(slot);
+    }
+}
+
+// the render data of a subtree, with static subtrees replaced by their batches
+void RenderList::collect(SceneObject* scene_object,
+        std::vector<RenderData*>& render_data_vector) {
+    StaticBatch* static_batch = scene_object->static_batch();
+    if (static_batch != 0 && scene_object->lod_group() == 0) {
+        const std::vector<SceneObject*>& batches = static_batch->batches();
+        for (auto it = batches.begin(); it != batches.end(); ++it) {
+            render_data_vector.push_back((*it)->render_data());
+        }
+        // LOD groups are left whole, levels and all, as the culler walks them
+        const std::vector<SceneObject*>& unbatched_objects =
+                static_batch->unbatched_objects();
+        for (auto it = unbatched_objects.begin(); it != unbatched_objects.end();
+                ++it) {
+            if ((*it)->lod_group() != 0) {
+                collect(*it, render_data_vector);
+                continue;
+            }
+            RenderData* render_data = (*it)->render_data();
+            if (render_data != 0 && render_data->pass(0)->material() != 0) {
+                render_data_vector.push_back(render_data);
+            }
+        }
+        return;
+    }
+
+    RenderData* render_data = scene_object->render_data();
+    if (render_data != 0 && render_data->pass(0)->material() != 0) {
+        render_data_vector.push_back(render_data);
+    }
+
+    const std::vector<SceneObject*>& children = scene_object->children();
+    for (auto it = children.begin(); it != children.end(); ++it) {
+        collect(*it, render_data_vector);
+    }
+}
+
+bool RenderList::contains(RenderData* render_data) const {
+    int slot = render_data->render_list_index();
+    return slot >= 0 && static_cast<size_t>(slot) < render_data_.size()
+            && render_data_[slot] == render_data;
+}
+
+}
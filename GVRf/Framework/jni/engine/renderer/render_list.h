@@ -0,0 +1,90 @@
+/* Copyright 2015 Samsung Electronics Co., LTD
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/***************************************************************************
+ * The renderable render data of a scene, kept in sorted order.
+ ***************************************************************************/
+
+#ifndef RENDER_LIST_H_
+#define RENDER_LIST_H_
+
+#include <stdint.h>
+#include <vector>
+
+namespace gvr {
+class RenderData;
+class RenderSorter;
+class SceneObject;
+
+/*
+ * Every render data a scene can draw, in the order of the render list of
+ * the last frame. Each frame the cull marks the visible ones, and the
+ * visible ones are taken out in list order, sorted by an insertion sort
+ * that only has to repair what moved since the last frame, and put back
+ * into the slots they came from. Each render data remembers its slot, so
+ * marking it visible is a bit set in a bit array.
+ *
+ * The list is only collected again from the scene graph after render data
+ * was added to or removed from the scene; render data that stays keeps its
+ * place and new render data is merged in at its sorted position. Render
+ * data that becomes drawable without the list knowing, like a pass getting
+ * its first material, is added the first time it is marked visible.
+ */
+class RenderList {
+public:
+    RenderList() :
+            render_data_(), visible_(), visible_slots_(), unlisted_(),
+            collected_(), added_() {
+    }
+
+    const std::vector<RenderData*>& render_data() const {
+        return render_data_;
+    }
+
+    void update(const std::vector<SceneObject*>& scene_objects,
+            RenderSorter& render_sorter);
+
+    void clearVisible();
+    void setVisible(RenderData* render_data);
+
+    // the visible render data in sorted order, which also becomes the order
+    // they start from next frame
+    void getVisible(std::vector<RenderData*>& render_data_vector,
+            RenderSorter& render_sorter);
+
+private:
+    RenderList(const RenderList& render_list);
+    RenderList(RenderList&& render_list);
+    RenderList& operator=(const RenderList& render_list);
+    RenderList& operator=(RenderList&& render_list);
+
+    static void collect(SceneObject* scene_object,
+            std::vector<RenderData*>& render_data_vector);
+
+    bool contains(RenderData* render_data) const;
+
+private:
+    static const int VISIBLE_WORD_BITS = 32;
+
+    std::vector<RenderData*> render_data_;
+    std::vector<uint32_t> visible_;
+    std::vector<int> visible_slots_;
+    std::vector<RenderData*> unlisted_;
+    std::vector<RenderData*> collected_;
+    std::vector<RenderData*> added_;
+};
+
+}
+#endif
@@ -0,0 +1,175 @@
+/* Copyright 2015 Samsung Electronics Co., LTD
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/***************************************************************************
+ * Sorts the render list by packed 64-bit keys.
+ ***************************************************************************/
+
+#include "render_sorter.h"
+
+#include <string.h>
+
+#include "objects/material.h"
+#include "objects/components/render_data.h"
+
+namespace gvr {
+
+static const int KEY_BYTES = 8;
+static const int MAX_AVERAGE_INSERTION_STEPS = 4;
+
+uint64_t RenderSorter::makeKey(const RenderData* render_data) {
+    int rendering_order = render_data->rendering_order();
+    if (rendering_order < 0) {
+        rendering_order = 0;
+    } else if (rendering_order > 0xffff) {
+        rendering_order = 0xffff;
+    }
+
+    uint64_t shader = 0;
+    uint64_t texture = 0;
+    Material* material = render_data->material(0);
+    if (material != 0) {
+        shader = material->shader_type() & 0xfff;
+        if (material->main_texture() != 0) {
+            texture = material->main_texture()->getId() & 0xfff;
+        }
+    }
+
+    float distance = render_data->camera_distance();
+    uint32_t distance_bits;
+    memcpy(&distance_bits, &distance, sizeof(distance_bits));
+    uint64_t depth = distance > 0.0f ? (distance_bits >> 7) & 0xffffff : 0;
+
+    uint64_t key = static_cast<uint64_t>(rendering_order) << 48;
+    if (rendering_order >= RenderData::Transparent
+            && rendering_order < RenderData::Overlay) {
+        key |= (~depth & 0xffffff) << 24 | shader << 12 | texture;
+    } else {
+        // a hash of the mesh, so that instances of it end up next to each
+        // other; collisions only cost batching
+        uint64_t mesh = (reinterpret_cast<uintptr_t>(render_data->mesh()) >> 4)
+                & 0xff;
+        key |= shader << 36 | texture << 24 | mesh << 16 | depth >> 8;
+    }
+    return key;
+}
+
+void RenderSorter::sort(std::vector<RenderData*>& render_data_vector) {
+    sort(render_data_vector, 0, render_data_vector.size());
+}
+
+void RenderSorter::sort(std::vector<RenderData*>& render_data_vector,
+        int first, int last) {
+    int count = last - first;
+    if (count < 2) {
+        return;
+    }
+
+    fillItems(render_data_vector, first, last);
+    radixSortItems();
+    for (int i = 0; i < count; ++i) {
+        render_data_vector[first + i] = items_[i].render_data;
+    }
+}
+
+/*
+ * An insertion sort costs one step per place an item moves, which for the
+ * render list in last frame's order is little more than a pass over it. A
+ * turn of the head or a changed rendering order can move many items far,
+ * so once the steps exceed a few per item the radix sort finishes the job.
+ */
+void RenderSorter::sortNearlySorted(
+        std::vector<RenderData*>& render_data_vector) {
+    int count = render_data_vector.size();
+    if (count < 2) {
+        return;
+    }
+
+    fillItems(render_data_vector, 0, count);
+    int budget = count * MAX_AVERAGE_INSERTION_STEPS;
+    for (int i = 1; i < count; ++i) {
+        Item item = items_[i];
+        int j = i;
+        for (; j > 0 && items_[j - 1].key > item.key; --j) {
+            items_[j] = items_[j - 1];
+        }
+        items_[j] = item;
+
+        budget -= i - j;
+        if (budget < 0) {
+            radixSortItems();
+            break;
+        }
+    }
+
+    for (int i = 0; i < count; ++i) {
+        render_data_vector[i] = items_[i].render_data;
+    }
+}
+
+void RenderSorter::fillItems(const std::vector<RenderData*>& render_data_vector,
+        int first, int last) {
+    items_.resize(last - first);
+    for (int i = first; i < last; ++i) {
+        RenderData* render_data = render_data_vector[i];
+        items_[i - first].key = makeKey(render_data);
+        items_[i - first].render_data = render_data;
+    }
+}
+
+void RenderSorter::radixSortItems() {
+    unsigned int count = items_.size();
+    scratch_.resize(count);
+
+    unsigned int histograms[KEY_BYTES][256];
+    memset(histograms, 0, sizeof(histograms));
+    for (unsigned int i = 0; i < count; ++i) {
+        uint64_t key = items_[i].key;
+        for (int b = 0; b < KEY_BYTES; ++b) {
+            ++histograms[b][(key >> (b * 8)) & 0xff];
+        }
+    }
+
+    Item* source = &items_[0];
+    Item* destination = &scratch_[0];
+    for (int b = 0; b < KEY_BYTES; ++b) {
+        unsigned int* histogram = histograms[b];
+        int shift = b * 8;
+        if (histogram[(source[0].key >> shift) & 0xff] == count) {
+            continue;
+        }
+
+        unsigned int offset = 0;
+        for (int d = 0; d < 256; ++d) {
+            unsigned int digit_count = histogram[d];
+            histogram[d] = offset;
+            offset += digit_count;
+        }
+        for (unsigned int i = 0; i < count; ++i) {
+            destination[histogram[(source[i].key >> shift) & 0xff]++] =
+                    source[i];
+        }
+
+        Item* swap = source;
+        source = destination;
+        destination = swap;
+    }
+
+    if (source != &items_[0]) {
+        items_.swap(scratch_);
+    }
+}
+
+}
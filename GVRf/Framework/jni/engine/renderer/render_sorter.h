@@ -0,0 +1,83 @@
+/* Copyright 2015 Samsung Electronics Co., LTD
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/***************************************************************************
+ * Sorts the render list by packed 64-bit keys.
+ ***************************************************************************/
+
+#ifndef RENDER_SORTER_H_
+#define RENDER_SORTER_H_
+
+#include <stdint.h>
+#include <vector>
+
+namespace gvr {
+class RenderData;
+
+/*
+ * Orders render data by one 64-bit key per draw, from the most significant
+ * bits down:
+ *
+ *     opaque:      rendering order (16) | shader (12) | texture (12) | mesh (8) | depth (16)
+ *     transparent: rendering order (16) | inverted depth (24) | shader (12) | texture (12)
+ *
+ * so that within a rendering order opaque draws are grouped by state and
+ * mesh and go front to back, while transparent draws go back to front.
+ * Grouping by mesh keeps instances of a mesh together for the renderer's
+ * instanced draws. The depth is the camera distance, which is never
+ * negative, so the high bits of its float representation order the same
+ * way as the distance itself.
+ *
+ * The keys are sorted with an LSD radix sort, one byte per pass; passes in
+ * which every key has the same byte are skipped. A list that is already
+ * close to sorted, like last frame's, can be sorted with an insertion sort
+ * instead, which hands over to the radix sort when the items moved too far.
+ */
+class RenderSorter {
+public:
+    RenderSorter() :
+            items_(), scratch_() {
+    }
+
+    static uint64_t makeKey(const RenderData* render_data);
+
+    void sort(std::vector<RenderData*>& render_data_vector);
+    void sort(std::vector<RenderData*>& render_data_vector, int first,
+            int last);
+    void sortNearlySorted(std::vector<RenderData*>& render_data_vector);
+
+private:
+    RenderSorter(const RenderSorter& render_sorter);
+    RenderSorter(RenderSorter&& render_sorter);
+    RenderSorter& operator=(const RenderSorter& render_sorter);
+    RenderSorter& operator=(RenderSorter&& render_sorter);
+
+private:
+    void fillItems(const std::vector<RenderData*>& render_data_vector,
+            int first, int last);
+    void radixSortItems();
+
+private:
+    struct Item {
+        uint64_t key;
+        RenderData* render_data;
+    };
+
+    std::vector<Item> items_;
+    std::vector<Item> scratch_;
+};
+
+}
+#endif
@@ -19,14 +19,29 @@
 
 #include "renderer.h"
 
+#include <limits>
+
 #include "glm/gtc/matrix_inverse.hpp"
+#include "glm/gtc/matrix_transform.hpp"
 
 #include "eglextension/tiledrendering/tiled_rendering_enhancer.h"
+#include "engine/renderer/frustum_culler.h"
+#include "engine/renderer/occlusion_culler.h"
+#include "engine/renderer/render_list.h"
+#include "engine/renderer/render_sorter.h"
+#include "engine/renderer/work_stealing_pool.h"
+#include "gl/gl_instance_buffer.h"
+#include "gl/gl_query_pool.h"
+#include "gl/gl_state.h"
+#include "objects/light.h"
+#include "objects/lod_group.h"
 #include "objects/material.h"
 #include "objects/post_effect_data.h"
 #include "objects/scene.h"
 #include "objects/scene_object.h"
+#include "objects/static_batch.h"
 #include "objects/components/camera.h"
+#include "objects/components/camera_rig.h"
 #include "objects/components/eye_pointee_holder.h"
 #include "objects/components/render_data.h"
 #include "objects/textures/render_texture.h"
@@ -34,6 +49,7 @@
 #include "shaders/post_effect_shader_manager.h"
 #include "util/gvr_gl.h"
 #include "util/gvr_log.h"
+#include "util/gvr_profiler.h"
 
 namespace gvr {
 
@@ -41,12 +57,13 @@ static int numberDrawCalls;
 static int numberTriangles;
 
 void Renderer::initializeStats() {
-    // TODO: this function will be filled in once we add draw time stats
+    // counts need no setup; timings are recorded by the Profiler
 }
 
 void Renderer::resetStats() {
     numberDrawCalls = 0;
     numberTriangles = 0;
+    GLState::reset_skipped_calls();
 }
 
 int Renderer::getNumberDrawCalls() {
@@ -57,76 +74,244 @@ int Renderer::getNumberTriangles() {
     return numberTriangles;
 }
 
+int Renderer::getNumberSkippedGLCalls() {
+    return GLState::skipped_calls();
+}
+
 static std::vector<RenderData*> render_data_vector;
+static std::vector<SceneObject*> cull_candidates;
+static std::vector<int> cull_candidate_boxes;
+static FrustumCuller frustum_culler;
+static WorkStealingPool cull_pool;
+static RenderSorter render_sorter;
+static std::vector<std::vector<int> > cull_chunk_results;
+
+// one occlusion culler per eye, in use when the scene culls against occluders
+static OcclusionCuller occlusion_cullers[2];
+static int occlusion_culler_count = 0;
+static std::vector<int> cull_occluders;
+static const int OCCLUSION_ROWS_PER_TASK = 8;
+
+// Occlusion queries are requested while culling and issued once the scene
+// has been drawn, in each eye, so their results are read a frame later.
+struct OcclusionQueryRequest {
+    SceneObject* scene_object;
+    glm::vec3 min_corner;
+    glm::vec3 max_corner;
+    bool subtree;
+};
+
+static GLQueryPool query_pool;
+static std::vector<OcclusionQueryRequest> occlusion_query_requests;
+static bool use_occlusion_queries = false;
+static glm::vec3 cull_camera_position;
+static unsigned int cull_frame = 0;
+
+// visible objects are queried again every this many frames, each on its own
+// frame, and no object is queried with the camera this close to its box
+static const unsigned int VISIBLE_QUERY_INTERVAL = 8;
+static const float QUERY_CAMERA_MARGIN = 0.5f;
+
+// LOD groups are sized on screen by the projection of the cull camera and
+// the height of the viewport last rendered to
+static float cull_projection_scale = 1.0f;
+static int lod_viewport_height = 1024;
+
+// what cull_scene_object found in a subtree
+static const int SUBTREE_HAS_VISIBLE = 1;
+static const int SUBTREE_HAS_HIDDEN = 2;
+
+// candidates and boxes are handed to the cull threads in chunks of this size
+static const int CULL_CHUNK_SIZE = 64;
+static const int CULL_BOX_CHUNK_SIZE = 8 * FrustumCuller::VISIBILITY_WORD_BITS;
+
+// set while the render list comes from a combined cull of both eyes
+static CameraRig* stereo_camera_rig = 0;
+
+// model matrices of the instanced draw being issued
+static std::vector<glm::mat4> instance_model_matrices;
+
+// runs of fewer draws than this are not worth an instance buffer upload
+static const int MIN_INSTANCE_COUNT = 2;
+static const int MAX_INSTANCE_COUNT = 1024;
 
 void Renderer::cull(Scene *scene, Camera *camera, ShaderManager* shader_manager) {
     glm::mat4 view_matrix = camera->getViewMatrix();
     glm::mat4 projection_matrix = camera->getProjectionMatrix();
     glm::mat4 vp_matrix = glm::mat4(projection_matrix * view_matrix);
 
+    float frustum[6][4];
+    build_frustum(frustum, vp_matrix);
+
+    stereo_camera_rig = 0;
+    cull_projection_scale = projection_matrix[1][1];
+    cull(scene, camera->getWorldPosition(), glm::vec3(0.0f), frustum, vp_matrix,
+            shader_manager);
+}
+
+/*
+ * Culls once for both eyes of the camera rig. The eyes only differ by a
+ * small translation, so the frustum of the pair is the frustum of either
+ * eye with the outermost of each two corresponding planes. LOD and camera
+ * distances are computed from the point between the eyes; the distances to
+ * each eye follow from it and are only used to re-sort the transparent
+ * objects when each eye is rendered.
+ */
+void Renderer::cull(Scene *scene, CameraRig *camera_rig,
+        ShaderManager* shader_manager) {
+    Camera* left_camera = camera_rig->left_camera();
+    Camera* right_camera = camera_rig->right_camera();
+
+    glm::mat4 left_vp_matrix = left_camera->getProjectionMatrix()
+            * left_camera->getViewMatrix();
+    glm::mat4 right_vp_matrix = right_camera->getProjectionMatrix()
+            * right_camera->getViewMatrix();
+
+    float frustum[6][4];
+    float right_frustum[6][4];
+    build_frustum(frustum, left_vp_matrix);
+    build_frustum(right_frustum, right_vp_matrix);
+    merge_frustums(frustum, right_frustum);
+
+    glm::vec3 left_position = left_camera->getWorldPosition();
+    glm::vec3 right_position = right_camera->getWorldPosition();
+    glm::vec3 center_position = (left_position + right_position) * 0.5f;
+
+    stereo_camera_rig = camera_rig;
+    cull_projection_scale = left_camera->getProjectionMatrix()[1][1];
+    cull(scene, center_position, right_position - center_position, frustum,
+            left_vp_matrix, shader_manager);
+}
+
+void Renderer::cull(Scene *scene, const glm::vec3& camera_position,
+        const glm::vec3& eye_offset, float frustum[6][4],
+        const glm::mat4& vp_matrix, ShaderManager* shader_manager) {
+    GVR_PROFILE("cull");
     render_data_vector.clear();
-    std::vector<SceneObject*> scene_objects = scene->getWholeSceneObjects();
+    cull_pool.set_thread_count(scene->get_cull_thread_count());
+
+    // the GL state may have been changed outside the renderer since the
+    // last frame
+    GLState::invalidate();
+
+    // the render list is only collected again when the scene changed
+    scene->updateRenderList(render_sorter);
+    RenderList& render_list = scene->render_list();
+    render_list.clearVisible();
 
-    // do occlusion culling, if enabled
-    occlusion_cull(scene, scene_objects);
+    // occlusion queries, if enabled and not replaced by occluders; requests
+    // the eyes of the last frame did not get to are dropped
+    occlusion_query_requests.clear();
+#if _GVRF_USE_GLES3_
+    use_occlusion_queries = scene->get_occlusion_culling()
+            && !scene->get_occluder_culling();
+#endif
+    cull_camera_position = camera_position;
+    ++cull_frame;
 
     // do frustum culling, if enabled
-    frustum_cull(scene, camera, scene_objects, render_data_vector,
+    frustum_cull(scene, camera_position, eye_offset, frustum, render_list,
             vp_matrix, shader_manager);
 
-    // do sorting based on render order
-    std::sort(render_data_vector.begin(), render_data_vector.end(),
-            compareRenderData);
+    // do sorting based on render order, state and distance, starting from
+    // the order of the last frame
+    render_list.getVisible(render_data_vector, render_sorter);
 
 }
 
+/*
+ * After a combined cull the transparent objects are sorted back to front
+ * from the point between the eyes. Only that part of the render list is
+ * sorted again, by the distances to the eye about to be rendered.
+ */
+void Renderer::sortForEye(Camera* camera) {
+    bool left_eye = camera == stereo_camera_rig->left_camera();
+    if (!left_eye && camera != stereo_camera_rig->right_camera()) {
+        return;
+    }
+
+    auto first = std::lower_bound(render_data_vector.begin(),
+            render_data_vector.end(), RenderData::Transparent,
+            [](RenderData* render_data, int rendering_order) {
+                return render_data->rendering_order() < rendering_order;
+            });
+    auto last = std::lower_bound(first, render_data_vector.end(),
+            RenderData::Overlay,
+            [](RenderData* render_data, int rendering_order) {
+                return render_data->rendering_order() < rendering_order;
+            });
+    if (last - first < 2) {
+        return;
+    }
+
+    for (auto it = first; it != last; ++it) {
+        (*it)->set_camera_distance(
+                left_eye ?
+                        (*it)->left_eye_distance() :
+                        (*it)->right_eye_distance());
+    }
+    render_sorter.sort(render_data_vector, first - render_data_vector.begin(),
+            last - render_data_vector.begin());
+}
+
 void Renderer::renderCamera(Scene* scene, Camera* camera, int framebufferId,
         int viewportX, int viewportY, int viewportWidth, int viewportHeight,
         ShaderManager* shader_manager,
         PostEffectShaderManager* post_effect_shader_manager,
         RenderTexture* post_effect_render_texture_a,
         RenderTexture* post_effect_render_texture_b) {
+    GVR_PROFILE("render camera");
 
     numberDrawCalls = 0;
     numberTriangles = 0;
+    // the skipped calls are counted for the whole frame, see resetStats()
+    GLState::invalidate();
+
+    if (stereo_camera_rig != 0) {
+        sortForEye(camera);
+    }
 
     glm::mat4 view_matrix = camera->getViewMatrix();
     glm::mat4 projection_matrix = camera->getProjectionMatrix();
     glm::mat4 vp_matrix = glm::mat4(projection_matrix * view_matrix);
 
+    shader_manager->getFrameUniforms()->update(view_matrix, projection_matrix,
+            camera->render_mask() & RenderData::RenderMaskBit::Right);
+
     std::vector<PostEffectData*> post_effects = camera->post_effect_data();
 
-    glEnable (GL_DEPTH_TEST);
-    glDepthFunc (GL_LEQUAL);
-    glEnable (GL_CULL_FACE);
-    glFrontFace (GL_CCW);
-    glCullFace (GL_BACK);
-    glEnable (GL_BLEND);
-    glBlendEquation (GL_FUNC_ADD);
-    glBlendFunc(GL_ONE, GL_ONE_MINUS_SRC_ALPHA);
-    glDisable (GL_POLYGON_OFFSET_FILL);
+    GLState::enable(GL_DEPTH_TEST);
+    GLState::depthFunc(GL_LEQUAL);
+    GLState::enable(GL_CULL_FACE);
+    GLState::frontFace(GL_CCW);
+    GLState::cullFace(GL_BACK);
+    GLState::enable(GL_BLEND);
+    GLState::blendEquation(GL_FUNC_ADD);
+    GLState::blendFunc(GL_ONE, GL_ONE_MINUS_SRC_ALPHA);
+    GLState::disable(GL_POLYGON_OFFSET_FILL);
+    GLState::disable(GL_SAMPLE_COVERAGE);
 
     if (post_effects.size() == 0) {
-        glBindFramebuffer(GL_FRAMEBUFFER, framebufferId);
-        glViewport(viewportX, viewportY, viewportWidth, viewportHeight);
+        lod_viewport_height = viewportHeight;
+        GLState::bindFramebuffer(GL_FRAMEBUFFER, framebufferId);
+        GLState::viewport(viewportX, viewportY, viewportWidth, viewportHeight);
 
         glClearColor(camera->background_color_r(),
                 camera->background_color_g(), camera->background_color_b(),
                 camera->background_color_a());
         glClear(GL_DEPTH_BUFFER_BIT | GL_COLOR_BUFFER_BIT);
 
-        for (auto it = render_data_vector.begin();
-                it != render_data_vector.end(); ++it) {
-            renderRenderData(*it, view_matrix, projection_matrix,
-                    camera->render_mask(), shader_manager);
-        }
+        renderRenderDataVector(view_matrix, projection_matrix,
+                camera->render_mask(), shader_manager);
+        issue_occlusion_queries(camera, vp_matrix, shader_manager);
     } else {
         RenderTexture* texture_render_texture = post_effect_render_texture_a;
         RenderTexture* target_render_texture;
 
-        glBindFramebuffer(GL_FRAMEBUFFER,
+        lod_viewport_height = texture_render_texture->height();
+        GLState::bindFramebuffer(GL_FRAMEBUFFER,
                 texture_render_texture->getFrameBufferId());
-        glViewport(0, 0, texture_render_texture->width(),
+        GLState::viewport(0, 0, texture_render_texture->width(),
                 texture_render_texture->height());
 
         glClearColor(camera->background_color_r(),
@@ -134,14 +319,12 @@ void Renderer::renderCamera(Scene* scene, Camera* camera, int framebufferId,
                 camera->background_color_a());
         glClear(GL_DEPTH_BUFFER_BIT | GL_COLOR_BUFFER_BIT);
 
-        for (auto it = render_data_vector.begin();
-                it != render_data_vector.end(); ++it) {
-            renderRenderData(*it, view_matrix, projection_matrix,
-                    camera->render_mask(), shader_manager);
-        }
+        renderRenderDataVector(view_matrix, projection_matrix,
+                camera->render_mask(), shader_manager);
+        issue_occlusion_queries(camera, vp_matrix, shader_manager);
 
-        glDisable(GL_DEPTH_TEST);
-        glDisable(GL_CULL_FACE);
+        GLState::disable(GL_DEPTH_TEST);
+        GLState::disable(GL_CULL_FACE);
 
         for (int i = 0; i < post_effects.size() - 1; ++i) {
             if (i % 2 == 0) {
@@ -151,125 +334,244 @@ void Renderer::renderCamera(Scene* scene, Camera* camera, int framebufferId,
                 texture_render_texture = post_effect_render_texture_b;
                 target_render_texture = post_effect_render_texture_a;
             }
-            glBindFramebuffer(GL_FRAMEBUFFER, framebufferId);
-            glViewport(viewportX, viewportY, viewportWidth, viewportHeight);
+            GLState::bindFramebuffer(GL_FRAMEBUFFER, framebufferId);
+            GLState::viewport(viewportX, viewportY, viewportWidth, viewportHeight);
 
             glClear(GL_DEPTH_BUFFER_BIT | GL_COLOR_BUFFER_BIT);
             renderPostEffectData(camera, texture_render_texture,
                     post_effects[i], post_effect_shader_manager);
         }
 
-        glBindFramebuffer(GL_FRAMEBUFFER, framebufferId);
-        glViewport(viewportX, viewportY, viewportWidth, viewportHeight);
+        GLState::bindFramebuffer(GL_FRAMEBUFFER, framebufferId);
+        GLState::viewport(viewportX, viewportY, viewportWidth, viewportHeight);
         glClear(GL_DEPTH_BUFFER_BIT | GL_COLOR_BUFFER_BIT);
         renderPostEffectData(camera, texture_render_texture,
                 post_effects.back(), post_effect_shader_manager);
     }
-}
 
-void Renderer::occlusion_cull(Scene* scene,
-        std::vector<SceneObject*> scene_objects) {
+    // leave the defaults for whatever renders after us
+    GLState::enable(GL_DEPTH_TEST);
+    GLState::enable(GL_CULL_FACE);
+    GLState::cullFace(GL_BACK);
+    GLState::enable(GL_BLEND);
+    GLState::disable(GL_POLYGON_OFFSET_FILL);
+    GLState::disable(GL_SAMPLE_COVERAGE);
 #if _GVRF_USE_GLES3_
-    if (!scene->get_occlusion_culling()) {
+    GLState::bindVertexArray(0);
+#endif
+}
+
+void Renderer::frustum_cull(Scene* scene, const glm::vec3& camera_position,
+        const glm::vec3& eye_offset, float frustum[6][4],
+        RenderList& render_list, const glm::mat4& vp_matrix,
+        ShaderManager* shader_manager) {
+    GVR_PROFILE("frustum cull");
+
+    // Check for frustum culling flag
+    if (!scene->get_frustum_culling()) {
+        //No frustum tests enabled, which leaves no candidates to query
+        const std::vector<RenderData*>& render_data = render_list.render_data();
+        for (auto it = render_data.begin(); it != render_data.end(); ++it) {
+            if ((*it)->pass(0)->material() != 0) {
+                (*it)->set_lod_coverage(1.0f, false);
+                render_list.setVisible(*it);
+            }
+        }
         return;
     }
 
+    // Frustum culling setup: whole subtrees are rejected or accepted by
+    // their world-space bounds and only the objects left undecided are
+    // tested as boxes in one batch
+    frustum_culler.set_frustum(frustum);
+    frustum_culler.clear();
+    cull_candidates.clear();
+    cull_candidate_boxes.clear();
+    cull_occluders.clear();
+    occlusion_culler_count = 0;
+
+    scene->updateMeshBoundingVolumes();
+    const std::vector<SceneObject*>& scene_objects = scene->scene_objects();
     for (auto it = scene_objects.begin(); it != scene_objects.end(); ++it) {
-        RenderData* render_data = (*it)->render_data();
-        if (render_data == 0) {
-            continue;
-        }
-
-        if (render_data->pass(0)->material() == 0) {
-            continue;
-        }
-
-        //If a query was issued on an earlier or same frame and if results are
-        //available, then update the same. If results are unavailable, do nothing
-        if (!(*it)->is_query_issued()) {
-            continue;
-        }
+        cull_scene_object(*it, FrustumCuller::ALL_PLANES);
+    }
 
-        GLuint query_result = GL_FALSE;
-        GLuint *query = (*it)->get_occlusion_array();
-        glGetQueryObjectuiv(query[0], GL_QUERY_RESULT_AVAILABLE, &query_result);
+    frustum_culler.beginCull();
+    int box_count = frustum_culler.box_count();
+    int box_chunk_count = (box_count + CULL_BOX_CHUNK_SIZE - 1)
+            / CULL_BOX_CHUNK_SIZE;
+    cull_pool.run(box_chunk_count, [box_count](int chunk) {
+        GVR_PROFILE("cull boxes");
+        int first_box = chunk * CULL_BOX_CHUNK_SIZE;
+        frustum_culler.cull(first_box,
+                std::min(first_box + CULL_BOX_CHUNK_SIZE, box_count));
+    });
+
+    if (scene->get_occluder_culling()) {
+        rasterize_occluders(camera_position, vp_matrix);
+    }
 
-        if (query_result) {
-            GLuint pixel_count;
-            glGetQueryObjectuiv(query[0], GL_QUERY_RESULT, &pixel_count);
-            bool visibility = ((pixel_count & GL_TRUE) == GL_TRUE);
+    int candidate_count = cull_candidates.size();
+    int chunk_count = (candidate_count + CULL_CHUNK_SIZE - 1)
+            / CULL_CHUNK_SIZE;
+    if (cull_chunk_results.size() < chunk_count) {
+        cull_chunk_results.resize(chunk_count);
+    }
+    cull_pool.run(chunk_count,
+            [candidate_count, &camera_position, &eye_offset](int chunk) {
+                GVR_PROFILE("cull candidates");
+                int first = chunk * CULL_CHUNK_SIZE;
+                cull_candidates_range(first,
+                        std::min(first + CULL_CHUNK_SIZE, candidate_count),
+                        camera_position, eye_offset, cull_chunk_results[chunk]);
+            });
+
+    // The chunks are merged in order, so the render list comes out the same
+    // whatever the number of cull threads. Query results are applied and new
+    // queries requested on this thread: objects that failed their last query
+    // are queried every frame, visible ones only now and then, and never
+    // while a query is pending.
+    for (int chunk = 0; chunk < chunk_count; ++chunk) {
+        const std::vector<int>& accepted = cull_chunk_results[chunk];
+        for (auto it = accepted.begin(); it != accepted.end(); ++it) {
+            SceneObject *scene_object = cull_candidates[*it];
+            RenderData* render_data = scene_object->render_data();
+            if (!use_occlusion_queries) {
+                render_list.setVisible(render_data);
+                continue;
+            }
 
-            (*it)->set_visible(visibility);
-            (*it)->set_query_issued(false);
+            bool visible = scene_object->visible();
+            unsigned int query_frame = cull_frame
+                    + (reinterpret_cast<uintptr_t>(scene_object) >> 4);
+            if (!scene_object->is_query_issued()
+                    && (!visible || query_frame % VISIBLE_QUERY_INTERVAL == 0)) {
+                BoundingVolume bounds;
+                bounds.expand(render_data->mesh()->getBoundingVolume(),
+                        scene_object->transform()->getModelMatrix());
+                if (!request_occlusion_query(scene_object, bounds, false)) {
+                    scene_object->set_visible(true);
+                    visible = true;
+                }
+            }
+            if (visible) {
+                render_list.setVisible(render_data);
+            }
         }
     }
-#endif
 }
 
-void Renderer::frustum_cull(Scene* scene, Camera *camera,
-        std::vector<SceneObject*> scene_objects,
-        std::vector<RenderData*>& render_data_vector, glm::mat4 vp_matrix,
-        ShaderManager* shader_manager) {
-    for (auto it = scene_objects.begin(); it != scene_objects.end(); ++it) {
-        SceneObject *scene_object = (*it);
-        RenderData* render_data = scene_object->render_data();
-        if (render_data == 0 || render_data->pass(0)->material() == 0) {
+/*
+ * Sets up the occluders in view for each eye and rasterizes them on the
+ * cull threads, a few tile rows per task, before the candidates are tested
+ * against them. An object visible to either eye is drawn for both.
+ */
+void Renderer::rasterize_occluders(const glm::vec3& camera_position,
+        const glm::mat4& vp_matrix) {
+    GVR_PROFILE("set up occluders");
+    occlusion_cullers[0].clear(vp_matrix);
+    occlusion_culler_count = 1;
+    if (stereo_camera_rig != 0) {
+        Camera* right_camera = stereo_camera_rig->right_camera();
+        occlusion_cullers[1].clear(
+                right_camera->getProjectionMatrix()
+                        * right_camera->getViewMatrix());
+        occlusion_culler_count = 2;
+    }
+
+    for (auto it = cull_occluders.begin(); it != cull_occluders.end(); ++it) {
+        int box = cull_candidate_boxes[*it];
+        if (box >= 0 && !frustum_culler.is_visible(box)) {
             continue;
         }
 
-        // Check for frustum culling flag
-        if (!scene->get_frustum_culling()) {
-            //No occlusion or frustum tests enabled
-            render_data_vector.push_back(render_data);
+        SceneObject* scene_object = cull_candidates[*it];
+        RenderData* render_data = scene_object->render_data();
+        Mesh* mesh = render_data->mesh();
+        if (render_data->draw_mode() != GL_TRIANGLES) {
             continue;
         }
 
-        // Frustum culling setup
-        Mesh* currentMesh = render_data->mesh();
-        if (currentMesh == NULL) {
-            continue;
+        glm::mat4 model_matrix(scene_object->transform()->getModelMatrix());
+        if (scene_object->using_lod()) {
+            glm::vec3 center(
+                    model_matrix
+                            * glm::vec4(mesh->getBoundingVolume().center(),
+                                    1.0f));
+            glm::vec3 difference = center - camera_position;
+            if (!scene_object->inLODRange(
+                    glm::dot(difference, difference))) {
+                continue;
+            }
         }
 
-        const BoundingVolume& bounding_volume = currentMesh->getBoundingVolume();
+        // an occluder rasterizes its own triangles, which a GPU-only mesh
+        // dropped after its first draw
+        if (!mesh->keep_positions()) {
+            mesh->readBack();
+        }
 
-        glm::mat4 model_matrix_tmp(
-                render_data->owner_object()->transform()->getModelMatrix());
-        glm::mat4 mvp_matrix_tmp(vp_matrix * model_matrix_tmp);
+        for (int i = 0; i < occlusion_culler_count; ++i) {
+            occlusion_cullers[i].addOccluder(model_matrix, mesh->vertices(),
+                    mesh->triangles());
+        }
+    }
 
-        // Frustum
-        float frustum[6][4];
+    int tasks_per_culler = OcclusionCuller::TILE_ROWS / OCCLUSION_ROWS_PER_TASK;
+    cull_pool.run(tasks_per_culler * occlusion_culler_count,
+            [tasks_per_culler](int task) {
+                GVR_PROFILE("rasterize occluder rows");
+                int first_row = (task % tasks_per_culler)
+                        * OCCLUSION_ROWS_PER_TASK;
+                occlusion_cullers[task / tasks_per_culler].rasterize(first_row,
+                        first_row + OCCLUSION_ROWS_PER_TASK);
+            });
+}
 
-        // Matrix to array
-        float mvp_matrix_array[16] = { 0.0 };
-        const float *mat_to_array = (const float*) glm::value_ptr(
-                mvp_matrix_tmp);
-        memcpy(mvp_matrix_array, mat_to_array, sizeof(float) * 16);
+/*
+ * Frustum box result, camera distance, LOD range and occlusion of a range
+ * of cull candidates. Runs on the cull threads: it only touches the
+ * candidates of its own range and writes the indices of the accepted ones
+ * to accepted.
+ */
+void Renderer::cull_candidates_range(int first, int last,
+        const glm::vec3& camera_position, const glm::vec3& eye_offset,
+        std::vector<int>& accepted) {
+    float eye_offset_squared = glm::dot(eye_offset, eye_offset);
 
-        // Build the frustum
-        build_frustum(frustum, mvp_matrix_array);
+    accepted.clear();
 
-        // Check for being inside or outside frustum
-        bool is_inside = is_cube_in_frustum(frustum, bounding_volume);
+    for (int i = first; i < last; ++i) {
+        SceneObject *scene_object = cull_candidates[i];
+        RenderData* render_data = scene_object->render_data();
 
         // Only push those scene objects that are inside of the frustum
-        if (!is_inside) {
+        int box = cull_candidate_boxes[i];
+        if (box >= 0 && !frustum_culler.is_visible(box)) {
+            // what hid it no longer holds once it is back in view
             scene_object->set_in_frustum(false);
+            scene_object->set_visible(true);
             continue;
         }
 
-        // Transform the bounding sphere
-        glm::vec4 sphere_center(bounding_volume.center(), 1.0f);
-        glm::vec4 transformed_sphere_center = mvp_matrix_tmp * sphere_center;
+        const BoundingVolume& bounding_volume =
+                render_data->mesh()->getBoundingVolume();
+
+        glm::mat4 model_matrix_tmp(
+                scene_object->transform()->getModelMatrix());
 
-        // Calculate distance from camera
-        glm::vec3 camera_position =
-                camera->owner_object()->transform()->position();
-        glm::vec4 position(camera_position, 1.0f);
-        glm::vec4 difference = transformed_sphere_center - position;
+        // Squared distance from the camera to the bounds center
+        glm::vec3 center(
+                model_matrix_tmp * glm::vec4(bounding_volume.center(), 1.0f));
+        glm::vec3 difference = center - camera_position;
         float distance = glm::dot(difference, difference);
 
-        // this distance will be used when sorting transparent objects
+        // this distance will be used when sorting transparent objects;
+        // the eyes are at camera_position -/+ eye_offset
+        float eye_delta = 2.0f * glm::dot(difference, eye_offset);
         render_data->set_camera_distance(distance);
+        render_data->set_eye_distances(distance + eye_delta + eye_offset_squared,
+                distance - eye_delta + eye_offset_squared);
 
         // Check if this is the correct LOD level
         if (!scene_object->inLODRange(distance)) {
@@ -277,57 +579,386 @@ void Renderer::frustum_cull(Scene* scene, Camera *camera,
             continue;
         }
 
+        // occluders are drawn whenever they are in view, anything else only
+        // if some part of it may be in front of them
+        bool occluded = occlusion_culler_count > 0
+                && !scene_object->is_occluder();
+        for (int c = 0; c < occlusion_culler_count && occluded; ++c) {
+            occluded = !occlusion_cullers[c].isVisible(bounding_volume,
+                    model_matrix_tmp);
+        }
+        if (occluded) {
+            continue;
+        }
+
         scene_object->set_in_frustum();
-        bool visible = scene_object->visible();
+        accepted.push_back(i);
+    }
+}
 
-        //If visibility flag was set by an earlier occlusion query,
-        //turn visibility on for the object
-        if (visible) {
-            render_data_vector.push_back(render_data);
+/*
+ * Merges the planes of a frustum translated from the first one, keeping the
+ * outermost plane of each pair. Planes that are not parallel, as for eyes
+ * which are not looking the same way, are dropped, which keeps the result
+ * conservative.
+ */
+void Renderer::merge_frustums(float frustum[6][4],
+        const float other_frustum[6][4]) {
+    for (int p = 0; p < 6; ++p) {
+        float cos_angle = frustum[p][0] * other_frustum[p][0]
+                + frustum[p][1] * other_frustum[p][1]
+                + frustum[p][2] * other_frustum[p][2];
+        if (cos_angle < 0.9999f) {
+            frustum[p][0] = 0.0f;
+            frustum[p][1] = 0.0f;
+            frustum[p][2] = 0.0f;
+            frustum[p][3] = 1.0f;
+        } else if (other_frustum[p][3] > frustum[p][3]) {
+            for (int i = 0; i < 4; ++i) {
+                frustum[p][i] = other_frustum[p][i];
+            }
         }
+    }
+}
 
-        if (render_data->pass(0)->material() == 0
-                || !scene->get_occlusion_culling()) {
-            continue;
+/*
+ * The diameter of world-space bounds on screen, in pixels, as seen from the
+ * cull camera. Bounds around the camera are as large as can be.
+ */
+static float screen_size(const BoundingVolume& bounds) {
+    float distance = glm::length(bounds.center() - cull_camera_position);
+    if (distance <= bounds.radius()) {
+        return std::numeric_limits<float>::max();
+    }
+    return bounds.radius() * cull_projection_scale * lod_viewport_height
+            / distance;
+}
+
+/*
+ * Narrows the sample coverage inherited from fading levels above by that of
+ * the scene object as a level of the LOD group. A level that is not shown
+ * gets no coverage; a fade further up takes precedence over one below.
+ */
+static void apply_lod_coverage(LODGroup* lod_group, SceneObject* scene_object,
+        float& coverage, bool& invert) {
+    bool level_invert;
+    float level_coverage = lod_group->coverage(scene_object, level_invert);
+    if (level_coverage <= 0.0f) {
+        coverage = 0.0f;
+    } else if (level_coverage < 1.0f && coverage >= 1.0f) {
+        coverage = level_coverage;
+        invert = level_invert;
+    }
+}
+
+/*
+ * Walks the hierarchy rejecting whole subtrees whose world-space bounds are
+ * outside of the frustum. Planes a subtree is entirely inside of are not
+ * tested again below it, and once no plane is left everything below is
+ * accepted without any test.
+ *
+ * With occlusion queries, a subtree in which objects were hidden and none
+ * was visible is skipped from then on and only its bounds are queried,
+ * until the query passes. Returns SUBTREE_HAS_VISIBLE and
+ * SUBTREE_HAS_HIDDEN for what it found.
+ *
+ * The level of a LOD group is picked here, once per cull, from the size of
+ * the group on screen; levels not shown are skipped with their subtrees and
+ * levels fading in or out pass their sample coverage down.
+ */
+int Renderer::cull_scene_object(SceneObject* scene_object, int plane_mask,
+        float lod_coverage, bool lod_invert) {
+    if (plane_mask != 0) {
+        FrustumCuller::Containment containment = frustum_culler.classifyBox(
+                scene_object->getBoundingVolume(), plane_mask);
+        if (containment == FrustumCuller::Outside) {
+            scene_object->set_in_frustum(false);
+            scene_object->set_subtree_visible(true);
+            return 0;
         }
+    }
 
-#if _GVRF_USE_GLES3_
-        //If a previous query is active, do not issue a new query.
-        //This avoids overloading the GPU with too many queries
-        //Queries may span multiple frames
+    if (use_occlusion_queries) {
+        poll_occlusion_query(scene_object);
+        if (!scene_object->subtree_visible()) {
+            if (scene_object->is_query_issued()
+                    || request_occlusion_query(scene_object,
+                            scene_object->getBoundingVolume(), true)) {
+                return SUBTREE_HAS_HIDDEN;
+            }
+            show_subtree(scene_object);
+        }
+    }
 
-        bool is_query_issued = scene_object->is_query_issued();
-        if (!is_query_issued) {
-            //Setup basic bounding box and material
-            RenderData* bounding_box_render_data(new RenderData());
-            Mesh* bounding_box_mesh = render_data->mesh()->getBoundingBox();
-            bounding_box_render_data->set_mesh(bounding_box_mesh);
+    LODGroup* lod_group = scene_object->lod_group();
+    if (lod_group != 0) {
+        lod_group->select(screen_size(scene_object->getBoundingVolume()),
+                cull_frame);
+    }
 
-            GLuint *query = scene_object->get_occlusion_array();
+    // the merged meshes of a static subtree stand in for it, only what
+    // could not be merged is culled on its own
+    int occlusion = 0;
+    StaticBatch* static_batch = scene_object->static_batch();
+    if (static_batch != 0 && lod_group == 0) {
+        const std::vector<SceneObject*>& batches = static_batch->batches();
+        for (auto it = batches.begin(); it != batches.end(); ++it) {
+            occlusion |= cull_scene_object(*it, plane_mask, lod_coverage,
+                    lod_invert);
+        }
+        const std::vector<SceneObject*>& unbatched_objects =
+                static_batch->unbatched_objects();
+        for (auto it = unbatched_objects.begin(); it != unbatched_objects.end();
+                ++it) {
+            if ((*it)->lod_group() != 0) {
+                occlusion |= cull_scene_object(*it, plane_mask, lod_coverage,
+                        lod_invert);
+                continue;
+            }
+            if (use_occlusion_queries) {
+                poll_occlusion_query(*it);
+            }
+            occlusion |= add_cull_candidate(*it, plane_mask, true,
+                    lod_coverage, lod_invert);
+        }
+    } else {
+        const std::vector<SceneObject*>& children = scene_object->children();
+        float coverage = lod_coverage;
+        bool invert = lod_invert;
+        if (lod_group != 0) {
+            apply_lod_coverage(lod_group, scene_object, coverage, invert);
+        }
+        if (coverage > 0.0f) {
+            occlusion = add_cull_candidate(scene_object, plane_mask,
+                    !children.empty(), coverage, invert);
+        }
 
-            glDepthFunc (GL_LEQUAL);
-            glEnable (GL_DEPTH_TEST);
-            glColorMask(GL_FALSE, GL_FALSE, GL_FALSE, GL_FALSE);
+        for (auto it = children.begin(); it != children.end(); ++it) {
+            coverage = lod_coverage;
+            invert = lod_invert;
+            if (lod_group != 0) {
+                apply_lod_coverage(lod_group, *it, coverage, invert);
+            }
+            if (coverage > 0.0f) {
+                occlusion |= cull_scene_object(*it, plane_mask, coverage,
+                        invert);
+            }
+        }
+        if (children.empty()) {
+            return occlusion;
+        }
+    }
+
+    if (use_occlusion_queries && occlusion == SUBTREE_HAS_HIDDEN) {
+        scene_object->set_subtree_visible(false);
+    }
+    return occlusion;
+}
 
-            //Issue the query only with a bounding box
-            glBeginQuery(GL_ANY_SAMPLES_PASSED, query[0]);
-            shader_manager->getBoundingBoxShader()->render(mvp_matrix_tmp,
-                    bounding_box_render_data,
-                    bounding_box_render_data->pass(0)->material());
-            glEndQuery (GL_ANY_SAMPLES_PASSED);
-            scene_object->set_query_issued(true);
+/*
+ * Adds the render data of the scene object to the candidates, with a box
+ * test unless the bounds that passed were its own. Returns whether it was
+ * visible or hidden by its last occlusion query, 0 if not a candidate.
+ */
+int Renderer::add_cull_candidate(SceneObject* scene_object, int plane_mask,
+        bool test_box, float lod_coverage, bool lod_invert) {
+    RenderData* render_data = scene_object->render_data();
+    if (render_data == 0 || render_data->pass(0)->material() == 0
+            || render_data->mesh() == NULL) {
+        return 0;
+    }
+    render_data->set_lod_coverage(lod_coverage, lod_invert);
 
-            glColorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE);
+    // the lazily computed bounds and matrix are brought up to date here,
+    // on the calling thread, so that the cull threads only read them
+    const BoundingVolume& bounding_volume =
+            render_data->mesh()->getBoundingVolume();
+    glm::mat4 model_matrix = scene_object->transform()->getModelMatrix();
 
-            //Delete the generated bounding box mesh
-            bounding_box_mesh->cleanUp();
-            delete bounding_box_render_data;
+    int box = -1;
+    if (plane_mask != 0 && test_box) {
+        box = frustum_culler.addBox(bounding_volume, model_matrix);
+    }
+    if (scene_object->is_occluder()) {
+        cull_occluders.push_back(cull_candidates.size());
+    }
+    cull_candidates.push_back(scene_object);
+    cull_candidate_boxes.push_back(box);
+    return scene_object->visible() ? SUBTREE_HAS_VISIBLE : SUBTREE_HAS_HIDDEN;
+}
+
+/*
+ * Applies the results of the pending queries of a scene object once every
+ * eye's result is available, without waiting for them. A subtree that
+ * passed is shown whole again, its objects to be queried on their own.
+ */
+void Renderer::poll_occlusion_query(SceneObject* scene_object) {
+#if _GVRF_USE_GLES3_
+    if (!scene_object->is_query_issued()) {
+        return;
+    }
+
+    bool visible = false;
+    for (int eye = 0; eye < 2; ++eye) {
+        GLuint query = scene_object->occlusion_query(eye);
+        if (query == 0) {
+            continue;
         }
+        GLuint available = GL_FALSE;
+        glGetQueryObjectuiv(query, GL_QUERY_RESULT_AVAILABLE, &available);
+        if (!available) {
+            return;
+        }
+        GLuint any_samples_passed = GL_FALSE;
+        glGetQueryObjectuiv(query, GL_QUERY_RESULT, &any_samples_passed);
+        visible = visible || any_samples_passed;
+    }
+
+    bool subtree_query = scene_object->is_subtree_query();
+    release_occlusion_queries(scene_object);
+
+    if (!subtree_query) {
+        scene_object->set_visible(visible);
+    } else if (visible) {
+        show_subtree(scene_object);
+    }
 #endif
+}
+
+void Renderer::release_occlusion_queries(SceneObject* scene_object) {
+    for (int eye = 0; eye < 2; ++eye) {
+        GLuint query = scene_object->occlusion_query(eye);
+        if (query != 0) {
+            query_pool.release(query);
+            scene_object->set_occlusion_query(eye, 0, false);
+        }
+    }
+}
+
+/*
+ * Queues a query on world-space bounds for the eyes rendered next. Returns
+ * false without queuing if the camera is inside or about at the bounds, as
+ * the front faces of the box would be clipped away.
+ */
+bool Renderer::request_occlusion_query(SceneObject* scene_object,
+        const BoundingVolume& bounds, bool subtree) {
+    glm::vec3 margin(QUERY_CAMERA_MARGIN);
+    if (glm::all(glm::greaterThan(cull_camera_position,
+            bounds.min_corner() - margin))
+            && glm::all(glm::lessThan(cull_camera_position,
+                    bounds.max_corner() + margin))) {
+        return false;
+    }
+
+    OcclusionQueryRequest request;
+    request.scene_object = scene_object;
+    request.min_corner = bounds.min_corner();
+    request.max_corner = bounds.max_corner();
+    request.subtree = subtree;
+    occlusion_query_requests.push_back(request);
+    return true;
+}
+
+/*
+ * Marks a subtree hidden by a subtree query visible again, along with the
+ * objects below, which are queried on their own from the next frame on.
+ * Results of queries left pending below are from before it was hidden and
+ * are dropped.
+ */
+void Renderer::show_subtree(SceneObject* scene_object) {
+    scene_object->set_subtree_visible(true);
+    scene_object->set_visible(true);
+    release_occlusion_queries(scene_object);
+
+    StaticBatch* static_batch = scene_object->static_batch();
+    if (static_batch != 0) {
+        const std::vector<SceneObject*>& batches = static_batch->batches();
+        for (auto it = batches.begin(); it != batches.end(); ++it) {
+            (*it)->set_visible(true);
+            release_occlusion_queries(*it);
+        }
+        const std::vector<SceneObject*>& unbatched_objects =
+                static_batch->unbatched_objects();
+        for (auto it = unbatched_objects.begin(); it != unbatched_objects.end();
+                ++it) {
+            if ((*it)->lod_group() != 0) {
+                show_subtree(*it);
+                continue;
+            }
+            (*it)->set_visible(true);
+            release_occlusion_queries(*it);
+        }
+    }
+
+    const std::vector<SceneObject*>& children = scene_object->children();
+    for (auto it = children.begin(); it != children.end(); ++it) {
+        show_subtree(*it);
+    }
+}
+
+/*
+ * Issues the queries requested by the last cull against the depth buffer
+ * of the eye just rendered, all in one batch of unit cube draws with color
+ * and depth writes off. The requests are kept until the last eye of the
+ * cull has issued them.
+ */
+void Renderer::issue_occlusion_queries(Camera* camera,
+        const glm::mat4& vp_matrix, ShaderManager* shader_manager) {
+#if _GVRF_USE_GLES3_
+    if (occlusion_query_requests.empty()) {
+        return;
+    }
+    GVR_PROFILE("occlusion queries");
+    GVR_PROFILE_GPU("occlusion queries");
+
+    int eye = 0;
+    bool last_eye = true;
+    if (stereo_camera_rig != 0) {
+        if (camera == stereo_camera_rig->right_camera()) {
+            eye = 1;
+        } else {
+            last_eye = false;
+        }
+    }
+
+    GLState::enable(GL_DEPTH_TEST);
+    GLState::depthFunc(GL_LEQUAL);
+    GLState::disable(GL_CULL_FACE);
+    GLState::disable(GL_BLEND);
+    GLState::disable(GL_POLYGON_OFFSET_FILL);
+    GLState::disable(GL_SAMPLE_COVERAGE);
+    glColorMask(GL_FALSE, GL_FALSE, GL_FALSE, GL_FALSE);
+    glDepthMask(GL_FALSE);
+
+    BoundingBoxShader* bounding_box_shader =
+            shader_manager->getBoundingBoxShader();
+    bounding_box_shader->beginBoxes();
+    for (auto it = occlusion_query_requests.begin();
+            it != occlusion_query_requests.end(); ++it) {
+        glm::mat4 box_matrix(glm::translate(vp_matrix, it->min_corner));
+        box_matrix = glm::scale(box_matrix, it->max_corner - it->min_corner);
+
+        GLuint query = query_pool.acquire();
+        glBeginQuery(GL_ANY_SAMPLES_PASSED_CONSERVATIVE, query);
+        bounding_box_shader->renderBox(box_matrix);
+        glEndQuery(GL_ANY_SAMPLES_PASSED_CONSERVATIVE);
+        it->scene_object->set_occlusion_query(eye, query, it->subtree);
+    }
+
+    glColorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE);
+    glDepthMask(GL_TRUE);
+    GLState::enable(GL_CULL_FACE);
+    GLState::enable(GL_BLEND);
+
+    if (last_eye) {
+        occlusion_query_requests.clear();
     }
+    checkGlError("Renderer::issue_occlusion_queries");
+#endif
 }
 
-void Renderer::build_frustum(float frustum[6][4], float mvp_matrix[16]) {
+void Renderer::build_frustum(float frustum[6][4], const glm::mat4& vp_matrix) {
+    const float* mvp_matrix = glm::value_ptr(vp_matrix);
     float t;
 
     /* Extract the numbers for the RIGHT plane */
@@ -421,49 +1052,6 @@ void Renderer::build_frustum(float frustum[6][4], float mvp_matrix[16]) {
     frustum[5][3] /= t;
 }
 
-bool Renderer::is_cube_in_frustum(float frustum[6][4],
-        const BoundingVolume &bounding_volume) {
-    int p;
-    glm::vec3 min_corner = bounding_volume.min_corner();
-    glm::vec3 max_corner = bounding_volume.max_corner();
-
-    float Xmin = min_corner[0];
-    float Ymin = min_corner[1];
-    float Zmin = min_corner[2];
-    float Xmax = max_corner[0];
-    float Ymax = max_corner[1];
-    float Zmax = max_corner[2];
-
-    for (p = 0; p < 6; p++) {
-        if (frustum[p][0] * (Xmin) + frustum[p][1] * (Ymin)
-                + frustum[p][2] * (Zmin) + frustum[p][3] > 0)
-            continue;
-        if (frustum[p][0] * (Xmax) + frustum[p][1] * (Ymin)
-                + frustum[p][2] * (Zmin) + frustum[p][3] > 0)
-            continue;
-        if (frustum[p][0] * (Xmin) + frustum[p][1] * (Ymax)
-                + frustum[p][2] * (Zmin) + frustum[p][3] > 0)
-            continue;
-        if (frustum[p][0] * (Xmax) + frustum[p][1] * (Ymax)
-                + frustum[p][2] * (Zmin) + frustum[p][3] > 0)
-            continue;
-        if (frustum[p][0] * (Xmin) + frustum[p][1] * (Ymin)
-                + frustum[p][2] * (Zmax) + frustum[p][3] > 0)
-            continue;
-        if (frustum[p][0] * (Xmax) + frustum[p][1] * (Ymin)
-                + frustum[p][2] * (Zmax) + frustum[p][3] > 0)
-            continue;
-        if (frustum[p][0] * (Xmin) + frustum[p][1] * (Ymax)
-                + frustum[p][2] * (Zmax) + frustum[p][3] > 0)
-            continue;
-        if (frustum[p][0] * (Xmax) + frustum[p][1] * (Ymax)
-                + frustum[p][2] * (Zmax) + frustum[p][3] > 0)
-            continue;
-        return false;
-    }
-    return true;
-}
-
 void Renderer::renderCamera(Scene* scene, Camera* camera,
         ShaderManager* shader_manager,
         PostEffectShaderManager* post_effect_shader_manager,
@@ -504,22 +1092,138 @@ void Renderer::renderCamera(Scene* scene, Camera* camera, int viewportX,
             post_effect_render_texture_a, post_effect_render_texture_b);
 }
 
+/*
+ * Whether the render data can be drawn by renderInstancedRenderData(): a
+ * single pass with a shader that has an instanced variant.
+ */
+static bool can_instance(RenderData* render_data,
+        ShaderManager* shader_manager) {
+    if (render_data->mesh() == 0 || render_data->pass_count() != 1) {
+        return false;
+    }
+    Material* material = render_data->material(0);
+    if (material == 0) {
+        return false;
+    }
+
+    switch (material->shader_type()) {
+    case Material::ShaderType::TEXTURE_SHADER:
+        // the lit variant needs per-instance normal matrices as well
+        return !render_data->light_enabled()
+                || !render_data->light()->enabled();
+    case Material::ShaderType::UNLIT_HORIZONTAL_STEREO_SHADER:
+    case Material::ShaderType::UNLIT_VERTICAL_STEREO_SHADER:
+        return true;
+    case Material::ShaderType::OES_SHADER:
+    case Material::ShaderType::OES_HORIZONTAL_STEREO_SHADER:
+    case Material::ShaderType::OES_VERTICAL_STEREO_SHADER:
+    case Material::ShaderType::CUBEMAP_SHADER:
+    case Material::ShaderType::CUBEMAP_REFLECTION_SHADER:
+    case Material::ShaderType::EXTERNAL_RENDERER_SHADER:
+    case Material::ShaderType::ASSIMP_SHADER:
+        return false;
+    default:
+        try {
+            return shader_manager->getCustomShader(material->shader_type())->instanced();
+        } catch (const char* error) {
+            return false;
+        }
+    }
+}
+
+// whether other can be drawn as another instance of the first of a run
+static bool is_same_instance(RenderData* first, RenderData* other) {
+    return other->mesh() == first->mesh()
+            && other->pass_count() == 1
+            && other->material(0) == first->material(0)
+            && other->render_mask() == first->render_mask()
+            && other->cull_face(0) == first->cull_face(0)
+            && other->offset() == first->offset()
+            && (!first->offset()
+                    || (other->offset_factor() == first->offset_factor()
+                            && other->offset_units() == first->offset_units()))
+            && other->depth_test() == first->depth_test()
+            && other->alpha_blend() == first->alpha_blend()
+            && other->light_enabled() == first->light_enabled()
+            && other->light() == first->light()
+            && other->lod_coverage() == first->lod_coverage()
+            && other->lod_coverage_invert() == first->lod_coverage_invert();
+}
+
+// the name of the draws of each stock shader in the profiler
+static const char* shader_profile_name(int shader_type) {
+    switch (shader_type) {
+    case Material::ShaderType::UNLIT_HORIZONTAL_STEREO_SHADER:
+        return "draw unlit horizontal stereo";
+    case Material::ShaderType::UNLIT_VERTICAL_STEREO_SHADER:
+        return "draw unlit vertical stereo";
+    case Material::ShaderType::OES_SHADER:
+        return "draw oes";
+    case Material::ShaderType::OES_HORIZONTAL_STEREO_SHADER:
+        return "draw oes horizontal stereo";
+    case Material::ShaderType::OES_VERTICAL_STEREO_SHADER:
+        return "draw oes vertical stereo";
+    case Material::ShaderType::CUBEMAP_SHADER:
+        return "draw cubemap";
+    case Material::ShaderType::CUBEMAP_REFLECTION_SHADER:
+        return "draw cubemap reflection";
+    case Material::ShaderType::TEXTURE_SHADER:
+        return "draw texture";
+    case Material::ShaderType::EXTERNAL_RENDERER_SHADER:
+        return "draw external renderer";
+    case Material::ShaderType::ASSIMP_SHADER:
+        return "draw assimp";
+    default:
+        return "draw custom shader";
+    }
+}
+
+/*
+ * Draws the sorted render list. Runs of render data that only differ by
+ * their transform are drawn with one instanced draw; the sort keys group
+ * render data by shader, texture and mesh so such runs stay together.
+ */
+void Renderer::renderRenderDataVector(const glm::mat4& view_matrix,
+        const glm::mat4& projection_matrix, int render_mask,
+        ShaderManager* shader_manager) {
+    GVR_PROFILE("draw");
+    GVR_PROFILE_GPU("draw");
+
+    int count = render_data_vector.size();
+    for (int i = 0; i < count;) {
+        RenderData* render_data = render_data_vector[i];
+        int run_end = i + 1;
+
+#if _GVRF_USE_GLES3_
+        if ((render_mask & render_data->render_mask())
+                && can_instance(render_data, shader_manager)) {
+            while (run_end < count && run_end - i < MAX_INSTANCE_COUNT
+                    && is_same_instance(render_data,
+                            render_data_vector[run_end])) {
+                ++run_end;
+            }
+            if (run_end - i >= MIN_INSTANCE_COUNT) {
+                renderInstancedRenderData(i, run_end, view_matrix,
+                        projection_matrix, render_mask, shader_manager);
+                i = run_end;
+                continue;
+            }
+            run_end = i + 1;
+        }
+#endif
+
+        renderRenderData(render_data, view_matrix, projection_matrix,
+                render_mask, shader_manager);
+        i = run_end;
+    }
+}
+
 void Renderer::renderRenderData(RenderData* render_data,
         const glm::mat4& view_matrix, const glm::mat4& projection_matrix,
         int render_mask, ShaderManager* shader_manager) {
     if (render_mask & render_data->render_mask()) {
 
-        if (render_data->offset()) {
-            glEnable (GL_POLYGON_OFFSET_FILL);
-            glPolygonOffset(render_data->offset_factor(),
-                    render_data->offset_units());
-        }
-        if (!render_data->depth_test()) {
-            glDisable (GL_DEPTH_TEST);
-        }
-        if (!render_data->alpha_blend()) {
-            glDisable (GL_BLEND);
-        }
+        set_render_state(render_data);
         if (render_data->mesh() != 0) {
             for (int curr_pass = 0; curr_pass < render_data->pass_count();
                     ++curr_pass) {
@@ -531,6 +1235,8 @@ void Renderer::renderRenderData(RenderData* render_data,
                         render_data->pass(curr_pass)->material();
 
                 if (curr_material != nullptr) {
+                    GVR_PROFILE(
+                            shader_profile_name(curr_material->shader_type()));
                     glm::mat4 model_matrix(
                             render_data->owner_object()->transform()->getModelMatrix());
                     glm::mat4 mv_matrix(view_matrix * model_matrix);
@@ -582,19 +1288,35 @@ void Renderer::renderRenderData(RenderData* render_data,
                         case Material::ShaderType::EXTERNAL_RENDERER_SHADER:
                             shader_manager->getExternalRendererShader()->render(
                                     mvp_matrix, render_data);
+                            // the external renderer does its own GL calls
+                            GLState::invalidate();
                             break;
                         case Material::ShaderType::ASSIMP_SHADER:
                             shader_manager->getAssimpShader()->render(
                                     mv_matrix, glm::inverseTranspose(mv_matrix),
                                     mvp_matrix, render_data, curr_material);
                             break;
-                        default:
-                            shader_manager->getCustomShader(
-                                    curr_material->shader_type())->render(
-                                    mvp_matrix, render_data, curr_material,
-                                    right);
+                        default: {
+                            CustomShader* custom_shader =
+                                    shader_manager->getCustomShader(
+                                            curr_material->shader_type());
+                            if (custom_shader->instanced()) {
+                                GLInstanceBuffer* instance_buffer =
+                                        shader_manager->getInstanceBuffer();
+                                instance_buffer->setModelMatrices(
+                                        &model_matrix, 1);
+                                custom_shader->renderInstanced(
+                                        projection_matrix * view_matrix,
+                                        render_data, curr_material, right,
+                                        instance_buffer);
+                            } else {
+                                custom_shader->render(model_matrix,
+                                        mvp_matrix, render_data, curr_material,
+                                        right);
+                            }
                             break;
                         }
+                        }
                     } catch (std::string error) {
                         LOGE(
                                 "Error detected in Renderer::renderRenderData; name : %s, error : %s", render_data->owner_object()->name().c_str(), error.c_str());
@@ -604,30 +1326,75 @@ void Renderer::renderRenderData(RenderData* render_data,
                 }
             }
         }
+    }
+}
 
-        // Restoring to Default.
-        // TODO: There's a lot of redundant state changes. If on every render face culling is being set there's no need to
-        // restore defaults. Possibly later we could add a OpenGL state wrapper to avoid redundant api calls.
-        if (render_data->cull_face() != RenderData::CullBack) {
-            glEnable (GL_CULL_FACE);
-            glCullFace (GL_BACK);
-        }
+/*
+ * Draws render data [first, last) of the render list, which all passed
+ * is_same_instance() against the first, with one instanced draw. If the
+ * shader fails they are drawn one at a time instead.
+ */
+void Renderer::renderInstancedRenderData(int first, int last,
+        const glm::mat4& view_matrix, const glm::mat4& projection_matrix,
+        int render_mask, ShaderManager* shader_manager) {
+    GVR_PROFILE("draw instanced");
+    RenderData* render_data = render_data_vector[first];
+    Material* material = render_data->material(0);
+    int instance_count = last - first;
+
+    instance_model_matrices.resize(instance_count);
+    for (int i = 0; i < instance_count; ++i) {
+        instance_model_matrices[i] =
+                render_data_vector[first + i]->owner_object()->transform()->getModelMatrix();
+    }
 
-        if (render_data->offset()) {
-            glDisable (GL_POLYGON_OFFSET_FILL);
-        }
-        if (!render_data->depth_test()) {
-            glEnable (GL_DEPTH_TEST);
+    set_render_state(render_data);
+    set_face_culling(render_data->pass(0)->cull_face());
+
+    GLInstanceBuffer* instance_buffer = shader_manager->getInstanceBuffer();
+    instance_buffer->setModelMatrices(&instance_model_matrices[0],
+            instance_count);
+
+    glm::mat4 vp_matrix(projection_matrix * view_matrix);
+    bool right = render_mask & RenderData::RenderMaskBit::Right;
+    try {
+        switch (material->shader_type()) {
+        case Material::ShaderType::TEXTURE_SHADER:
+            shader_manager->getTextureShader()->renderInstanced(render_data,
+                    material, instance_buffer);
+            break;
+        case Material::ShaderType::UNLIT_HORIZONTAL_STEREO_SHADER:
+            shader_manager->getUnlitHorizontalStereoShader()->renderInstanced(
+                    render_data, material, instance_buffer);
+            break;
+        case Material::ShaderType::UNLIT_VERTICAL_STEREO_SHADER:
+            shader_manager->getUnlitVerticalStereoShader()->renderInstanced(
+                    render_data, material, instance_buffer);
+            break;
+        default:
+            shader_manager->getCustomShader(material->shader_type())->renderInstanced(
+                    vp_matrix, render_data, material, right, instance_buffer);
+            break;
         }
-        if (!render_data->alpha_blend()) {
-            glEnable (GL_BLEND);
+    } catch (std::string error) {
+        LOGE(
+                "Error detected in Renderer::renderInstancedRenderData; name : %s, error : %s", render_data->owner_object()->name().c_str(), error.c_str());
+        for (int i = first; i < last; ++i) {
+            renderRenderData(render_data_vector[i], view_matrix,
+                    projection_matrix, render_mask, shader_manager);
         }
+        return;
     }
+
+    numberDrawCalls++;
+    numberTriangles += render_data->mesh()->getNumTriangles() * instance_count;
 }
 
 void Renderer::renderPostEffectData(Camera* camera,
         RenderTexture* render_texture, PostEffectData* post_effect_data,
         PostEffectShaderManager* post_effect_shader_manager) {
+    GVR_PROFILE("post effect");
+    GVR_PROFILE_GPU("post effect");
     try {
         switch (post_effect_data->shader_type()) {
         case PostEffectData::ShaderType::COLOR_BLEND_SHADER:
@@ -659,21 +1426,51 @@ void Renderer::renderPostEffectData(Camera* camera,
     }
 }
 
+// sets the state of every draw, redundant changes are skipped by GLState
+void Renderer::set_render_state(RenderData* render_data) {
+    if (render_data->offset()) {
+        GLState::enable(GL_POLYGON_OFFSET_FILL);
+        GLState::polygonOffset(render_data->offset_factor(),
+                render_data->offset_units());
+    } else {
+        GLState::disable(GL_POLYGON_OFFSET_FILL);
+    }
+    if (render_data->depth_test()) {
+        GLState::enable(GL_DEPTH_TEST);
+    } else {
+        GLState::disable(GL_DEPTH_TEST);
+    }
+    if (render_data->alpha_blend()) {
+        GLState::enable(GL_BLEND);
+    } else {
+        GLState::disable(GL_BLEND);
+    }
+    // complementary coverage masks dither two fading LOD levels together;
+    // it takes multisampling, without which a fading level is all or none
+    if (render_data->lod_coverage() < 1.0f) {
+        GLState::enable(GL_SAMPLE_COVERAGE);
+        GLState::sampleCoverage(render_data->lod_coverage(),
+                render_data->lod_coverage_invert());
+    } else {
+        GLState::disable(GL_SAMPLE_COVERAGE);
+    }
+}
+
 void Renderer::set_face_culling(int cull_face) {
     switch (cull_face) {
     case RenderData::CullFront:
-        glEnable (GL_CULL_FACE);
-        glCullFace (GL_FRONT);
+        GLState::enable(GL_CULL_FACE);
+        GLState::cullFace(GL_FRONT);
         break;
 
     case RenderData::CullNone:
-        glDisable(GL_CULL_FACE);
+        GLState::disable(GL_CULL_FACE);
         break;
 
         // CullBack as Default
     default:
-        glEnable(GL_CULL_FACE);
-        glCullFace (GL_BACK);
+        GLState::enable(GL_CULL_FACE);
+        GLState::cullFace(GL_BACK);
         break;
     }
 }
@@ -41,11 +41,13 @@
 
 namespace gvr {
 class Camera;
+class CameraRig;
 class Scene;
 class SceneObject;
 class PostEffectData;
 class PostEffectShaderManager;
 class RenderData;
+class RenderList;
 class RenderTexture;
 class ShaderManager;
 
@@ -81,31 +83,58 @@ public:
             RenderTexture* post_effect_render_texture_b);
 
     static void cull(Scene *scene, Camera *camera, ShaderManager* shader_manager);
+    static void cull(Scene *scene, CameraRig *camera_rig,
+            ShaderManager* shader_manager);
 
     static void initializeStats();
     static void resetStats();
     static int getNumberDrawCalls();
     static int getNumberTriangles();
+    static int getNumberSkippedGLCalls();
 
 private:
+    static void renderRenderDataVector(const glm::mat4& view_matrix,
+            const glm::mat4& projection_matrix, int render_mask,
+            ShaderManager* shader_manager);
     static void renderRenderData(RenderData* render_data,
             const glm::mat4& view_matrix, const glm::mat4& projection_matrix,
             int render_mask, ShaderManager* shader_manager);
+    static void renderInstancedRenderData(int first, int last,
+            const glm::mat4& view_matrix, const glm::mat4& projection_matrix,
+            int render_mask, ShaderManager* shader_manager);
     static void renderPostEffectData(Camera* camera,
             RenderTexture* render_texture, PostEffectData* post_effect_data,
             PostEffectShaderManager* post_effect_shader_manager);
 
-    static void occlusion_cull(Scene* scene,
-            std::vector<SceneObject*> scene_objects);
-    static void frustum_cull(Scene* scene, Camera *camera,
-            std::vector<SceneObject*> scene_objects,
-            std::vector<RenderData*>& render_data_vector, glm::mat4 vp_matrix,
+    static void cull(Scene *scene, const glm::vec3& camera_position,
+            const glm::vec3& eye_offset, float frustum[6][4],
+            const glm::mat4& vp_matrix, ShaderManager* shader_manager);
+    static void sortForEye(Camera* camera);
+    static void frustum_cull(Scene* scene, const glm::vec3& camera_position,
+            const glm::vec3& eye_offset, float frustum[6][4],
+            RenderList& render_list, const glm::mat4& vp_matrix,
             ShaderManager* shader_manager);
-    static void build_frustum(float frustum[6][4], float mvp_matrix[16]);
-
-    static bool is_cube_in_frustum(float frustum[6][4],
-            const BoundingVolume &bounding_volume);
-
+    static int cull_scene_object(SceneObject* scene_object, int plane_mask,
+            float lod_coverage = 1.0f, bool lod_invert = false);
+    static int add_cull_candidate(SceneObject* scene_object, int plane_mask,
+            bool test_box, float lod_coverage, bool lod_invert);
+    static void poll_occlusion_query(SceneObject* scene_object);
+    static bool request_occlusion_query(SceneObject* scene_object,
+            const BoundingVolume& bounds, bool subtree);
+    static void release_occlusion_queries(SceneObject* scene_object);
+    static void show_subtree(SceneObject* scene_object);
+    static void issue_occlusion_queries(Camera* camera,
+            const glm::mat4& vp_matrix, ShaderManager* shader_manager);
+    static void rasterize_occluders(const glm::vec3& camera_position,
+            const glm::mat4& vp_matrix);
+    static void cull_candidates_range(int first, int last,
+            const glm::vec3& camera_position, const glm::vec3& eye_offset,
+            std::vector<int>& accepted);
+    static void build_frustum(float frustum[6][4], const glm::mat4& vp_matrix);
+    static void merge_frustums(float frustum[6][4],
+            const float other_frustum[6][4]);
+
+    static void set_render_state(RenderData* render_data);
     static void set_face_culling(int cull_face);
 
     Renderer(const Renderer& render_engine);
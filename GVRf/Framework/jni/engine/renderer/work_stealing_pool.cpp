@@ -0,0 +1,181 @@
+/* Copyright 2015 Samsung Electronics Co., LTD
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/***************************************************************************
+ * Worker threads that run indexed tasks, stealing from each other.
+ ***************************************************************************/
+
+#include "work_stealing_pool.h"
+
+#include <unistd.h>
+
+namespace gvr {
+
+WorkStealingPool::WorkStealingPool() :
+        requested_thread_count_(1), thread_count_(1), threads_(), queues_(), mutex_(), start_condition_(), done_condition_(), task_(
+                0), generation_(0), busy_threads_(0), stopping_(false) {
+    queues_.push_back(new TaskQueue());
+}
+
+WorkStealingPool::~WorkStealingPool() {
+    stopThreads();
+    for (auto it = queues_.begin(); it != queues_.end(); ++it) {
+        delete *it;
+    }
+}
+
+void WorkStealingPool::set_thread_count(int thread_count) {
+    if (thread_count == requested_thread_count_) {
+        return;
+    }
+    requested_thread_count_ = thread_count;
+
+    if (thread_count <= 0) {
+        thread_count = sysconf(_SC_NPROCESSORS_ONLN);
+        if (thread_count <= 0) {
+            thread_count = 1;
+        }
+    }
+    if (thread_count == thread_count_) {
+        return;
+    }
+
+    stopThreads();
+    for (auto it = queues_.begin(); it != queues_.end(); ++it) {
+        delete *it;
+    }
+    queues_.clear();
+
+    thread_count_ = thread_count;
+    for (int i = 0; i < thread_count_; ++i) {
+        queues_.push_back(new TaskQueue());
+    }
+    startThreads();
+}
+
+void WorkStealingPool::startThreads() {
+    stopping_ = false;
+    for (int i = 1; i < thread_count_; ++i) {
+        threads_.push_back(
+                std::thread(&WorkStealingPool::workerThreadFunc, this, i,
+                        generation_));
+    }
+}
+
+void WorkStealingPool::stopThreads() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+    }
+    start_condition_.notify_all();
+    for (auto it = threads_.begin(); it != threads_.end(); ++it) {
+        it->join();
+    }
+    threads_.clear();
+}
+
+void WorkStealingPool::run(int task_count,
+        const std::function<void(int)>& task) {
+    if (thread_count_ <= 1 || task_count <= 1) {
+        for (int i = 0; i < task_count; ++i) {
+            task(i);
+        }
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (int t = 0; t < thread_count_; ++t) {
+            int first = task_count * t / thread_count_;
+            int last = task_count * (t + 1) / thread_count_;
+            std::lock_guard<std::mutex> queue_lock(queues_[t]->mutex);
+            for (int i = first; i < last; ++i) {
+                queues_[t]->tasks.push_back(i);
+            }
+        }
+        task_ = &task;
+        busy_threads_ = thread_count_ - 1;
+        ++generation_;
+    }
+    start_condition_.notify_all();
+
+    runTasks(0);
+
+    // wait for the workers to leave runTasks(), not just for the queues to
+    // drain, so that none of them still holds task_ when this returns
+    std::unique_lock<std::mutex> lock(mutex_);
+    done_condition_.wait(lock, [this] {return busy_threads_ == 0;});
+    task_ = 0;
+}
+
+void WorkStealingPool::workerThreadFunc(int thread,
+        unsigned int generation) {
+    while (true) {
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            start_condition_.wait(lock,
+                    [this, generation] {return stopping_ || generation_ != generation;});
+            if (stopping_) {
+                return;
+            }
+            generation = generation_;
+        }
+
+        runTasks(thread);
+
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (--busy_threads_ == 0) {
+            done_condition_.notify_one();
+        }
+    }
+}
+
+void WorkStealingPool::runTasks(int thread) {
+    int task;
+    while (popTask(thread, task)) {
+        (*task_)(task);
+    }
+}
+
+/*
+ * Takes the next task of this thread's own range from the front, otherwise
+ * steals the last task of another thread's range. No tasks are added while
+ * a run is in progress, so all queues being empty means the run is over.
+ */
+bool WorkStealingPool::popTask(int thread, int& task) {
+    {
+        TaskQueue* queue = queues_[thread];
+        std::lock_guard<std::mutex> lock(queue->mutex);
+        if (!queue->tasks.empty()) {
+            task = queue->tasks.front();
+            queue->tasks.pop_front();
+            return true;
+        }
+    }
+
+    for (int i = 1; i < thread_count_; ++i) {
+        TaskQueue* victim = queues_[(thread + i) % thread_count_];
+        std::lock_guard<std::mutex> lock(victim->mutex);
+        if (!victim->tasks.empty()) {
+            task = victim->tasks.back();
+            victim->tasks.pop_back();
+            return true;
+        }
+    }
+
+    return false;
+}
+
+}
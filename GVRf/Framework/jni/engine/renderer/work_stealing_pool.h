@@ -0,0 +1,89 @@
+/* Copyright 2015 Samsung Electronics Co., LTD
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/***************************************************************************
+ * Worker threads that run indexed tasks, stealing from each other.
+ ***************************************************************************/
+
+#ifndef WORK_STEALING_POOL_H_
+#define WORK_STEALING_POOL_H_
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace gvr {
+
+/*
+ * Runs tasks 0..n-1 on a fixed set of threads, the calling thread being one
+ * of them. Each thread starts on its own contiguous range of tasks, in
+ * order, and steals from the far end of the other ranges once its own is
+ * exhausted. run() returns when every task has finished.
+ *
+ * With a thread count of 1 the tasks are run in order on the calling thread.
+ * The pool itself is not thread safe: run() and set_thread_count() must be
+ * called from one thread.
+ */
+class WorkStealingPool {
+public:
+    WorkStealingPool();
+    ~WorkStealingPool();
+
+    // 0 means one thread per online core
+    void set_thread_count(int thread_count);
+
+    int thread_count() const {
+        return thread_count_;
+    }
+
+    void run(int task_count, const std::function<void(int)>& task);
+
+private:
+    WorkStealingPool(const WorkStealingPool& pool);
+    WorkStealingPool(WorkStealingPool&& pool);
+    WorkStealingPool& operator=(const WorkStealingPool& pool);
+    WorkStealingPool& operator=(WorkStealingPool&& pool);
+
+    void startThreads();
+    void stopThreads();
+    void workerThreadFunc(int thread, unsigned int generation);
+    void runTasks(int thread);
+    bool popTask(int thread, int& task);
+
+private:
+    struct TaskQueue {
+        std::mutex mutex;
+        std::deque<int> tasks;
+    };
+
+    int requested_thread_count_;
+    int thread_count_;
+    std::vector<std::thread> threads_;
+    std::vector<TaskQueue*> queues_;
+
+    std::mutex mutex_;
+    std::condition_variable start_condition_;
+    std::condition_variable done_condition_;
+    const std::function<void(int)>* task_;
+    unsigned int generation_;
+    int busy_threads_;
+    bool stopping_;
+};
+
+}
+#endif
@@ -0,0 +1,65 @@
+/* Copyright 2015 Samsung Electronics Co., LTD
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/***************************************************************************
+ * Uniforms that stay the same for a whole eye.
+ ***************************************************************************/
+
+#include "gl_frame_uniforms.h"
+
+#include "engine/memory/gl_delete.h"
+#include "gl/gl_program.h"
+
+namespace gvr {
+
+const char GLFrameUniforms::SHADER_HEADER[] = "#version 300 es\n"
+        "layout(std140) uniform FrameUniforms {\n"
+        "  highp mat4 u_view;\n"
+        "  highp mat4 u_projection;\n"
+        "  highp mat4 u_view_projection;\n"
+        "  highp int u_eye;\n"
+        "};\n";
+
+GLFrameUniforms::GLFrameUniforms() :
+        id_(0) {
+    glGenBuffers(1, &id_);
+    glBindBuffer(GL_UNIFORM_BUFFER, id_);
+    glBufferData(GL_UNIFORM_BUFFER, sizeof(Block), 0, GL_DYNAMIC_DRAW);
+    glBindBuffer(GL_UNIFORM_BUFFER, 0);
+}
+
+GLFrameUniforms::~GLFrameUniforms() {
+    gl_delete.queueBuffer(id_);
+}
+
+void GLFrameUniforms::update(const glm::mat4& view_matrix,
+        const glm::mat4& projection_matrix, bool right) {
+    Block block;
+    block.view = view_matrix;
+    block.projection = projection_matrix;
+    block.view_projection = projection_matrix * view_matrix;
+    block.eye = right ? 1 : 0;
+    block.padding[0] = block.padding[1] = block.padding[2] = 0;
+
+    // orphan the storage the previous eye may still be reading
+    glBindBuffer(GL_UNIFORM_BUFFER, id_);
+    glBufferData(GL_UNIFORM_BUFFER, sizeof(Block), 0, GL_DYNAMIC_DRAW);
+    glBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(Block), &block);
+    glBindBufferBase(GL_UNIFORM_BUFFER, GLProgram::FRAME_UNIFORMS_BINDING,
+            id_);
+    glBindBuffer(GL_UNIFORM_BUFFER, 0);
+}
+
+}
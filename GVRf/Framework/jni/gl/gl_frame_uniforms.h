@@ -0,0 +1,79 @@
+/* Copyright 2015 Samsung Electronics Co., LTD
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/***************************************************************************
+ * Uniforms that stay the same for a whole eye.
+ ***************************************************************************/
+
+#ifndef GL_FRAME_UNIFORMS_H_
+#define GL_FRAME_UNIFORMS_H_
+
+#ifndef GL_ES_VERSION_3_0
+#include "GLES3/gl3.h"
+#endif
+
+#include "glm/glm.hpp"
+
+namespace gvr {
+
+/*
+ * A uniform buffer with the view and projection of the eye being drawn,
+ * filled and bound once per eye. GLProgram binds any block named
+ * FrameUniforms to it, so GLSL ES 3.00 shaders, custom ones included, can
+ * read these instead of having them uploaded with every draw:
+ *
+ *   layout(std140) uniform FrameUniforms {
+ *       highp mat4 u_view;
+ *       highp mat4 u_projection;
+ *       highp mat4 u_view_projection;
+ *       highp int u_eye; // 0 for the left eye, 1 for the right
+ *   };
+ *
+ * The precisions are explicit so both stages declare the same block.
+ */
+class GLFrameUniforms {
+public:
+    // the #version line and the block above, for the stock shaders to start
+    // their sources with
+    static const char SHADER_HEADER[];
+
+    GLFrameUniforms();
+    ~GLFrameUniforms();
+
+    void update(const glm::mat4& view_matrix,
+            const glm::mat4& projection_matrix, bool right);
+
+private:
+    GLFrameUniforms(const GLFrameUniforms& gl_frame_uniforms);
+    GLFrameUniforms(GLFrameUniforms&& gl_frame_uniforms);
+    GLFrameUniforms& operator=(const GLFrameUniforms& gl_frame_uniforms);
+    GLFrameUniforms& operator=(GLFrameUniforms&& gl_frame_uniforms);
+
+private:
+    // std140 layout of the block
+    struct Block {
+        glm::mat4 view;
+        glm::mat4 projection;
+        glm::mat4 view_projection;
+        GLint eye;
+        GLint padding[3];
+    };
+
+    GLuint id_;
+};
+
+}
+
+#endif
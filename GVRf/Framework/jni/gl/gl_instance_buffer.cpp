@@ -0,0 +1,67 @@
+/* Copyright 2015 Samsung Electronics Co., LTD
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/***************************************************************************
+ * Per-instance model matrices for instanced draws.
+ ***************************************************************************/
+
+#include "gl_instance_buffer.h"
+
+#include "engine/memory/gl_delete.h"
+#include "gl/gl_program.h"
+
+namespace gvr {
+
+GLInstanceBuffer::GLInstanceBuffer() :
+        id_(0), capacity_(0), instance_count_(0) {
+    glGenBuffers(1, &id_);
+}
+
+GLInstanceBuffer::~GLInstanceBuffer() {
+    gl_delete.queueBuffer(id_);
+}
+
+void GLInstanceBuffer::setModelMatrices(const glm::mat4* model_matrices,
+        int count) {
+    glBindBuffer(GL_ARRAY_BUFFER, id_);
+    if (count > capacity_) {
+        capacity_ = count;
+        glBufferData(GL_ARRAY_BUFFER, sizeof(glm::mat4) * count,
+                model_matrices, GL_STREAM_DRAW);
+    } else {
+        // orphan the storage the previous draw may still be reading
+        glBufferData(GL_ARRAY_BUFFER, sizeof(glm::mat4) * capacity_, 0,
+                GL_STREAM_DRAW);
+        glBufferSubData(GL_ARRAY_BUFFER, 0, sizeof(glm::mat4) * count,
+                model_matrices);
+    }
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    instance_count_ = count;
+}
+
+void GLInstanceBuffer::bindModelMatrixAttribute() const {
+    glBindBuffer(GL_ARRAY_BUFFER, id_);
+    for (int column = 0; column < 4; ++column) {
+        GLuint location = GLProgram::MODEL_MATRIX_ATTRIBUTE_LOCATION + column;
+        glEnableVertexAttribArray(location);
+        glVertexAttribPointer(location, 4, GL_FLOAT, GL_FALSE,
+                sizeof(glm::mat4),
+                reinterpret_cast<const GLvoid*>(sizeof(glm::vec4) * column));
+        glVertexAttribDivisor(location, 1);
+    }
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+}
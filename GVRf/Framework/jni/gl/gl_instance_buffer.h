@@ -0,0 +1,68 @@
+/* Copyright 2015 Samsung Electronics Co., LTD
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/***************************************************************************
+ * Per-instance model matrices for instanced draws.
+ ***************************************************************************/
+
+#ifndef GL_INSTANCE_BUFFER_H_
+#define GL_INSTANCE_BUFFER_H_
+
+#ifndef GL_ES_VERSION_3_0
+#include "GLES3/gl3.h"
+#endif
+
+#include "glm/glm.hpp"
+
+namespace gvr {
+
+/*
+ * A streamed array buffer with one model matrix per instance. The buffer is
+ * refilled for every instanced draw and only grows, so a frame of batches
+ * settles on a single allocation.
+ *
+ * Shaders read the matrix through the attribute a_model, which GLProgram
+ * binds to MODEL_MATRIX_ATTRIBUTE_LOCATION.
+ */
+class GLInstanceBuffer {
+public:
+    GLInstanceBuffer();
+    ~GLInstanceBuffer();
+
+    int instance_count() const {
+        return instance_count_;
+    }
+
+    void setModelMatrices(const glm::mat4* model_matrices, int count);
+
+    // points the model matrix attribute of the bound vertex array at the
+    // buffer, advancing once per instance
+    void bindModelMatrixAttribute() const;
+
+private:
+    GLInstanceBuffer(const GLInstanceBuffer& gl_instance_buffer);
+    GLInstanceBuffer(GLInstanceBuffer&& gl_instance_buffer);
+    GLInstanceBuffer& operator=(const GLInstanceBuffer& gl_instance_buffer);
+    GLInstanceBuffer& operator=(GLInstanceBuffer&& gl_instance_buffer);
+
+private:
+    GLuint id_;
+    int capacity_;
+    int instance_count_;
+};
+
+}
+
+#endif
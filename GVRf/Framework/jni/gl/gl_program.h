@@ -133,15 +133,24 @@ public:
                 }
                 gl_delete.queueProgram(program);
                 program = 0;
+            } else {
+                bindCommonUniformBlocks(program);
             }
         }
         return program;
     }
 
+    // the per-instance model matrix takes four locations, one per column
     enum attributeBindLocation {
         POSITION_ATTRIBUTE_LOCATION = 0,
         TEXCOORD_ATTRIBUT_LOCATION = 1,
-        NORMAL_ATTRIBUTE_LOCATION = 2
+        NORMAL_ATTRIBUTE_LOCATION = 2,
+        MODEL_MATRIX_ATTRIBUTE_LOCATION = 12
+    };
+
+    // see GLFrameUniforms
+    enum uniformBlockBinding {
+        FRAME_UNIFORMS_BINDING = 0
     };
 
 private:
@@ -152,6 +161,14 @@ private:
     	glBindAttribLocation (id, POSITION_ATTRIBUTE_LOCATION, "a_position");
     	glBindAttribLocation (id, TEXCOORD_ATTRIBUT_LOCATION, "a_tex_coord");
     	glBindAttribLocation (id, NORMAL_ATTRIBUTE_LOCATION, "a_normal");
+    	glBindAttribLocation (id, MODEL_MATRIX_ATTRIBUTE_LOCATION, "a_model");
+    }
+
+    static void bindCommonUniformBlocks(GLuint id) {
+        GLuint index = glGetUniformBlockIndex(id, "FrameUniforms");
+        if (index != GL_INVALID_INDEX) {
+            glUniformBlockBinding(id, index, FRAME_UNIFORMS_BINDING);
+        }
     }
 
 };
@@ -0,0 +1,42 @@
+/* Copyright 2015 Samsung Electronics Co., LTD
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/***************************************************************************
+ * Query objects recycled across frames.
+ ***************************************************************************/
+
+#include "gl_query_pool.h"
+
+#include <algorithm>
+
+namespace gvr {
+
+GLuint GLQueryPool::acquire() {
+    if (free_queries_.empty()) {
+        // grow by half of what exists, so a large scene gets there in a few
+        // frames
+        int block_size = std::max(static_cast<int>(MIN_BLOCK_SIZE),
+                generated_count_ / 2);
+        free_queries_.resize(block_size);
+        glGenQueries(block_size, free_queries_.data());
+        generated_count_ += block_size;
+    }
+
+    GLuint query = free_queries_.back();
+    free_queries_.pop_back();
+    return query;
+}
+
+}
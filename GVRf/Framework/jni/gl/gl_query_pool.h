@@ -0,0 +1,73 @@
+/* Copyright 2015 Samsung Electronics Co., LTD
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/***************************************************************************
+ * Query objects recycled across frames.
+ ***************************************************************************/
+
+#ifndef GL_QUERY_POOL_H_
+#define GL_QUERY_POOL_H_
+
+#include <vector>
+
+#ifndef GL_ES_VERSION_3_0
+#include "GLES3/gl3.h"
+#endif
+
+namespace gvr {
+
+/*
+ * Hands out query objects and takes them back once their result has been
+ * read. The pool starts empty and generates queries in growing blocks
+ * when it runs out, so a scene settles on as many queries as it keeps in
+ * flight and then generates none.
+ *
+ * Only used on the GL thread.
+ */
+class GLQueryPool {
+public:
+    GLQueryPool() :
+            free_queries_(), generated_count_(0) {
+    }
+
+    ~GLQueryPool() {
+    }
+
+    GLuint acquire();
+
+    void release(GLuint query) {
+        free_queries_.push_back(query);
+    }
+
+    int generated_count() const {
+        return generated_count_;
+    }
+
+private:
+    GLQueryPool(const GLQueryPool& gl_query_pool);
+    GLQueryPool(GLQueryPool&& gl_query_pool);
+    GLQueryPool& operator=(const GLQueryPool& gl_query_pool);
+    GLQueryPool& operator=(GLQueryPool&& gl_query_pool);
+
+private:
+    static const int MIN_BLOCK_SIZE = 32;
+
+    std::vector<GLuint> free_queries_;
+    int generated_count_;
+};
+
+}
+
+#endif
@@ -0,0 +1,172 @@
+/* Copyright 2015 Samsung Electronics Co., LTD
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/***************************************************************************
+ * Shadow copy of the GL state, to skip redundant GL calls.
+ ***************************************************************************/
+
+#include "gl_state.h"
+
+#include "util/gvr_gl.h"
+
+namespace gvr {
+
+int GLState::skipped_calls_ = 0;
+int GLState::capabilities_[CAPABILITY_COUNT] = { -1, -1, -1, -1, -1 };
+GLenum GLState::depth_func_ = UNKNOWN;
+GLenum GLState::blend_source_factor_ = UNKNOWN;
+GLenum GLState::blend_destination_factor_ = UNKNOWN;
+GLenum GLState::blend_equation_ = UNKNOWN;
+GLenum GLState::cull_face_ = UNKNOWN;
+GLenum GLState::front_face_ = UNKNOWN;
+bool GLState::polygon_offset_valid_ = false;
+GLfloat GLState::polygon_offset_factor_ = 0.0f;
+GLfloat GLState::polygon_offset_units_ = 0.0f;
+bool GLState::sample_coverage_valid_ = false;
+GLfloat GLState::sample_coverage_value_ = 1.0f;
+GLboolean GLState::sample_coverage_invert_ = GL_FALSE;
+GLuint GLState::program_ = UNKNOWN;
+GLuint GLState::vertex_array_ = UNKNOWN;
+GLenum GLState::active_texture_ = UNKNOWN;
+GLuint GLState::textures_[TEXTURE_UNIT_COUNT][TEXTURE_TARGET_COUNT];
+bool GLState::textures_known_[TEXTURE_UNIT_COUNT][TEXTURE_TARGET_COUNT];
+GLuint GLState::draw_framebuffer_ = UNKNOWN;
+GLuint GLState::read_framebuffer_ = UNKNOWN;
+GLint GLState::viewport_[4] = { -1, -1, -1, -1 };
+
+void GLState::invalidate() {
+    for (int i = 0; i < CAPABILITY_COUNT; ++i) {
+        capabilities_[i] = -1;
+    }
+    depth_func_ = UNKNOWN;
+    blend_source_factor_ = UNKNOWN;
+    blend_destination_factor_ = UNKNOWN;
+    blend_equation_ = UNKNOWN;
+    cull_face_ = UNKNOWN;
+    front_face_ = UNKNOWN;
+    polygon_offset_valid_ = false;
+    sample_coverage_valid_ = false;
+    program_ = UNKNOWN;
+    vertex_array_ = UNKNOWN;
+    active_texture_ = UNKNOWN;
+    for (int unit = 0; unit < TEXTURE_UNIT_COUNT; ++unit) {
+        for (int target = 0; target < TEXTURE_TARGET_COUNT; ++target) {
+            textures_known_[unit][target] = false;
+        }
+    }
+    draw_framebuffer_ = UNKNOWN;
+    read_framebuffer_ = UNKNOWN;
+    for (int i = 0; i < 4; ++i) {
+        viewport_[i] = -1;
+    }
+}
+
+void GLState::setCapability(GLenum capability, bool enabled) {
+    int index;
+    switch (capability) {
+    case GL_DEPTH_TEST:
+        index = DEPTH_TEST_CAPABILITY;
+        break;
+    case GL_CULL_FACE:
+        index = CULL_FACE_CAPABILITY;
+        break;
+    case GL_BLEND:
+        index = BLEND_CAPABILITY;
+        break;
+    case GL_POLYGON_OFFSET_FILL:
+        index = POLYGON_OFFSET_FILL_CAPABILITY;
+        break;
+    case GL_SAMPLE_COVERAGE:
+        index = SAMPLE_COVERAGE_CAPABILITY;
+        break;
+    default:
+        if (enabled) {
+            glEnable(capability);
+        } else {
+            glDisable(capability);
+        }
+        return;
+    }
+
+    int state = enabled ? 1 : 0;
+    if (capabilities_[index] == state) {
+        ++skipped_calls_;
+        return;
+    }
+    capabilities_[index] = state;
+    if (enabled) {
+        glEnable(capability);
+    } else {
+        glDisable(capability);
+    }
+}
+
+/*
+ * Bindings are shadowed per texture unit for the targets the shaders use;
+ * binds on other targets, or while the active unit is unknown, always go
+ * to the driver.
+ */
+void GLState::bindTexture(GLenum target, GLuint texture) {
+    int target_index;
+    switch (target) {
+    case GL_TEXTURE_2D:
+        target_index = 0;
+        break;
+    case GL_TEXTURE_CUBE_MAP:
+        target_index = 1;
+        break;
+    case GL_TEXTURE_EXTERNAL_OES:
+        target_index = 2;
+        break;
+    default:
+        target_index = -1;
+        break;
+    }
+
+    int unit = active_texture_ - GL_TEXTURE0;
+    if (target_index < 0 || active_texture_ == UNKNOWN || unit < 0
+            || unit >= TEXTURE_UNIT_COUNT) {
+        glBindTexture(target, texture);
+        return;
+    }
+
+    if (textures_known_[unit][target_index]
+            && textures_[unit][target_index] == texture) {
+        ++skipped_calls_;
+        return;
+    }
+    textures_known_[unit][target_index] = true;
+    textures_[unit][target_index] = texture;
+    glBindTexture(target, texture);
+}
+
+void GLState::bindFramebuffer(GLenum target, GLuint framebuffer) {
+    bool draw = target == GL_FRAMEBUFFER || target == GL_DRAW_FRAMEBUFFER;
+    bool read = target == GL_FRAMEBUFFER || target == GL_READ_FRAMEBUFFER;
+    if ((!draw || draw_framebuffer_ == framebuffer)
+            && (!read || read_framebuffer_ == framebuffer)) {
+        ++skipped_calls_;
+        return;
+    }
+    if (draw) {
+        draw_framebuffer_ = framebuffer;
+    }
+    if (read) {
+        read_framebuffer_ = framebuffer;
+    }
+    glBindFramebuffer(target, framebuffer);
+}
+
+}
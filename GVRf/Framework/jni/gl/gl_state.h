@@ -0,0 +1,228 @@
+/* Copyright 2015 Samsung Electronics Co., LTD
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/***************************************************************************
+ * Shadow copy of the GL state, to skip redundant GL calls.
+ ***************************************************************************/
+
+#ifndef GL_STATE_H_
+#define GL_STATE_H_
+
+#ifndef GL_ES_VERSION_3_0
+#include "GLES3/gl3.h"
+#include <GLES2/gl2ext.h>
+#endif
+
+namespace gvr {
+
+/*
+ * Every call made through this class is compared with the state it last
+ * set, and only goes to the driver when it would change something. The
+ * shadow state only knows about calls made through here: code that touches
+ * the same state directly, like the Oculus runtime between frames or the
+ * texture classes when they upload, must be followed by invalidate().
+ *
+ * GL is only used from the GL thread, so the state is not synchronized.
+ */
+class GLState {
+private:
+    GLState();
+
+public:
+    // forgets everything, so the next call of each kind goes to the driver
+    static void invalidate();
+
+    static int skipped_calls() {
+        return skipped_calls_;
+    }
+
+    static void reset_skipped_calls() {
+        skipped_calls_ = 0;
+    }
+
+    static void enable(GLenum capability) {
+        setCapability(capability, true);
+    }
+
+    static void disable(GLenum capability) {
+        setCapability(capability, false);
+    }
+
+    static void depthFunc(GLenum func) {
+        if (depth_func_ == func) {
+            ++skipped_calls_;
+            return;
+        }
+        depth_func_ = func;
+        glDepthFunc(func);
+    }
+
+    static void blendFunc(GLenum source_factor, GLenum destination_factor) {
+        if (blend_source_factor_ == source_factor
+                && blend_destination_factor_ == destination_factor) {
+            ++skipped_calls_;
+            return;
+        }
+        blend_source_factor_ = source_factor;
+        blend_destination_factor_ = destination_factor;
+        glBlendFunc(source_factor, destination_factor);
+    }
+
+    static void blendEquation(GLenum mode) {
+        if (blend_equation_ == mode) {
+            ++skipped_calls_;
+            return;
+        }
+        blend_equation_ = mode;
+        glBlendEquation(mode);
+    }
+
+    static void cullFace(GLenum mode) {
+        if (cull_face_ == mode) {
+            ++skipped_calls_;
+            return;
+        }
+        cull_face_ = mode;
+        glCullFace(mode);
+    }
+
+    static void frontFace(GLenum mode) {
+        if (front_face_ == mode) {
+            ++skipped_calls_;
+            return;
+        }
+        front_face_ = mode;
+        glFrontFace(mode);
+    }
+
+    static void polygonOffset(GLfloat factor, GLfloat units) {
+        if (polygon_offset_valid_ && polygon_offset_factor_ == factor
+                && polygon_offset_units_ == units) {
+            ++skipped_calls_;
+            return;
+        }
+        polygon_offset_valid_ = true;
+        polygon_offset_factor_ = factor;
+        polygon_offset_units_ = units;
+        glPolygonOffset(factor, units);
+    }
+
+    static void sampleCoverage(GLfloat value, GLboolean invert) {
+        if (sample_coverage_valid_ && sample_coverage_value_ == value
+                && sample_coverage_invert_ == invert) {
+            ++skipped_calls_;
+            return;
+        }
+        sample_coverage_valid_ = true;
+        sample_coverage_value_ = value;
+        sample_coverage_invert_ = invert;
+        glSampleCoverage(value, invert);
+    }
+
+    static void useProgram(GLuint program) {
+        if (program_ == program) {
+            ++skipped_calls_;
+            return;
+        }
+        program_ = program;
+        glUseProgram(program);
+    }
+
+    static void bindVertexArray(GLuint vertex_array) {
+        if (vertex_array_ == vertex_array) {
+            ++skipped_calls_;
+            return;
+        }
+        vertex_array_ = vertex_array;
+        glBindVertexArray(vertex_array);
+    }
+
+    static void activeTexture(GLenum texture_unit) {
+        if (active_texture_ == texture_unit) {
+            ++skipped_calls_;
+            return;
+        }
+        active_texture_ = texture_unit;
+        glActiveTexture(texture_unit);
+    }
+
+    static void bindTexture(GLenum target, GLuint texture);
+
+    static void bindFramebuffer(GLenum target, GLuint framebuffer);
+
+    static void viewport(GLint x, GLint y, GLsizei width, GLsizei height) {
+        if (viewport_[0] == x && viewport_[1] == y && viewport_[2] == width
+                && viewport_[3] == height) {
+            ++skipped_calls_;
+            return;
+        }
+        viewport_[0] = x;
+        viewport_[1] = y;
+        viewport_[2] = width;
+        viewport_[3] = height;
+        glViewport(x, y, width, height);
+    }
+
+private:
+    GLState(const GLState& gl_state);
+    GLState(GLState&& gl_state);
+    GLState& operator=(const GLState& gl_state);
+    GLState& operator=(GLState&& gl_state);
+
+    static void setCapability(GLenum capability, bool enabled);
+
+private:
+    // a value no GL object or enum ever takes
+    static const GLuint UNKNOWN = 0xffffffff;
+    static const int TEXTURE_UNIT_COUNT = 16;
+    static const int TEXTURE_TARGET_COUNT = 3;
+
+    enum Capability {
+        DEPTH_TEST_CAPABILITY,
+        CULL_FACE_CAPABILITY,
+        BLEND_CAPABILITY,
+        POLYGON_OFFSET_FILL_CAPABILITY,
+        SAMPLE_COVERAGE_CAPABILITY,
+        CAPABILITY_COUNT
+    };
+
+    static int skipped_calls_;
+
+    // -1 unknown, 0 disabled, 1 enabled
+    static int capabilities_[CAPABILITY_COUNT];
+    static GLenum depth_func_;
+    static GLenum blend_source_factor_;
+    static GLenum blend_destination_factor_;
+    static GLenum blend_equation_;
+    static GLenum cull_face_;
+    static GLenum front_face_;
+    static bool polygon_offset_valid_;
+    static GLfloat polygon_offset_factor_;
+    static GLfloat polygon_offset_units_;
+    static bool sample_coverage_valid_;
+    static GLfloat sample_coverage_value_;
+    static GLboolean sample_coverage_invert_;
+    static GLuint program_;
+    static GLuint vertex_array_;
+    static GLenum active_texture_;
+    static GLuint textures_[TEXTURE_UNIT_COUNT][TEXTURE_TARGET_COUNT];
+    static bool textures_known_[TEXTURE_UNIT_COUNT][TEXTURE_TARGET_COUNT];
+    static GLuint draw_framebuffer_;
+    static GLuint read_framebuffer_;
+    static GLint viewport_[4];
+};
+
+}
+#endif
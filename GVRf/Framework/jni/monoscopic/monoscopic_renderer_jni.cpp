@@ -16,6 +16,7 @@
 #include "../engine/renderer/renderer.h"
 
 #include "util/gvr_jni.h"
+#include "util/gvr_profiler.h"
 
 namespace gvr {
 extern "C" {
@@ -58,6 +59,8 @@ void Java_org_gearvrf_NativeMonoscopicRenderer_cull(JNIEnv * env,
     Camera* camera = reinterpret_cast<Camera*>(jcamera);
     ShaderManager* shader_manager = reinterpret_cast<ShaderManager*>(jshader_manager);
 
+    // culling starts each frame
+    Profiler::beginFrame();
     Renderer::cull(scene, camera, shader_manager);
 }
 
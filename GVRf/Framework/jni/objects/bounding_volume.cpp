@@ -19,10 +19,21 @@
 
 #include "bounding_volume.h"
 
+#include <math.h>
+#include <limits>
+
 namespace gvr {
 
 BoundingVolume::BoundingVolume() {
+    reset();
+}
+
+/*
+ * make the volume empty again
+ */
+void BoundingVolume::reset() {
     center_ = glm::vec3(0.0f, 0.0f, 0.0f);
+    radius_ = 0.0f;
     min_corner_ = glm::vec3(
            std::numeric_limits<float>::infinity(), 
            std::numeric_limits<float>::infinity(), 
@@ -33,6 +44,11 @@ BoundingVolume::BoundingVolume() {
           -std::numeric_limits<float>::infinity());
 }
 
+bool BoundingVolume::is_empty() const {
+    return min_corner_[0] > max_corner_[0] || min_corner_[1] > max_corner_[1]
+            || min_corner_[2] > max_corner_[2];
+}
+
 /* 
  * expand the current volume by the given point
  */
@@ -58,61 +74,46 @@ void BoundingVolume::expand(const glm::vec3 point) {
     }
 
     center_ = (min_corner_ + max_corner_)*0.5f;
-    radius_ = (max_corner_ - center_).length();
+    radius_ = glm::length(max_corner_ - center_);
 }
 
 /* 
  * expand the volume by the incoming volume
  */
 void BoundingVolume::expand(const BoundingVolume &volume) {
-    const glm::vec3 in_center = volume.center();
-    float in_radius = volume.radius();
-
-    glm::vec3 v = in_center - center_;
-    float length = v.length();
-
-    // if the center is the same and incoming radius is
-    // bigger, use that.
-    if(length == 0 && in_radius > radius_) {
-        radius_ = in_radius;
-    } else if((length + in_radius) > radius_) {
-        // find the new center by taking the half-way point
-        // between the two outer ends of the two spheres.
-        // the radius is the distance between the two points
-        // divided by two.
-        glm::normalize(v);
-        glm::vec3 c1 = in_center + (v * in_radius);
-        glm::vec3 c0 = center_ - (v * radius_);
-        center_ = (c0 + c1) * 0.5f;
-        radius_ = (c1 - c0).length() * 0.5f;
+    if(volume.is_empty()) {
+        return;
+    }
+
+    expand(volume.min_corner());
+    expand(volume.max_corner());
+}
+
+/* 
+ * expand the volume by the incoming volume transformed by matrix.
+ * The transformed box is the axis aligned box around the oriented one:
+ *     center' = M * center
+ *     extent' = |M3x3| * extent
+ */
+void BoundingVolume::expand(const BoundingVolume &volume,
+        const glm::mat4 &matrix) {
+    if(volume.is_empty()) {
+        return;
+    }
+
+    glm::vec3 center = (volume.min_corner() + volume.max_corner()) * 0.5f;
+    glm::vec3 extent = (volume.max_corner() - volume.min_corner()) * 0.5f;
+
+    glm::vec3 transformed_center(matrix * glm::vec4(center, 1.0f));
+    glm::vec3 transformed_extent;
+    for(int i = 0; i < 3; i++) {
+        transformed_extent[i] = fabsf(matrix[0][i]) * extent[0]
+                + fabsf(matrix[1][i]) * extent[1]
+                + fabsf(matrix[2][i]) * extent[2];
     }
 
-    // define the bounding box inside the sphere
-    //       .. .. .. 
-    //     . -------/ .
-    //    . |     r/ | .
-    //    . |    /___| .
-    //    . |      s | .
-    //     .|________|.
-    //       .. .. ..
-    //
-    // for a sphere:
-    //             r = sqrt(s^2 + s^2 + s^2)
-    //           r^2 = s^2 + s^2 + s^2
-    //           r^2 = (s^2)*3
-    // sqrt((r^2)/3) = s
-    //
-    // r is radius_
-    // s is side of the triangle
-    //
-    float side = (float) sqrt(((radius_*radius_)/3.0f));
-    min_corner_ = glm::vec3(center_[0] - side,
-                            center_[1] - side,
-                            center_[2] - side);
-
-    max_corner_ = glm::vec3(center_[0] + side,
-                            center_[1] + side,
-                            center_[2] + side);
+    expand(transformed_center - transformed_extent);
+    expand(transformed_center + transformed_extent);
 }
 
 } // namespace
@@ -38,8 +38,13 @@ public:
     ~BoundingVolume() {
     }
 
+    void reset();
+    bool is_empty() const;
+
     void expand(const glm::vec3 point);
     void expand(const BoundingVolume &volume);
+    // expand by the axis aligned box around volume transformed by matrix
+    void expand(const BoundingVolume &volume, const glm::mat4 &matrix);
 
     const glm::vec3& center() const { return center_; }
     float radius() const { return radius_; }
@@ -60,4 +60,13 @@ glm::mat4 Camera::getCenterViewMatrix() {
     }
     return glm::affineInverse(owner_object()->parent()->transform()->getModelMatrix());
 }
+
+glm::vec3 Camera::getWorldPosition() {
+    if (owner_object() == 0) {
+        std::string error = "Camera::getWorldPosition() : camera not attached.";
+        LOGE("%s at %s:%d", error.c_str(), __FILE__, __LINE__);
+        throw error;
+    }
+    return glm::vec3(owner_object()->transform()->getModelMatrix()[3]);
+}
 }
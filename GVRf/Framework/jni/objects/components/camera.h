@@ -84,6 +84,7 @@ public:
     virtual glm::mat4 getProjectionMatrix() const = 0;
     glm::mat4 getViewMatrix();
     glm::mat4 getCenterViewMatrix();
+    glm::vec3 getWorldPosition();
 
 private:
     Camera(const Camera& camera);
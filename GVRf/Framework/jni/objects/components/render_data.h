@@ -26,6 +26,7 @@
 #include "gl/gl_program.h"
 #include "glm/glm.hpp"
 
+#include "objects/scene_object.h"
 #include "objects/components/component.h"
 #include "objects/render_pass.h"
 
@@ -53,7 +54,9 @@ public:
                     DEFAULT_RENDER_MASK), rendering_order_(
                     DEFAULT_RENDERING_ORDER), offset_(false), offset_factor_(
                     0.0f), offset_units_(0.0f), depth_test_(true), alpha_blend_(
-                    true), draw_mode_(GL_TRIANGLES) {
+                    true), draw_mode_(GL_TRIANGLES), camera_distance_(0.0f), left_eye_distance_(
+                    0.0f), right_eye_distance_(0.0f), lod_coverage_(1.0f), lod_coverage_invert_(
+                    false), render_list_index_(-1) {
     }
 
     ~RenderData() {
@@ -66,10 +69,17 @@ public:
 
     void set_mesh(Mesh* mesh) {
         mesh_ = mesh;
+        if (owner_object()) {
+            owner_object()->dirtyBoundingVolume();
+            owner_object()->dirtyStaticBatch();
+        }
     }
 
     void add_pass(RenderPass* render_pass) {
         render_pass_list_.push_back(render_pass);
+        if (owner_object()) {
+            owner_object()->dirtyStaticBatch();
+        }
     }
 
     const RenderPass* pass(int pass) const {
@@ -201,6 +211,46 @@ public:
         return camera_distance_;
     }
 
+    // camera distances of each eye after a combined cull of both eyes
+    void set_eye_distances(float left_eye_distance, float right_eye_distance) {
+        left_eye_distance_ = left_eye_distance;
+        right_eye_distance_ = right_eye_distance;
+    }
+
+    float left_eye_distance() const {
+        return left_eye_distance_;
+    }
+
+    float right_eye_distance() const {
+        return right_eye_distance_;
+    }
+
+    // The share of samples drawn while a LOD level fades in or out, 1 when
+    // not fading. Inverted coverage draws the complementary samples, so two
+    // levels fading into each other never cover the same sample.
+    void set_lod_coverage(float lod_coverage, bool invert) {
+        lod_coverage_ = lod_coverage;
+        lod_coverage_invert_ = invert;
+    }
+
+    float lod_coverage() const {
+        return lod_coverage_;
+    }
+
+    bool lod_coverage_invert() const {
+        return lod_coverage_invert_;
+    }
+
+    // the slot of this render data in the render list of its scene, -1 if
+    // it has not been in one yet
+    int render_list_index() const {
+        return render_list_index_;
+    }
+
+    void set_render_list_index(int render_list_index) {
+        render_list_index_ = render_list_index;
+    }
+
 
     void set_draw_mode(GLenum draw_mode) {
         draw_mode_ = draw_mode;
@@ -228,36 +278,12 @@ private:
     bool alpha_blend_;
     GLenum draw_mode_;
     float camera_distance_;
+    float left_eye_distance_;
+    float right_eye_distance_;
+    float lod_coverage_;
+    bool lod_coverage_invert_;
+    int render_list_index_;
 };
 
-inline bool compareRenderData(RenderData* i, RenderData* j) {
-    // if it is a transparent object, sort by camera distance.
-    if(i->rendering_order() == j->rendering_order() &&
-       i->rendering_order() >= RenderData::Transparent &&
-       i->rendering_order() < RenderData::Overlay) {
-        return i->camera_distance() > j->camera_distance();
-    }
-
-    return i->rendering_order() < j->rendering_order();
-}
-
-inline bool compareRenderDataWithFrustumCulling(RenderData* i, RenderData* j) {
-    // if either i or j is a transparent object or an overlay object
-    if (i->rendering_order() >= RenderData::Transparent
-            || j->rendering_order() >= RenderData::Transparent) {
-        if (i->rendering_order() == j->rendering_order()) {
-            // if both are either transparent or both are overlays
-            // place them in reverse camera order from back to front
-            return i->camera_distance() < j->camera_distance();
-        } else {
-            // if one of them is a transparent or an overlay draw by rendering order
-            return i->rendering_order() < j->rendering_order();
-        }
-    }
-
-    // if both are neither transparent nor overlays, place them in camera order front to back
-    return i->camera_distance() > j->camera_distance();
-}
-
 }
 #endif
@@ -20,20 +20,20 @@
 #ifndef LIGHT_H_
 #define LIGHT_H_
 
-#include <map>
 #include <memory>
 #include <string>
 
 #include "glm/glm.hpp"
 
 #include "objects/hybrid_object.h"
+#include "objects/property_block.h"
 
 namespace gvr {
 class Color;
 
 class Light: public HybridObject {
 public:
-    explicit Light() : enabled_(true) {
+    explicit Light() : enabled_(true), properties_("Light") {
     }
 
     ~Light() {
@@ -51,45 +51,44 @@ public:
         enabled_ = false;
     }
 
-    float getFloat(std::string key) {
-        auto it = floats_.find(key);
-        if (it != floats_.end()) {
-            return it->second;
-        } else {
-            std::string error = "Light::getFloat() : " + key + " not found";
-            throw error;
-        }
+    const PropertyBlock& properties() const {
+        return properties_;
     }
-    void setFloat(std::string key, float value) {
-        floats_[key] = value;
+
+    bool getFloat(int id, float& value) const {
+        return properties_.getFloat(id, value);
+    }
+
+    float getFloat(const std::string& key) const {
+        return properties_.getFloat(key);
+    }
+
+    void setFloat(const std::string& key, float value) {
+        properties_.setFloat(PropertyBlock::id(key), value);
+    }
+
+    bool getVec3(int id, glm::vec3& vector) const {
+        return properties_.getVec3(id, vector);
+    }
+
+    glm::vec3 getVec3(const std::string& key) const {
+        return properties_.getVec3(key);
     }
 
-    glm::vec3 getVec3(std::string key) {
-        auto it = vec3s_.find(key);
-        if (it != vec3s_.end()) {
-            return it->second;
-        } else {
-            std::string error = "Light::getVec3() : " + key + " not found";
-            throw error;
-        }
+    void setVec3(const std::string& key, glm::vec3 vector) {
+        properties_.setVec3(PropertyBlock::id(key), vector);
     }
 
-    void setVec3(std::string key, glm::vec3 vector) {
-        vec3s_[key] = vector;
+    bool getVec4(int id, glm::vec4& vector) const {
+        return properties_.getVec4(id, vector);
     }
 
-    glm::vec4 getVec4(std::string key) {
-        auto it = vec4s_.find(key);
-        if (it != vec4s_.end()) {
-            return it->second;
-        } else {
-            std::string error = "Light::getVec4() : " + key + " not found";
-            throw error;
-        }
+    glm::vec4 getVec4(const std::string& key) const {
+        return properties_.getVec4(key);
     }
 
-    void setVec4(std::string key, glm::vec4 vector) {
-        vec4s_[key] = vector;
+    void setVec4(const std::string& key, glm::vec4 vector) {
+        properties_.setVec4(PropertyBlock::id(key), vector);
     }
 
 private:
@@ -100,9 +99,7 @@ private:
 
 private:
     bool enabled_;
-    std::map<std::string, float> floats_;
-    std::map<std::string, glm::vec3> vec3s_;
-    std::map<std::string, glm::vec4> vec4s_;
+    PropertyBlock properties_;
 };
 }
 #endif
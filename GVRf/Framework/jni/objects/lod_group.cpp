@@ -0,0 +1,124 @@
+/* Copyright 2015 Samsung Electronics Co., LTD
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/***************************************************************************
+ * Levels of detail picked by their size on screen.
+ ***************************************************************************/
+
+#include "lod_group.h"
+
+namespace gvr {
+
+void LODGroup::addLevel(SceneObject* scene_object, float min_screen_size) {
+    for (auto it = levels_.begin(); it != levels_.end(); ++it) {
+        if (it->scene_object == scene_object) {
+            levels_.erase(it);
+            break;
+        }
+    }
+
+    auto it = levels_.begin();
+    while (it != levels_.end() && it->min_screen_size >= min_screen_size) {
+        ++it;
+    }
+    Level level;
+    level.scene_object = scene_object;
+    level.min_screen_size = min_screen_size;
+    levels_.insert(it, level);
+
+    // the indices changed, so pick again without fading
+    current_level_ = -1;
+    previous_level_ = -1;
+}
+
+void LODGroup::clearLevels() {
+    levels_.clear();
+    current_level_ = -1;
+    previous_level_ = -1;
+}
+
+/*
+ * The first selection takes the level the size falls in. From then on the
+ * group only moves to a finer level once the size is above that level's
+ * minimum by the hysteresis, and to a coarser one once it is below the
+ * current minimum by the hysteresis.
+ */
+void LODGroup::select(float screen_size, unsigned int frame) {
+    int level_count = levels_.size();
+    if (level_count == 0) {
+        return;
+    }
+
+    int level = current_level_;
+    if (level < 0) {
+        level = 0;
+        while (level < level_count
+                && screen_size < levels_[level].min_screen_size) {
+            ++level;
+        }
+    } else {
+        while (level > 0
+                && screen_size
+                        >= levels_[level - 1].min_screen_size
+                                * (1.0f + hysteresis_)) {
+            --level;
+        }
+        while (level < level_count
+                && screen_size
+                        < levels_[level].min_screen_size * (1.0f - hysteresis_)) {
+            ++level;
+        }
+    }
+
+    if (current_level_ >= 0 && level != current_level_ && fade_frames_ > 0) {
+        previous_level_ = current_level_;
+        fade_start_frame_ = frame;
+    }
+    current_level_ = level;
+
+    if (previous_level_ >= 0) {
+        unsigned int elapsed = frame - fade_start_frame_ + 1;
+        if (elapsed > static_cast<unsigned int>(fade_frames_)) {
+            previous_level_ = -1;
+            fade_coverage_ = 1.0f;
+        } else {
+            fade_coverage_ = static_cast<float>(elapsed) / (fade_frames_ + 1);
+        }
+    }
+}
+
+float LODGroup::coverage(const SceneObject* scene_object, bool& invert) const {
+    invert = false;
+    int index = 0;
+    int level_count = levels_.size();
+    while (index < level_count && levels_[index].scene_object != scene_object) {
+        ++index;
+    }
+    if (index == level_count) {
+        return 1.0f;
+    }
+
+    if (index == current_level_) {
+        return previous_level_ >= 0 ? fade_coverage_ : 1.0f;
+    }
+    // the same share, inverted, is exactly the samples the new level leaves
+    if (index == previous_level_) {
+        invert = true;
+        return fade_coverage_;
+    }
+    return 0.0f;
+}
+
+}
@@ -0,0 +1,110 @@
+/* Copyright 2015 Samsung Electronics Co., LTD
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/***************************************************************************
+ * Levels of detail picked by their size on screen.
+ ***************************************************************************/
+
+#ifndef LOD_GROUP_H_
+#define LOD_GROUP_H_
+
+#include <vector>
+
+namespace gvr {
+class SceneObject;
+
+/*
+ * The levels of detail of a scene object: the scene object itself or its
+ * direct children, each shown while the bounds of the group cover at least
+ * its minimum size on screen, in pixels. Exactly one level is shown at a
+ * time, or none once the group is smaller than every minimum.
+ *
+ * A level is only left once the size is past its bounds by the hysteresis,
+ * a fraction of the bound, so a group at about a bound does not switch back
+ * and forth. With fade frames, the level left is faded out while the new
+ * one fades in, each covering the samples the other does not.
+ */
+class LODGroup {
+public:
+    LODGroup() :
+            levels_(), hysteresis_(0.1f), fade_frames_(0), current_level_(
+                    -1), previous_level_(-1), fade_start_frame_(0), fade_coverage_(
+                    1.0f) {
+    }
+
+    ~LODGroup() {
+    }
+
+    // levels are kept from the largest minimum size to the smallest
+    void addLevel(SceneObject* scene_object, float min_screen_size);
+    void clearLevels();
+
+    int level_count() const {
+        return levels_.size();
+    }
+
+    float hysteresis() const {
+        return hysteresis_;
+    }
+
+    void set_hysteresis(float hysteresis) {
+        hysteresis_ = hysteresis;
+    }
+
+    int fade_frames() const {
+        return fade_frames_;
+    }
+
+    void set_fade_frames(int fade_frames) {
+        fade_frames_ = fade_frames;
+    }
+
+    // the level shown, level_count() if none
+    int current_level() const {
+        return current_level_;
+    }
+
+    // Picks the level for the size of the group on screen, in pixels, in
+    // the given cull frame. Called once per cull of the group.
+    void select(float screen_size, unsigned int frame);
+
+    // The share of samples the scene object is drawn with: 0 if it is a
+    // level that is not shown, 1 if it is not a level or is shown alone.
+    float coverage(const SceneObject* scene_object, bool& invert) const;
+
+private:
+    LODGroup(const LODGroup& lod_group);
+    LODGroup(LODGroup&& lod_group);
+    LODGroup& operator=(const LODGroup& lod_group);
+    LODGroup& operator=(LODGroup&& lod_group);
+
+    struct Level {
+        SceneObject* scene_object;
+        float min_screen_size;
+    };
+
+private:
+    std::vector<Level> levels_;
+    float hysteresis_;
+    int fade_frames_;
+    int current_level_;
+    // the level fading out, -1 if none
+    int previous_level_;
+    unsigned int fade_start_frame_;
+    float fade_coverage_;
+};
+
+}
+#endif
@@ -20,13 +20,13 @@
 #ifndef MATERIAL_H_
 #define MATERIAL_H_
 
-#include <map>
 #include <memory>
 #include <string>
 
 #include "glm/glm.hpp"
 
 #include "objects/hybrid_object.h"
+#include "objects/property_block.h"
 #include "objects/textures/texture.h"
 
 namespace gvr {
@@ -49,12 +49,13 @@ public:
     };
 
     explicit Material(ShaderType shader_type) :
-            shader_type_(shader_type), textures_(), floats_(), vec2s_(), vec3s_(), vec4s_(), shader_feature_set_(
+            shader_type_(shader_type), properties_("Material"), main_texture_(), shader_feature_set_(
                     0) {
         switch (shader_type) {
         default:
-            vec3s_["color"] = glm::vec3(1.0f, 1.0f, 1.0f);
-            floats_["opacity"] = 1.0f;
+            properties_.setVec3(PropertyBlock::COLOR,
+                    glm::vec3(1.0f, 1.0f, 1.0f));
+            properties_.setFloat(PropertyBlock::OPACITY, 1.0f);
             break;
         }
     }
@@ -70,88 +71,96 @@ public:
         shader_type_ = shader_type;
     }
 
-    Texture* getTexture(std::string key) const {
-        auto it = textures_.find(key);
-        if (it != textures_.end()) {
-            return it->second;
-        } else {
-            std::string error = "Material::getTexture() : " + key
-                    + " not found";
-            throw error;
-        }
+    // the shaders use the ids, resolved once; the names are for Java
+    const PropertyBlock& properties() const {
+        return properties_;
     }
 
-    void setTexture(std::string key, Texture* texture) {
-        textures_[key] = texture;
+    // changes whenever a property is set
+    unsigned int version() const {
+        return properties_.version();
     }
 
-    float getFloat(std::string key) {
-        auto it = floats_.find(key);
-        if (it != floats_.end()) {
-            return it->second;
-        } else {
-            std::string error = "Material::getFloat() : " + key + " not found";
-            throw error;
-        }
+    // null if not set
+    Texture* getTexture(int id) const {
+        return properties_.findTexture(id);
     }
-    void setFloat(std::string key, float value) {
-        floats_[key] = value;
+
+    Texture* getTexture(const std::string& key) const {
+        return properties_.getTexture(key);
     }
 
-    glm::vec2 getVec2(std::string key) {
-        auto it = vec2s_.find(key);
-        if (it != vec2s_.end()) {
-            return it->second;
-        } else {
-            std::string error = "Material::getVec2() : " + key + " not found";
-            throw error;
+    void setTexture(const std::string& key, Texture* texture) {
+        int id = PropertyBlock::id(key);
+        properties_.setTexture(id, texture);
+        if (id == PropertyBlock::MAIN_TEXTURE) {
+            main_texture_ = texture;
         }
     }
 
-    void setVec2(std::string key, glm::vec2 vector) {
-        vec2s_[key] = vector;
+    // kept aside for the render sort, which can't afford even the id lookup
+    Texture* main_texture() const {
+        return main_texture_;
     }
 
-    glm::vec3 getVec3(std::string key) {
-        auto it = vec3s_.find(key);
-        if (it != vec3s_.end()) {
-            return it->second;
-        } else {
-            std::string error = "Material::getVec3() : " + key + " not found";
-            throw error;
-        }
+    bool getFloat(int id, float& value) const {
+        return properties_.getFloat(id, value);
     }
 
-    void setVec3(std::string key, glm::vec3 vector) {
-        vec3s_[key] = vector;
+    float getFloat(const std::string& key) const {
+        return properties_.getFloat(key);
     }
 
-    glm::vec4 getVec4(std::string key) {
-        auto it = vec4s_.find(key);
-        if (it != vec4s_.end()) {
-            return it->second;
-        } else {
-            std::string error = "Material::getVec4() : " + key + " not found";
-            throw error;
-        }
+    void setFloat(const std::string& key, float value) {
+        properties_.setFloat(PropertyBlock::id(key), value);
     }
 
-    void setVec4(std::string key, glm::vec4 vector) {
-        vec4s_[key] = vector;
+    bool getVec2(int id, glm::vec2& vector) const {
+        return properties_.getVec2(id, vector);
     }
 
-    glm::mat4 getMat4(std::string key) {
-        auto it = mat4s_.find(key);
-        if (it != mat4s_.end()) {
-            return it->second;
-        } else {
-            std::string error = "Material::getMat4() : " + key + " not found";
-            throw error;
-        }
+    glm::vec2 getVec2(const std::string& key) const {
+        return properties_.getVec2(key);
+    }
+
+    void setVec2(const std::string& key, glm::vec2 vector) {
+        properties_.setVec2(PropertyBlock::id(key), vector);
+    }
+
+    bool getVec3(int id, glm::vec3& vector) const {
+        return properties_.getVec3(id, vector);
+    }
+
+    glm::vec3 getVec3(const std::string& key) const {
+        return properties_.getVec3(key);
+    }
+
+    void setVec3(const std::string& key, glm::vec3 vector) {
+        properties_.setVec3(PropertyBlock::id(key), vector);
+    }
+
+    bool getVec4(int id, glm::vec4& vector) const {
+        return properties_.getVec4(id, vector);
+    }
+
+    glm::vec4 getVec4(const std::string& key) const {
+        return properties_.getVec4(key);
+    }
+
+    void setVec4(const std::string& key, glm::vec4 vector) {
+        properties_.setVec4(PropertyBlock::id(key), vector);
+    }
+
+    bool getMat4(int id, glm::mat4& matrix) const {
+        return properties_.getMat4(id, matrix);
+    }
+
+    glm::mat4 getMat4(const std::string& key) const {
+        return properties_.getMat4(key);
     }
 
-    void setMat4(std::string key, glm::mat4 matrix) {
-        mat4s_[key] = matrix;
+    void setMat4(const std::string& key, glm::mat4 matrix) {
+        properties_.setMat4(PropertyBlock::id(key), matrix);
     }
 
     int get_shader_feature_set() {
@@ -170,12 +179,8 @@ private:
 
 private:
     ShaderType shader_type_;
-    std::map<std::string, Texture*> textures_;
-    std::map<std::string, float> floats_;
-    std::map<std::string, glm::vec2> vec2s_;
-    std::map<std::string, glm::vec3> vec3s_;
-    std::map<std::string, glm::vec4> vec4s_;
-    std::map<std::string, glm::mat4> mat4s_;
+    PropertyBlock properties_;
+    Texture* main_texture_;
     unsigned int shader_feature_set_;
 };
 }
@@ -19,17 +19,25 @@
 
 #include "mesh.h"
 
+#include <algorithm>
+#include <cmath>
+#include <cstring>
 #include <limits>
 
 #include "assimp/Importer.hpp"
 #include "assimp/mesh.h"
 #include "assimp/postprocess.h"
 #include "assimp/scene.h"
+#include "gl/gl_state.h"
 #include "util/gvr_log.h"
 #include "util/gvr_gl.h"
 #include "glm/gtc/matrix_inverse.hpp"
+#include "glm/gtc/packing.hpp"
+#include "glm/gtc/type_ptr.hpp"
 
 namespace gvr {
+std::atomic<unsigned int> Mesh::bounding_volume_epoch_(0);
+
 Mesh* Mesh::getBoundingBox() {
 
     Mesh* mesh = new Mesh();
@@ -100,12 +108,168 @@ Mesh* Mesh::getBoundingBox() {
     return mesh;
 }
 
+template<class T>
+static void copySubset(const std::vector<T>& source,
+        const std::vector<unsigned short>& vertex_order,
+        std::vector<T>& destination) {
+    destination.reserve(vertex_order.size());
+    for (auto it = vertex_order.begin(); it != vertex_order.end(); ++it) {
+        destination.push_back(source[*it]);
+    }
+}
+
+Mesh* Mesh::createSubset(const std::vector<unsigned short>& triangles) const {
+    // the vertices used, in order of first use
+    std::vector<int> vertex_map(vertices_.size(), -1);
+    std::vector<unsigned short> vertex_order;
+    std::vector<unsigned short> subset_triangles;
+    subset_triangles.reserve(triangles.size());
+    for (auto it = triangles.begin(); it != triangles.end(); ++it) {
+        int& index = vertex_map[*it];
+        if (index < 0) {
+            index = vertex_order.size();
+            vertex_order.push_back(*it);
+        }
+        subset_triangles.push_back(index);
+    }
+
+    Mesh* mesh = new Mesh();
+    std::vector<glm::vec3> vertices;
+    copySubset(vertices_, vertex_order, vertices);
+    mesh->set_vertices(std::move(vertices));
+    if (normals_.size() == vertices_.size()) {
+        copySubset(normals_, vertex_order, mesh->normals_);
+    }
+    if (tex_coords_.size() == vertices_.size()) {
+        std::vector<glm::vec2> tex_coords;
+        copySubset(tex_coords_, vertex_order, tex_coords);
+        mesh->set_tex_coords(std::move(tex_coords));
+    }
+    mesh->set_triangles(std::move(subset_triangles));
+
+    for (auto it = float_vectors_.begin(); it != float_vectors_.end(); ++it) {
+        if (it->second.size() == vertices_.size()) {
+            copySubset(it->second, vertex_order,
+                    mesh->float_vectors_[it->first]);
+        }
+    }
+    for (auto it = vec2_vectors_.begin(); it != vec2_vectors_.end(); ++it) {
+        if (it->second.size() == vertices_.size()) {
+            copySubset(it->second, vertex_order,
+                    mesh->vec2_vectors_[it->first]);
+        }
+    }
+    for (auto it = vec3_vectors_.begin(); it != vec3_vectors_.end(); ++it) {
+        if (it->second.size() == vertices_.size()) {
+            copySubset(it->second, vertex_order,
+                    mesh->vec3_vectors_[it->first]);
+        }
+    }
+    for (auto it = vec4_vectors_.begin(); it != vec4_vectors_.end(); ++it) {
+        if (it->second.size() == vertices_.size()) {
+            copySubset(it->second, vertex_order,
+                    mesh->vec4_vectors_[it->first]);
+        }
+    }
+
+    return mesh;
+}
+
+template<class T>
+static void updateRange(std::vector<T>& vector, int first, const T* data,
+        int count, const char* caller) {
+    if (first < 0 || count < 0
+            || static_cast<size_t>(first + count) > vector.size()) {
+        std::string error = std::string("Mesh::") + caller
+                + "() : range out of bounds";
+        throw error;
+    }
+    std::copy(data, data + count, vector.begin() + first);
+}
+
+void Mesh::updateVertices(int first, const glm::vec3* vertices, int count) {
+    updateRange(vertices_, first, vertices, count, "updateVertices");
+    verticesChanged(true, first, count);
+    dirtyBoundingVolume();
+    getBoundingVolume();
+}
+
+void Mesh::updateNormals(int first, const glm::vec3* normals, int count) {
+    updateRange(normals_, first, normals, count, "updateNormals");
+    verticesChanged(true, first, count);
+}
+
+void Mesh::updateTexCoords(int first, const glm::vec2* tex_coords,
+        int count) {
+    updateRange(tex_coords_, first, tex_coords, count, "updateTexCoords");
+    verticesChanged(true, first, count);
+}
+
+template<class T>
+static void reorderVector(std::vector<T>& vector,
+        const std::vector<unsigned short>& vertex_order) {
+    std::vector<T> reordered;
+    copySubset(vector, vertex_order, reordered);
+    vector.swap(reordered);
+}
+
+template<class T>
+static void reorderVectors(std::map<std::string, std::vector<T>>& vectors,
+        const std::vector<unsigned short>& vertex_order) {
+    for (auto it = vectors.begin(); it != vectors.end(); ++it) {
+        if (it->second.size() == vertex_order.size()) {
+            reorderVector(it->second, vertex_order);
+        }
+    }
+}
+
+void Mesh::reorderVertices() {
+    int vertex_count = vertices_.size();
+    for (auto it = triangles_.begin(); it != triangles_.end(); ++it) {
+        if (*it >= vertex_count) {
+            return;
+        }
+    }
+
+    std::vector<int> vertex_map(vertex_count, -1);
+    std::vector<unsigned short> vertex_order;
+    vertex_order.reserve(vertex_count);
+    for (auto it = triangles_.begin(); it != triangles_.end(); ++it) {
+        int& index = vertex_map[*it];
+        if (index < 0) {
+            index = vertex_order.size();
+            vertex_order.push_back(*it);
+        }
+        *it = index;
+    }
+    for (int i = 0; i < vertex_count; ++i) {
+        if (vertex_map[i] < 0) {
+            vertex_map[i] = vertex_order.size();
+            vertex_order.push_back(i);
+        }
+    }
+
+    reorderVector(vertices_, vertex_order);
+    if (normals_.size() == vertices_.size()) {
+        reorderVector(normals_, vertex_order);
+    }
+    if (tex_coords_.size() == vertices_.size()) {
+        reorderVector(tex_coords_, vertex_order);
+    }
+    reorderVectors(float_vectors_, vertex_order);
+    reorderVectors(vec2_vectors_, vertex_order);
+    reorderVectors(vec3_vectors_, vertex_order);
+    reorderVectors(vec4_vectors_, vertex_order);
+    vao_dirty_ = true;
+}
+
 // an array of size:6 with Xmin, Ymin, Zmin and Xmax, Ymax, Zmax values
 const BoundingVolume& Mesh::getBoundingVolume() {
     if (have_bounding_volume_) {
         return bounding_volume;
     }
 
+    bounding_volume.reset();
     for (auto it = vertices_.begin(); it != vertices_.end(); ++it) {
         bounding_volume.expand(*it);
     }
@@ -176,117 +340,569 @@ void Mesh::getTransformedBoundingBoxInfo(glm::mat4 *Mat,
     }
 }
 
-// generate vertex array object
-void Mesh::generateVAO() {
-#if _GVRF_USE_GLES3_
-
-    if (vaoInitiliased_)
-        return;
-    GLuint tmpID;
-
+GLuint Mesh::getVAOId(const AttributeLayout& layout) {
     if (vao_dirty_) {
-         deleteVaos();
+        // what only the old buffers hold is read back before they go
+        readBack();
+        releaseBuffers();
+        uploadBuffers();
+    } else if (dirty_begin_ < dirty_end_ || triangles_dirty_
+            || !dirty_attributes_.empty()) {
+        updateBuffers();
     }
 
-    if (vertices_.size() == 0 && normals_.size() == 0
-            && tex_coords_.size() == 0) {
-        std::string error = "no vertex data yet, shouldn't call here. ";
-        throw error;
-        return;
+    auto it = vaoIDs_.find(layout);
+    if (it != vaoIDs_.end()) {
+        return it->second;
     }
 
-    glGenVertexArrays(1, &vaoID_);
-    glBindVertexArray(vaoID_);
+    GLuint vaoID;
+    glGenVertexArrays(1, &vaoID);
+    GLState::bindVertexArray(vaoID);
 
-    glGenBuffers(1, &triangle_vboID_);
     glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, triangle_vboID_);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER,
-            sizeof(unsigned short) * triangles_.size(), &triangles_[0],
-            GL_STATIC_DRAW);
-    numTriangles_ = triangles_.size() / 3;
 
-    if (vertices_.size()) {
-        glGenBuffers(1, &vert_vboID_);
-        glBindBuffer(GL_ARRAY_BUFFER, vert_vboID_);
-        glBufferData(GL_ARRAY_BUFFER, sizeof(glm::vec3) * vertices_.size(),
-                &vertices_[0], GL_STATIC_DRAW);
-        GLuint vertexLoc = GLProgram::POSITION_ATTRIBUTE_LOCATION;
-        glEnableVertexAttribArray(vertexLoc);
-        glVertexAttribPointer(vertexLoc, 3, GL_FLOAT, 0, 0, 0);
-    }
-
-    if (normals_.size()) {
-        glGenBuffers(1, &norm_vboID_);
-        glBindBuffer(GL_ARRAY_BUFFER, norm_vboID_);
-        glBufferData(GL_ARRAY_BUFFER, sizeof(glm::vec3) * normals_.size(),
-                &normals_[0], GL_STATIC_DRAW);
+    glBindBuffer(GL_ARRAY_BUFFER, vertex_vboID_);
+
+    // half float positions carry w, so a vec4 a_position still gets 1
+    GLuint vertexLoc = GLProgram::POSITION_ATTRIBUTE_LOCATION;
+    glEnableVertexAttribArray(vertexLoc);
+    glVertexAttribPointer(vertexLoc, position_type_ == GL_HALF_FLOAT ? 4 : 3,
+            position_type_, GL_FALSE, vertex_stride_, 0);
+
+    if (normal_type_ != 0) {
         GLuint normalLoc = GLProgram::NORMAL_ATTRIBUTE_LOCATION;
         glEnableVertexAttribArray(normalLoc);
-        glVertexAttribPointer(normalLoc, 3, GL_FLOAT, 0, 0, 0);
+        if (normal_type_ == GL_INT_2_10_10_10_REV) {
+            glVertexAttribPointer(normalLoc, 4, normal_type_, GL_TRUE,
+                    vertex_stride_,
+                    reinterpret_cast<const GLvoid*>(normal_offset_));
+        } else {
+            glVertexAttribPointer(normalLoc, 3, normal_type_, GL_FALSE,
+                    vertex_stride_,
+                    reinterpret_cast<const GLvoid*>(normal_offset_));
+        }
     }
 
-    if (tex_coords_.size()) {
-        glGenBuffers(1, &tex_vboID_);
-        glBindBuffer(GL_ARRAY_BUFFER, tex_vboID_);
-        glBufferData(GL_ARRAY_BUFFER, sizeof(glm::vec2) * tex_coords_.size(),
-                &tex_coords_[0], GL_STATIC_DRAW);
+    if (tex_coord_type_ != 0) {
         GLuint texCoordLoc = GLProgram::TEXCOORD_ATTRIBUT_LOCATION;
         glEnableVertexAttribArray(texCoordLoc);
-        glVertexAttribPointer(texCoordLoc, 2, GL_FLOAT, 0, 0, 0);
-    }
-
-    for (auto it = attribute_float_keys_.begin();
-            it != attribute_float_keys_.end(); ++it) {
-        glGenBuffers(1, &tmpID);
-        glBindBuffer(GL_ARRAY_BUFFER, tmpID);
-        glBufferData(GL_ARRAY_BUFFER,
-                sizeof(GLfloat) * getFloatVector(it->second).size(),
-                getFloatVector(it->second).data(), GL_STATIC_DRAW);
-        glEnableVertexAttribArray(it->first);
-        glVertexAttribPointer(it->first, 1, GL_FLOAT, 0, 0, 0);
-    }
-
-    for (auto it = attribute_vec2_keys_.begin();
-            it != attribute_vec2_keys_.end(); ++it) {
-        glGenBuffers(1, &tmpID);
-        glBindBuffer(GL_ARRAY_BUFFER, tmpID);
-        glBufferData(GL_ARRAY_BUFFER,
-                sizeof(glm::vec2) * getVec2Vector(it->second).size(),
-                getVec2Vector(it->second).data(), GL_STATIC_DRAW);
-        glEnableVertexAttribArray(it->first);
-        glVertexAttribPointer(it->first, 2, GL_FLOAT, 0, 0, 0);
-    }
-
-    for (auto it = attribute_vec3_keys_.begin();
-            it != attribute_vec3_keys_.end(); ++it) {
-        glGenBuffers(1, &tmpID);
-        glBindBuffer(GL_ARRAY_BUFFER, tmpID);
-        glBufferData(GL_ARRAY_BUFFER,
-                sizeof(glm::vec3) * getVec3Vector(it->second).size(),
-                getVec3Vector(it->second).data(), GL_STATIC_DRAW);
-        glEnableVertexAttribArray(it->first);
-        glVertexAttribPointer(it->first, 3, GL_FLOAT, 0, 0, 0);
-    }
-
-    for (auto it = attribute_vec4_keys_.begin();
-            it != attribute_vec4_keys_.end(); ++it) {
-        glGenBuffers(1, &tmpID);
-        glBindBuffer(GL_ARRAY_BUFFER, tmpID);
-        glBufferData(GL_ARRAY_BUFFER,
-                sizeof(glm::vec4) * getVec4Vector(it->second).size(),
-                getVec4Vector(it->second).data(), GL_STATIC_DRAW);
-        glEnableVertexAttribArray(it->first);
-        glVertexAttribPointer(it->first, 4, GL_FLOAT, 0, 0, 0);
+        glVertexAttribPointer(texCoordLoc, 2, tex_coord_type_,
+                tex_coord_type_ == GL_UNSIGNED_SHORT, vertex_stride_,
+                reinterpret_cast<const GLvoid*>(tex_coord_offset_));
+    }
+
+    for (auto it = layout.begin(); it != layout.end(); ++it) {
+        glBindBuffer(GL_ARRAY_BUFFER, getAttributeBuffer(*it));
+        glEnableVertexAttribArray(it->location);
+        glVertexAttribPointer(it->location, it->size, GL_FLOAT, 0, 0, 0);
     }
 
     // done generation
-    glBindVertexArray(0);
+    GLState::bindVertexArray(0);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+
+    vaoIDs_[layout] = vaoID;
+    return vaoID;
+}
+
+template<class T>
+static GLuint createBuffer(GLenum target, const std::vector<T>& data,
+        GLenum usage) {
+    GLuint id;
+    glGenBuffers(1, &id);
+    glBindBuffer(target, id);
+    glBufferData(target, sizeof(T) * data.size(), data.data(), usage);
+    return id;
+}
+
+/*
+ * Half floats have an 11-bit significand, so positions lose up to 1/2048 of
+ * their largest coordinate. That is taken as invisible when the largest
+ * coordinate is within twice the bounding radius, i.e. when the mesh sits
+ * about on its origin; meshes placed far out in their own space keep
+ * floats, or the error would be large next to their size.
+ */
+void Mesh::chooseVertexTypes() {
+    int vertex_count = vertices_.size();
+    bool packed = vertex_format_ == VERTEX_FORMAT_PACKED;
+    // the data of dynamic meshes may not fit tomorrow what it fits today
+    bool automatic = vertex_format_ == VERTEX_FORMAT_AUTO
+            && buffer_usage_ == BUFFER_USAGE_STATIC;
+
+    position_type_ = GL_FLOAT;
+    if (packed || automatic) {
+        float max_coordinate = 0.0f;
+        for (auto it = vertices_.begin(); it != vertices_.end(); ++it) {
+            max_coordinate = std::max(max_coordinate,
+                    std::max(std::fabs(it->x),
+                            std::max(std::fabs(it->y), std::fabs(it->z))));
+        }
+        // half floats keep 11 significant bits, so rounding is off by up to
+        // 2^-11 of the largest coordinate; the relative test alone would
+        // let a model hundreds of meters across be off by decimeters
+        float radius = getBoundingVolume().radius();
+        float max_error = max_coordinate / 2048.0f;
+        if (max_coordinate < 65504.0f
+                && (packed
+                        || (max_coordinate <= 2.0f * radius
+                                && max_error <= position_tolerance_))) {
+            position_type_ = GL_HALF_FLOAT;
+        }
+    }
+
+    normal_type_ = 0;
+    if (normals_.size() == vertices_.size() && vertex_count > 0) {
+        normal_type_ = packed ? GL_INT_2_10_10_10_REV : GL_FLOAT;
+        if (automatic) {
+            normal_type_ = GL_INT_2_10_10_10_REV;
+            for (auto it = normals_.begin(); it != normals_.end(); ++it) {
+                if (std::fabs(glm::dot(*it, *it) - 1.0f) > 0.01f) {
+                    normal_type_ = GL_FLOAT;
+                    break;
+                }
+            }
+        }
+    }
+
+    tex_coord_type_ = 0;
+    if (tex_coords_.size() == vertices_.size() && vertex_count > 0) {
+        tex_coord_type_ = GL_FLOAT;
+        if (packed || automatic) {
+            bool unit = true;
+            for (auto it = tex_coords_.begin(); it != tex_coords_.end(); ++it) {
+                if (it->x < 0.0f || it->x > 1.0f || it->y < 0.0f
+                        || it->y > 1.0f) {
+                    unit = false;
+                    break;
+                }
+            }
+            if (unit) {
+                tex_coord_type_ = GL_UNSIGNED_SHORT;
+            } else if (packed) {
+                tex_coord_type_ = GL_HALF_FLOAT;
+            }
+        }
+    }
+
+    // every attribute stays 4-byte aligned
+    vertex_stride_ = position_type_ == GL_HALF_FLOAT ? 8 : 12;
+    normal_offset_ = vertex_stride_;
+    if (normal_type_ != 0) {
+        vertex_stride_ += normal_type_ == GL_FLOAT ? 12 : 4;
+    }
+    tex_coord_offset_ = vertex_stride_;
+    if (tex_coord_type_ != 0) {
+        vertex_stride_ += tex_coord_type_ == GL_FLOAT ? 8 : 4;
+    }
+}
+
+static GLuint packNormal(const glm::vec3& normal) {
+    GLuint packed = 0;
+    for (int i = 0; i < 3; ++i) {
+        float component = std::min(1.0f, std::max(-1.0f, normal[i]));
+        GLint value = static_cast<GLint>(std::floor(component * 511.0f + 0.5f));
+        packed |= (static_cast<GLuint>(value) & 0x3ff) << (10 * i);
+    }
+    return packed;
+}
+
+static GLushort packUnorm16(float value) {
+    return static_cast<GLushort>(std::floor(value * 65535.0f + 0.5f));
+}
+
+static glm::vec3 unpackNormal(GLuint packed) {
+    glm::vec3 normal;
+    for (int i = 0; i < 3; ++i) {
+        GLint value = (packed >> (10 * i)) & 0x3ff;
+        if (value & 0x200) {
+            value -= 0x400;
+        }
+        normal[i] = std::max(-1.0f, value / 511.0f);
+    }
+    return normal;
+}
+
+void Mesh::packVertices(int begin, int end,
+        std::vector<unsigned char>& interleaved) const {
+    interleaved.resize(vertex_stride_ * (end - begin));
+    unsigned char* vertex = interleaved.data();
+    for (int i = begin; i < end; ++i, vertex += vertex_stride_) {
+        if (position_type_ == GL_HALF_FLOAT) {
+            GLushort* position = reinterpret_cast<GLushort*>(vertex);
+            position[0] = glm::packHalf1x16(vertices_[i].x);
+            position[1] = glm::packHalf1x16(vertices_[i].y);
+            position[2] = glm::packHalf1x16(vertices_[i].z);
+            position[3] = glm::packHalf1x16(1.0f);
+        } else {
+            memcpy(vertex, &vertices_[i], sizeof(glm::vec3));
+        }
+
+        if (normal_type_ == GL_INT_2_10_10_10_REV) {
+            GLuint normal = packNormal(normals_[i]);
+            memcpy(vertex + normal_offset_, &normal, sizeof(normal));
+        } else if (normal_type_ == GL_FLOAT) {
+            memcpy(vertex + normal_offset_, &normals_[i], sizeof(glm::vec3));
+        }
+
+        GLushort* tex_coord = reinterpret_cast<GLushort*>(vertex
+                + tex_coord_offset_);
+        if (tex_coord_type_ == GL_UNSIGNED_SHORT) {
+            tex_coord[0] = packUnorm16(tex_coords_[i].x);
+            tex_coord[1] = packUnorm16(tex_coords_[i].y);
+        } else if (tex_coord_type_ == GL_HALF_FLOAT) {
+            tex_coord[0] = glm::packHalf1x16(tex_coords_[i].x);
+            tex_coord[1] = glm::packHalf1x16(tex_coords_[i].y);
+        } else if (tex_coord_type_ == GL_FLOAT) {
+            memcpy(tex_coord, &tex_coords_[i], sizeof(glm::vec2));
+        }
+    }
+}
+
+void Mesh::unpackVertices(const unsigned char* interleaved, int count) {
+    bool read_positions = positions_released_ && vertices_.empty();
+    bool read_normals = attributes_released_ && normal_type_ != 0
+            && normals_.empty();
+    bool read_tex_coords = attributes_released_ && tex_coord_type_ != 0
+            && tex_coords_.empty();
+    if (read_positions) {
+        vertices_.resize(count);
+    }
+    if (read_normals) {
+        normals_.resize(count);
+    }
+    if (read_tex_coords) {
+        tex_coords_.resize(count);
+    }
+
+    const unsigned char* vertex = interleaved;
+    for (int i = 0; i < count; ++i, vertex += vertex_stride_) {
+        if (read_positions && position_type_ == GL_HALF_FLOAT) {
+            const GLushort* position = reinterpret_cast<const GLushort*>(vertex);
+            vertices_[i] = glm::vec3(glm::unpackHalf1x16(position[0]),
+                    glm::unpackHalf1x16(position[1]),
+                    glm::unpackHalf1x16(position[2]));
+        } else if (read_positions) {
+            memcpy(glm::value_ptr(vertices_[i]), vertex, sizeof(glm::vec3));
+        }
+
+        if (read_normals && normal_type_ == GL_INT_2_10_10_10_REV) {
+            GLuint normal;
+            memcpy(&normal, vertex + normal_offset_, sizeof(normal));
+            normals_[i] = unpackNormal(normal);
+        } else if (read_normals) {
+            memcpy(glm::value_ptr(normals_[i]), vertex + normal_offset_,
+                    sizeof(glm::vec3));
+        }
+
+        const GLushort* tex_coord = reinterpret_cast<const GLushort*>(vertex
+                + tex_coord_offset_);
+        if (read_tex_coords && tex_coord_type_ == GL_UNSIGNED_SHORT) {
+            tex_coords_[i] = glm::vec2(tex_coord[0] / 65535.0f,
+                    tex_coord[1] / 65535.0f);
+        } else if (read_tex_coords && tex_coord_type_ == GL_HALF_FLOAT) {
+            tex_coords_[i] = glm::vec2(glm::unpackHalf1x16(tex_coord[0]),
+                    glm::unpackHalf1x16(tex_coord[1]));
+        } else if (read_tex_coords) {
+            memcpy(glm::value_ptr(tex_coords_[i]), tex_coord,
+                    sizeof(glm::vec2));
+        }
+    }
+}
+
+GLenum Mesh::usage() const {
+    switch (buffer_usage_) {
+    case BUFFER_USAGE_DYNAMIC:
+        return GL_DYNAMIC_DRAW;
+    case BUFFER_USAGE_STREAM:
+        return GL_STREAM_DRAW;
+    default:
+        return GL_STATIC_DRAW;
+    }
+}
+
+void Mesh::uploadBuffers() {
+    if (vertices_.size() == 0) {
+        std::string error = "no vertex data yet, shouldn't call here. ";
+        throw error;
+    }
+
+    chooseVertexTypes();
+
+    std::vector<unsigned char> interleaved;
+    packVertices(0, vertices_.size(), interleaved);
+
+    // the element buffer binding belongs to the vertex array
+    GLState::bindVertexArray(0);
+
+    triangle_vboID_ = createBuffer(GL_ELEMENT_ARRAY_BUFFER, triangles_,
+            usage());
+    numTriangles_ = triangles_.size() / 3;
+    vertex_vboID_ = createBuffer(GL_ARRAY_BUFFER, interleaved, usage());
     glBindBuffer(GL_ARRAY_BUFFER, 0);
     glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
 
     vao_dirty_ = false;
-    vaoInitiliased_ = true;
-#endif
+    dirty_begin_ = dirty_end_ = 0;
+    triangles_dirty_ = false;
+    dirty_attributes_.clear();
+
+    if (buffer_usage_ == BUFFER_USAGE_STATIC
+            && residency_ != RESIDENCY_KEEP_ALL) {
+        releaseCpuData();
+    }
+}
+
+template<class T>
+void Mesh::uploadAttributeBuffers(
+        const std::map<std::string, std::vector<T>>& vectors, int size) {
+    for (auto it = vectors.begin(); it != vectors.end(); ++it) {
+        Attribute attribute;
+        attribute.location = 0;
+        attribute.size = size;
+        attribute.key = it->first;
+        getAttributeBuffer(attribute);
+    }
+}
+
+template<class T>
+static void releaseVector(std::vector<T>& vector) {
+    std::vector<T> empty;
+    vector.swap(empty);
+}
+
+/*
+ * Custom attributes are otherwise uploaded when a layout first uses them,
+ * so all of them are uploaded before their vectors go.
+ */
+void Mesh::releaseCpuData() {
+    uploadAttributeBuffers(float_vectors_, 1);
+    uploadAttributeBuffers(vec2_vectors_, 2);
+    uploadAttributeBuffers(vec3_vectors_, 3);
+    uploadAttributeBuffers(vec4_vectors_, 4);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+    releaseVector(normals_);
+    releaseVector(tex_coords_);
+    float_vectors_.clear();
+    vec2_vectors_.clear();
+    vec3_vectors_.clear();
+    vec4_vectors_.clear();
+    attributes_released_ = true;
+
+    if (residency_ == RESIDENCY_GPU_ONLY && !positions_kept_) {
+        releaseVector(vertices_);
+        releaseVector(triangles_);
+        positions_released_ = true;
+    }
+}
+
+template<class T>
+static void readBuffer(GLenum target, GLuint id, std::vector<T>& data) {
+    GLint size = 0;
+    glBindBuffer(target, id);
+    glGetBufferParameteriv(target, GL_BUFFER_SIZE, &size);
+    data.resize(size / sizeof(T));
+    if (data.empty()) {
+        return;
+    }
+
+    const void* mapped = glMapBufferRange(target, 0, data.size() * sizeof(T),
+            GL_MAP_READ_BIT);
+    if (mapped == 0) {
+        LOGE("Mesh::readBack() : cannot map buffer %u", id);
+        data.clear();
+        return;
+    }
+    const T* source = static_cast<const T*>(mapped);
+    std::copy(source, source + data.size(), data.begin());
+    glUnmapBuffer(target);
+}
+
+/*
+ * Vectors set again since they were dropped are newer than the buffers, so
+ * only those still empty are read back.
+ */
+void Mesh::readBack() {
+    if (has_cpu_data() || vertex_vboID_ == GVR_INVALID) {
+        return;
+    }
+
+    // the element buffer binding belongs to the vertex array
+    GLState::bindVertexArray(0);
+
+    std::vector<unsigned char> interleaved;
+    readBuffer(GL_ARRAY_BUFFER, vertex_vboID_, interleaved);
+    unpackVertices(interleaved.data(), interleaved.size() / vertex_stride_);
+
+    if (attributes_released_) {
+        for (auto it = attribute_vboIDs_.begin();
+                it != attribute_vboIDs_.end(); ++it) {
+            const std::string& key = it->first.second;
+            switch (it->first.first) {
+            case 1:
+                readBuffer(GL_ARRAY_BUFFER, it->second, float_vectors_[key]);
+                break;
+            case 2:
+                readBuffer(GL_ARRAY_BUFFER, it->second, vec2_vectors_[key]);
+                break;
+            case 3:
+                readBuffer(GL_ARRAY_BUFFER, it->second, vec3_vectors_[key]);
+                break;
+            case 4:
+                readBuffer(GL_ARRAY_BUFFER, it->second, vec4_vectors_[key]);
+                break;
+            }
+        }
+    }
+
+    if (positions_released_ && triangles_.empty()) {
+        readBuffer(GL_ELEMENT_ARRAY_BUFFER, triangle_vboID_, triangles_);
+    }
+
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+    positions_released_ = false;
+    attributes_released_ = false;
+}
+
+template<class T>
+static void updateBuffer(GLenum target, GLuint id,
+        const std::vector<T>& data, GLenum usage) {
+    glBindBuffer(target, id);
+    glBufferData(target, sizeof(T) * data.size(), data.data(), usage);
+}
+
+/*
+ * Buffers changed for the most part, and all buffers of stream meshes, are
+ * uploaded whole with glBufferData, which orphans the storage draws still in
+ * flight may read: the driver gives the buffer new storage instead of
+ * waiting for them. A smaller range goes in with glBufferSubData, which
+ * drivers either fit between draws or copy on write.
+ */
+void Mesh::updateBuffers() {
+    // the element buffer binding belongs to the vertex array
+    GLState::bindVertexArray(0);
+
+    if (dirty_begin_ < dirty_end_) {
+        int vertex_count = vertices_.size();
+        dirty_end_ = std::min(dirty_end_, vertex_count);
+        bool whole = buffer_usage_ == BUFFER_USAGE_STREAM
+                || 2 * (dirty_end_ - dirty_begin_) > vertex_count;
+        if (whole) {
+            dirty_begin_ = 0;
+            dirty_end_ = vertex_count;
+        }
+
+        std::vector<unsigned char> interleaved;
+        packVertices(dirty_begin_, dirty_end_, interleaved);
+        glBindBuffer(GL_ARRAY_BUFFER, vertex_vboID_);
+        if (whole) {
+            glBufferData(GL_ARRAY_BUFFER, interleaved.size(),
+                    interleaved.data(), usage());
+        } else {
+            glBufferSubData(GL_ARRAY_BUFFER, dirty_begin_ * vertex_stride_,
+                    interleaved.size(), interleaved.data());
+        }
+        dirty_begin_ = dirty_end_ = 0;
+    }
+
+    if (triangles_dirty_) {
+        updateBuffer(GL_ELEMENT_ARRAY_BUFFER, triangle_vboID_, triangles_,
+                usage());
+        triangles_dirty_ = false;
+    }
+
+    for (auto it = attribute_vboIDs_.begin(); it != attribute_vboIDs_.end();
+            ++it) {
+        const std::string& key = it->first.second;
+        if (dirty_attributes_.count(key) == 0) {
+            continue;
+        }
+        switch (it->first.first) {
+        case 1:
+            updateBuffer(GL_ARRAY_BUFFER, it->second, getFloatVector(key),
+                    usage());
+            break;
+        case 2:
+            updateBuffer(GL_ARRAY_BUFFER, it->second, getVec2Vector(key),
+                    usage());
+            break;
+        case 3:
+            updateBuffer(GL_ARRAY_BUFFER, it->second, getVec3Vector(key),
+                    usage());
+            break;
+        case 4:
+            updateBuffer(GL_ARRAY_BUFFER, it->second, getVec4Vector(key),
+                    usage());
+            break;
+        }
+    }
+    dirty_attributes_.clear();
+
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+}
+
+// uploaded the first time a layout uses it
+GLuint Mesh::getAttributeBuffer(const Attribute& attribute) {
+    std::pair<int, std::string> key(attribute.size, attribute.key);
+    auto it = attribute_vboIDs_.find(key);
+    if (it != attribute_vboIDs_.end()) {
+        return it->second;
+    }
+
+    GLuint id;
+    switch (attribute.size) {
+    case 1:
+        id = createBuffer(GL_ARRAY_BUFFER, getFloatVector(attribute.key),
+                usage());
+        break;
+    case 2:
+        id = createBuffer(GL_ARRAY_BUFFER, getVec2Vector(attribute.key),
+                usage());
+        break;
+    case 3:
+        id = createBuffer(GL_ARRAY_BUFFER, getVec3Vector(attribute.key),
+                usage());
+        break;
+    case 4:
+        id = createBuffer(GL_ARRAY_BUFFER, getVec4Vector(attribute.key),
+                usage());
+        break;
+    default:
+        std::string error = "Mesh::getAttributeBuffer() : bad size for "
+                + attribute.key;
+        throw error;
+    }
+    attribute_vboIDs_[key] = id;
+    return id;
+}
+
+void Mesh::releaseBuffers() {
+    for (auto it = vaoIDs_.begin(); it != vaoIDs_.end(); ++it) {
+        gl_delete.queueVertexArray(it->second);
+    }
+    vaoIDs_.clear();
+
+    if (triangle_vboID_ != GVR_INVALID)
+        gl_delete.queueBuffer(triangle_vboID_);
+    if (vertex_vboID_ != GVR_INVALID)
+        gl_delete.queueBuffer(vertex_vboID_);
+    triangle_vboID_ = GVR_INVALID;
+    vertex_vboID_ = GVR_INVALID;
+
+    for (auto it = attribute_vboIDs_.begin(); it != attribute_vboIDs_.end();
+            ++it) {
+        gl_delete.queueBuffer(it->second);
+    }
+    attribute_vboIDs_.clear();
+
+    vao_dirty_ = true;
+    dirty_begin_ = dirty_end_ = 0;
+    triangles_dirty_ = false;
+    dirty_attributes_.clear();
 }
 
 }
@@ -20,8 +20,11 @@
 #ifndef MESH_H_
 #define MESH_H_
 
+#include <algorithm>
+#include <atomic>
 #include <map>
 #include <memory>
+#include <set>
 #include <vector>
 #include <string>
 
@@ -34,7 +37,6 @@
 #include "gl/gl_program.h"
 
 #include "objects/hybrid_object.h"
-#include "objects/material.h"
 #include "objects/bounding_volume.h"
 
 #include "engine/memory/gl_delete.h"
@@ -42,11 +44,79 @@
 namespace gvr {
 class Mesh: public HybridObject {
 public:
+    // a vertex attribute a custom shader reads from one of the vectors set
+    // with setFloatVector() .. setVec4Vector(), by component count
+    struct Attribute {
+        GLuint location;
+        int size;
+        std::string key;
+
+        bool operator<(const Attribute& attribute) const {
+            if (location != attribute.location) {
+                return location < attribute.location;
+            }
+            if (size != attribute.size) {
+                return size < attribute.size;
+            }
+            return key < attribute.key;
+        }
+    };
+
+    // attributes besides position, normal and texture coordinates, which
+    // every layout has at their GLProgram locations; sorted by location
+    typedef std::vector<Attribute> AttributeLayout;
+
+    // How positions, normals and texture coordinates are stored on the GPU,
+    // interleaved in one buffer. The packed types are decoded by the vertex
+    // fetch, so shaders read them as floats all the same.
+    enum VertexFormat {
+        // packed where the data allows it without visible loss: positions
+        // as half floats if the mesh is about centered on its origin and
+        // half float rounding stays within the position tolerance, normals as 10 bits each if they are unit length, texture
+        // coordinates as 16-bit unorms if they are within [0, 1]
+        VERTEX_FORMAT_AUTO = 0,
+        // everything as 32-bit floats
+        VERTEX_FORMAT_FLOAT = 1,
+        // half float positions, 10-bit normals, and 16-bit unorm texture
+        // coordinates, or half floats if they are outside [0, 1]
+        VERTEX_FORMAT_PACKED = 2
+    };
+
+    // How often the vertices are expected to change, as the GL usage of
+    // the buffers. Dynamic and stream meshes keep their buffers when data
+    // of the same size is set, and upload just the vertices that changed.
+    enum BufferUsage {
+        BUFFER_USAGE_STATIC = 0,
+        // changed every now and then, a few vertices at a time
+        BUFFER_USAGE_DYNAMIC = 1,
+        // changed about every frame, mostly all at once
+        BUFFER_USAGE_STREAM = 2
+    };
+
+    // Which vertex data a static mesh keeps in memory once it is uploaded.
+    // What is dropped is read back from the GPU buffers by readBack(), or
+    // before the buffers are rebuilt; the bounds are always kept.
+    enum Residency {
+        RESIDENCY_KEEP_ALL = 0,
+        // keep positions and triangles, for picking and occlusion
+        RESIDENCY_KEEP_POSITIONS = 1,
+        RESIDENCY_GPU_ONLY = 2
+    };
+
     Mesh() :
-            vertices_(), normals_(), tex_coords_(), triangles_(), float_vectors_(), vec2_vectors_(), vec3_vectors_(), vec4_vectors_(),
-                    have_bounding_volume_(false), vaoInitiliased_(false),
-                    vaoID_(GVR_INVALID), triangle_vboID_(GVR_INVALID), vert_vboID_(GVR_INVALID),
-                    norm_vboID_(GVR_INVALID), tex_vboID_(GVR_INVALID)
+            vertices_(), normals_(), tex_coords_(), float_vectors_(), vec2_vectors_(), vec3_vectors_(), vec4_vectors_(), triangles_(),
+                    vertex_format_(VERTEX_FORMAT_AUTO), position_tolerance_(0.001f),
+                    buffer_usage_(BUFFER_USAGE_STATIC),
+                    residency_(RESIDENCY_KEEP_ALL), positions_kept_(false),
+                    positions_released_(false),
+                    attributes_released_(false),
+                    triangle_vboID_(GVR_INVALID),
+                    vertex_vboID_(GVR_INVALID), attribute_vboIDs_(), vaoIDs_(),
+                    vertex_stride_(0), position_type_(GL_FLOAT), normal_type_(0),
+                    normal_offset_(0), tex_coord_type_(0), tex_coord_offset_(0),
+                    numTriangles_(0), vao_dirty_(true), dirty_begin_(0), dirty_end_(0),
+                    triangles_dirty_(false), dirty_attributes_(),
+                    have_bounding_volume_(false), bounding_volume_version_(0)
     {
     }
 
@@ -68,16 +138,7 @@ public:
     }
 
     void deleteVaos() {
-        if (vaoID_ != GVR_INVALID)
-            gl_delete.queueVertexArray(vaoID_);
-        if (triangle_vboID_ != GVR_INVALID)
-            gl_delete.queueBuffer(triangle_vboID_);
-        if (vert_vboID_ != GVR_INVALID)
-            gl_delete.queueBuffer(vert_vboID_);
-        if (norm_vboID_ != GVR_INVALID)
-            gl_delete.queueBuffer(norm_vboID_);
-        if (tex_vboID_ != GVR_INVALID)
-            gl_delete.queueBuffer(tex_vboID_);
+        releaseBuffers();
         have_bounding_volume_ = false;
     }
 
@@ -90,14 +151,18 @@ public:
     }
 
     void set_vertices(const std::vector<glm::vec3>& vertices) {
+        verticesChanged(vertices_.size() == vertices.size(), 0,
+                vertices.size());
         vertices_ = vertices;
-        have_bounding_volume_ = false;
+        dirtyBoundingVolume();
         getBoundingVolume(); // calculate bounding volume
     }
 
     void set_vertices(std::vector<glm::vec3>&& vertices) {
+        verticesChanged(vertices_.size() == vertices.size(), 0,
+                vertices.size());
         vertices_ = std::move(vertices);
-        have_bounding_volume_ = false;
+        dirtyBoundingVolume();
         getBoundingVolume(); // calculate bounding volume
     }
 
@@ -110,10 +175,12 @@ public:
     }
 
     void set_normals(const std::vector<glm::vec3>& normals) {
+        verticesChanged(normals_.size() == normals.size(), 0, normals.size());
         normals_ = normals;
     }
 
     void set_normals(std::vector<glm::vec3>&& normals) {
+        verticesChanged(normals_.size() == normals.size(), 0, normals.size());
         normals_ = std::move(normals);
     }
 
@@ -126,13 +193,13 @@ public:
     }
 
     void set_tex_coords(const std::vector<glm::vec2>& tex_coords) {
+        verticesChanged(tex_coords_.size() == tex_coords.size(), 0, tex_coords.size());
         tex_coords_ = tex_coords;
-        vao_dirty_ = true;
     }
 
     void set_tex_coords(std::vector<glm::vec2>&& tex_coords) {
+        verticesChanged(tex_coords_.size() == tex_coords.size(), 0, tex_coords.size());
         tex_coords_ = std::move(tex_coords);
-        vao_dirty_ = true;
     }
 
     std::vector<unsigned short>& triangles() {
@@ -144,10 +211,12 @@ public:
     }
 
     void set_triangles(const std::vector<unsigned short>& triangles) {
+        trianglesChanged(triangles_.size() == triangles.size());
         triangles_ = triangles;
     }
 
     void set_triangles(std::vector<unsigned short>&& triangles) {
+        trianglesChanged(triangles_.size() == triangles.size());
         triangles_ = std::move(triangles);
     }
 
@@ -174,6 +243,7 @@ public:
     }
 
     void setFloatVector(std::string key, const std::vector<float>& vector) {
+        attributeChanged(key, float_vectors_, vector.size());
         float_vectors_[key] = vector;
     }
 
@@ -198,6 +268,7 @@ public:
     }
 
     void setVec2Vector(std::string key, const std::vector<glm::vec2>& vector) {
+        attributeChanged(key, vec2_vectors_, vector.size());
         vec2_vectors_[key] = vector;
     }
 
@@ -222,6 +293,7 @@ public:
     }
 
     void setVec3Vector(std::string key, const std::vector<glm::vec3>& vector) {
+        attributeChanged(key, vec3_vectors_, vector.size());
         vec3_vectors_[key] = vector;
     }
 
@@ -246,38 +318,122 @@ public:
     }
 
     void setVec4Vector(std::string key, const std::vector<glm::vec4>& vector) {
+        attributeChanged(key, vec4_vectors_, vector.size());
         vec4_vectors_[key] = vector;
     }
 
+    // whether there are vertex attributes besides position, normal and
+    // texture coordinates
+    bool has_attribute_vectors() const {
+        return !float_vectors_.empty() || !vec2_vectors_.empty()
+                || !vec3_vectors_.empty() || !vec4_vectors_.empty();
+    }
+
     const BoundingVolume& getBoundingVolume() const { return bounding_volume; }
+
+    // bumped every time the bounds may have changed, so that scene objects
+    // caching world-space bounds of this mesh can tell theirs are stale
+    unsigned int bounding_volume_version() const {
+        return bounding_volume_version_;
+    }
+
+    // bumped whenever the bounds of any mesh may have changed, from any
+    // thread, as meshes are also filled on loader threads
+    static unsigned int bounding_volume_epoch() {
+        return bounding_volume_epoch_.load();
+    }
+
     Mesh* getBoundingBox();
+
+    // a mesh of the given triangles of this one, with only the vertices
+    // and vertex attributes they use
+    Mesh* createSubset(const std::vector<unsigned short>& triangles) const;
+
+    // renumbers the vertices in the order the triangles first use them, so
+    // they are fetched about in sequence; unused vertices go last
+    void reorderVertices();
     void getTransformedBoundingBoxInfo(glm::mat4 *M,
             float *transformed_bounding_box); //Get Bounding box info transformed by matrix
 
-    // /////////////////////////////////////////////////
-    //  code for vertex attribute location
+    VertexFormat vertex_format() const {
+        return vertex_format_;
+    }
+
+    void set_vertex_format(VertexFormat vertex_format) {
+        vertex_format_ = vertex_format;
+        vao_dirty_ = true;
+    }
+
+    // the largest rounding error, in model units, VERTEX_FORMAT_AUTO
+    // accepts to store positions as half floats; 1 mm by default
+    float position_tolerance() const {
+        return position_tolerance_;
+    }
 
-    void setVertexAttribLocF(GLuint location, std::string key) {
-        attribute_float_keys_[location] = key;
+    void set_position_tolerance(float position_tolerance) {
+        position_tolerance_ = position_tolerance;
+        vao_dirty_ = true;
     }
 
-    void setVertexAttribLocV2(GLuint location, std::string key) {
-        attribute_vec2_keys_[location] = key;
+    BufferUsage buffer_usage() const {
+        return buffer_usage_;
     }
 
-    void setVertexAttribLocV3(GLuint location, std::string key) {
-        attribute_vec3_keys_[location] = key;
+    void set_buffer_usage(BufferUsage buffer_usage) {
+        buffer_usage_ = buffer_usage;
+        vao_dirty_ = true;
     }
 
-    void setVertexAttribLocV4(GLuint location, std::string key) {
-        attribute_vec4_keys_[location] = key;
+    Residency residency() const {
+        return residency_;
     }
 
-    // generate VAO
-    void generateVAO();
+    // takes effect on the next upload
+    void set_residency(Residency residency) {
+        residency_ = residency;
+    }
 
-    const GLuint getVAOId(Material::ShaderType key) const {
-    	return vaoID_;
+    // Keeps the positions and triangles in memory from now on, whatever the
+    // residency, for picking and occlusion culling, which read them on the
+    // CPU. False if they were dropped already, to be read back by
+    // readBack() on the GL thread.
+    bool keep_positions() {
+        positions_kept_ = true;
+        return !positions_released_;
+    }
+
+    // false while some vertex data lives only in the GPU buffers
+    bool has_cpu_data() const {
+        return !positions_released_ && !attributes_released_;
+    }
+
+    // Reads the vertex data dropped after upload back from the GPU
+    // buffers. Packed vertex formats read back as they were packed, so
+    // with some loss of precision. Called on the GL thread.
+    void readBack();
+
+    // Replace count vertices, normals or texture coordinates from first;
+    // a dynamic or stream mesh uploads only those on the next draw.
+    void updateVertices(int first, const glm::vec3* vertices, int count);
+    void updateNormals(int first, const glm::vec3* normals, int count);
+    void updateTexCoords(int first, const glm::vec2* tex_coords, int count);
+
+    // bytes per vertex in the interleaved buffer, once uploaded
+    int vertex_stride() const {
+        return vertex_stride_;
+    }
+
+    // The vertex array for a layout, made on first use. Every vertex
+    // vector is uploaded once, to a buffer the vertex arrays of all layouts
+    // share; changing any of them releases the buffers and vertex arrays,
+    // to be made again on the next draw, unless the mesh is dynamic and the
+    // sizes stay the same, in which case only what changed is uploaded.
+    // Called on the GL thread.
+    GLuint getVAOId(const AttributeLayout& layout);
+
+    // the vertex array with position, normal and texture coordinates only
+    GLuint getVAOId() {
+        return getVAOId(AttributeLayout());
     }
 
     GLuint getNumTriangles() {
@@ -301,27 +457,98 @@ private:
     std::map<std::string, std::vector<glm::vec4>> vec4_vectors_;
     std::vector<unsigned short> triangles_;
 
-    // add location slot map
-    std::map<int, std::string> attribute_float_keys_;
-    std::map<int, std::string> attribute_vec2_keys_;
-    std::map<int, std::string> attribute_vec3_keys_;
-    std::map<int, std::string> attribute_vec4_keys_;
+    // a dynamic mesh keeps its buffers while the sizes stay the same
+    void verticesChanged(bool same_size, int first, int count) {
+        if (buffer_usage_ == BUFFER_USAGE_STATIC || !same_size || vao_dirty_) {
+            vao_dirty_ = true;
+        } else if (dirty_begin_ < dirty_end_) {
+            dirty_begin_ = std::min(dirty_begin_, first);
+            dirty_end_ = std::max(dirty_end_, first + count);
+        } else {
+            dirty_begin_ = first;
+            dirty_end_ = first + count;
+        }
+    }
+
+    void trianglesChanged(bool same_size) {
+        if (buffer_usage_ == BUFFER_USAGE_STATIC || !same_size) {
+            vao_dirty_ = true;
+        } else {
+            triangles_dirty_ = true;
+        }
+    }
 
-    // add vertex array object and VBO
+    template<class T>
+    void attributeChanged(const std::string& key,
+            const std::map<std::string, std::vector<T>>& vectors,
+            size_t size) {
+        auto it = vectors.find(key);
+        if (buffer_usage_ == BUFFER_USAGE_STATIC || it == vectors.end()
+                || it->second.size() != size) {
+            vao_dirty_ = true;
+        } else {
+            dirty_attributes_.insert(key);
+        }
+    }
 
-    bool   vaoInitiliased_;
-    GLuint vaoID_;
+    GLenum usage() const;
+    void chooseVertexTypes();
+    void packVertices(int begin, int end,
+            std::vector<unsigned char>& interleaved) const;
+    void unpackVertices(const unsigned char* interleaved, int count);
+    void uploadBuffers();
+    void updateBuffers();
+    template<class T>
+    void uploadAttributeBuffers(
+            const std::map<std::string, std::vector<T>>& vectors, int size);
+    void releaseCpuData();
+    GLuint getAttributeBuffer(const Attribute& attribute);
+    void releaseBuffers();
+
+    VertexFormat vertex_format_;
+    float position_tolerance_;
+    BufferUsage buffer_usage_;
+    Residency residency_;
+    bool positions_kept_;
+    bool positions_released_;
+    bool attributes_released_;
+
+    // vertex buffers, shared by the vertex arrays of all layouts
     GLuint triangle_vboID_;
-    GLuint vert_vboID_;
-    GLuint norm_vboID_;
-    GLuint tex_vboID_;
+    GLuint vertex_vboID_;
+    std::map<std::pair<int, std::string>, GLuint> attribute_vboIDs_;
+
+    std::map<AttributeLayout, GLuint> vaoIDs_;
+
+    // the interleaved layout of vertex_vboID_; a type of 0 is left out
+    int vertex_stride_;
+    GLenum position_type_;
+    GLenum normal_type_;
+    int normal_offset_;
+    GLenum tex_coord_type_;
+    int tex_coord_offset_;
 
     // triangle information
     GLuint numTriangles_;
     bool vao_dirty_;
 
+    // what changed since the last upload of a dynamic mesh: a range of
+    // vertices in vertex_vboID_, the triangles, and attributes by key
+    int dirty_begin_;
+    int dirty_end_;
+    bool triangles_dirty_;
+    std::set<std::string> dirty_attributes_;
+
+    void dirtyBoundingVolume() {
+        have_bounding_volume_ = false;
+        ++bounding_volume_version_;
+        bounding_volume_epoch_.fetch_add(1);
+    }
+
     bool have_bounding_volume_;
     BoundingVolume bounding_volume;
+    unsigned int bounding_volume_version_;
+    static std::atomic<unsigned int> bounding_volume_epoch_;
 };
 }
 #endif
@@ -31,6 +31,12 @@
 namespace gvr {
 MeshEyePointee::MeshEyePointee(Mesh* mesh) :
         EyePointee(), mesh_(mesh) {
+    mesh_->keep_positions();
+}
+
+void MeshEyePointee::set_mesh(Mesh* mesh) {
+    mesh_ = mesh;
+    mesh_->keep_positions();
 }
 
 MeshEyePointee::~MeshEyePointee() {
@@ -37,9 +37,9 @@ public:
         return mesh_;
     }
 
-    void set_mesh(Mesh* mesh) {
-        mesh_ = mesh;
-    }
+    // the mesh keeps its positions, whatever its residency; the Java
+    // side reads them back if they were dropped already
+    void set_mesh(Mesh* mesh);
 
     EyePointData isPointed(const glm::mat4& mv_matrix);
     EyePointData isPointed(const glm::mat4& mv_matrix, float ox, float oy,
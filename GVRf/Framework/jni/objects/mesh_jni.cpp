@@ -20,6 +20,8 @@
 
 #include "mesh.h"
 
+#include "objects/mesh_optimizer.h"
+#include "objects/mesh_simplifier.h"
 #include "util/gvr_log.h"
 #include "util/gvr_jni.h"
 #include "android/asset_manager_jni.h"
@@ -84,9 +86,49 @@ Java_org_gearvrf_NativeMesh_getVec4Vector(JNIEnv * env,
 JNIEXPORT void JNICALL
 Java_org_gearvrf_NativeMesh_setVec4Vector(JNIEnv * env,
         jobject obj, jlong jmesh, jstring key, jfloatArray vec4_vector);
+JNIEXPORT void JNICALL
+Java_org_gearvrf_NativeMesh_setVertexFormat(JNIEnv * env,
+        jobject obj, jlong jmesh, jint format);
+JNIEXPORT void JNICALL
+Java_org_gearvrf_NativeMesh_setPositionTolerance(JNIEnv * env,
+        jobject obj, jlong jmesh, jfloat tolerance);
+JNIEXPORT jfloatArray JNICALL
+Java_org_gearvrf_NativeMesh_optimize(JNIEnv * env,
+        jobject obj, jlong jmesh);
+JNIEXPORT void JNICALL
+Java_org_gearvrf_NativeMesh_setBufferUsage(JNIEnv * env,
+        jobject obj, jlong jmesh, jint usage);
+JNIEXPORT void JNICALL
+Java_org_gearvrf_NativeMesh_setResidency(JNIEnv * env,
+        jobject obj, jlong jmesh, jint residency);
+JNIEXPORT jboolean JNICALL
+Java_org_gearvrf_NativeMesh_hasCpuData(JNIEnv * env,
+        jobject obj, jlong jmesh);
+JNIEXPORT jboolean JNICALL
+Java_org_gearvrf_NativeMesh_keepPositions(JNIEnv * env,
+        jobject obj, jlong jmesh);
+JNIEXPORT void JNICALL
+Java_org_gearvrf_NativeMesh_readBack(JNIEnv * env,
+        jobject obj, jlong jmesh);
+JNIEXPORT void JNICALL
+Java_org_gearvrf_NativeMesh_upload(JNIEnv * env,
+        jobject obj, jlong jmesh);
+JNIEXPORT void JNICALL
+Java_org_gearvrf_NativeMesh_updateVertices(JNIEnv * env,
+        jobject obj, jlong jmesh, jint first, jfloatArray vertices);
+JNIEXPORT void JNICALL
+Java_org_gearvrf_NativeMesh_updateNormals(JNIEnv * env,
+        jobject obj, jlong jmesh, jint first, jfloatArray normals);
+JNIEXPORT void JNICALL
+Java_org_gearvrf_NativeMesh_updateTexCoords(JNIEnv * env,
+        jobject obj, jlong jmesh, jint first, jfloatArray tex_coords);
 JNIEXPORT jlong JNICALL
 Java_org_gearvrf_NativeMesh_getBoundingBox(JNIEnv * env,
         jobject obj, jlong jmesh);
+JNIEXPORT jlongArray JNICALL
+Java_org_gearvrf_NativeMesh_simplify(JNIEnv * env,
+        jobject obj, jlong jmesh, jfloatArray triangle_ratios,
+        jfloatArray errors);
 }
 ;
 
@@ -340,6 +382,127 @@ Java_org_gearvrf_NativeMesh_setVec4Vector(JNIEnv * env,
     env->ReleaseFloatArrayElements(vec4_vector, jvec4_vector_pointer, 0);
 }
 
+JNIEXPORT void JNICALL
+Java_org_gearvrf_NativeMesh_setVertexFormat(JNIEnv * env,
+        jobject obj, jlong jmesh, jint format) {
+    Mesh* mesh = reinterpret_cast<Mesh*>(jmesh);
+    mesh->set_vertex_format(static_cast<Mesh::VertexFormat>(format));
+}
+
+JNIEXPORT void JNICALL
+Java_org_gearvrf_NativeMesh_setPositionTolerance(JNIEnv * env,
+        jobject obj, jlong jmesh, jfloat tolerance) {
+    Mesh* mesh = reinterpret_cast<Mesh*>(jmesh);
+    mesh->set_position_tolerance(tolerance);
+}
+
+JNIEXPORT void JNICALL
+Java_org_gearvrf_NativeMesh_setBufferUsage(JNIEnv * env,
+        jobject obj, jlong jmesh, jint usage) {
+    Mesh* mesh = reinterpret_cast<Mesh*>(jmesh);
+    mesh->set_buffer_usage(static_cast<Mesh::BufferUsage>(usage));
+}
+
+JNIEXPORT void JNICALL
+Java_org_gearvrf_NativeMesh_setResidency(JNIEnv * env,
+        jobject obj, jlong jmesh, jint residency) {
+    Mesh* mesh = reinterpret_cast<Mesh*>(jmesh);
+    mesh->set_residency(static_cast<Mesh::Residency>(residency));
+}
+
+JNIEXPORT jboolean JNICALL
+Java_org_gearvrf_NativeMesh_hasCpuData(JNIEnv * env,
+        jobject obj, jlong jmesh) {
+    Mesh* mesh = reinterpret_cast<Mesh*>(jmesh);
+    return static_cast<jboolean>(mesh->has_cpu_data());
+}
+
+JNIEXPORT jboolean JNICALL
+Java_org_gearvrf_NativeMesh_keepPositions(JNIEnv * env,
+        jobject obj, jlong jmesh) {
+    Mesh* mesh = reinterpret_cast<Mesh*>(jmesh);
+    return static_cast<jboolean>(mesh->keep_positions());
+}
+
+JNIEXPORT void JNICALL
+Java_org_gearvrf_NativeMesh_readBack(JNIEnv * env,
+        jobject obj, jlong jmesh) {
+    Mesh* mesh = reinterpret_cast<Mesh*>(jmesh);
+    mesh->readBack();
+}
+
+JNIEXPORT void JNICALL
+Java_org_gearvrf_NativeMesh_upload(JNIEnv * env,
+        jobject obj, jlong jmesh) {
+    Mesh* mesh = reinterpret_cast<Mesh*>(jmesh);
+    mesh->getVAOId();
+}
+
+JNIEXPORT void JNICALL
+Java_org_gearvrf_NativeMesh_updateVertices(JNIEnv * env,
+        jobject obj, jlong jmesh, jint first, jfloatArray vertices) {
+    Mesh* mesh = reinterpret_cast<Mesh*>(jmesh);
+    jfloat* jvertices_pointer = env->GetFloatArrayElements(vertices, 0);
+    int vertices_length = static_cast<int>(env->GetArrayLength(vertices))
+            / (sizeof(glm::vec3) / sizeof(jfloat));
+    try {
+        mesh->updateVertices(first,
+                reinterpret_cast<glm::vec3*>(jvertices_pointer),
+                vertices_length);
+    } catch (const std::string& error) {
+        LOGE("%s", error.c_str());
+    }
+    env->ReleaseFloatArrayElements(vertices, jvertices_pointer, JNI_ABORT);
+}
+
+JNIEXPORT void JNICALL
+Java_org_gearvrf_NativeMesh_updateNormals(JNIEnv * env,
+        jobject obj, jlong jmesh, jint first, jfloatArray normals) {
+    Mesh* mesh = reinterpret_cast<Mesh*>(jmesh);
+    jfloat* jnormals_pointer = env->GetFloatArrayElements(normals, 0);
+    int normals_length = static_cast<int>(env->GetArrayLength(normals))
+            / (sizeof(glm::vec3) / sizeof(jfloat));
+    try {
+        mesh->updateNormals(first,
+                reinterpret_cast<glm::vec3*>(jnormals_pointer),
+                normals_length);
+    } catch (const std::string& error) {
+        LOGE("%s", error.c_str());
+    }
+    env->ReleaseFloatArrayElements(normals, jnormals_pointer, JNI_ABORT);
+}
+
+JNIEXPORT void JNICALL
+Java_org_gearvrf_NativeMesh_updateTexCoords(JNIEnv * env,
+        jobject obj, jlong jmesh, jint first, jfloatArray tex_coords) {
+    Mesh* mesh = reinterpret_cast<Mesh*>(jmesh);
+    jfloat* jtex_coords_pointer = env->GetFloatArrayElements(tex_coords, 0);
+    int tex_coords_length = static_cast<int>(env->GetArrayLength(tex_coords))
+            / (sizeof(glm::vec2) / sizeof(jfloat));
+    try {
+        mesh->updateTexCoords(first,
+                reinterpret_cast<glm::vec2*>(jtex_coords_pointer),
+                tex_coords_length);
+    } catch (const std::string& error) {
+        LOGE("%s", error.c_str());
+    }
+    env->ReleaseFloatArrayElements(tex_coords, jtex_coords_pointer,
+            JNI_ABORT);
+}
+
+JNIEXPORT jfloatArray JNICALL
+Java_org_gearvrf_NativeMesh_optimize(JNIEnv * env,
+        jobject obj, jlong jmesh) {
+    Mesh* mesh = reinterpret_cast<Mesh*>(jmesh);
+    MeshOptimizer mesh_optimizer(*mesh);
+    mesh_optimizer.optimize();
+    jfloat acmr[] = { mesh_optimizer.acmr_before(),
+            mesh_optimizer.acmr_after() };
+    jfloatArray jacmr = env->NewFloatArray(2);
+    env->SetFloatArrayRegion(jacmr, 0, 2, acmr);
+    return jacmr;
+}
+
 JNIEXPORT jlong JNICALL
 Java_org_gearvrf_NativeMesh_getBoundingBox(JNIEnv * env,
         jobject obj, jlong jmesh) {
@@ -347,4 +510,45 @@ Java_org_gearvrf_NativeMesh_getBoundingBox(JNIEnv * env,
     return reinterpret_cast<jlong>(mesh->getBoundingBox());
 }
 
+JNIEXPORT jlongArray JNICALL
+Java_org_gearvrf_NativeMesh_simplify(JNIEnv * env,
+        jobject obj, jlong jmesh, jfloatArray triangle_ratios,
+        jfloatArray errors) {
+    Mesh* mesh = reinterpret_cast<Mesh*>(jmesh);
+    jsize level_count = env->GetArrayLength(triangle_ratios);
+    if (errors != 0 && env->GetArrayLength(errors) < level_count) {
+        LOGE("Mesh::simplify() : %d triangle ratios but room for %d errors",
+                level_count, env->GetArrayLength(errors));
+        return env->NewLongArray(0);
+    }
+    jfloat* triangle_ratios_pointer = env->GetFloatArrayElements(
+            triangle_ratios, 0);
+
+    // each level goes on from the one before
+    MeshSimplifier mesh_simplifier(*mesh);
+    int triangle_count = mesh->triangles().size() / 3;
+    std::vector<jlong> levels;
+    // errors, if asked for, are relative to the size of the mesh
+    float diameter = 2.0f * mesh->getBoundingVolume().radius();
+    std::vector<jfloat> level_errors;
+    for (int i = 0; i < level_count; ++i) {
+        mesh_simplifier.simplify(
+                static_cast<int>(triangle_count * triangle_ratios_pointer[i]));
+        levels.push_back(
+                reinterpret_cast<jlong>(mesh->createSubset(
+                        mesh_simplifier.triangles())));
+        level_errors.push_back(
+                diameter > 0.0f ? mesh_simplifier.error() / diameter : 0.0f);
+    }
+    env->ReleaseFloatArrayElements(triangle_ratios, triangle_ratios_pointer,
+            JNI_ABORT);
+    if (errors != 0) {
+        env->SetFloatArrayRegion(errors, 0, level_count, level_errors.data());
+    }
+
+    jlongArray jlevels = env->NewLongArray(level_count);
+    env->SetLongArrayRegion(jlevels, 0, level_count, levels.data());
+    return jlevels;
+}
+
 }
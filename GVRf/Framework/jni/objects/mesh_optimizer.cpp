@@ -0,0 +1,350 @@
+/* Copyright 2015 Samsung Electronics Co., LTD
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/***************************************************************************
+ * Reorders the triangles and vertices of a mesh for faster drawing.
+ ***************************************************************************/
+
+#include "mesh_optimizer.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "objects/mesh.h"
+
+namespace gvr {
+
+// the cache Forsyth's scores assume; real caches are smaller, but scoring
+// a longer history still helps them
+static const int SCORE_CACHE_SIZE = 32;
+
+// the cache the ACMR is measured with, about that of mobile GPUs
+static const int FIFO_CACHE_SIZE = 16;
+
+// how much worse than its whole cluster a part of it may use the cache and
+// still be cut off as a cluster of its own
+static const float CLUSTER_ACMR_THRESHOLD = 1.05f;
+
+namespace {
+struct Cluster {
+    unsigned int start;
+    unsigned int end;
+    float sort_key;
+
+    bool operator<(const Cluster& other) const {
+        return sort_key > other.sort_key;
+    }
+};
+}
+
+/*
+ * A vertex scores higher the more recently it was used, so the triangles
+ * still cached are drawn first, except the last triangle's own vertices,
+ * which score a bit lower so strips do not turn back on themselves. It
+ * also scores higher the fewer triangles it has left, so that lone
+ * triangles are not left behind, to be drawn with a cold cache.
+ */
+static float vertexScore(int cache_position, unsigned int triangles_left) {
+    if (triangles_left == 0) {
+        return -1.0f;
+    }
+
+    float score = 0.0f;
+    if (cache_position >= 3) {
+        score = powf(
+                1.0f - (cache_position - 3)
+                        / static_cast<float>(SCORE_CACHE_SIZE - 3), 1.5f);
+    } else if (cache_position >= 0) {
+        score = 0.75f;
+    }
+    return score + 2.0f / sqrtf(triangles_left);
+}
+
+float MeshOptimizer::acmr(const std::vector<unsigned short>& triangles,
+        int vertex_count, int cache_size) {
+    if (triangles.size() < 3) {
+        return 0.0f;
+    }
+
+    // a vertex is cached if fewer than cache_size misses came after its own
+    std::vector<unsigned int> miss_times(vertex_count, 0);
+    unsigned int misses = 0;
+    unsigned int time = cache_size + 1;
+    for (auto it = triangles.begin(); it != triangles.end(); ++it) {
+        if (time - miss_times[*it] > static_cast<unsigned int>(cache_size)) {
+            miss_times[*it] = time++;
+            ++misses;
+        }
+    }
+    return misses / (triangles.size() / 3.0f);
+}
+
+void MeshOptimizer::optimize() {
+    std::vector<unsigned short> triangles(mesh_.triangles());
+    int vertex_count = mesh_.vertices().size();
+    for (auto it = triangles.begin(); it != triangles.end(); ++it) {
+        if (*it >= vertex_count) {
+            return;
+        }
+    }
+    triangles.resize(triangles.size() / 3 * 3);
+
+    acmr_before_ = acmr(triangles, vertex_count, FIFO_CACHE_SIZE);
+    optimizeVertexCache(triangles, vertex_count);
+    optimizeOverdraw(triangles, vertex_count);
+
+    mesh_.set_triangles(std::move(triangles));
+    mesh_.reorderVertices();
+    acmr_after_ = acmr(mesh_.triangles(), vertex_count, FIFO_CACHE_SIZE);
+}
+
+/*
+ * Draws the best scoring triangle next, over and over. Only the triangles
+ * of vertices in the cache change score, so only those are looked at; when
+ * none of them is left, the next triangle not drawn yet starts afresh.
+ */
+void MeshOptimizer::optimizeVertexCache(
+        std::vector<unsigned short>& triangles, int vertex_count) {
+    unsigned int triangle_count = triangles.size() / 3;
+
+    // the triangles not drawn yet around each vertex, the first
+    // triangles_left[v] of those from offsets[v]
+    std::vector<unsigned int> offsets(vertex_count + 1, 0);
+    for (auto it = triangles.begin(); it != triangles.end(); ++it) {
+        ++offsets[*it + 1];
+    }
+    for (int i = 0; i < vertex_count; ++i) {
+        offsets[i + 1] += offsets[i];
+    }
+    std::vector<unsigned int> vertex_triangles(triangles.size());
+    std::vector<unsigned int> triangles_left(vertex_count, 0);
+    for (unsigned int i = 0; i < triangles.size(); ++i) {
+        unsigned short vertex = triangles[i];
+        vertex_triangles[offsets[vertex] + triangles_left[vertex]++] = i / 3;
+    }
+
+    std::vector<float> vertex_scores(vertex_count);
+    for (int i = 0; i < vertex_count; ++i) {
+        vertex_scores[i] = vertexScore(-1, triangles_left[i]);
+    }
+    std::vector<float> triangle_scores(triangle_count);
+    for (unsigned int i = 0; i < triangle_count; ++i) {
+        triangle_scores[i] = vertex_scores[triangles[i * 3]]
+                + vertex_scores[triangles[i * 3 + 1]]
+                + vertex_scores[triangles[i * 3 + 2]];
+    }
+    std::vector<bool> drawn(triangle_count, false);
+
+    std::vector<unsigned short> ordered;
+    ordered.reserve(triangles.size());
+    std::vector<unsigned short> cache;
+    std::vector<unsigned short> new_cache;
+    unsigned int next_undrawn = 0;
+    int best = -1;
+    for (unsigned int i = 0; i < triangle_count; ++i) {
+        if (best < 0) {
+            while (drawn[next_undrawn]) {
+                ++next_undrawn;
+            }
+            best = next_undrawn;
+        }
+
+        drawn[best] = true;
+        new_cache.clear();
+        for (int j = 0; j < 3; ++j) {
+            unsigned short vertex = triangles[best * 3 + j];
+            ordered.push_back(vertex);
+
+            unsigned int* first = &vertex_triangles[offsets[vertex]];
+            unsigned int* last = first + triangles_left[vertex] - 1;
+            *std::find(first, last, best) = *last;
+            --triangles_left[vertex];
+
+            if (std::find(new_cache.begin(), new_cache.end(), vertex)
+                    == new_cache.end()) {
+                new_cache.push_back(vertex);
+            }
+        }
+        int used = new_cache.size();
+        for (auto it = cache.begin(); it != cache.end(); ++it) {
+            if (std::find(new_cache.begin(), new_cache.begin() + used, *it)
+                    == new_cache.begin() + used) {
+                new_cache.push_back(*it);
+            }
+        }
+        cache.swap(new_cache);
+
+        // rescore the cache and what just fell out of it, then pick the best
+        // triangle of the vertices still in it
+        for (unsigned int j = 0; j < cache.size(); ++j) {
+            unsigned short vertex = cache[j];
+            int position = j < SCORE_CACHE_SIZE ? j : -1;
+            float score = vertexScore(position, triangles_left[vertex]);
+            float delta = score - vertex_scores[vertex];
+            vertex_scores[vertex] = score;
+            for (unsigned int k = offsets[vertex];
+                    k < offsets[vertex] + triangles_left[vertex]; ++k) {
+                triangle_scores[vertex_triangles[k]] += delta;
+            }
+        }
+        if (cache.size() > SCORE_CACHE_SIZE) {
+            cache.resize(SCORE_CACHE_SIZE);
+        }
+
+        best = -1;
+        float best_score = 0.0f;
+        for (auto it = cache.begin(); it != cache.end(); ++it) {
+            for (unsigned int k = offsets[*it];
+                    k < offsets[*it] + triangles_left[*it]; ++k) {
+                unsigned int triangle = vertex_triangles[k];
+                if (triangle_scores[triangle] > best_score) {
+                    best = triangle;
+                    best_score = triangle_scores[triangle];
+                }
+            }
+        }
+    }
+
+    triangles.swap(ordered);
+}
+
+/*
+ * Cuts the triangles, already in cache order, into clusters: first where
+ * all three vertices of a triangle miss the cache, which happens when the
+ * order jumps to another part of the mesh; then inside those, wherever the
+ * cluster so far uses the cache about as well as the whole, since starting
+ * over there costs little.
+ */
+void MeshOptimizer::findClusters(const std::vector<unsigned short>& triangles,
+        int vertex_count, std::vector<unsigned int>& cluster_starts) {
+    unsigned int triangle_count = triangles.size() / 3;
+    std::vector<unsigned int> miss_times(vertex_count, 0);
+    unsigned int time = FIFO_CACHE_SIZE + 1;
+
+    std::vector<unsigned int> hard_starts;
+    for (unsigned int i = 0; i < triangle_count; ++i) {
+        int misses = 0;
+        for (int j = 0; j < 3; ++j) {
+            unsigned short vertex = triangles[i * 3 + j];
+            if (time - miss_times[vertex] > FIFO_CACHE_SIZE) {
+                miss_times[vertex] = time++;
+                ++misses;
+            }
+        }
+        if (i == 0 || misses == 3) {
+            hard_starts.push_back(i);
+        }
+    }
+    hard_starts.push_back(triangle_count);
+
+    for (unsigned int i = 0; i + 1 < hard_starts.size(); ++i) {
+        unsigned int start = hard_starts[i];
+        unsigned int end = hard_starts[i + 1];
+        std::vector<unsigned short> cluster(triangles.begin() + start * 3,
+                triangles.begin() + end * 3);
+        float threshold = CLUSTER_ACMR_THRESHOLD
+                * acmr(cluster, vertex_count, FIFO_CACHE_SIZE);
+
+        cluster_starts.push_back(start);
+        time += FIFO_CACHE_SIZE + 1;
+        unsigned int misses = 0;
+        for (unsigned int j = start; j < end; ++j) {
+            for (int k = 0; k < 3; ++k) {
+                unsigned short vertex = triangles[j * 3 + k];
+                if (time - miss_times[vertex] > FIFO_CACHE_SIZE) {
+                    miss_times[vertex] = time++;
+                    ++misses;
+                }
+            }
+            unsigned int cluster_start = cluster_starts.back();
+            if (j + 1 < end
+                    && misses <= threshold * (j + 1 - cluster_start)) {
+                cluster_starts.push_back(j + 1);
+                time += FIFO_CACHE_SIZE + 1;
+                misses = 0;
+            }
+        }
+    }
+}
+
+/*
+ * Clusters facing out from the middle of the mesh, and further out, are
+ * likely in front of the others, so they are drawn first and the depth
+ * test rejects more of what is drawn after them.
+ */
+void MeshOptimizer::optimizeOverdraw(std::vector<unsigned short>& triangles,
+        int vertex_count) {
+    const std::vector<glm::vec3>& vertices = mesh_.vertices();
+    unsigned int triangle_count = triangles.size() / 3;
+    if (triangle_count == 0) {
+        return;
+    }
+
+    std::vector<unsigned int> cluster_starts;
+    findClusters(triangles, vertex_count, cluster_starts);
+    cluster_starts.push_back(triangle_count);
+
+    glm::vec3 mesh_center(0.0f);
+    float mesh_area = 0.0f;
+    std::vector<Cluster> clusters;
+    for (unsigned int i = 0; i + 1 < cluster_starts.size(); ++i) {
+        Cluster cluster = { cluster_starts[i], cluster_starts[i + 1], 0.0f };
+        clusters.push_back(cluster);
+    }
+
+    // area weighted centers and normals
+    std::vector<glm::vec3> centers(clusters.size(), glm::vec3(0.0f));
+    std::vector<glm::vec3> normals(clusters.size(), glm::vec3(0.0f));
+    for (unsigned int i = 0; i < clusters.size(); ++i) {
+        float cluster_area = 0.0f;
+        for (unsigned int j = clusters[i].start; j < clusters[i].end; ++j) {
+            const glm::vec3& p0 = vertices[triangles[j * 3]];
+            const glm::vec3& p1 = vertices[triangles[j * 3 + 1]];
+            const glm::vec3& p2 = vertices[triangles[j * 3 + 2]];
+            glm::vec3 normal = glm::cross(p1 - p0, p2 - p0);
+            float area = glm::length(normal);
+            centers[i] += (p0 + p1 + p2) * (area / 3.0f);
+            normals[i] += normal;
+            cluster_area += area;
+        }
+        mesh_center += centers[i];
+        mesh_area += cluster_area;
+        if (cluster_area > 0.0f) {
+            centers[i] /= cluster_area;
+        }
+    }
+    if (mesh_area > 0.0f) {
+        mesh_center /= mesh_area;
+    }
+
+    for (unsigned int i = 0; i < clusters.size(); ++i) {
+        float length = glm::length(normals[i]);
+        if (length > 0.0f) {
+            clusters[i].sort_key = glm::dot(centers[i] - mesh_center,
+                    normals[i] / length);
+        }
+    }
+    std::stable_sort(clusters.begin(), clusters.end());
+
+    std::vector<unsigned short> ordered;
+    ordered.reserve(triangles.size());
+    for (auto it = clusters.begin(); it != clusters.end(); ++it) {
+        ordered.insert(ordered.end(), triangles.begin() + it->start * 3,
+                triangles.begin() + it->end * 3);
+    }
+    triangles.swap(ordered);
+}
+
+}
@@ -0,0 +1,567 @@
+/* Copyright 2015 Samsung Electronics Co., LTD
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/***************************************************************************
+ * Quadric error edge collapse simplification of a mesh.
+ ***************************************************************************/
+
+#include "mesh_simplifier.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "objects/mesh.h"
+
+namespace gvr {
+
+// border and seam edges weigh this much more than the triangles around
+// them, so that their shape survives longer
+static const float BORDER_WEIGHT = 10.0f;
+
+static const float MAX_TURN_COSINE = 0.25f;
+
+MeshSimplifier::MeshSimplifier(const Mesh& mesh) :
+        positions_(mesh.vertices()), scale_(1.0f), remap_(), wedge_(),
+        kinds_(), quadrics_(), triangles_(), edge_offsets_(), edges_(),
+        triangle_offsets_(), vertex_triangles_(), collapses_(),
+        collapse_remap_(), collapse_locked_(), max_error_(0.0f) {
+    if (positions_.empty()) {
+        return;
+    }
+
+    glm::vec3 min_corner(positions_[0]);
+    glm::vec3 max_corner(positions_[0]);
+    for (auto it = positions_.begin(); it != positions_.end(); ++it) {
+        min_corner = glm::min(min_corner, *it);
+        max_corner = glm::max(max_corner, *it);
+    }
+    glm::vec3 extent(max_corner - min_corner);
+    scale_ = std::max(extent.x, std::max(extent.y, extent.z));
+    if (scale_ <= 0.0f) {
+        scale_ = 1.0f;
+    }
+    for (auto it = positions_.begin(); it != positions_.end(); ++it) {
+        *it = (*it - min_corner) / scale_;
+    }
+
+    buildPositionRemap();
+
+    // triangles already degenerate in position would only get in the way
+    const std::vector<unsigned short>& triangles = mesh.triangles();
+    size_t vertex_count = positions_.size();
+    for (size_t i = 0; i + 2 < triangles.size(); i += 3) {
+        unsigned short i0 = triangles[i];
+        unsigned short i1 = triangles[i + 1];
+        unsigned short i2 = triangles[i + 2];
+        if (i0 >= vertex_count || i1 >= vertex_count || i2 >= vertex_count) {
+            continue;
+        }
+        if (remap_[i0] == remap_[i1] || remap_[i1] == remap_[i2]
+                || remap_[i2] == remap_[i0]) {
+            continue;
+        }
+        triangles_.push_back(i0);
+        triangles_.push_back(i1);
+        triangles_.push_back(i2);
+    }
+
+    buildAdjacency();
+    classifyVertices();
+    buildQuadrics();
+}
+
+float MeshSimplifier::error() const {
+    return sqrtf(max_error_) * scale_;
+}
+
+/*
+ * Collapses in passes. Each pass picks the cheapest collapse of every edge,
+ * then applies them cheapest first, skipping any that touch the triangles
+ * of one already applied, until enough triangles are gone or the errors
+ * become much larger than those of the collapses needed.
+ */
+void MeshSimplifier::simplify(int target_triangle_count) {
+    if (target_triangle_count < 0) {
+        target_triangle_count = 0;
+    }
+
+    while (triangles_.size() / 3
+            > static_cast<size_t>(target_triangle_count)) {
+        buildAdjacency();
+        pickCollapses();
+        if (applyCollapses(triangles_.size() / 3 - target_triangle_count)
+                == 0) {
+            break;
+        }
+        remapTriangles();
+    }
+}
+
+void MeshSimplifier::buildPositionRemap() {
+    unsigned int vertex_count = positions_.size();
+    std::vector<unsigned int> order(vertex_count);
+    for (unsigned int i = 0; i < vertex_count; ++i) {
+        order[i] = i;
+    }
+    std::sort(order.begin(), order.end(),
+            [this](unsigned int a, unsigned int b) {
+                const glm::vec3& pa = positions_[a];
+                const glm::vec3& pb = positions_[b];
+                if (pa.x != pb.x) {
+                    return pa.x < pb.x;
+                }
+                if (pa.y != pb.y) {
+                    return pa.y < pb.y;
+                }
+                if (pa.z != pb.z) {
+                    return pa.z < pb.z;
+                }
+                return a < b;
+            });
+
+    remap_.resize(vertex_count);
+    wedge_.resize(vertex_count);
+    unsigned int first = 0;
+    while (first < vertex_count) {
+        unsigned int last = first + 1;
+        while (last < vertex_count
+                && positions_[order[last]] == positions_[order[first]]) {
+            ++last;
+        }
+        for (unsigned int i = first; i < last; ++i) {
+            remap_[order[i]] = order[first];
+            wedge_[order[i]] = order[i + 1 < last ? i + 1 : first];
+        }
+        first = last;
+    }
+}
+
+void MeshSimplifier::buildAdjacency() {
+    unsigned int vertex_count = positions_.size();
+    unsigned int corner_count = triangles_.size();
+
+    edge_offsets_.assign(vertex_count + 1, 0);
+    triangle_offsets_.assign(vertex_count + 1, 0);
+    for (unsigned int i = 0; i < corner_count; ++i) {
+        ++edge_offsets_[triangles_[i] + 1];
+        ++triangle_offsets_[remap_[triangles_[i]] + 1];
+    }
+    for (unsigned int i = 0; i < vertex_count; ++i) {
+        edge_offsets_[i + 1] += edge_offsets_[i];
+        triangle_offsets_[i + 1] += triangle_offsets_[i];
+    }
+
+    // filling moves each offset to the end of its range, which is where
+    // the next range starts
+    edges_.resize(corner_count);
+    vertex_triangles_.resize(corner_count);
+    for (unsigned int i = 0; i < corner_count; ++i) {
+        unsigned int from = triangles_[i];
+        unsigned int to = triangles_[i % 3 == 2 ? i - 2 : i + 1];
+        edges_[edge_offsets_[from]++] = to;
+        vertex_triangles_[triangle_offsets_[remap_[from]]++] = i / 3;
+    }
+    for (unsigned int i = vertex_count; i > 0; --i) {
+        edge_offsets_[i] = edge_offsets_[i - 1];
+        triangle_offsets_[i] = triangle_offsets_[i - 1];
+    }
+    edge_offsets_[0] = 0;
+    triangle_offsets_[0] = 0;
+}
+
+bool MeshSimplifier::hasEdge(unsigned int from, unsigned int to) const {
+    for (unsigned int i = edge_offsets_[from]; i < edge_offsets_[from + 1];
+            ++i) {
+        if (edges_[i] == to) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/*
+ * An edge is open when the triangles only use it in one direction. A
+ * position is a seam when its two vertices each have one open edge in and
+ * one out, running between the same positions in opposite directions.
+ */
+void MeshSimplifier::classifyVertices() {
+    unsigned int vertex_count = positions_.size();
+    std::vector<unsigned int> open_in(vertex_count, NO_VERTEX);
+    std::vector<unsigned int> open_out(vertex_count, NO_VERTEX);
+    for (unsigned int from = 0; from < vertex_count; ++from) {
+        for (unsigned int i = edge_offsets_[from];
+                i < edge_offsets_[from + 1]; ++i) {
+            unsigned int to = edges_[i];
+            if (!hasEdge(to, from)) {
+                open_out[from] = open_out[from] == NO_VERTEX ?
+                        to : MANY_VERTICES;
+                open_in[to] = open_in[to] == NO_VERTEX ? from : MANY_VERTICES;
+            }
+        }
+    }
+
+    kinds_.assign(vertex_count, Locked);
+    for (unsigned int v = 0; v < vertex_count; ++v) {
+        if (remap_[v] != v) {
+            continue;
+        }
+
+        unsigned char kind = Locked;
+        if (wedge_[v] == v) {
+            if (open_in[v] == NO_VERTEX && open_out[v] == NO_VERTEX) {
+                kind = Manifold;
+            } else if (open_in[v] < MANY_VERTICES
+                    && open_out[v] < MANY_VERTICES) {
+                kind = Border;
+            }
+        } else if (wedge_[wedge_[v]] == v) {
+            unsigned int w = wedge_[v];
+            if (open_in[v] < MANY_VERTICES && open_out[v] < MANY_VERTICES
+                    && open_in[w] < MANY_VERTICES && open_out[w] < MANY_VERTICES
+                    && remap_[open_out[v]] == remap_[open_in[w]]
+                    && remap_[open_in[v]] == remap_[open_out[w]]) {
+                kind = Seam;
+            }
+        }
+
+        unsigned int w = v;
+        do {
+            kinds_[w] = kind;
+            w = wedge_[w];
+        } while (w != v);
+    }
+}
+
+void MeshSimplifier::buildQuadrics() {
+    quadrics_.assign(positions_.size(), Quadric());
+
+    for (unsigned int i = 0; i < triangles_.size(); i += 3) {
+        unsigned int corners[3] = { triangles_[i], triangles_[i + 1],
+                triangles_[i + 2] };
+        const glm::vec3& p0 = positions_[corners[0]];
+        glm::vec3 normal(
+                glm::cross(positions_[corners[1]] - p0,
+                        positions_[corners[2]] - p0));
+        float length = glm::length(normal);
+        if (length == 0.0f) {
+            continue;
+        }
+        normal /= length;
+
+        float distance = -glm::dot(normal, p0);
+        for (int k = 0; k < 3; ++k) {
+            addPlane(quadrics_[remap_[corners[k]]], normal, distance,
+                    length * 0.5f);
+        }
+
+        // open edges get a plane through them, at right angles to the
+        // triangle, which keeps their vertices from sliding off the edge
+        for (int k = 0; k < 3; ++k) {
+            unsigned int from = corners[k];
+            unsigned int to = corners[(k + 1) % 3];
+            if (hasEdge(to, from)) {
+                continue;
+            }
+            glm::vec3 edge(positions_[to] - positions_[from]);
+            float edge_length = glm::length(edge);
+            if (edge_length == 0.0f) {
+                continue;
+            }
+            glm::vec3 edge_normal(
+                    glm::normalize(glm::cross(edge, normal)));
+            float edge_distance = -glm::dot(edge_normal, positions_[from]);
+            float weight = edge_length * edge_length * BORDER_WEIGHT;
+            addPlane(quadrics_[remap_[from]], edge_normal, edge_distance,
+                    weight);
+            addPlane(quadrics_[remap_[to]], edge_normal, edge_distance,
+                    weight);
+        }
+    }
+}
+
+void MeshSimplifier::pickCollapses() {
+    collapses_.clear();
+
+    for (unsigned int i = 0; i < triangles_.size(); ++i) {
+        unsigned int v0 = triangles_[i];
+        unsigned int v1 = triangles_[i % 3 == 2 ? i - 2 : i + 1];
+
+        // edges inside a chart are seen from both triangles
+        if (v0 > v1 && hasEdge(v1, v0)) {
+            continue;
+        }
+
+        bool forward = canCollapse(v0, v1);
+        bool backward = canCollapse(v1, v0);
+        if (!forward && !backward) {
+            continue;
+        }
+
+        Collapse collapse;
+        float forward_error =
+                forward ?
+                        evaluate(quadrics_[remap_[v0]], positions_[v1]) :
+                        0.0f;
+        float backward_error =
+                backward ?
+                        evaluate(quadrics_[remap_[v1]], positions_[v0]) :
+                        0.0f;
+        if (forward && (!backward || forward_error <= backward_error)) {
+            collapse.from = v0;
+            collapse.to = v1;
+            collapse.error = forward_error;
+        } else {
+            collapse.from = v1;
+            collapse.to = v0;
+            collapse.error = backward_error;
+        }
+        collapses_.push_back(collapse);
+    }
+}
+
+bool MeshSimplifier::canCollapse(unsigned int from, unsigned int to) const {
+    unsigned char kind = kinds_[from];
+    if (kind == Manifold) {
+        return true;
+    }
+    if (kind == Locked || kinds_[to] != kind) {
+        return false;
+    }
+
+    // borders and seams only collapse along themselves
+    if (hasEdge(from, to) == hasEdge(to, from)) {
+        return false;
+    }
+    if (kind == Seam) {
+        unsigned int other_from = wedge_[from];
+        unsigned int other_to = wedge_[to];
+        return hasEdge(other_from, other_to) != hasEdge(other_to, other_from);
+    }
+    return true;
+}
+
+/*
+ * A collapse must not turn any triangle around the moved position over,
+ * nor join two positions that share a neighbor without sharing a triangle,
+ * which would pinch the surface.
+ */
+bool MeshSimplifier::damagesSurface(unsigned int from, unsigned int to) const {
+    unsigned int r0 = remap_[from];
+    unsigned int r1 = remap_[to];
+    const glm::vec3& target = positions_[to];
+
+    int shared_triangles = 0;
+    for (unsigned int i = triangle_offsets_[r0];
+            i < triangle_offsets_[r0 + 1]; ++i) {
+        const unsigned short* corners = &triangles_[vertex_triangles_[i] * 3];
+        int k = 0;
+        while (remap_[corners[k]] != r0) {
+            ++k;
+        }
+        unsigned int next = corners[(k + 1) % 3];
+        unsigned int previous = corners[(k + 2) % 3];
+        if (remap_[next] == r1 || remap_[previous] == r1) {
+            ++shared_triangles;
+            continue;
+        }
+
+        const glm::vec3& p0 = positions_[corners[k]];
+        const glm::vec3& p1 = positions_[next];
+        const glm::vec3& p2 = positions_[previous];
+        glm::vec3 normal(glm::cross(p1 - p0, p2 - p0));
+        glm::vec3 moved_normal(glm::cross(p1 - target, p2 - target));
+        // turning by more than about 75 degrees is taken as a flip, which
+        // also keeps slivers out
+        float turn = glm::dot(normal, moved_normal);
+        if (turn <= MAX_TURN_COSINE * glm::length(normal)
+                * glm::length(moved_normal)) {
+            return true;
+        }
+    }
+
+    int common_neighbors = 0;
+    for (unsigned int i = triangle_offsets_[r0];
+            i < triangle_offsets_[r0 + 1]; ++i) {
+        const unsigned short* corners = &triangles_[vertex_triangles_[i] * 3];
+        for (int k = 0; k < 3; ++k) {
+            unsigned int neighbor = remap_[corners[k]];
+            if (neighbor == r0 || neighbor == r1) {
+                continue;
+            }
+
+            // count each neighbor once, at its first triangle around r0
+            bool seen = false;
+            for (unsigned int j = triangle_offsets_[r0]; j < i && !seen;
+                    ++j) {
+                const unsigned short* other =
+                        &triangles_[vertex_triangles_[j] * 3];
+                seen = remap_[other[0]] == neighbor
+                        || remap_[other[1]] == neighbor
+                        || remap_[other[2]] == neighbor;
+            }
+            for (int m = 0; m < k && !seen; ++m) {
+                seen = remap_[corners[m]] == neighbor;
+            }
+            if (seen) {
+                continue;
+            }
+
+            for (unsigned int j = triangle_offsets_[r1];
+                    j < triangle_offsets_[r1 + 1]; ++j) {
+                const unsigned short* other =
+                        &triangles_[vertex_triangles_[j] * 3];
+                if (remap_[other[0]] == neighbor
+                        || remap_[other[1]] == neighbor
+                        || remap_[other[2]] == neighbor) {
+                    ++common_neighbors;
+                    break;
+                }
+            }
+        }
+    }
+    return common_neighbors > shared_triangles;
+}
+
+/*
+ * Applies the collapses of this pass and returns the number of triangles
+ * they remove.
+ */
+int MeshSimplifier::applyCollapses(int triangle_goal) {
+    if (collapses_.empty()) {
+        return 0;
+    }
+
+    std::sort(collapses_.begin(), collapses_.end(),
+            [](const Collapse& a, const Collapse& b) {
+                return a.error < b.error;
+            });
+
+    // every edge collapse removes about two triangles, and about half of
+    // the collapses picked are skipped for touching an earlier one
+    unsigned int error_index = std::min(
+            static_cast<unsigned int>(collapses_.size() - 1),
+            static_cast<unsigned int>(triangle_goal));
+    float error_limit = collapses_[error_index].error;
+
+    unsigned int vertex_count = positions_.size();
+    collapse_remap_.resize(vertex_count);
+    for (unsigned int i = 0; i < vertex_count; ++i) {
+        collapse_remap_[i] = i;
+    }
+    collapse_locked_.assign(vertex_count, false);
+
+    int removed = 0;
+    for (auto it = collapses_.begin();
+            it != collapses_.end() && removed < triangle_goal; ++it) {
+        if (it->error > error_limit) {
+            break;
+        }
+
+        unsigned int r0 = remap_[it->from];
+        unsigned int r1 = remap_[it->to];
+        if (collapse_locked_[r0] || collapse_locked_[r1]
+                || damagesSurface(it->from, it->to)) {
+            continue;
+        }
+
+        collapse_remap_[it->from] = it->to;
+        if (kinds_[it->from] == Seam) {
+            collapse_remap_[wedge_[it->from]] = wedge_[it->to];
+        }
+        addQuadric(quadrics_[r1], quadrics_[r0]);
+        max_error_ = std::max(max_error_, it->error);
+
+        // nothing touching the triangles around the collapse moves again in
+        // this pass, so that the flip tests above stay exact
+        for (unsigned int i = triangle_offsets_[r0];
+                i < triangle_offsets_[r0 + 1]; ++i) {
+            const unsigned short* corners =
+                    &triangles_[vertex_triangles_[i] * 3];
+            bool removes = false;
+            for (int k = 0; k < 3; ++k) {
+                collapse_locked_[remap_[corners[k]]] = true;
+                removes = removes || remap_[corners[k]] == r1;
+            }
+            if (removes) {
+                ++removed;
+            }
+        }
+        collapse_locked_[r1] = true;
+    }
+    return removed;
+}
+
+void MeshSimplifier::remapTriangles() {
+    unsigned int write = 0;
+    for (unsigned int i = 0; i < triangles_.size(); i += 3) {
+        unsigned int v0 = collapse_remap_[triangles_[i]];
+        unsigned int v1 = collapse_remap_[triangles_[i + 1]];
+        unsigned int v2 = collapse_remap_[triangles_[i + 2]];
+        if (remap_[v0] == remap_[v1] || remap_[v1] == remap_[v2]
+                || remap_[v2] == remap_[v0]) {
+            continue;
+        }
+        triangles_[write++] = v0;
+        triangles_[write++] = v1;
+        triangles_[write++] = v2;
+    }
+    triangles_.resize(write);
+}
+
+void MeshSimplifier::addPlane(Quadric& quadric, const glm::vec3& normal,
+        float distance, float weight) {
+    quadric.a00 += weight * normal.x * normal.x;
+    quadric.a11 += weight * normal.y * normal.y;
+    quadric.a22 += weight * normal.z * normal.z;
+    quadric.a10 += weight * normal.y * normal.x;
+    quadric.a20 += weight * normal.z * normal.x;
+    quadric.a21 += weight * normal.z * normal.y;
+    quadric.b0 += weight * normal.x * distance;
+    quadric.b1 += weight * normal.y * distance;
+    quadric.b2 += weight * normal.z * distance;
+    quadric.c += weight * distance * distance;
+    quadric.weight += weight;
+}
+
+void MeshSimplifier::addQuadric(Quadric& quadric, const Quadric& other) {
+    quadric.a00 += other.a00;
+    quadric.a11 += other.a11;
+    quadric.a22 += other.a22;
+    quadric.a10 += other.a10;
+    quadric.a20 += other.a20;
+    quadric.a21 += other.a21;
+    quadric.b0 += other.b0;
+    quadric.b1 += other.b1;
+    quadric.b2 += other.b2;
+    quadric.c += other.c;
+    quadric.weight += other.weight;
+}
+
+// the mean squared distance to the planes of the quadric
+float MeshSimplifier::evaluate(const Quadric& quadric,
+        const glm::vec3& point) {
+    float x = point.x;
+    float y = point.y;
+    float z = point.z;
+    float ax = quadric.a00 * x + quadric.a10 * y + quadric.a20 * z;
+    float ay = quadric.a10 * x + quadric.a11 * y + quadric.a21 * z;
+    float az = quadric.a20 * x + quadric.a21 * y + quadric.a22 * z;
+    float error = x * ax + y * ay + z * az
+            + 2.0f * (quadric.b0 * x + quadric.b1 * y + quadric.b2 * z)
+            + quadric.c;
+    return quadric.weight > 0.0f ? fabsf(error) / quadric.weight : 0.0f;
+}
+
+}
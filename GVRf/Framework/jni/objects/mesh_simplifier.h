@@ -0,0 +1,137 @@
+/* Copyright 2015 Samsung Electronics Co., LTD
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/***************************************************************************
+ * Quadric error edge collapse simplification of a mesh.
+ ***************************************************************************/
+
+#ifndef MESH_SIMPLIFIER_H_
+#define MESH_SIMPLIFIER_H_
+
+#include <vector>
+
+#include "glm/glm.hpp"
+
+namespace gvr {
+class Mesh;
+
+/*
+ * Reduces the triangles of a mesh by collapsing edges into one of their
+ * vertices, cheapest first by the quadric error metric: the sum of squared
+ * distances to the planes of the triangles merged into a vertex.
+ *
+ * Vertices sharing a position are treated as one, so normal and texture
+ * coordinate seams do not tear. A seam vertex, a position with exactly two
+ * vertices joined along a seam, only collapses along the seam, moving both
+ * of its vertices. A vertex on an open border only collapses along the
+ * border. Positions with more vertices, or where seams or borders meet, are
+ * never moved. Vertices are only moved onto other vertices, so every vertex
+ * keeps its own normal, texture coordinates and attributes.
+ *
+ * Simplifying continues from where the last call stopped, so calls with
+ * decreasing targets give a chain of levels of detail.
+ */
+class MeshSimplifier {
+public:
+    explicit MeshSimplifier(const Mesh& mesh);
+    ~MeshSimplifier() {
+    }
+
+    // Collapses edges until no more than target_triangle_count triangles
+    // are left, or no edge can be collapsed.
+    void simplify(int target_triangle_count);
+
+    // the triangles left, indexing the vertices of the mesh
+    const std::vector<unsigned short>& triangles() const {
+        return triangles_;
+    }
+
+    // the largest distance, in mesh units, collapses have moved the surface
+    // by so far, as estimated by the quadrics
+    float error() const;
+
+private:
+    MeshSimplifier(const MeshSimplifier& mesh_simplifier);
+    MeshSimplifier(MeshSimplifier&& mesh_simplifier);
+    MeshSimplifier& operator=(const MeshSimplifier& mesh_simplifier);
+    MeshSimplifier& operator=(MeshSimplifier&& mesh_simplifier);
+
+    enum VertexKind {
+        Manifold, Border, Seam, Locked
+    };
+
+    // symmetric matrix A, vector b and constant c of the error
+    // p A p + 2 b p + c, summed over planes of total weight
+    struct Quadric {
+        float a00, a11, a22, a10, a20, a21;
+        float b0, b1, b2;
+        float c;
+        float weight;
+    };
+
+    struct Collapse {
+        unsigned int from;
+        unsigned int to;
+        float error;
+    };
+
+    void buildPositionRemap();
+    void buildAdjacency();
+    bool hasEdge(unsigned int from, unsigned int to) const;
+    void classifyVertices();
+    void buildQuadrics();
+    void pickCollapses();
+    bool canCollapse(unsigned int from, unsigned int to) const;
+    bool damagesSurface(unsigned int from, unsigned int to) const;
+    int applyCollapses(int triangle_goal);
+    void remapTriangles();
+
+    static void addPlane(Quadric& quadric, const glm::vec3& normal,
+            float distance, float weight);
+    static void addQuadric(Quadric& quadric, const Quadric& other);
+    static float evaluate(const Quadric& quadric, const glm::vec3& point);
+
+private:
+    static const unsigned int NO_VERTEX = ~0u;
+    static const unsigned int MANY_VERTICES = ~1u;
+
+    // positions scaled into the unit cube, which keeps the quadrics well
+    // conditioned
+    std::vector<glm::vec3> positions_;
+    float scale_;
+
+    // first vertex with the same position, and the next one in the ring of
+    // vertices sharing it
+    std::vector<unsigned int> remap_;
+    std::vector<unsigned int> wedge_;
+    std::vector<unsigned char> kinds_;
+    std::vector<Quadric> quadrics_;
+    std::vector<unsigned short> triangles_;
+
+    // outgoing half-edges of each vertex, and triangles around each
+    // position, for the current triangles
+    std::vector<unsigned int> edge_offsets_;
+    std::vector<unsigned int> edges_;
+    std::vector<unsigned int> triangle_offsets_;
+    std::vector<unsigned int> vertex_triangles_;
+
+    std::vector<Collapse> collapses_;
+    std::vector<unsigned int> collapse_remap_;
+    std::vector<bool> collapse_locked_;
+    float max_error_;
+};
+
+}
+#endif
@@ -21,7 +21,6 @@
 #ifndef COLOR_BLEND_POST_EFFECT_H_
 #define COLOR_BLEND_POST_EFFECT_H_
 
-#include <map>
 #include <memory>
 #include <string>
 
@@ -29,6 +28,7 @@
 #include "glm/gtc/type_ptr.hpp"
 
 #include "objects/hybrid_object.h"
+#include "objects/property_block.h"
 
 namespace gvr {
 class Texture;
@@ -40,13 +40,13 @@ public:
     };
 
     PostEffectData(ShaderType shader_type) :
-            shader_type_(shader_type), textures_(), floats_(), vec2s_(), vec3s_(), vec4s_(), mat4s_() {
+            shader_type_(shader_type), properties_("PostEffectData") {
         switch (shader_type) {
         case COLOR_BLEND_SHADER:
-            floats_["r"] = 0.0f;
-            floats_["g"] = 0.0f;
-            floats_["b"] = 0.0f;
-            floats_["factor"] = 0.0f;
+            properties_.setFloat(PropertyBlock::BLEND_R, 0.0f);
+            properties_.setFloat(PropertyBlock::BLEND_G, 0.0f);
+            properties_.setFloat(PropertyBlock::BLEND_B, 0.0f);
+            properties_.setFloat(PropertyBlock::BLEND_FACTOR, 0.0f);
             break;
         }
     }
@@ -62,94 +62,81 @@ public:
         shader_type_ = shader_type;
     }
 
-    Texture* getTexture(std::string key) const {
-        auto it = textures_.find(key);
-        if (it != textures_.end()) {
-            return it->second;
-        } else {
-            std::string error = "PostEffectData::getTexture() : " + key
-                    + " not found";
-            throw error;
-        }
+    const PropertyBlock& properties() const {
+        return properties_;
     }
 
-    void setTexture(std::string key, Texture* texture) {
-        textures_[key] = texture;
+    // null if not set
+    Texture* getTexture(int id) const {
+        return properties_.findTexture(id);
     }
 
-    float getFloat(std::string key) {
-        auto it = floats_.find(key);
-        if (it != floats_.end()) {
-            return it->second;
-        } else {
-            std::string error = "PostEffectData::getFloat() : " + key
-                    + " not found";
-            throw error;
-        }
+    Texture* getTexture(const std::string& key) const {
+        return properties_.getTexture(key);
     }
 
-    void setFloat(std::string key, float value) {
-        floats_[key] = value;
+    void setTexture(const std::string& key, Texture* texture) {
+        properties_.setTexture(PropertyBlock::id(key), texture);
     }
 
-    glm::vec2 getVec2(std::string key) {
-        auto it = vec2s_.find(key);
-        if (it != vec2s_.end()) {
-            return it->second;
-        } else {
-            std::string error = "PostEffectData::getVec2() : " + key
-                    + " not found";
-            throw error;
-        }
+    bool getFloat(int id, float& value) const {
+        return properties_.getFloat(id, value);
     }
 
-    void setVec2(std::string key, glm::vec2 vector) {
-        vec2s_[key] = vector;
+    float getFloat(const std::string& key) const {
+        return properties_.getFloat(key);
     }
 
-    glm::vec3 getVec3(std::string key) {
-        auto it = vec3s_.find(key);
-        if (it != vec3s_.end()) {
-            return it->second;
-        } else {
-            std::string error = "PostEffectData::getVec3() : " + key
-                    + " not found";
-            throw error;
-        }
+    void setFloat(const std::string& key, float value) {
+        properties_.setFloat(PropertyBlock::id(key), value);
     }
 
-    void setVec3(std::string key, glm::vec3 vector) {
-        vec3s_[key] = vector;
+    bool getVec2(int id, glm::vec2& vector) const {
+        return properties_.getVec2(id, vector);
     }
 
-    glm::vec4 getVec4(std::string key) {
-        auto it = vec4s_.find(key);
-        if (it != vec4s_.end()) {
-            return it->second;
-        } else {
-            std::string error = "PostEffectData::getVec4() : " + key
-                    + " not found";
-            throw error;
-        }
+    glm::vec2 getVec2(const std::string& key) const {
+        return properties_.getVec2(key);
     }
 
-    void setVec4(std::string key, glm::vec4 vector) {
-        vec4s_[key] = vector;
+    void setVec2(const std::string& key, glm::vec2 vector) {
+        properties_.setVec2(PropertyBlock::id(key), vector);
     }
 
-    glm::mat4 getMat4(std::string key) {
-        auto it = mat4s_.find(key);
-        if (it != mat4s_.end()) {
-            return it->second;
-        } else {
-            std::string error = "PostEffectData::getMat4() : " + key
-                    + " not found";
-            throw error;
-        }
+    bool getVec3(int id, glm::vec3& vector) const {
+        return properties_.getVec3(id, vector);
+    }
+
+    glm::vec3 getVec3(const std::string& key) const {
+        return properties_.getVec3(key);
+    }
+
+    void setVec3(const std::string& key, glm::vec3 vector) {
+        properties_.setVec3(PropertyBlock::id(key), vector);
+    }
+
+    bool getVec4(int id, glm::vec4& vector) const {
+        return properties_.getVec4(id, vector);
+    }
+
+    glm::vec4 getVec4(const std::string& key) const {
+        return properties_.getVec4(key);
+    }
+
+    void setVec4(const std::string& key, glm::vec4 vector) {
+        properties_.setVec4(PropertyBlock::id(key), vector);
+    }
+
+    bool getMat4(int id, glm::mat4& matrix) const {
+        return properties_.getMat4(id, matrix);
+    }
+
+    glm::mat4 getMat4(const std::string& key) const {
+        return properties_.getMat4(key);
     }
 
-    void setMat4(std::string key, glm::mat4 mat) {
-        mat4s_[key] = mat;
+    void setMat4(const std::string& key, glm::mat4 mat) {
+        properties_.setMat4(PropertyBlock::id(key), mat);
     }
 
 private:
@@ -160,12 +147,7 @@ private:
 
 private:
     ShaderType shader_type_;
-    std::map<std::string, Texture*> textures_;
-    std::map<std::string, float> floats_;
-    std::map<std::string, glm::vec2> vec2s_;
-    std::map<std::string, glm::vec3> vec3s_;
-    std::map<std::string, glm::vec4> vec4s_;
-    std::map<std::string, glm::mat4> mat4s_;
+    PropertyBlock properties_;
 };
 
 }
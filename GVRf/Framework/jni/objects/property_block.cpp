@@ -0,0 +1,113 @@
+/* Copyright 2015 Samsung Electronics Co., LTD
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/***************************************************************************
+ * Named shader properties, stored by interned id.
+ ***************************************************************************/
+
+#include "property_block.h"
+
+#include <map>
+#include <mutex>
+
+namespace gvr {
+
+std::atomic<unsigned int> PropertyBlock::last_version_(0);
+
+// in the order of PropertyBlock::BuiltInId
+static const char* BUILT_IN_NAMES[] = { "main_texture", "color", "opacity",
+        "mono_rendering", "ambient_color", "diffuse_color", "specular_color",
+        "specular_exponent", "position", "ambient_intensity",
+        "diffuse_intensity", "specular_intensity", "r", "g", "b", "factor" };
+
+namespace {
+struct NameTable {
+    NameTable() {
+        for (int i = 0; i < PropertyBlock::BUILT_IN_ID_COUNT; ++i) {
+            ids[BUILT_IN_NAMES[i]] = i;
+            names.push_back(BUILT_IN_NAMES[i]);
+        }
+    }
+
+    std::mutex lock;
+    std::map<std::string, int> ids;
+    std::vector<std::string> names;
+};
+}
+
+static NameTable& name_table() {
+    static NameTable table;
+    return table;
+}
+
+int PropertyBlock::id(const std::string& name) {
+    NameTable& table = name_table();
+    std::lock_guard<std::mutex> lock(table.lock);
+    auto it = table.ids.find(name);
+    if (it != table.ids.end()) {
+        return it->second;
+    }
+    int id = table.names.size();
+    table.ids[name] = id;
+    table.names.push_back(name);
+    return id;
+}
+
+void PropertyBlock::setTexture(int id, Texture* texture) {
+    auto it = std::lower_bound(textures_.begin(), textures_.end(), id,
+            slotBefore<TextureSlot>);
+    if (it == textures_.end() || it->id != id) {
+        TextureSlot slot = { id, 0 };
+        it = textures_.insert(it, slot);
+    }
+    it->texture = texture;
+    version_ = nextVersion();
+}
+
+float* PropertyBlock::set(int id, int size) {
+    version_ = nextVersion();
+    auto it = std::lower_bound(slots_.begin(), slots_.end(), id,
+            slotBefore<Slot>);
+    if (it != slots_.end() && it->id == id) {
+        if (it->size == static_cast<unsigned int>(size)) {
+            return &data_[it->offset];
+        }
+        // a value of another size frees its floats and goes to the end
+        unsigned int offset = it->offset;
+        unsigned int old_size = it->size;
+        data_.erase(data_.begin() + offset, data_.begin() + offset + old_size);
+        for (auto slot = slots_.begin(); slot != slots_.end(); ++slot) {
+            if (slot->offset > offset) {
+                slot->offset -= old_size;
+            }
+        }
+    } else {
+        Slot slot = { id, 0, 0 };
+        it = slots_.insert(it, slot);
+    }
+    it->offset = data_.size();
+    it->size = size;
+    data_.resize(data_.size() + size, 0.0f);
+    return &data_[it->offset];
+}
+
+void PropertyBlock::notFound(const char* getter,
+        const std::string& key) const {
+    std::string error = std::string(owner_) + "::" + getter + "() : " + key
+            + " not found";
+    throw error;
+}
+
+}
@@ -0,0 +1,289 @@
+/* Copyright 2015 Samsung Electronics Co., LTD
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/***************************************************************************
+ * Named shader properties, stored by interned id.
+ ***************************************************************************/
+
+#ifndef PROPERTY_BLOCK_H_
+#define PROPERTY_BLOCK_H_
+
+#include <algorithm>
+#include <atomic>
+#include <string>
+#include <vector>
+
+#include "glm/glm.hpp"
+
+namespace gvr {
+class Texture;
+
+/*
+ * The floats, vectors, matrices and textures of a material, light or post
+ * effect.
+ *
+ * Property names are interned once into small integer ids, shared by all
+ * blocks; the names the built-in shaders use have fixed ids. Each block
+ * keeps its values in one contiguous array of floats, and a table of the
+ * ids it holds, sorted by id, telling where in the array each value is and
+ * how many floats it has; a block only grows with the properties it holds.
+ * A name holds a single value: setting it with another type replaces the
+ * old value and frees its floats.
+ *
+ * The getters by id, which the shaders call for every draw, return whether
+ * the property is set. The getters by name, which Java calls, throw a
+ * string if it is not, like the maps they replace did.
+ *
+ * Every change gives the block a new version, unique across all blocks, so
+ * a shader can tell that the values it last uploaded are still current.
+ */
+class PropertyBlock {
+public:
+    enum BuiltInId {
+        MAIN_TEXTURE = 0,
+        COLOR,
+        OPACITY,
+        MONO_RENDERING,
+        AMBIENT_COLOR,
+        DIFFUSE_COLOR,
+        SPECULAR_COLOR,
+        SPECULAR_EXPONENT,
+        POSITION,
+        AMBIENT_INTENSITY,
+        DIFFUSE_INTENSITY,
+        SPECULAR_INTENSITY,
+        BLEND_R,
+        BLEND_G,
+        BLEND_B,
+        BLEND_FACTOR,
+        BUILT_IN_ID_COUNT
+    };
+
+    // owner names the class in the errors the getters by name throw
+    explicit PropertyBlock(const char* owner) :
+            owner_(owner), version_(nextVersion()), slots_(), data_(),
+            textures_() {
+    }
+
+    ~PropertyBlock() {
+    }
+
+    // the id of a name, interned on first use; safe on any thread
+    static int id(const std::string& name);
+
+    unsigned int version() const {
+        return version_;
+    }
+
+    const float* findFloats(int id, int size) const {
+        const Slot* slot = findSlot(slots_, id);
+        if (slot != 0 && slot->size == static_cast<unsigned int>(size)) {
+            return &data_[slot->offset];
+        }
+        return 0;
+    }
+
+    const float* findFloat(int id) const {
+        return findFloats(id, 1);
+    }
+
+    Texture* findTexture(int id) const {
+        const TextureSlot* slot = findSlot(textures_, id);
+        return slot != 0 ? slot->texture : 0;
+    }
+
+    bool getTexture(int id, Texture*& texture) const {
+        texture = findTexture(id);
+        return texture != 0;
+    }
+
+    Texture* getTexture(const std::string& key) const {
+        Texture* texture;
+        if (!getTexture(id(key), texture)) {
+            notFound("getTexture", key);
+        }
+        return texture;
+    }
+
+    void setTexture(int id, Texture* texture);
+
+    bool getFloat(int id, float& value) const {
+        const float* floats = findFloats(id, 1);
+        if (floats == 0) {
+            return false;
+        }
+        value = floats[0];
+        return true;
+    }
+
+    float getFloat(const std::string& key) const {
+        float value;
+        if (!getFloat(id(key), value)) {
+            notFound("getFloat", key);
+        }
+        return value;
+    }
+
+    void setFloat(int id, float value) {
+        *set(id, 1) = value;
+    }
+
+    bool getVec2(int id, glm::vec2& vector) const {
+        const float* value = findFloats(id, 2);
+        if (value == 0) {
+            return false;
+        }
+        vector = glm::vec2(value[0], value[1]);
+        return true;
+    }
+
+    glm::vec2 getVec2(const std::string& key) const {
+        glm::vec2 vector;
+        if (!getVec2(id(key), vector)) {
+            notFound("getVec2", key);
+        }
+        return vector;
+    }
+
+    void setVec2(int id, const glm::vec2& vector) {
+        float* value = set(id, 2);
+        value[0] = vector.x;
+        value[1] = vector.y;
+    }
+
+    bool getVec3(int id, glm::vec3& vector) const {
+        const float* value = findFloats(id, 3);
+        if (value == 0) {
+            return false;
+        }
+        vector = glm::vec3(value[0], value[1], value[2]);
+        return true;
+    }
+
+    glm::vec3 getVec3(const std::string& key) const {
+        glm::vec3 vector;
+        if (!getVec3(id(key), vector)) {
+            notFound("getVec3", key);
+        }
+        return vector;
+    }
+
+    void setVec3(int id, const glm::vec3& vector) {
+        float* value = set(id, 3);
+        value[0] = vector.x;
+        value[1] = vector.y;
+        value[2] = vector.z;
+    }
+
+    bool getVec4(int id, glm::vec4& vector) const {
+        const float* value = findFloats(id, 4);
+        if (value == 0) {
+            return false;
+        }
+        vector = glm::vec4(value[0], value[1], value[2], value[3]);
+        return true;
+    }
+
+    glm::vec4 getVec4(const std::string& key) const {
+        glm::vec4 vector;
+        if (!getVec4(id(key), vector)) {
+            notFound("getVec4", key);
+        }
+        return vector;
+    }
+
+    void setVec4(int id, const glm::vec4& vector) {
+        float* value = set(id, 4);
+        value[0] = vector.x;
+        value[1] = vector.y;
+        value[2] = vector.z;
+        value[3] = vector.w;
+    }
+
+    bool getMat4(int id, glm::mat4& matrix) const {
+        const float* value = findFloats(id, 16);
+        if (value == 0) {
+            return false;
+        }
+        for (int i = 0; i < 16; ++i) {
+            matrix[i / 4][i % 4] = value[i];
+        }
+        return true;
+    }
+
+    glm::mat4 getMat4(const std::string& key) const {
+        glm::mat4 matrix;
+        if (!getMat4(id(key), matrix)) {
+            notFound("getMat4", key);
+        }
+        return matrix;
+    }
+
+    void setMat4(int id, const glm::mat4& matrix) {
+        float* value = set(id, 16);
+        for (int i = 0; i < 16; ++i) {
+            value[i] = matrix[i / 4][i % 4];
+        }
+    }
+
+private:
+    PropertyBlock(const PropertyBlock& property_block);
+    PropertyBlock(PropertyBlock&& property_block);
+    PropertyBlock& operator=(const PropertyBlock& property_block);
+    PropertyBlock& operator=(PropertyBlock&& property_block);
+
+    static unsigned int nextVersion() {
+        return ++last_version_;
+    }
+
+    // a block holds a handful of properties, so a binary search is cheap
+    template<class T>
+    static const T* findSlot(const std::vector<T>& slots, int id) {
+        auto it = std::lower_bound(slots.begin(), slots.end(), id,
+                slotBefore<T>);
+        return it != slots.end() && it->id == id ? &*it : 0;
+    }
+
+    template<class T>
+    static bool slotBefore(const T& slot, int id) {
+        return slot.id < id;
+    }
+
+    float* set(int id, int size);
+    void notFound(const char* getter, const std::string& key) const;
+
+private:
+    struct Slot {
+        int id;
+        unsigned int offset;
+        unsigned int size;
+    };
+
+    struct TextureSlot {
+        int id;
+        Texture* texture;
+    };
+
+    static std::atomic<unsigned int> last_version_;
+
+    const char* owner_;
+    unsigned int version_;
+    std::vector<Slot> slots_; // sorted by id
+    std::vector<float> data_;
+    std::vector<TextureSlot> textures_; // sorted by id
+};
+
+}
+#endif
@@ -20,6 +20,8 @@
 #ifndef RENDER_PASS_H_
 #define RENDER_PASS_H_
 
+#include <atomic>
+
 #include "objects/hybrid_object.h"
 
 namespace gvr {
@@ -42,6 +44,13 @@ public:
 
     void set_material(Material* material) {
         material_ = material;
+        material_epoch_.fetch_add(1);
+    }
+
+    // bumped whenever any pass changes material, so that static batches
+    // can tell when to check the materials they were baked with
+    static unsigned int material_epoch() {
+        return material_epoch_.load();
     }
 
     int cull_face() const {
@@ -57,6 +66,7 @@ private:
     static const int DEFAULT_CULL_FACE = CullBack;
     Material* material_;
     int cull_face_;
+    static std::atomic<unsigned int> material_epoch_;
 };
 
 }
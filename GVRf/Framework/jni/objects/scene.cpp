@@ -19,12 +19,15 @@
 
 #include "scene.h"
 
+#include "objects/mesh.h"
 #include "objects/scene_object.h"
+#include "util/gvr_profiler.h"
 
 namespace gvr {
 Scene::Scene() :
-        HybridObject(), scene_objects_(), main_camera_rig_(), frustum_flag_(
-                false), dirtyFlag_(0), occlusion_flag_(false) {
+        HybridObject(), scene_objects_(), main_camera_rig_(), render_list_(), render_list_epoch_(
+                0), mesh_bounding_volume_epoch_(0), frustum_flag_(false), occlusion_flag_(
+                false), occluder_flag_(false), cull_thread_count_(0) {
 }
 
 Scene::~Scene() {
@@ -32,12 +35,14 @@ Scene::~Scene() {
 
 void Scene::addSceneObject(SceneObject* scene_object) {
     scene_objects_.push_back(scene_object);
+    SceneObject::dirtyRenderList();
 }
 
 void Scene::removeSceneObject(SceneObject* scene_object) {
     scene_objects_.erase(
             std::remove(scene_objects_.begin(), scene_objects_.end(),
                     scene_object), scene_objects_.end());
+    SceneObject::dirtyRenderList();
 }
 
 std::vector<SceneObject*> Scene::getWholeSceneObjects() {
@@ -52,4 +57,37 @@ std::vector<SceneObject*> Scene::getWholeSceneObjects() {
     return scene_objects;
 }
 
+/*
+ * Cached world-space bounds are dirtied by transform and hierarchy changes
+ * directly. Mesh changes are only detected here, once per frame, and only
+ * when some mesh actually changed since the last call.
+ */
+void Scene::updateMeshBoundingVolumes() {
+    unsigned int epoch = Mesh::bounding_volume_epoch();
+    if (epoch == mesh_bounding_volume_epoch_) {
+        return;
+    }
+
+    for (auto it = scene_objects_.begin(); it != scene_objects_.end(); ++it) {
+        (*it)->dirtyChangedMeshBoundingVolumes();
+    }
+    mesh_bounding_volume_epoch_ = epoch;
+}
+
+/*
+ * The epoch is shared by all scenes, so a change to one scene also makes
+ * the others collect their lists again, which only costs a walk of their
+ * scene graphs.
+ */
+void Scene::updateRenderList(RenderSorter& render_sorter) {
+    GVR_PROFILE("update render list");
+    unsigned int epoch = SceneObject::render_list_epoch();
+    if (epoch == render_list_epoch_) {
+        return;
+    }
+
+    render_list_.update(scene_objects_, render_sorter);
+    render_list_epoch_ = epoch;
+}
+
 }
@@ -27,6 +27,7 @@
 
 #include "objects/hybrid_object.h"
 #include "components/camera_rig.h"
+#include "engine/renderer/render_list.h"
 #include "engine/renderer/renderer.h"
 
 namespace gvr {
@@ -48,9 +49,12 @@ public:
         main_camera_rig_ = camera_rig;
     }
     std::vector<SceneObject*> getWholeSceneObjects();
+    void updateMeshBoundingVolumes();
 
-    int getSceneDirtyFlag() { return 1 || dirtyFlag_;  /* force to be true */}
-    void setSceneDirtyFlag(int dirtyBits) { dirtyFlag_ |= dirtyBits; }
+    RenderList& render_list() {
+        return render_list_;
+    }
+    void updateRenderList(RenderSorter& render_sorter);
 
     void set_frustum_culling( bool frustum_flag){ frustum_flag_ = frustum_flag; }
     bool get_frustum_culling(){ return frustum_flag_; }
@@ -58,6 +62,15 @@ public:
     void set_occlusion_culling( bool occlusion_flag){ occlusion_flag_ = occlusion_flag; }
     bool get_occlusion_culling(){ return occlusion_flag_; }
 
+    // culls against the scene objects marked as occluders instead of with
+    // occlusion queries
+    void set_occluder_culling( bool occluder_flag){ occluder_flag_ = occluder_flag; }
+    bool get_occluder_culling(){ return occluder_flag_; }
+
+    // 0 culls on one thread per core, 1 culls on the GL thread only
+    void set_cull_thread_count(int cull_thread_count){ cull_thread_count_ = cull_thread_count; }
+    int get_cull_thread_count(){ return cull_thread_count_; }
+
     void resetStats() {
         if (!statsInitialized) {
             Renderer::initializeStats();
@@ -71,6 +84,9 @@ public:
     int getNumberTriangles() {
         return Renderer::getNumberTriangles();
     }
+    int getNumberSkippedGLCalls() {
+        return Renderer::getNumberSkippedGLCalls();
+    }
 
 private:
     Scene(const Scene& scene);
@@ -82,9 +98,13 @@ private:
     std::vector<SceneObject*> scene_objects_;
     CameraRig* main_camera_rig_;
 
-    int dirtyFlag_;
+    RenderList render_list_;
+    unsigned int render_list_epoch_;
+    unsigned int mesh_bounding_volume_epoch_;
     bool frustum_flag_;
     bool occlusion_flag_;
+    bool occluder_flag_;
+    int cull_thread_count_;
     bool statsInitialized = false;
 
 };
@@ -43,6 +43,12 @@ Java_org_gearvrf_NativeScene_setFrustumCulling(JNIEnv * env,
 JNIEXPORT void JNICALL
 Java_org_gearvrf_NativeScene_setOcclusionQuery(JNIEnv * env,
         jobject obj, jlong jscene, jboolean flag);
+JNIEXPORT void JNICALL
+Java_org_gearvrf_NativeScene_setOccluderCulling(JNIEnv * env,
+        jobject obj, jlong jscene, jboolean flag);
+JNIEXPORT void JNICALL
+Java_org_gearvrf_NativeScene_setCullThreadCount(JNIEnv * env,
+        jobject obj, jlong jscene, jint count);
 
 JNIEXPORT void JNICALL
 Java_org_gearvrf_NativeScene_resetStats(JNIEnv * env,
@@ -55,6 +61,10 @@ Java_org_gearvrf_NativeScene_getNumberDrawCalls(JNIEnv * env,
 JNIEXPORT int JNICALL
 Java_org_gearvrf_NativeScene_getNumberTriangles(JNIEnv * env,
         jobject obj, jlong jscene);
+
+JNIEXPORT int JNICALL
+Java_org_gearvrf_NativeScene_getNumberSkippedGLCalls(JNIEnv * env,
+        jobject obj, jlong jscene);
 }
 ;
 
@@ -101,6 +111,20 @@ Java_org_gearvrf_NativeScene_setOcclusionQuery(JNIEnv * env,
     scene->set_occlusion_culling(static_cast<bool>(flag));
 }
 
+JNIEXPORT void JNICALL
+Java_org_gearvrf_NativeScene_setOccluderCulling(JNIEnv * env,
+        jobject obj, jlong jscene, jboolean flag) {
+    Scene* scene = reinterpret_cast<Scene*>(jscene);
+    scene->set_occluder_culling(static_cast<bool>(flag));
+}
+
+JNIEXPORT void JNICALL
+Java_org_gearvrf_NativeScene_setCullThreadCount(JNIEnv * env,
+        jobject obj, jlong jscene, jint count) {
+    Scene* scene = reinterpret_cast<Scene*>(jscene);
+    scene->set_cull_thread_count(count);
+}
+
 JNIEXPORT void JNICALL
 Java_org_gearvrf_NativeScene_resetStats(JNIEnv * env,
         jobject obj, jlong jscene) {
@@ -124,5 +148,12 @@ Java_org_gearvrf_NativeScene_getNumberTriangles(JNIEnv * env,
     return scene->getNumberTriangles();
 }
 
+JNIEXPORT int JNICALL
+Java_org_gearvrf_NativeScene_getNumberSkippedGLCalls(JNIEnv * env,
+        jobject obj, jlong jscene) {
+    Scene* scene = reinterpret_cast<Scene*>(jscene);
+    return scene->getNumberSkippedGLCalls();
+}
+
 
 }
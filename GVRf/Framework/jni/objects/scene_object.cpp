@@ -19,31 +19,51 @@
 
 #include "scene_object.h"
 
+#include "engine/memory/gl_delete.h"
 #include "objects/components/camera.h"
 #include "objects/components/camera_rig.h"
 #include "objects/components/eye_pointee_holder.h"
 #include "objects/components/render_data.h"
+#include "objects/lod_group.h"
+#include "objects/static_batch.h"
 #include "util/gvr_log.h"
 #include "mesh.h"
 
 namespace gvr {
-SceneObject::SceneObject() :
-        HybridObject(), name_(""), transform_(), render_data_(), camera_(), camera_rig_(), eye_pointee_holder_(), parent_(), children_(), visible_(
-                true), in_frustum_(false), query_currently_issued_(false), vis_count_(0), lod_min_range_(0), lod_max_range_(MAXFLOAT), using_lod_(false), bounding_volume_dirty_(true) {
+std::atomic<unsigned int> SceneObject::render_list_epoch_(0);
 
-    // Occlusion query setup
-#if _GVRF_USE_GLES3_
-    queries_ = new GLuint[1];
-    glGenQueries(1, queries_);
-#endif
+SceneObject::SceneObject() :
+        HybridObject(), name_(""), transform_(), render_data_(), camera_(), camera_rig_(), eye_pointee_holder_(), parent_(), children_(), lod_min_range_(
+                0), lod_max_range_(MAXFLOAT), using_lod_(false), lod_group_(), bounding_volume_dirty_(true), mesh_bounding_volume_version_(0), static_batch_(), static_batch_dirty_(false), occluder_(false), visible_(true), subtree_visible_(true), in_frustum_(false), occlusion_queries_(), subtree_query_(false) {
 }
 
 SceneObject::~SceneObject() {
+    delete static_batch_;
+    delete lod_group_;
 #if _GVRF_USE_GLES3_
-    delete queries_;
+    // queries come from the renderer's pool, which never sees this one again
+    for (int eye = 0; eye < 2; ++eye) {
+        if (occlusion_queries_[eye] != 0) {
+            gl_delete.queueQuery(occlusion_queries_[eye]);
+        }
+    }
 #endif
 }
 
+LODGroup* SceneObject::getLODGroup() {
+    if (lod_group_ == 0) {
+        lod_group_ = new LODGroup();
+        dirtyStaticBatch();
+    }
+    return lod_group_;
+}
+
+void SceneObject::clearLODGroup() {
+    delete lod_group_;
+    lod_group_ = 0;
+    dirtyStaticBatch();
+}
+
 void SceneObject::attachTransform(SceneObject* self, Transform* transform) {
     if (transform_) {
         detachTransform();
@@ -76,6 +96,8 @@ void SceneObject::attachRenderData(SceneObject* self, RenderData* render_data) {
     render_data_ = render_data;
     render_data->set_owner_object(self);
     dirtyBoundingVolume();
+    dirtyRenderList();
+    dirtyStaticBatch();
 }
 
 void SceneObject::detachRenderData() {
@@ -84,6 +106,8 @@ void SceneObject::detachRenderData() {
         render_data_ = NULL;
     }
     dirtyBoundingVolume();
+    dirtyRenderList();
+    dirtyStaticBatch();
 }
 
 void SceneObject::attachCamera(SceneObject* self, Camera* camera) {
@@ -158,6 +182,8 @@ void SceneObject::addChildObject(SceneObject* self, SceneObject* child) {
     child->parent_ = self;
     child->transform()->invalidate(false);
     dirtyBoundingVolume();
+    dirtyRenderList();
+    dirtyStaticBatch();
 }
 
 void SceneObject::removeChildObject(SceneObject* child) {
@@ -167,6 +193,52 @@ void SceneObject::removeChildObject(SceneObject* child) {
         child->parent_ = NULL;
     }
     dirtyBoundingVolume();
+    dirtyRenderList();
+    dirtyStaticBatch();
+}
+
+void SceneObject::set_static(bool is_static) {
+    if (is_static == (static_batch_ != 0)) {
+        return;
+    }
+    if (is_static) {
+        static_batch_ = new StaticBatch(this);
+    } else {
+        delete static_batch_;
+        static_batch_ = 0;
+    }
+    static_batch_dirty_ = false;
+    dirtyRenderList();
+}
+
+/*
+ * The batch points at the scene objects and materials of the subtree, so
+ * a stale one is baked again before anything looks at it; until then it
+ * is only deleted, never read.
+ */
+StaticBatch* SceneObject::static_batch() {
+    if (static_batch_ == 0) {
+        return 0;
+    }
+    if (!static_batch_dirty_ && !static_batch_->checkMaterials()) {
+        static_batch_dirty_ = true;
+    }
+    if (static_batch_dirty_) {
+        delete static_batch_;
+        static_batch_ = new StaticBatch(this);
+        static_batch_dirty_ = false;
+        dirtyRenderList();
+    }
+    return static_batch_;
+}
+
+void SceneObject::dirtyStaticBatch() {
+    for (SceneObject* scene_object = this; scene_object != 0; scene_object =
+            scene_object->parent_) {
+        if (scene_object->static_batch_ != 0) {
+            scene_object->static_batch_dirty_ = true;
+        }
+    }
 }
 
 int SceneObject::getChildrenCount() const {
@@ -182,29 +254,6 @@ SceneObject* SceneObject::getChildByIndex(int index) {
     }
 }
 
-void SceneObject::set_visible(bool visibility = true) {
-
-    //HACK
-    //If checked every frame, queries may return
-    //an inconsistent result when used with bounding boxes.
-
-    //We need to make sure that the object's visibility status is consistent before
-    //changing the status to avoid flickering artifacts.
-
-    if (visibility == true)
-        vis_count_++;
-    else
-        vis_count_--;
-
-    if (vis_count_ > check_frames_) {
-        visible_ = true;
-        vis_count_ = 0;
-    } else if (vis_count_ < (-1 * check_frames_)) {
-        visible_ = false;
-        vis_count_ = 0;
-    }
-}
-
 bool SceneObject::isColliding(SceneObject *scene_object) {
 
     //Get the transformed bounding boxes in world coordinates and check if they intersect
@@ -244,13 +293,23 @@ void SceneObject::dirtyBoundingVolume() {
     }
 }
 
+/*
+ * World-space bounds of this object's mesh and of all its descendants.
+ * Only the dirty part of the hierarchy is recomputed; transform, mesh and
+ * hierarchy changes dirty the object and its ancestors.
+ */
 BoundingVolume& SceneObject::getBoundingVolume() {
     if(!bounding_volume_dirty_) {
         return bounding_volume_;
     }
 
-    if(render_data_ && render_data_->mesh()) {
-        bounding_volume_.expand(render_data_->mesh()->getBoundingVolume());
+    bounding_volume_.reset();
+
+    if(transform_ && render_data_ && render_data_->mesh()) {
+        Mesh* mesh = render_data_->mesh();
+        bounding_volume_.expand(mesh->getBoundingVolume(),
+                transform_->getModelMatrix());
+        mesh_bounding_volume_version_ = mesh->bounding_volume_version();
     }
 
     for(int i=0; i<children_.size(); i++) {
@@ -258,6 +317,24 @@ BoundingVolume& SceneObject::getBoundingVolume() {
         bounding_volume_.expand(child->getBoundingVolume());
     }
 
+    bounding_volume_dirty_ = false;
     return bounding_volume_;
 }
+
+/*
+ * Meshes don't know which objects use them, so after mesh vertices change
+ * the hierarchy is walked once to dirty the objects whose cached bounds
+ * were computed from an older version of their mesh.
+ */
+void SceneObject::dirtyChangedMeshBoundingVolumes() {
+    if(render_data_ && render_data_->mesh() && !bounding_volume_dirty_
+            && render_data_->mesh()->bounding_volume_version()
+                    != mesh_bounding_volume_version_) {
+        dirtyBoundingVolume();
+    }
+
+    for(int i=0; i<children_.size(); i++) {
+        children_[i]->dirtyChangedMeshBoundingVolumes();
+    }
+}
 }
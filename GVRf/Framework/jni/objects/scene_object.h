@@ -21,6 +21,7 @@
 #define SCENE_OBJECT_H_
 
 #include <algorithm>
+#include <atomic>
 #include <vector>
 #include <memory>
 
@@ -33,7 +34,9 @@ namespace gvr {
 class Camera;
 class CameraRig;
 class EyePointeeHolder;
+class LODGroup;
 class RenderData;
+class StaticBatch;
 
 class SceneObject: public HybridObject {
 public:
@@ -56,17 +59,43 @@ public:
         return in_frustum_;
     }
 
-    void set_visible(bool visibility);
+    // whether the render data passed its last occlusion query
+    void set_visible(bool visible) {
+        visible_ = visible;
+    }
+
     bool visible() const {
         return visible_;
     }
 
-    void set_query_issued(bool issued = true) {
-        query_currently_issued_ = issued;
+    // false once nothing in the subtree passed its occlusion queries, after
+    // which the subtree is skipped and queried as a whole
+    void set_subtree_visible(bool subtree_visible) {
+        subtree_visible_ = subtree_visible;
+    }
+
+    bool subtree_visible() const {
+        return subtree_visible_;
+    }
+
+    // The pending occlusion query of each eye, 0 if none, and whether they
+    // are on the bounds of the whole subtree or of the render data only.
+    GLuint occlusion_query(int eye) const {
+        return occlusion_queries_[eye];
+    }
+
+    bool is_subtree_query() const {
+        return subtree_query_;
+    }
+
+    void set_occlusion_query(int eye, GLuint occlusion_query,
+            bool subtree_query) {
+        occlusion_queries_[eye] = occlusion_query;
+        subtree_query_ = subtree_query;
     }
 
-    bool is_query_issued() {
-        return query_currently_issued_;
+    bool is_query_issued() const {
+        return occlusion_queries_[0] != 0 || occlusion_queries_[1] != 0;
     }
 
     void attachTransform(SceneObject* self, Transform* transform);
@@ -117,15 +146,13 @@ public:
     void removeChildObject(SceneObject* child);
     int getChildrenCount() const;
     SceneObject* getChildByIndex(int index);
-    GLuint *get_occlusion_array() {
-        return queries_;
-    }
     bool isColliding(SceneObject* scene_object);
 
     void setLODRange(float minRange, float maxRange) {
         lod_min_range_ = minRange * minRange;
         lod_max_range_ = maxRange * maxRange;
         using_lod_ = true;
+        dirtyStaticBatch();
     }
 
     float getLODMinRange() {
@@ -136,6 +163,10 @@ public:
         return lod_max_range_;
     }
 
+    bool using_lod() const {
+        return using_lod_;
+    }
+
     bool inLODRange(float distance_from_camera) {
         if(!using_lod_) {
             return true;
@@ -147,8 +178,58 @@ public:
         return false;
     }
 
+    // The levels of detail picked by size on screen, 0 if there are none.
+    // getLODGroup() makes the group on first use; a scene object with a
+    // group is culled as a whole, never merged into a static batch.
+    LODGroup* lod_group() const {
+        return lod_group_;
+    }
+
+    LODGroup* getLODGroup();
+    void clearLODGroup();
+
     void dirtyBoundingVolume();
     BoundingVolume& getBoundingVolume();
+    void dirtyChangedMeshBoundingVolumes();
+
+    // A static subtree is baked into a few merged meshes that are culled and
+    // drawn in place of the scene objects of the subtree. Adding or removing
+    // objects or render data, or changing their meshes or materials, has the
+    // subtree baked again before it is next culled; moving objects does not.
+    // Clearing the flag drops the merged meshes and the original scene
+    // objects are drawn again.
+    void set_static(bool is_static);
+    bool is_static() const {
+        return static_batch_ != 0;
+    }
+
+    // bakes the subtree again first if it changed; on the GL thread only
+    StaticBatch* static_batch();
+
+    // marks the batches of the static subtrees this object is in as stale
+    void dirtyStaticBatch();
+
+    // the mesh of an occluder is rasterized to hide what is behind it when
+    // the scene culls against occluders
+    void set_occluder(bool occluder) {
+        occluder_ = occluder;
+        dirtyStaticBatch();
+    }
+
+    bool is_occluder() const {
+        return occluder_;
+    }
+
+    // bumped, from any thread, whenever render data may have been added to
+    // or removed from any scene, so that scenes can tell their render lists
+    // are stale
+    static unsigned int render_list_epoch() {
+        return render_list_epoch_.load();
+    }
+
+    static void dirtyRenderList() {
+        render_list_epoch_.fetch_add(1);
+    }
 
 private:
     SceneObject(const SceneObject& scene_object);
@@ -168,17 +249,22 @@ private:
     float lod_min_range_;
     float lod_max_range_;
     bool using_lod_;
+    LODGroup* lod_group_;
     BoundingVolume bounding_volume_;
     bool bounding_volume_dirty_;
+    unsigned int mesh_bounding_volume_version_;
+    StaticBatch* static_batch_;
+    bool static_batch_dirty_;
+    bool occluder_;
+    static std::atomic<unsigned int> render_list_epoch_;
 
     //Flags to check for visibility of a node and
     //whether there are any pending occlusion queries on it
-    const int check_frames_ = 12;
-    int vis_count_;
     bool visible_;
+    bool subtree_visible_;
     bool in_frustum_;
-    bool query_currently_issued_;
-    GLuint *queries_;
+    GLuint occlusion_queries_[2];
+    bool subtree_query_;
 };
 
 }
@@ -19,6 +19,8 @@
 
 #include "scene_object.h"
 
+#include "objects/lod_group.h"
+
 #include "util/gvr_log.h"
 #include "util/gvr_jni.h"
 
@@ -100,6 +102,39 @@ JNIEXPORT jfloat JNICALL
 Java_org_gearvrf_NativeSceneObject_getLODMaxRange(
         JNIEnv * env, jobject obj, jlong jscene_object);
 
+JNIEXPORT void JNICALL
+Java_org_gearvrf_NativeSceneObject_addLODLevel(
+        JNIEnv * env, jobject obj, jlong jscene_object, jlong jlevel,
+        jfloat min_screen_size);
+
+JNIEXPORT void JNICALL
+Java_org_gearvrf_NativeSceneObject_clearLODLevels(
+        JNIEnv * env, jobject obj, jlong jscene_object);
+
+JNIEXPORT void JNICALL
+Java_org_gearvrf_NativeSceneObject_setLODHysteresis(
+        JNIEnv * env, jobject obj, jlong jscene_object, jfloat hysteresis);
+
+JNIEXPORT void JNICALL
+Java_org_gearvrf_NativeSceneObject_setLODFadeFrames(
+        JNIEnv * env, jobject obj, jlong jscene_object, jint fade_frames);
+
+JNIEXPORT void JNICALL
+Java_org_gearvrf_NativeSceneObject_setStatic(
+        JNIEnv * env, jobject obj, jlong jscene_object, jboolean is_static);
+
+JNIEXPORT jboolean JNICALL
+Java_org_gearvrf_NativeSceneObject_isStatic(
+        JNIEnv * env, jobject obj, jlong jscene_object);
+
+JNIEXPORT void JNICALL
+Java_org_gearvrf_NativeSceneObject_setOccluder(
+        JNIEnv * env, jobject obj, jlong jscene_object, jboolean occluder);
+
+JNIEXPORT jboolean JNICALL
+Java_org_gearvrf_NativeSceneObject_isOccluder(
+        JNIEnv * env, jobject obj, jlong jscene_object);
+
 
 
 JNIEXPORT jlong JNICALL
@@ -248,6 +283,64 @@ Java_org_gearvrf_NativeSceneObject_getLODMaxRange(
     return scene_object->getLODMaxRange();
 }
 
+JNIEXPORT void JNICALL
+Java_org_gearvrf_NativeSceneObject_addLODLevel(
+        JNIEnv * env, jobject obj, jlong jscene_object, jlong jlevel,
+        jfloat min_screen_size) {
+    SceneObject* scene_object = reinterpret_cast<SceneObject*>(jscene_object);
+    SceneObject* level = reinterpret_cast<SceneObject*>(jlevel);
+    scene_object->getLODGroup()->addLevel(level, min_screen_size);
+}
+
+JNIEXPORT void JNICALL
+Java_org_gearvrf_NativeSceneObject_clearLODLevels(
+        JNIEnv * env, jobject obj, jlong jscene_object) {
+    SceneObject* scene_object = reinterpret_cast<SceneObject*>(jscene_object);
+    scene_object->clearLODGroup();
+}
+
+JNIEXPORT void JNICALL
+Java_org_gearvrf_NativeSceneObject_setLODHysteresis(
+        JNIEnv * env, jobject obj, jlong jscene_object, jfloat hysteresis) {
+    SceneObject* scene_object = reinterpret_cast<SceneObject*>(jscene_object);
+    scene_object->getLODGroup()->set_hysteresis(hysteresis);
+}
+
+JNIEXPORT void JNICALL
+Java_org_gearvrf_NativeSceneObject_setLODFadeFrames(
+        JNIEnv * env, jobject obj, jlong jscene_object, jint fade_frames) {
+    SceneObject* scene_object = reinterpret_cast<SceneObject*>(jscene_object);
+    scene_object->getLODGroup()->set_fade_frames(fade_frames);
+}
+
+JNIEXPORT void JNICALL
+Java_org_gearvrf_NativeSceneObject_setStatic(
+        JNIEnv * env, jobject obj, jlong jscene_object, jboolean is_static) {
+    SceneObject* scene_object = reinterpret_cast<SceneObject*>(jscene_object);
+    scene_object->set_static(is_static);
+}
+
+JNIEXPORT jboolean JNICALL
+Java_org_gearvrf_NativeSceneObject_isStatic(
+        JNIEnv * env, jobject obj, jlong jscene_object) {
+    SceneObject* scene_object = reinterpret_cast<SceneObject*>(jscene_object);
+    return scene_object->is_static();
+}
+
+JNIEXPORT void JNICALL
+Java_org_gearvrf_NativeSceneObject_setOccluder(
+        JNIEnv * env, jobject obj, jlong jscene_object, jboolean occluder) {
+    SceneObject* scene_object = reinterpret_cast<SceneObject*>(jscene_object);
+    scene_object->set_occluder(occluder);
+}
+
+JNIEXPORT jboolean JNICALL
+Java_org_gearvrf_NativeSceneObject_isOccluder(
+        JNIEnv * env, jobject obj, jlong jscene_object) {
+    SceneObject* scene_object = reinterpret_cast<SceneObject*>(jscene_object);
+    return scene_object->is_occluder();
+}
+
 } // extern "C"
 
 } // namespace gvr
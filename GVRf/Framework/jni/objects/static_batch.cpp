@@ -0,0 +1,286 @@
+/* Copyright 2015 Samsung Electronics Co., LTD
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/***************************************************************************
+ * Merged meshes standing in for a static subtree.
+ ***************************************************************************/
+
+#include "static_batch.h"
+
+#include <algorithm>
+
+#include "glm/gtc/matrix_inverse.hpp"
+
+#include "objects/mesh.h"
+#include "objects/render_pass.h"
+#include "objects/scene_object.h"
+#include "objects/components/render_data.h"
+#include "objects/components/transform.h"
+
+namespace gvr {
+
+StaticBatch::StaticBatch(SceneObject* root) :
+        root_(root), batches_(), render_passes_(), unbatched_objects_(),
+        sources_(), material_epoch_(RenderPass::material_epoch()) {
+    std::vector<std::vector<Item> > groups;
+    collect(root, groups);
+    for (auto it = groups.begin(); it != groups.end(); ++it) {
+        split(*it, 0, it->size());
+    }
+}
+
+StaticBatch::~StaticBatch() {
+    for (auto it = batches_.begin(); it != batches_.end(); ++it) {
+        SceneObject* batch = *it;
+        RenderData* render_data = batch->render_data();
+        Transform* transform = batch->transform();
+        Mesh* mesh = render_data->mesh();
+        batch->detachRenderData();
+        batch->detachTransform();
+        delete render_data;
+        delete transform;
+        delete mesh;
+        delete batch;
+    }
+    for (auto it = render_passes_.begin(); it != render_passes_.end(); ++it) {
+        delete *it;
+    }
+}
+
+bool StaticBatch::checkMaterials() {
+    unsigned int material_epoch = RenderPass::material_epoch();
+    if (material_epoch == material_epoch_) {
+        return true;
+    }
+    for (auto it = sources_.begin(); it != sources_.end(); ++it) {
+        if (it->render_data->material(0) != it->material) {
+            return false;
+        }
+    }
+    material_epoch_ = material_epoch;
+    return true;
+}
+
+void StaticBatch::collect(SceneObject* scene_object,
+        std::vector<std::vector<Item> >& groups) {
+    // only one level of a LOD group is drawn at a time, so the group is
+    // left whole to be culled on its own
+    if (scene_object != root_ && scene_object->lod_group() != 0) {
+        unbatched_objects_.push_back(scene_object);
+        return;
+    }
+
+    RenderData* render_data = scene_object->render_data();
+    if (render_data != 0) {
+        if (isBatchable(scene_object)) {
+            Item item;
+            item.scene_object = scene_object;
+            item.center = glm::vec3(
+                    scene_object->transform()->getModelMatrix()
+                            * glm::vec4(
+                                    render_data->mesh()->getBoundingVolume().center(),
+                                    1.0f));
+            item.vertex_count = render_data->mesh()->vertices().size();
+
+            auto group = groups.begin();
+            for (; group != groups.end(); ++group) {
+                if (isSameBatch((*group)[0].scene_object->render_data(),
+                        render_data)) {
+                    break;
+                }
+            }
+            if (group == groups.end()) {
+                groups.push_back(std::vector<Item>());
+                group = groups.end() - 1;
+            }
+            group->push_back(item);
+        } else {
+            unbatched_objects_.push_back(scene_object);
+        }
+    }
+
+    const std::vector<SceneObject*>& children = scene_object->children();
+    for (auto it = children.begin(); it != children.end(); ++it) {
+        collect(*it, groups);
+    }
+}
+
+/*
+ * Splits items [first, last) at the median of the axis along which their
+ * centers spread the most, until each part can be merged into one mesh.
+ */
+void StaticBatch::split(std::vector<Item>& items, int first, int last) {
+    int vertex_count = 0;
+    glm::vec3 min_center(items[first].center);
+    glm::vec3 max_center(items[first].center);
+    for (int i = first; i < last; ++i) {
+        vertex_count += items[i].vertex_count;
+        min_center = glm::min(min_center, items[i].center);
+        max_center = glm::max(max_center, items[i].center);
+    }
+
+    if (last - first == 1
+            || (vertex_count <= MAX_BATCH_VERTICES
+                    && last - first <= MAX_BATCH_OBJECTS)) {
+        merge(items, first, last);
+        return;
+    }
+
+    glm::vec3 extent(max_center - min_center);
+    int axis = 0;
+    if (extent.y > extent[axis]) {
+        axis = 1;
+    }
+    if (extent.z > extent[axis]) {
+        axis = 2;
+    }
+
+    int middle = first + (last - first) / 2;
+    std::nth_element(items.begin() + first, items.begin() + middle,
+            items.begin() + last, [axis](const Item& a, const Item& b) {
+                return a.center[axis] < b.center[axis];
+            });
+    split(items, first, middle);
+    split(items, middle, last);
+}
+
+void StaticBatch::merge(const std::vector<Item>& items, int first, int last) {
+    RenderData* source = items[first].scene_object->render_data();
+    Mesh* source_mesh = source->mesh();
+    bool has_normals = !source_mesh->normals().empty();
+    bool has_tex_coords = !source_mesh->tex_coords().empty();
+
+    std::vector<glm::vec3> vertices;
+    std::vector<glm::vec3> normals;
+    std::vector<glm::vec2> tex_coords;
+    std::vector<unsigned short> triangles;
+
+    for (int i = first; i < last; ++i) {
+        SceneObject* scene_object = items[i].scene_object;
+        Source batched = { scene_object->render_data(),
+                scene_object->render_data()->material(0) };
+        sources_.push_back(batched);
+        Mesh* mesh = scene_object->render_data()->mesh();
+        glm::mat4 model_matrix(scene_object->transform()->getModelMatrix());
+        glm::mat3 normal_matrix(
+                glm::inverseTranspose(glm::mat3(model_matrix)));
+        unsigned short base_vertex = vertices.size();
+
+        const std::vector<glm::vec3>& mesh_vertices = mesh->vertices();
+        for (auto it = mesh_vertices.begin(); it != mesh_vertices.end(); ++it) {
+            vertices.push_back(glm::vec3(model_matrix * glm::vec4(*it, 1.0f)));
+        }
+        if (has_normals) {
+            const std::vector<glm::vec3>& mesh_normals = mesh->normals();
+            for (auto it = mesh_normals.begin(); it != mesh_normals.end();
+                    ++it) {
+                normals.push_back(glm::normalize(normal_matrix * *it));
+            }
+        }
+        if (has_tex_coords) {
+            const std::vector<glm::vec2>& mesh_tex_coords = mesh->tex_coords();
+            tex_coords.insert(tex_coords.end(), mesh_tex_coords.begin(),
+                    mesh_tex_coords.end());
+        }
+        const std::vector<unsigned short>& mesh_triangles = mesh->triangles();
+        for (auto it = mesh_triangles.begin(); it != mesh_triangles.end();
+                ++it) {
+            triangles.push_back(base_vertex + *it);
+        }
+    }
+
+    Mesh* mesh = new Mesh();
+    mesh->set_vertices(std::move(vertices));
+    if (has_normals) {
+        mesh->set_normals(std::move(normals));
+    }
+    if (has_tex_coords) {
+        mesh->set_tex_coords(std::move(tex_coords));
+    }
+    mesh->set_triangles(std::move(triangles));
+
+    RenderPass* render_pass = new RenderPass();
+    render_pass->set_material(source->material(0));
+    render_pass->set_cull_face(source->pass(0)->cull_face());
+    render_passes_.push_back(render_pass);
+
+    RenderData* render_data = new RenderData();
+    render_data->add_pass(render_pass);
+    render_data->set_mesh(mesh);
+    render_data->set_light(source->light());
+    if (source->light_enabled()) {
+        render_data->enable_light();
+    }
+    render_data->set_render_mask(source->render_mask());
+    render_data->set_rendering_order(source->rendering_order());
+    render_data->set_offset(source->offset());
+    render_data->set_offset_factor(source->offset_factor());
+    render_data->set_offset_units(source->offset_units());
+    render_data->set_depth_test(source->depth_test());
+    render_data->set_alpha_blend(source->alpha_blend());
+    render_data->set_draw_mode(source->draw_mode());
+
+    SceneObject* batch = new SceneObject();
+    batch->set_name(root_->name() + " (static batch)");
+    batch->attachTransform(batch, new Transform());
+    batch->attachRenderData(batch, render_data);
+    batches_.push_back(batch);
+}
+
+bool StaticBatch::isBatchable(SceneObject* scene_object) {
+    RenderData* render_data = scene_object->render_data();
+    Mesh* mesh = render_data->mesh();
+    if (mesh == 0 || render_data->pass_count() != 1
+            || render_data->material(0) == 0 || scene_object->using_lod()
+            || scene_object->is_occluder() || scene_object->transform() == 0) {
+        return false;
+    }
+    // transparent objects have to stay sorted among each other
+    if (render_data->rendering_order() >= RenderData::Transparent) {
+        return false;
+    }
+    // meshes that dropped their vertices after upload have nothing to copy
+    if (!mesh->has_cpu_data()) {
+        return false;
+    }
+    size_t vertex_count = mesh->vertices().size();
+    return vertex_count > 0 && vertex_count <= MAX_BATCH_VERTICES
+            && (mesh->normals().empty()
+                    || mesh->normals().size() == vertex_count)
+            && (mesh->tex_coords().empty()
+                    || mesh->tex_coords().size() == vertex_count)
+            && !mesh->has_attribute_vectors();
+}
+
+bool StaticBatch::isSameBatch(RenderData* render_data, RenderData* other) {
+    Mesh* mesh = render_data->mesh();
+    Mesh* other_mesh = other->mesh();
+    return other->material(0) == render_data->material(0)
+            && other->cull_face(0) == render_data->cull_face(0)
+            && other->render_mask() == render_data->render_mask()
+            && other->rendering_order() == render_data->rendering_order()
+            && other->offset() == render_data->offset()
+            && other->offset_factor() == render_data->offset_factor()
+            && other->offset_units() == render_data->offset_units()
+            && other->depth_test() == render_data->depth_test()
+            && other->alpha_blend() == render_data->alpha_blend()
+            && other->draw_mode() == render_data->draw_mode()
+            && other->light_enabled() == render_data->light_enabled()
+            && other->light() == render_data->light()
+            && other_mesh->normals().empty() == mesh->normals().empty()
+            && other_mesh->tex_coords().empty() == mesh->tex_coords().empty();
+}
+
+}
@@ -0,0 +1,108 @@
+/* Copyright 2015 Samsung Electronics Co., LTD
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/***************************************************************************
+ * Merged meshes standing in for a static subtree.
+ ***************************************************************************/
+
+#ifndef STATIC_BATCH_H_
+#define STATIC_BATCH_H_
+
+#include <vector>
+
+#include "glm/glm.hpp"
+
+namespace gvr {
+class Material;
+class RenderData;
+class RenderPass;
+class SceneObject;
+
+/*
+ * Bakes the subtree of a scene object into merged meshes, one set per group
+ * of render data sharing a material and render state. The vertices are
+ * transformed to world space, so the batches have identity transforms and
+ * are not attached to the scene graph.
+ *
+ * Each group is split along the longest axis of its objects' centers until
+ * every part fits in 16-bit indices and holds at most MAX_BATCH_OBJECTS
+ * objects, which keeps the parts spatially compact for culling.
+ *
+ * Render data with several passes, extra vertex attributes, LOD ranges, a
+ * transparent rendering order or an occluder flag are not merged; their
+ * scene objects are kept in unbatched_objects() to be culled and drawn as
+ * before. So are scene objects with a LOD group, along with their subtrees.
+ *
+ * The batch holds plain pointers into the subtree, so the scene object at
+ * its root has it baked again whenever the subtree or its materials change;
+ * see SceneObject::dirtyStaticBatch().
+ */
+class StaticBatch {
+public:
+    explicit StaticBatch(SceneObject* root);
+    ~StaticBatch();
+
+    const std::vector<SceneObject*>& batches() const {
+        return batches_;
+    }
+
+    const std::vector<SceneObject*>& unbatched_objects() const {
+        return unbatched_objects_;
+    }
+
+    // false if a batched render data has changed material since baking;
+    // the render data are only looked at after some pass changed material
+    bool checkMaterials();
+
+private:
+    StaticBatch(const StaticBatch& static_batch);
+    StaticBatch(StaticBatch&& static_batch);
+    StaticBatch& operator=(const StaticBatch& static_batch);
+    StaticBatch& operator=(StaticBatch&& static_batch);
+
+    struct Item {
+        SceneObject* scene_object;
+        glm::vec3 center;
+        int vertex_count;
+    };
+
+    // a batched render data and the material it was baked with
+    struct Source {
+        RenderData* render_data;
+        Material* material;
+    };
+
+    void collect(SceneObject* scene_object,
+            std::vector<std::vector<Item> >& groups);
+    void split(std::vector<Item>& items, int first, int last);
+    void merge(const std::vector<Item>& items, int first, int last);
+
+    static bool isBatchable(SceneObject* scene_object);
+    static bool isSameBatch(RenderData* render_data, RenderData* other);
+
+private:
+    static const int MAX_BATCH_VERTICES = 65536;
+    static const int MAX_BATCH_OBJECTS = 256;
+
+    SceneObject* root_;
+    std::vector<SceneObject*> batches_;
+    std::vector<RenderPass*> render_passes_;
+    std::vector<SceneObject*> unbatched_objects_;
+    std::vector<Source> sources_;
+    unsigned int material_epoch_;
+};
+
+}
+#endif
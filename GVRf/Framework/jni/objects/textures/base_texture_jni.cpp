@@ -18,7 +18,7 @@
  ***************************************************************************/
 
 #include "base_texture.h"
-#include "png_loader.h"
+#include "png_texture_loader.h"
 #include "util/gvr_jni.h"
 #include "util/gvr_java_stack_trace.h"
 #include "android/asset_manager_jni.h"
@@ -30,6 +30,10 @@ extern "C" {
 JNIEXPORT jlong JNICALL
 Java_org_gearvrf_NativeBaseTexture_fileConstructor(JNIEnv * env,
         jobject obj, jobject asset_manager, jstring filename, jintArray jtexture_parameters);
+JNIEXPORT jlongArray JNICALL
+Java_org_gearvrf_NativeBaseTexture_fileConstructors(JNIEnv * env,
+        jobject obj, jobject asset_manager, jobjectArray jfilenames, jint max_size,
+        jintArray jtexture_parameters);
 JNIEXPORT jlong JNICALL
 Java_org_gearvrf_NativeBaseTexture_bareConstructor(JNIEnv * env, jobject obj, jintArray jtexture_parameters);
 JNIEXPORT jboolean JNICALL
@@ -45,35 +49,46 @@ Java_org_gearvrf_NativeBaseTexture_fileConstructor(JNIEnv * env,
     jint* texture_parameters = env->GetIntArrayElements(jtexture_parameters,0);
 
     const char* native_string = env->GetStringUTFChars(filename, 0);
-    AAssetManager* mgr = AAssetManager_fromJava(env, asset_manager);
-    AAsset* asset = AAssetManager_open(mgr, native_string, AASSET_MODE_UNKNOWN);
-    if (NULL == asset) {
-        LOGE("_ASSET_NOT_FOUND_");
-        return JNI_FALSE;
-    }
+    std::vector<std::string> filenames(1, native_string);
+    env->ReleaseStringUTFChars(filename, native_string);
 
-    PngLoader loader;
-    loader.loadFromAsset(asset);
+    std::vector<BaseTexture*> textures;
+    PngTextureLoader::load(AAssetManager_fromJava(env, asset_manager),
+            filenames, 0, texture_parameters, textures);
+    env->ReleaseIntArrayElements(jtexture_parameters, texture_parameters, 0);
+    return reinterpret_cast<jlong>(textures[0]);
+}
 
-    AAsset_close(asset);
-    env->ReleaseStringUTFChars(filename, native_string);
+JNIEXPORT jlongArray JNICALL
+Java_org_gearvrf_NativeBaseTexture_fileConstructors(JNIEnv * env,
+        jobject obj, jobject asset_manager, jobjectArray jfilenames, jint max_size,
+        jintArray jtexture_parameters) {
 
-    if (loader.pOutImage.bits == NULL) {
-        LOGE("PNG decoder failed");
-        return JNI_FALSE;
-    }
+    jint* texture_parameters = env->GetIntArrayElements(jtexture_parameters,0);
 
-    if (loader.pOutImage.format != PngLoader::RGBAFormat) {
-        LOGE("Only RGBA format supported");
-        return JNI_FALSE;
+    int count = env->GetArrayLength(jfilenames);
+    std::vector<std::string> filenames(count);
+    for (int i = 0; i < count; ++i) {
+        jstring filename = static_cast<jstring>(env->GetObjectArrayElement(
+                jfilenames, i));
+        const char* native_string = env->GetStringUTFChars(filename, 0);
+        filenames[i] = native_string;
+        env->ReleaseStringUTFChars(filename, native_string);
+        env->DeleteLocalRef(filename);
     }
 
-    int imgW = loader.pOutImage.width;
-    int imgH = loader.pOutImage.height;
-    unsigned char *pixels = loader.pOutImage.bits;
-    jlong result = reinterpret_cast<jlong>(new BaseTexture(imgW, imgH, pixels, texture_parameters));
+    std::vector<BaseTexture*> textures;
+    PngTextureLoader::load(AAssetManager_fromJava(env, asset_manager),
+            filenames, max_size, texture_parameters, textures);
     env->ReleaseIntArrayElements(jtexture_parameters, texture_parameters, 0);
-    return result;
+
+    std::vector<jlong> pointers(count);
+    for (int i = 0; i < count; ++i) {
+        pointers[i] = reinterpret_cast<jlong>(textures[i]);
+    }
+    jlongArray jpointers = env->NewLongArray(count);
+    env->SetLongArrayRegion(jpointers, 0, count, pointers.data());
+    return jpointers;
 }
 
 JNIEXPORT jlong JNICALL
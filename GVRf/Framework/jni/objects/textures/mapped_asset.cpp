@@ -0,0 +1,58 @@
+/* Copyright 2015 Samsung Electronics Co., LTD
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/***************************************************************************
+ * The bytes of an asset, in memory all at once.
+ ***************************************************************************/
+
+#include "mapped_asset.h"
+
+#include <sys/mman.h>
+#include <unistd.h>
+
+namespace gvr {
+
+MappedAsset::MappedAsset(AAsset* asset) :
+        map_(MAP_FAILED), map_size_(0), data_(0), size_(0) {
+    off_t start = 0;
+    off_t length = 0;
+    int fd = AAsset_openFileDescriptor(asset, &start, &length);
+    if (fd >= 0) {
+        off_t page_start = start - start % sysconf(_SC_PAGESIZE);
+        map_size_ = length + (start - page_start);
+        map_ = mmap(0, map_size_, PROT_READ, MAP_PRIVATE, fd, page_start);
+        close(fd);
+        if (map_ != MAP_FAILED) {
+            madvise(map_, map_size_, MADV_SEQUENTIAL);
+            data_ = static_cast<const unsigned char*>(map_)
+                    + (start - page_start);
+            size_ = length;
+            return;
+        }
+    }
+
+    data_ = static_cast<const unsigned char*>(AAsset_getBuffer(asset));
+    if (data_ != 0) {
+        size_ = AAsset_getLength(asset);
+    }
+}
+
+MappedAsset::~MappedAsset() {
+    if (map_ != MAP_FAILED) {
+        munmap(map_, map_size_);
+    }
+}
+
+}
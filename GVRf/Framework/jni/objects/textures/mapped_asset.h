@@ -0,0 +1,63 @@
+/* Copyright 2015 Samsung Electronics Co., LTD
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/***************************************************************************
+ * The bytes of an asset, in memory all at once.
+ ***************************************************************************/
+
+#ifndef MAPPED_ASSET_H_
+#define MAPPED_ASSET_H_
+
+#include <stddef.h>
+
+#include "android/asset_manager.h"
+
+namespace gvr {
+
+/*
+ * Maps an asset stored uncompressed in the APK, as PNGs are, straight from
+ * the APK's file descriptor at the asset's offset. Compressed assets are
+ * inflated into memory by the asset manager instead. The asset has to stay
+ * open while the mapping is in use.
+ */
+class MappedAsset {
+public:
+    explicit MappedAsset(AAsset* asset);
+    ~MappedAsset();
+
+    // null if the asset cannot be read
+    const unsigned char* data() const {
+        return data_;
+    }
+
+    size_t size() const {
+        return size_;
+    }
+
+private:
+    MappedAsset(const MappedAsset& mapped_asset);
+    MappedAsset(MappedAsset&& mapped_asset);
+    MappedAsset& operator=(const MappedAsset& mapped_asset);
+    MappedAsset& operator=(MappedAsset&& mapped_asset);
+
+private:
+    void* map_;
+    size_t map_size_;
+    const unsigned char* data_;
+    size_t size_;
+};
+
+}
+#endif
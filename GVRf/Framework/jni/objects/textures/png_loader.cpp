@@ -19,6 +19,9 @@
  ***************************************************************************/
 #include "png_loader.h"
 
+#include <algorithm>
+
+#include "objects/textures/mapped_asset.h"
 #include "util/gvr_log.h"
 #include <pngconf.h>
 
@@ -37,13 +40,11 @@
 
 #define FAST_SCAN_LINE(data, bpl, y) (data + (y) * bpl)
 
-static void iod_read_fn(png_structp png_ptr, png_bytep data,
-        png_size_t length) {
-    AAsset* asset = (AAsset *) png_get_io_ptr(png_ptr);
-    AAsset_read(asset, data, length);
-}
-
-static void setup_image(PngLoader::ImageData &image, png_structp png_ptr,
+/*
+ * Sets up the transforms to the format of image, and fills in its size and
+ * format; false if the format is not supported.
+ */
+static bool setup_image(PngLoader::ImageData &image, png_structp png_ptr,
         png_infop info_ptr, float screen_gamma = 0.0) {
     if (screen_gamma != 0.0
             && png_get_valid(png_ptr, info_ptr, PNG_INFO_gAMA)) {
@@ -56,9 +57,6 @@ static void setup_image(PngLoader::ImageData &image, png_structp png_ptr,
     png_uint_32 height;
     int bit_depth;
     int color_type;
-    png_bytep trans_alpha = 0;
-    png_color_16p trans_color_p = 0;
-    int num_trans;
     png_colorp palette = 0;
     int num_palette;
     int interlace_method;
@@ -74,8 +72,6 @@ static void setup_image(PngLoader::ImageData &image, png_structp png_ptr,
 
             image.width = width;
             image.height = height;
-            image.bits = (unsigned char*) malloc(
-                    width * height * sizeof(unsigned char));
             image.format = PngLoader::GrayFormat;
 
         } else if (bit_depth == 16
@@ -86,14 +82,13 @@ static void setup_image(PngLoader::ImageData &image, png_structp png_ptr,
 
             image.width = width;
             image.height = height;
-            image.bits = (unsigned char*) malloc(
-                    width * height * 4 * sizeof(unsigned char));
             image.format = PngLoader::RGBAFormat;
 
             png_read_update_info(png_ptr, info_ptr);
         } else {
 
             LOGE("PNG Format not supported");
+            return false;
 
         }
     } else if (color_type == PNG_COLOR_TYPE_PALETTE
@@ -105,17 +100,13 @@ static void setup_image(PngLoader::ImageData &image, png_structp png_ptr,
         png_read_update_info(png_ptr, info_ptr);
         png_get_IHDR(png_ptr, info_ptr, &width, &height, &bit_depth,
                 &color_type, 0, 0, 0);
-        PngLoader::ImageFormat format;
         if (bit_depth == 1) {
-            format = PngLoader::GrayFormat;
-
             image.width = width;
             image.height = height;
-            image.bits = (unsigned char*) malloc(
-                    width * height * sizeof(unsigned char));
             image.format = PngLoader::GrayFormat;
         } else {
             LOGE("PNG Format Indexed8 not supported");
+            return false;
         }
 
     } else {
@@ -128,8 +119,6 @@ static void setup_image(PngLoader::ImageData &image, png_structp png_ptr,
         if (color_type == PNG_COLOR_TYPE_GRAY_ALPHA)
             png_set_gray_to_rgb(png_ptr);
 
-        // Format_ARGB32;
-        PngLoader::ImageFormat format = PngLoader::RGBAFormat;
         // Only add filler if no alpha, or we can get 5 channel data.
         if (!(color_type & PNG_COLOR_MASK_ALPHA)
                 && !png_get_valid(png_ptr, info_ptr, PNG_INFO_tRNS)) {
@@ -144,111 +133,234 @@ static void setup_image(PngLoader::ImageData &image, png_structp png_ptr,
             // We want 4 bytes, but it isn't an alpha channel (XRGB32)
             image.width = width;
             image.height = height;
-            image.bits = (unsigned char*) malloc(
-                    width * height * 4 * sizeof(unsigned char));
             image.format = PngLoader::RGBAFormat;
 
-            return;
+            return true;
         }
 
         image.width = width;
         image.height = height;
-        image.bits = (unsigned char*) malloc(
-                width * height * 4 * sizeof(unsigned char));
         image.format = PngLoader::RGBAFormat;
 
         png_read_update_info(png_ptr, info_ptr);
     }
-
+    return true;
 }
 
 static void gvrf_png_warning(png_structp, png_const_charp message) {
     LOGE("libpng warning: %s", message);
 }
 
+/*
+ * libpng copies the compressed data out of the mapped file, so each chunk
+ * it reads is a memcpy rather than a call into the asset manager.
+ */
+void PngLoader::readFromMemory(png_structp png_ptr, png_bytep data,
+        png_size_t length) {
+    MemoryReader* reader = (MemoryReader *) png_get_io_ptr(png_ptr);
+    if (length > reader->size - reader->offset) {
+        png_error(png_ptr, "Read past the end of the PNG data");
+    }
+    memcpy(data, reader->data + reader->offset, length);
+    reader->offset += length;
+}
+
+int PngLoader::bytesPerPixel(ImageFormat format) {
+    switch (format) {
+    case GrayFormat:
+        return 1;
+    case RGBFormat:
+        return 3;
+    case RGBAFormat:
+        return 4;
+    default:
+        return 0;
+    }
+}
+
+void PngLoader::close() {
+    if (png_ptr) {
+        png_destroy_read_struct(&png_ptr, &info_ptr, &end_info);
+        png_ptr = 0;
+        info_ptr = 0;
+        end_info = 0;
+    }
+    amp.deallocate();
+}
+
 void PngLoader::loadFromAsset(AAsset *file) {
     pFileDescriptor = file;
     pOutImage.bits = NULL;
 
+    gvr::MappedAsset asset(file);
+    if (asset.data() == NULL
+            || !readHeader(asset.data(), asset.size(), 0)) {
+        return;
+    }
+
+    int bpl = bytesPerPixel(pOutImage.format) * pOutImage.width;
+    unsigned char *data = (unsigned char*) malloc(bpl * pOutImage.height);
+    if (data == NULL) {
+        close();
+        return;
+    }
+    if (!decode(data, bpl)) {
+        free(data);
+        return;
+    }
+    pOutImage.bits = data;
+}
+
+bool PngLoader::readHeader(const unsigned char *data, size_t size,
+        int maxSize) {
+    close();
+    pOutImage.bits = NULL;
+    reader.data = data;
+    reader.size = size;
+    reader.offset = 0;
+
+    if (size < 8 || png_sig_cmp(const_cast<png_bytep>(data), 0, 8) != 0) {
+        LOGE("Not a PNG file");
+        return false;
+    }
+
     png_ptr = png_create_read_struct(PNG_LIBPNG_VER_STRING, 0, 0, 0);
     if (!png_ptr)
-        return;
+        return false;
 
     png_set_error_fn(png_ptr, 0, 0, gvrf_png_warning);
 
     info_ptr = png_create_info_struct(png_ptr);
-    if (!info_ptr) {
-        png_destroy_read_struct(&png_ptr, 0, 0);
-        png_ptr = 0;
-        return;
-    }
-
     end_info = png_create_info_struct(png_ptr);
-    if (!end_info) {
-        png_destroy_read_struct(&png_ptr, &info_ptr, 0);
-        png_ptr = 0;
-        return;
+    if (!info_ptr || !end_info) {
+        close();
+        return false;
     }
 
     if (setjmp(png_jmpbuf(png_ptr))) {
-        png_destroy_read_struct(&png_ptr, &info_ptr, &end_info);
-        png_ptr = 0;
-        return;
+        LOGE("PNG header is corrupt");
+        close();
+        return false;
     }
 
-    png_set_read_fn(png_ptr, file, iod_read_fn);
+    png_set_read_fn(png_ptr, &reader, readFromMemory);
     png_read_info(png_ptr, info_ptr);
 
-    if (setjmp(png_jmpbuf(png_ptr))) {
-        png_destroy_read_struct(&png_ptr, &info_ptr, &end_info);
-        png_ptr = 0;
-        amp.deallocate();
-        return;
+    png_uint_32 width;
+    png_uint_32 height;
+    int bit_depth;
+    int color_type;
+    int interlace_method;
+    png_get_IHDR(png_ptr, info_ptr, &width, &height, &bit_depth, &color_type,
+            &interlace_method, 0, 0);
+    interlaced = interlace_method != PNG_INTERLACE_NONE;
+
+    if (!setup_image(pOutImage, png_ptr, info_ptr, gamma)) {
+        close();
+        return false;
     }
+    sourceWidth = pOutImage.width;
+    sourceHeight = pOutImage.height;
+
+    // 1-bit images stay packed eight pixels to a byte, and are not filtered
+    subsampleShift = 0;
+    if (maxSize > 0 && bit_depth > 1) {
+        while ((sourceWidth >> subsampleShift) > maxSize
+                || (sourceHeight >> subsampleShift) > maxSize) {
+            ++subsampleShift;
+        }
+    }
+    pOutImage.width = std::max(sourceWidth >> subsampleShift, 1);
+    pOutImage.height = std::max(sourceHeight >> subsampleShift, 1);
+    return true;
+}
 
-    setup_image(pOutImage, png_ptr, info_ptr, gamma);
+bool PngLoader::decode(unsigned char *pixels, int stride) {
+    if (!png_ptr) {
+        return false;
+    }
 
-    if (pOutImage.bits == NULL) {
-        png_destroy_read_struct(&png_ptr, &info_ptr, &end_info);
-        png_ptr = 0;
-        amp.deallocate();
-        return;
+    if (setjmp(png_jmpbuf(png_ptr))) {
+        LOGE("PNG data is corrupt");
+        close();
+        return false;
     }
 
-    png_uint_32 width;
-    png_uint_32 height;
-    int bit_depth;
-    int color_type;
-    png_get_IHDR(png_ptr, info_ptr, &width, &height, &bit_depth, &color_type, 0,
-            0, 0);
-    unsigned char *data = pOutImage.bits;
-    int bpp = 0;
-    switch (pOutImage.format) {
-    case GrayFormat:
-        bpp = 1;
-        break;
-    case RGBFormat:
-        bpp = 3;
-        break;
-    case RGBAFormat:
-        bpp = 4;
-        break;
-    default:
-        break;
+    if (subsampleShift == 0) {
+        decodeRows(pixels, stride);
+    } else {
+        decodeSubsampledRows(pixels, stride, bytesPerPixel(pOutImage.format));
     }
-    int bpl = bpp * pOutImage.width;
-    amp.row_pointers = new png_bytep[height];
+    close();
+    return true;
+}
 
-    for (uint y = 0; y < height; y++)
-        amp.row_pointers[y] = data + y * bpl;
+void PngLoader::decodeRows(unsigned char *pixels, int stride) {
+    amp.row_pointers = new png_bytep[sourceHeight];
+    for (int y = 0; y < sourceHeight; y++)
+        amp.row_pointers[y] = FAST_SCAN_LINE(pixels, stride, y);
 
     png_read_image(png_ptr, amp.row_pointers);
-    amp.deallocate();
-
     png_read_end(png_ptr, end_info);
-
-    png_destroy_read_struct(&png_ptr, &info_ptr, &end_info);
-    png_ptr = 0;
-    amp.deallocate();
 }
 
+/*
+ * Each pixel is the average of the block of source pixels it covers, clipped
+ * to the source at the right and bottom. Rows of a non-interlaced PNG are
+ * read one at a time and summed as they come, and the rows past the last
+ * block are never decompressed; an interlaced PNG has to be read whole
+ * before any row is complete, so it goes through a full-size scratch image.
+ */
+void PngLoader::decodeSubsampledRows(unsigned char *pixels, int stride,
+        int bpp) {
+    int width = pOutImage.width;
+    int height = pOutImage.height;
+    int block = 1 << subsampleShift;
+    int bpl = bpp * sourceWidth;
+
+    if (interlaced) {
+        amp.inRow = new png_byte[bpl * sourceHeight];
+        amp.row_pointers = new png_bytep[sourceHeight];
+        for (int y = 0; y < sourceHeight; y++)
+            amp.row_pointers[y] = FAST_SCAN_LINE(amp.inRow, bpl, y);
+        png_read_image(png_ptr, amp.row_pointers);
+    } else {
+        amp.inRow = new png_byte[bpl];
+    }
+    amp.accRow = new unsigned int[width * bpp];
+
+    for (int y = 0; y < height; y++) {
+        int top = y << subsampleShift;
+        int bottom = std::min(top + block, sourceHeight);
+        memset(amp.accRow, 0, width * bpp * sizeof(unsigned int));
+
+        for (int sy = top; sy < bottom; sy++) {
+            const png_byte *in = amp.inRow;
+            if (interlaced) {
+                in = amp.row_pointers[sy];
+            } else {
+                png_read_row(png_ptr, amp.inRow, NULL);
+            }
+            unsigned int *acc = amp.accRow;
+            for (int x = 0; x < width; x++, acc += bpp) {
+                int left = x << subsampleShift;
+                int right = std::min(left + block, sourceWidth);
+                for (const png_byte *p = in + left * bpp;
+                        p < in + right * bpp; p += bpp) {
+                    for (int c = 0; c < bpp; c++)
+                        acc[c] += p[c];
+                }
+            }
+        }
+
+        unsigned char *out = FAST_SCAN_LINE(pixels, stride, y);
+        const unsigned int *acc = amp.accRow;
+        for (int x = 0; x < width; x++, acc += bpp, out += bpp) {
+            int left = x << subsampleShift;
+            unsigned int count = (std::min(left + block, sourceWidth) - left)
+                    * (bottom - top);
+            for (int c = 0; c < bpp; c++)
+                out[c] = (acc[c] + count / 2) / count;
+        }
+    }
+}
@@ -28,15 +28,35 @@ public:
 
     PngLoader() :
             gamma(0.0), png_ptr(0), info_ptr(0), end_info(0), pFileDescriptor(
-                    NULL) {
+                    NULL), subsampleShift(0), sourceWidth(0), sourceHeight(0), interlaced(
+                    false) {
+        pOutImage.bits = NULL;
+    }
+
+    ~PngLoader() {
+        close();
     }
 
     void loadFromAsset(AAsset *file);
 
+    /*
+     * Two-step decode of a PNG already in memory, which has to outlive the
+     * loader. readHeader() fills in pOutImage, but for bits, so the caller
+     * can set aside memory for it - a mapped pixel unpack buffer, say; the
+     * image is halved until neither side is over maxSize, 0 meaning no
+     * limit. decode() then writes the rows straight to pixels, stride bytes
+     * apart, box-filtering them down as they are read when the image was
+     * halved. Both return false, and log why, if the PNG cannot be read.
+     */
+    bool readHeader(const unsigned char *data, size_t size, int maxSize);
+    bool decode(unsigned char *pixels, int stride);
+
     enum ImageFormat {
         GrayFormat, RGBFormat, RGBAFormat
     };
 
+    static int bytesPerPixel(ImageFormat format);
+
     struct ImageData {
         unsigned char *bits;
         int width;
@@ -47,6 +67,18 @@ public:
 
 private:
 
+    PngLoader(const PngLoader& png_loader);
+    PngLoader(PngLoader&& png_loader);
+    PngLoader& operator=(const PngLoader& png_loader);
+    PngLoader& operator=(PngLoader&& png_loader);
+
+    static void readFromMemory(png_structp png_ptr, png_bytep data,
+            png_size_t length);
+
+    void close();
+    void decodeRows(unsigned char *pixels, int stride);
+    void decodeSubsampledRows(unsigned char *pixels, int stride, int bpp);
+
     float gamma;
 
     png_struct *png_ptr;
@@ -78,6 +110,20 @@ private:
 
     AAsset * pFileDescriptor;
 
+    // the PNG readHeader() was given, and how far libpng has read it
+    struct MemoryReader {
+        const unsigned char *data;
+        size_t size;
+        size_t offset;
+    };
+
+    MemoryReader reader;
+
+    // the image is 1 << subsampleShift times smaller than the PNG each way
+    int subsampleShift;
+    int sourceWidth;
+    int sourceHeight;
+    bool interlaced;
 };
 
 #endif
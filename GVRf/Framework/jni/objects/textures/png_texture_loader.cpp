@@ -0,0 +1,174 @@
+/* Copyright 2015 Samsung Electronics Co., LTD
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/***************************************************************************
+ * Makes textures of PNG assets, decoding them in parallel.
+ ***************************************************************************/
+
+#include "png_texture_loader.h"
+
+#include <mutex>
+
+#include "engine/renderer/work_stealing_pool.h"
+#include "objects/textures/base_texture.h"
+#include "objects/textures/mapped_asset.h"
+#include "objects/textures/png_loader.h"
+#include "util/gvr_log.h"
+
+namespace gvr {
+
+namespace {
+
+struct PngJob {
+    PngJob() :
+            asset(0), mapped_asset(0), loader(), pixel_buffer(0), pixels(0), readable(
+                    false), decoded(false) {
+    }
+
+    ~PngJob() {
+        delete mapped_asset;
+        if (asset != 0) {
+            AAsset_close(asset);
+        }
+    }
+
+    int stride() const {
+        return loader.pOutImage.width
+                * PngLoader::bytesPerPixel(loader.pOutImage.format);
+    }
+
+    AAsset* asset;
+    MappedAsset* mapped_asset;
+    PngLoader loader;
+    GLuint pixel_buffer;
+    unsigned char* pixels;
+    bool readable;
+    bool decoded;
+};
+
+}
+
+// only one batch at a time uses the pool
+static std::mutex decode_mutex;
+static WorkStealingPool decode_pool;
+
+/*
+ * Staging memory for an image: a pixel unpack buffer mapped for writing,
+ * or, if it cannot be mapped, malloc'd memory that glTexImage2D() copies
+ * from as before.
+ */
+static void mapPixels(PngJob& job) {
+    GLsizeiptr size = job.stride() * job.loader.pOutImage.height;
+    glGenBuffers(1, &job.pixel_buffer);
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, job.pixel_buffer);
+    glBufferData(GL_PIXEL_UNPACK_BUFFER, size, 0, GL_STREAM_DRAW);
+    job.pixels = static_cast<unsigned char*>(glMapBufferRange(
+            GL_PIXEL_UNPACK_BUFFER, 0, size,
+            GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT));
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+    if (job.pixels == 0) {
+        LOGE("PngTextureLoader : cannot map a pixel unpack buffer");
+        glDeleteBuffers(1, &job.pixel_buffer);
+        job.pixel_buffer = 0;
+        job.pixels = static_cast<unsigned char*>(malloc(size));
+    }
+}
+
+static BaseTexture* makeTexture(PngJob& job, int* texture_parameters) {
+    BaseTexture* texture = 0;
+    int width = job.loader.pOutImage.width;
+    int height = job.loader.pOutImage.height;
+    if (job.pixel_buffer != 0) {
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, job.pixel_buffer);
+        if (glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER) == GL_FALSE) {
+            LOGE("PngTextureLoader : pixel unpack buffer was lost");
+            job.decoded = false;
+        }
+        if (job.decoded) {
+            // with a pixel unpack buffer bound, the pixels are an offset
+            texture = new BaseTexture(width, height, 0, texture_parameters);
+        }
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+        glDeleteBuffers(1, &job.pixel_buffer);
+    } else {
+        if (job.decoded) {
+            texture = new BaseTexture(width, height, job.pixels,
+                    texture_parameters);
+        }
+        free(job.pixels);
+    }
+    job.pixel_buffer = 0;
+    job.pixels = 0;
+    return texture;
+}
+
+void PngTextureLoader::load(AAssetManager* asset_manager,
+        const std::vector<std::string>& filenames, int max_size,
+        int* texture_parameters, std::vector<BaseTexture*>& textures) {
+    int count = filenames.size();
+    std::vector<PngJob> jobs(count);
+    textures.assign(count, 0);
+
+    std::lock_guard<std::mutex> lock(decode_mutex);
+    decode_pool.set_thread_count(0);
+
+    decode_pool.run(count, [&](int i) {
+        PngJob& job = jobs[i];
+        job.asset = AAssetManager_open(asset_manager, filenames[i].c_str(),
+                AASSET_MODE_BUFFER);
+        if (job.asset == 0) {
+            LOGE("_ASSET_NOT_FOUND_ %s", filenames[i].c_str());
+            return;
+        }
+        job.mapped_asset = new MappedAsset(job.asset);
+        if (job.mapped_asset->data() == 0
+                || !job.loader.readHeader(job.mapped_asset->data(),
+                        job.mapped_asset->size(), max_size)) {
+            LOGE("PNG decoder failed on %s", filenames[i].c_str());
+            return;
+        }
+        if (job.loader.pOutImage.format != PngLoader::RGBAFormat) {
+            LOGE("Only RGBA format supported: %s", filenames[i].c_str());
+            return;
+        }
+        job.readable = true;
+    });
+
+    // buffers are made and mapped on the GL thread; the mappings can then
+    // be written from any thread
+    for (auto it = jobs.begin(); it != jobs.end(); ++it) {
+        if (it->readable) {
+            mapPixels(*it);
+        }
+    }
+
+    decode_pool.run(count, [&](int i) {
+        PngJob& job = jobs[i];
+        if (job.pixels != 0) {
+            job.decoded = job.loader.decode(job.pixels, job.stride());
+            if (!job.decoded) {
+                LOGE("PNG decoder failed on %s", filenames[i].c_str());
+            }
+        }
+    });
+
+    for (int i = 0; i < count; ++i) {
+        if (jobs[i].readable) {
+            textures[i] = makeTexture(jobs[i], texture_parameters);
+        }
+    }
+}
+
+}
@@ -0,0 +1,62 @@
+/* Copyright 2015 Samsung Electronics Co., LTD
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/***************************************************************************
+ * Makes textures of PNG assets, decoding them in parallel.
+ ***************************************************************************/
+
+#ifndef PNG_TEXTURE_LOADER_H_
+#define PNG_TEXTURE_LOADER_H_
+
+#include <string>
+#include <vector>
+
+#include "android/asset_manager.h"
+
+namespace gvr {
+class BaseTexture;
+
+/*
+ * Loads a batch of PNG assets as textures:
+ *
+ * - each asset is mapped from the APK rather than read through the asset
+ *   manager a chunk at a time;
+ * - the headers are read, and then the images decoded, on a pool of
+ *   threads, the GL thread being one of them;
+ * - rows are decoded straight into mapped pixel unpack buffers, which the
+ *   textures are then made from without another copy.
+ *
+ * Images with a side over max_size are halved until they fit, 0 meaning no
+ * limit, which saves decoding and uploading detail that will only be
+ * mipmapped away.
+ */
+class PngTextureLoader {
+public:
+    // textures[i] is null if filenames[i] cannot be loaded. Must be called
+    // on the GL thread.
+    static void load(AAssetManager* asset_manager,
+            const std::vector<std::string>& filenames, int max_size,
+            int* texture_parameters, std::vector<BaseTexture*>& textures);
+
+private:
+    PngTextureLoader();
+    PngTextureLoader(const PngTextureLoader& png_texture_loader);
+    PngTextureLoader(PngTextureLoader&& png_texture_loader);
+    PngTextureLoader& operator=(const PngTextureLoader& png_texture_loader);
+    PngTextureLoader& operator=(PngTextureLoader&& png_texture_loader);
+};
+
+}
+#endif
@@ -18,17 +18,21 @@
 #include <jni.h>
 #include "../engine/renderer/renderer.h"
 #include "../objects/components/camera.h"
+#include "../objects/components/camera_rig.h"
+#include "util/gvr_profiler.h"
 
 namespace gvr {
 
 extern "C" {
 
 void Java_org_gearvrf_GVRViewManager_cull(JNIEnv * jni, jclass clazz,
-        jlong jscene, jlong jcamera, jlong jshader_manager) {
+        jlong jscene, jlong jcamera_rig, jlong jshader_manager) {
     Scene* scene = reinterpret_cast<Scene*>(jscene);
-    Camera* camera = reinterpret_cast<Camera*>(jcamera);
+    CameraRig* camera_rig = reinterpret_cast<CameraRig*>(jcamera_rig);
     ShaderManager* shader_manager = reinterpret_cast<ShaderManager*>(jshader_manager);
-    Renderer::cull(scene, camera, shader_manager);
+    // culling starts each frame
+    Profiler::beginFrame();
+    Renderer::cull(scene, camera_rig, shader_manager);
 }
 
 void Java_org_gearvrf_GVRViewManager_renderCamera(JNIEnv * jni, jclass clazz,
@@ -109,17 +113,7 @@ void GVRViewManager::renderCamera(OVR::OvrSceneView &ovr_scene, Scene* scene,
         PostEffectShaderManager* post_effect_shader_manager,
         RenderTexture* post_effect_render_texture_a,
         RenderTexture* post_effect_render_texture_b) {
-#ifdef GVRF_FBO_FPS
-    // starting to collect rendering time
-    // first flash GPU tasks
-    glFinish();
-
-    // collect data
-    struct timeval start, end;
-    double t1, t2;
-    float fps = 0.0;
-    gettimeofday(&start, NULL);
-#endif
+    GVR_PROFILE("render eye");
 
     if (camera->render_mask() == 1) {
         glClearColor(0.0f, 1.0f, 0.0f, 1.0f);
@@ -131,23 +125,5 @@ void GVRViewManager::renderCamera(OVR::OvrSceneView &ovr_scene, Scene* scene,
     Renderer::renderCamera(scene, camera, shader_manager,
             post_effect_shader_manager, post_effect_render_texture_a,
             post_effect_render_texture_b);
-
-#ifdef GVRF_FBO_FPS
-    // finish rendering
-    glFinish();// force rendering
-
-    gettimeofday(&end, NULL);
-    t1 = start.tv_sec + (start.tv_usec / 1000000.0);
-    t2 = end.tv_sec + (end.tv_usec / 1000000.0);
-    gTotalSec += (t2 - t1);
-    gNumFrame++;
-
-    fps = (float)gNumFrame/gTotalSec;
-    if(!(gNumFrame%50) )
-    {
-        LOGI("FPS is %.2f gNumFrame=%d, gTotalSec = %.2f", fps, gNumFrame, gTotalSec);
-    }
-#endif
-
 }
 }
@@ -40,7 +40,6 @@ class ShaderManager;
 
 
 #define OCULUS_EXAMPLE_CODE
-//#define GVRF_FBO_FPS
 
 class GVRViewManager
 {
@@ -24,6 +24,7 @@
 
 #include "ktracker_data_info.h"
 #include "util/gvr_log.h"
+#include "util/gvr_profiler.h"
 #include "util/gvr_time.h"
 #include <chrono>
 #include <assert.h>
@@ -156,6 +157,7 @@ bool KSensor::pollSensor(KTrackerSensorZip* data) {
 }
 
 void KSensor::process(KTrackerSensorZip* data, vec3& corrected_gyro, Quaternion& q) {
+    GVR_PROFILE("sensor");
     const float timeUnit = (1.0f / 1000.f);
 
     struct timespec tp;
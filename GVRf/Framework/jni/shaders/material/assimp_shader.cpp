@@ -20,6 +20,7 @@
 #include "assimp_shader.h"
 
 #include "gl/gl_program.h"
+#include "gl/gl_state.h"
 #include "objects/material.h"
 #include "objects/mesh.h"
 #include "objects/components/render_data.h"
@@ -80,9 +81,8 @@ static const char FRAGMENT_SHADER[] =
                 "}\n";
 
 AssimpShader::AssimpShader() :
-        program_(0), u_mvp_(0), u_diffuse_color_(0), u_ambient_color_(
-                0), u_texture_(0), u_color_(0), u_opacity_(
-                0), program_list_(0) {
+        program_(0), program_list_(0), u_mvp_(0), u_texture_(0), u_diffuse_color_(
+                0), u_ambient_color_(0), u_color_(0), u_opacity_(0) {
     program_list_ = new GLProgram*[AS_TOTAL_GL_PROGRAM_COUNT];
 
     const char* vertex_shader_strings[AS_TOTAL_SHADER_STRINGS_COUNT];
@@ -132,6 +132,15 @@ AssimpShader::AssimpShader() :
         program_list_[i] = new GLProgram(vertex_shader_strings,
                     vertex_shader_string_lengths, fragment_shader_strings,
                     fragment_shader_string_lengths, counter);
+
+        /* Uniform locations are fixed once linked */
+        GLuint id = program_list_[i]->id();
+        u_mvp_list_[i] = glGetUniformLocation(id, "u_mvp");
+        u_texture_list_[i] = glGetUniformLocation(id, "u_texture");
+        u_diffuse_color_list_[i] = glGetUniformLocation(id, "u_diffuse_color");
+        u_ambient_color_list_[i] = glGetUniformLocation(id, "u_ambient_color");
+        u_color_list_[i] = glGetUniformLocation(id, "u_color");
+        u_opacity_list_[i] = glGetUniformLocation(id, "u_opacity");
     }
 }
 
@@ -163,7 +172,12 @@ void AssimpShader::render(const glm::mat4& mv_matrix,
 
     /* Get the texture only diffuse texture is set */
     if (ISSET(feature_set, AS_DIFFUSE_TEXTURE)) {
-        texture = material->getTexture("main_texture");
+        texture = material->getTexture(PropertyBlock::MAIN_TEXTURE);
+        if (texture == 0) {
+            std::string error =
+                    "AssimpShader::render : material property not set";
+            throw error;
+        }
         if (texture->getTarget() != GL_TEXTURE_2D) {
             std::string error =
                     "TextureShader::render : texture with wrong target.";
@@ -172,32 +186,44 @@ void AssimpShader::render(const glm::mat4& mv_matrix,
     }
 
     /* Based on feature set get the shader program, feature set cannot exceed program count */
-    program_ = program_list_[feature_set & (AS_TOTAL_GL_PROGRAM_COUNT - 1)];
+    int program_index = feature_set & (AS_TOTAL_GL_PROGRAM_COUNT - 1);
+    program_ = program_list_[program_index];
 
-    u_mvp_ = glGetUniformLocation(program_->id(), "u_mvp");
-    u_texture_ = glGetUniformLocation(program_->id(), "u_texture");
-    u_diffuse_color_ = glGetUniformLocation(program_->id(), "u_diffuse_color");
-    u_ambient_color_ = glGetUniformLocation(program_->id(), "u_ambient_color");
-    u_color_ = glGetUniformLocation(program_->id(), "u_color");
-    u_opacity_ = glGetUniformLocation(program_->id(), "u_opacity");
+    u_mvp_ = u_mvp_list_[program_index];
+    u_texture_ = u_texture_list_[program_index];
+    u_diffuse_color_ = u_diffuse_color_list_[program_index];
+    u_ambient_color_ = u_ambient_color_list_[program_index];
+    u_color_ = u_color_list_[program_index];
+    u_opacity_ = u_opacity_list_[program_index];
 
     /* Get common attributes and uniforms from material */
-    glm::vec3 color = material->getVec3("color");
-    float opacity = material->getFloat("opacity");
+    glm::vec3 color;
+    float opacity;
+    glm::vec4 diffuse_color;
+    glm::vec4 ambient_color;
+    bool found = material->getVec3(PropertyBlock::COLOR, color)
+            && material->getFloat(PropertyBlock::OPACITY, opacity);
+    if (!ISSET(feature_set, AS_DIFFUSE_TEXTURE)) {
+        found = found
+                && material->getVec4(PropertyBlock::DIFFUSE_COLOR,
+                        diffuse_color)
+                && material->getVec4(PropertyBlock::AMBIENT_COLOR,
+                        ambient_color);
+    }
+    if (!found) {
+        std::string error = "AssimpShader::render : material property not set";
+        throw error;
+    }
 
 #if _GVRF_USE_GLES3_
-    mesh->generateVAO();
-
-    glUseProgram(program_->id());
+    GLState::useProgram(program_->id());
     glUniformMatrix4fv(u_mvp_, 1, GL_FALSE, glm::value_ptr(mvp_matrix));
 
     if (ISSET(feature_set, AS_DIFFUSE_TEXTURE)) {
-        glActiveTexture (GL_TEXTURE0);
-        glBindTexture(texture->getTarget(), texture->getId());
+        GLState::activeTexture(GL_TEXTURE0);
+        GLState::bindTexture(texture->getTarget(), texture->getId());
         glUniform1i(u_texture_, 0);
     } else {
-        glm::vec4 diffuse_color = material->getVec4("diffuse_color");
-        glm::vec4 ambient_color = material->getVec4("ambient_color");
         glUniform4f(u_diffuse_color_, diffuse_color.r, diffuse_color.g,
                 diffuse_color.b, diffuse_color.a);
         glUniform4f(u_ambient_color_, ambient_color.r, ambient_color.g,
@@ -206,12 +232,11 @@ void AssimpShader::render(const glm::mat4& mv_matrix,
     glUniform3f(u_color_, color.r, color.g, color.b);
     glUniform1f(u_opacity_, opacity);
 
-    glBindVertexArray(mesh->getVAOId(Material::ASSIMP_SHADER));
-    glDrawElements(GL_TRIANGLES, mesh->triangles().size(), GL_UNSIGNED_SHORT,
-            0);
-    glBindVertexArray(0);
+    GLState::bindVertexArray(mesh->getVAOId());
+    glDrawElements(GL_TRIANGLES, mesh->getNumTriangles() * 3,
+            GL_UNSIGNED_SHORT, 0);
 #else
-    glUseProgram(program_->id());
+    GLState::useProgram(program_->id());
 
     glVertexAttribPointer(a_position_, 3, GL_FLOAT, GL_FALSE, 0,
             mesh->vertices().data());
@@ -224,12 +249,10 @@ void AssimpShader::render(const glm::mat4& mv_matrix,
     glUniformMatrix4fv(u_mvp_, 1, GL_FALSE, glm::value_ptr(mvp_matrix));
 
     if (ISSET(feature_set, AS_DIFFUSE_TEXTURE)) {
-        glActiveTexture (GL_TEXTURE0);
-        glBindTexture(texture->getTarget(), texture->getId());
+        GLState::activeTexture(GL_TEXTURE0);
+        GLState::bindTexture(texture->getTarget(), texture->getId());
         glUniform1i(u_texture_, 0);
     } else {
-        glm::vec4 diffuse_color = material->getVec4("diffuse_color");
-        glm::vec4 ambient_color = material->getVec4("ambient_color");
         glUniform4f(u_diffuse_color_, diffuse_color.x, diffuse_color.y, diffuse_color.z, diffuse_color.w);
         glUniform4f(u_ambient_color_, ambient_color.x, ambient_color.y, ambient_color.z, ambient_color.w);
     }
@@ -77,6 +77,14 @@ private:
     GLuint u_ambient_color_;
     GLuint u_color_;
     GLuint u_opacity_;
+
+    // the locations above, per program in program_list_
+    GLuint u_mvp_list_[AS_TOTAL_GL_PROGRAM_COUNT];
+    GLuint u_texture_list_[AS_TOTAL_GL_PROGRAM_COUNT];
+    GLuint u_diffuse_color_list_[AS_TOTAL_GL_PROGRAM_COUNT];
+    GLuint u_ambient_color_list_[AS_TOTAL_GL_PROGRAM_COUNT];
+    GLuint u_color_list_[AS_TOTAL_GL_PROGRAM_COUNT];
+    GLuint u_opacity_list_[AS_TOTAL_GL_PROGRAM_COUNT];
 };
 
 }
@@ -19,11 +19,9 @@
 
 #include "bounding_box_shader.h"
 
+#include "engine/memory/gl_delete.h"
 #include "gl/gl_program.h"
-#include "objects/material.h"
-#include "objects/mesh.h"
-#include "objects/components/render_data.h"
-#include "objects/textures/texture.h"
+#include "gl/gl_state.h"
 #include "util/gvr_gl.h"
 
 namespace gvr {
@@ -41,8 +39,18 @@ static const char FRAGMENT_SHADER[] = //
                 "gl_FragColor =  vec4(0.0, 1.0, 0.0, 0.0);\n"
                 "}\n";
 
+// the corners of the unit cube and its twelve triangles, wound
+// counter-clockwise seen from outside
+static const GLfloat CUBE_VERTICES[] = { 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f,
+        1.0f, 1.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f, 1.0f, 1.0f, 0.0f, 1.0f,
+        1.0f, 1.0f, 1.0f, 0.0f, 1.0f, 1.0f };
+
+static const GLushort CUBE_INDICES[] = { 0, 2, 1, 0, 3, 2, 4, 5, 6, 4, 6, 7, 0,
+        1, 5, 0, 5, 4, 3, 7, 6, 3, 6, 2, 0, 4, 7, 0, 7, 3, 1, 2, 6, 1, 6, 5 };
+
 BoundingBoxShader::BoundingBoxShader() :
-        program_(0), u_mvp_(0) {
+        program_(0), u_mvp_(0), vertex_array_(0), vertex_buffer_(0),
+        index_buffer_(0) {
     program_ = new GLProgram(VERTEX_SHADER, FRAGMENT_SHADER);
     u_mvp_ = glGetUniformLocation(program_->id(), "u_mvp");
 }
@@ -56,36 +64,59 @@ BoundingBoxShader::~BoundingBoxShader() {
 void BoundingBoxShader::recycle() {
     delete program_;
     program_ = 0;
+#if _GVRF_USE_GLES3_
+    if (vertex_array_ != 0) {
+        gl_delete.queueVertexArray(vertex_array_);
+        gl_delete.queueBuffer(vertex_buffer_);
+        gl_delete.queueBuffer(index_buffer_);
+        vertex_array_ = 0;
+        vertex_buffer_ = 0;
+        index_buffer_ = 0;
+    }
+#endif
 }
 
-void BoundingBoxShader::render(const glm::mat4& mvp_matrix,
-        RenderData* render_data, Material* material) {
-    Mesh* mesh = render_data->mesh();
+void BoundingBoxShader::beginBoxes() {
+    GLState::useProgram(program_->id());
 
 #if _GVRF_USE_GLES3_
-    mesh->generateVAO();
-
-    glUseProgram(program_->id());
-    glUniformMatrix4fv(u_mvp_, 1, GL_FALSE, glm::value_ptr(mvp_matrix));
-
-    glBindVertexArray(mesh->getVAOId(material->shader_type()));
-    glDrawElements(GL_TRIANGLES, mesh->triangles().size(), GL_UNSIGNED_SHORT,
-            0);
-    glBindVertexArray(0);
-
+    if (vertex_array_ == 0) {
+        glGenVertexArrays(1, &vertex_array_);
+        GLState::bindVertexArray(vertex_array_);
+
+        glGenBuffers(1, &index_buffer_);
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, index_buffer_);
+        glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(CUBE_INDICES),
+                CUBE_INDICES, GL_STATIC_DRAW);
+
+        glGenBuffers(1, &vertex_buffer_);
+        glBindBuffer(GL_ARRAY_BUFFER, vertex_buffer_);
+        glBufferData(GL_ARRAY_BUFFER, sizeof(CUBE_VERTICES), CUBE_VERTICES,
+                GL_STATIC_DRAW);
+        glEnableVertexAttribArray(GLProgram::POSITION_ATTRIBUTE_LOCATION);
+        glVertexAttribPointer(GLProgram::POSITION_ATTRIBUTE_LOCATION, 3,
+                GL_FLOAT, GL_FALSE, 0, 0);
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+    } else {
+        GLState::bindVertexArray(vertex_array_);
+    }
 #else
-    glUseProgram(program_->id());
-    glVertexAttribPointer(a_position_, 3, GL_FLOAT, GL_FALSE, 0,
-            mesh->vertices().data());
-    glEnableVertexAttribArray(a_position_);
+    glVertexAttribPointer(GLProgram::POSITION_ATTRIBUTE_LOCATION, 3, GL_FLOAT,
+            GL_FALSE, 0, CUBE_VERTICES);
+    glEnableVertexAttribArray(GLProgram::POSITION_ATTRIBUTE_LOCATION);
+#endif
+
+    checkGlError("BoundingBoxShader::beginBoxes");
+}
 
+void BoundingBoxShader::renderBox(const glm::mat4& mvp_matrix) {
     glUniformMatrix4fv(u_mvp_, 1, GL_FALSE, glm::value_ptr(mvp_matrix));
-    glDrawElements(GL_TRIANGLES, mesh->triangles().size(), GL_UNSIGNED_SHORT,
-            mesh->triangles().data());
+#if _GVRF_USE_GLES3_
+    glDrawElements(GL_TRIANGLES, CUBE_INDEX_COUNT, GL_UNSIGNED_SHORT, 0);
+#else
+    glDrawElements(GL_TRIANGLES, CUBE_INDEX_COUNT, GL_UNSIGNED_SHORT,
+            CUBE_INDICES);
 #endif
-
-    checkGlError("BoundingBoxShader::render");
 }
 
 }
-;
@@ -30,15 +30,20 @@
 
 namespace gvr {
 class GLProgram;
-class RenderData;
-class Material;
 
+/*
+ * Draws boxes as one shared unit cube, [0, 1] along each axis, scaled and
+ * translated into place by the matrix of each box. A batch of boxes binds
+ * the program and the cube once in beginBoxes(), after which each box is a
+ * uniform update and a draw.
+ */
 class BoundingBoxShader: public RecyclableObject {
 public:
     BoundingBoxShader();
     ~BoundingBoxShader();
     void recycle();
-    void render(const glm::mat4& mvp_matrix, RenderData* render_data, Material* material);
+    void beginBoxes();
+    void renderBox(const glm::mat4& mvp_matrix);
 
 private:
     BoundingBoxShader(const BoundingBoxShader& bounding_box_shader);
@@ -47,8 +52,13 @@ private:
     BoundingBoxShader& operator=(BoundingBoxShader&& bounding_box_shader);
 
 private:
+    static const int CUBE_INDEX_COUNT = 36;
+
     GLProgram* program_;
     GLuint u_mvp_;
+    GLuint vertex_array_;
+    GLuint vertex_buffer_;
+    GLuint index_buffer_;
 };
 
 }
@@ -20,6 +20,7 @@
 #include "cubemap_reflection_shader.h"
 
 #include "gl/gl_program.h"
+#include "gl/gl_state.h"
 #include "objects/material.h"
 #include "objects/mesh.h"
 #include "objects/components/render_data.h"
@@ -122,9 +123,15 @@ void CubemapReflectionShader::render(const glm::mat4& mv_matrix,
         const glm::mat4& mv_it_matrix, const glm::mat4& view_invers_matrix,
         const glm::mat4& mvp_matrix, RenderData* render_data, Material* material) {
     Mesh* mesh = render_data->mesh();
-    Texture* texture = material->getTexture("main_texture");
-    glm::vec3 color = material->getVec3("color");
-    float opacity = material->getFloat("opacity");
+    Texture* texture = material->getTexture(PropertyBlock::MAIN_TEXTURE);
+    glm::vec3 color;
+    float opacity;
+    if (texture == 0 || !material->getVec3(PropertyBlock::COLOR, color)
+            || !material->getFloat(PropertyBlock::OPACITY, opacity)) {
+        std::string error =
+                "CubemapReflectionShader::render : material property not set";
+        throw error;
+    }
 
     if (texture->getTarget() != GL_TEXTURE_CUBE_MAP) {
         std::string error =
@@ -133,27 +140,24 @@ void CubemapReflectionShader::render(const glm::mat4& mv_matrix,
     }
 
 #if _GVRF_USE_GLES3_
-    mesh->generateVAO();
-
-    glUseProgram(program_->id());
+    GLState::useProgram(program_->id());
 
     glUniformMatrix4fv(u_mv_, 1, GL_FALSE, glm::value_ptr(mv_matrix));
     glUniformMatrix4fv(u_mv_it_, 1, GL_FALSE, glm::value_ptr(mv_it_matrix));
     glUniformMatrix4fv(u_mvp_, 1, GL_FALSE, glm::value_ptr(mvp_matrix));
     glUniformMatrix4fv(u_view_i_, 1, GL_FALSE,
             glm::value_ptr(view_invers_matrix));
-    glActiveTexture (GL_TEXTURE0);
-    glBindTexture(texture->getTarget(), texture->getId());
+    GLState::activeTexture(GL_TEXTURE0);
+    GLState::bindTexture(texture->getTarget(), texture->getId());
     glUniform1i(u_texture_, 0);
     glUniform3f(u_color_, color.r, color.g, color.b);
     glUniform1f(u_opacity_, opacity);
 
-    glBindVertexArray(mesh->getVAOId(Material::CUBEMAP_REFLECTION_SHADER));
-    glDrawElements(GL_TRIANGLES, mesh->triangles().size(), GL_UNSIGNED_SHORT,
-            0);
-    glBindVertexArray(0);
+    GLState::bindVertexArray(mesh->getVAOId());
+    glDrawElements(GL_TRIANGLES, mesh->getNumTriangles() * 3,
+            GL_UNSIGNED_SHORT, 0);
 #else
-    glUseProgram(program_->id());
+    GLState::useProgram(program_->id());
 
     glVertexAttribPointer(a_position_, 3, GL_FLOAT, GL_FALSE, 0,
             mesh->vertices().data());
@@ -168,8 +172,8 @@ void CubemapReflectionShader::render(const glm::mat4& mv_matrix,
     glUniformMatrix4fv(u_mvp_, 1, GL_FALSE, glm::value_ptr(mvp_matrix));
     glUniformMatrix4fv(u_view_i_, 1, GL_FALSE, glm::value_ptr(view_invers_matrix));
 
-    glActiveTexture (GL_TEXTURE0);
-    glBindTexture(texture->getTarget(), texture->getId());
+    GLState::activeTexture(GL_TEXTURE0);
+    GLState::bindTexture(texture->getTarget(), texture->getId());
     glUniform1i(u_texture_, 0);
 
     glUniform3f(u_color_, color.r, color.g, color.b);
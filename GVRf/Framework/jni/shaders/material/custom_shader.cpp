@@ -19,7 +19,11 @@
 
 #include "custom_shader.h"
 
+#include <algorithm>
+
+#include "gl/gl_instance_buffer.h"
 #include "gl/gl_program.h"
+#include "gl/gl_state.h"
 #include "objects/material.h"
 #include "objects/mesh.h"
 #include "objects/textures/texture.h"
@@ -29,11 +33,21 @@
 namespace gvr {
 CustomShader::CustomShader(std::string vertex_shader,
         std::string fragment_shader) :
-        program_(0), u_mvp_(0), u_right_(
-                0), texture_keys_(), attribute_float_keys_(), attribute_vec2_keys_(), attribute_vec3_keys_(), attribute_vec4_keys_(), uniform_float_keys_(), uniform_vec2_keys_(), uniform_vec3_keys_(), uniform_vec4_keys_(), uniform_mat4_keys_() {
+        program_(0), u_mvp_(-1), u_model_(-1), u_right_(-1), u_vp_(
+                -1), instanced_(false), uploaded_material_(0), uploaded_version_(
+                0), uploaded_right_(-1), samplers_set_(false), uploaded_vp_valid_(
+                false), texture_keys_(), attribute_float_keys_(), attribute_vec2_keys_(), attribute_vec3_keys_(), attribute_vec4_keys_(), uniform_float_keys_(), uniform_vec2_keys_(), uniform_vec3_keys_(), uniform_vec4_keys_(), uniform_mat4_keys_() {
     program_ = new GLProgram(vertex_shader.c_str(), fragment_shader.c_str());
     u_mvp_ = glGetUniformLocation(program_->id(), "u_mvp");
+    u_model_ = glGetUniformLocation(program_->id(), "u_model");
     u_right_ = glGetUniformLocation(program_->id(), "u_right");
+    u_vp_ = glGetUniformLocation(program_->id(), "u_vp");
+#if _GVRF_USE_GLES3_
+    bool frame_uniforms = glGetUniformBlockIndex(program_->id(),
+            "FrameUniforms") != GL_INVALID_INDEX;
+    instanced_ = glGetAttribLocation(program_->id(), "a_model") != -1
+            && (u_vp_ != -1 || frame_uniforms);
+#endif
 }
 
 CustomShader::~CustomShader() {
@@ -49,243 +63,250 @@ void CustomShader::recycle() {
 
 void CustomShader::addTextureKey(std::string variable_name, std::string key) {
     int location = glGetUniformLocation(program_->id(), variable_name.c_str());
-    texture_keys_[location] = key;
+    texture_keys_[location] = PropertyBlock::id(key);
+    invalidateUniforms();
 }
 
 void CustomShader::addAttributeFloatKey(std::string variable_name,
         std::string key) {
     int location = glGetAttribLocation(program_->id(), variable_name.c_str());
     attribute_float_keys_[location] = key;
+    updateAttributeLayout();
 }
 
 void CustomShader::addAttributeVec2Key(std::string variable_name,
         std::string key) {
     int location = glGetAttribLocation(program_->id(), variable_name.c_str());
     attribute_vec2_keys_[location] = key;
+    updateAttributeLayout();
 }
 
 void CustomShader::addAttributeVec3Key(std::string variable_name,
         std::string key) {
     int location = glGetAttribLocation(program_->id(), variable_name.c_str());
     attribute_vec3_keys_[location] = key;
+    updateAttributeLayout();
 }
 
 void CustomShader::addAttributeVec4Key(std::string variable_name,
         std::string key) {
     int location = glGetAttribLocation(program_->id(), variable_name.c_str());
     attribute_vec4_keys_[location] = key;
+    updateAttributeLayout();
 }
 
 void CustomShader::addUniformFloatKey(std::string variable_name,
         std::string key) {
     int location = glGetUniformLocation(program_->id(), variable_name.c_str());
-    uniform_float_keys_[location] = key;
+    uniform_float_keys_[location] = PropertyBlock::id(key);
+    invalidateUniforms();
 }
 
 void CustomShader::addUniformVec2Key(std::string variable_name,
         std::string key) {
     int location = glGetUniformLocation(program_->id(), variable_name.c_str());
-    uniform_vec2_keys_[location] = key;
+    uniform_vec2_keys_[location] = PropertyBlock::id(key);
+    invalidateUniforms();
 }
 
 void CustomShader::addUniformVec3Key(std::string variable_name,
         std::string key) {
     int location = glGetUniformLocation(program_->id(), variable_name.c_str());
-    uniform_vec3_keys_[location] = key;
+    uniform_vec3_keys_[location] = PropertyBlock::id(key);
+    invalidateUniforms();
 }
 
 void CustomShader::addUniformVec4Key(std::string variable_name,
         std::string key) {
     int location = glGetUniformLocation(program_->id(), variable_name.c_str());
-    uniform_vec4_keys_[location] = key;
+    uniform_vec4_keys_[location] = PropertyBlock::id(key);
+    invalidateUniforms();
 }
 
 void CustomShader::addUniformMat4Key(std::string variable_name,
         std::string key) {
     int location = glGetUniformLocation(program_->id(), variable_name.c_str());
-    uniform_mat4_keys_[location] = key;
+    uniform_mat4_keys_[location] = PropertyBlock::id(key);
+    invalidateUniforms();
 }
 
-void CustomShader::render(const glm::mat4& mvp_matrix, RenderData* render_data, Material* material,
-        bool right) {
-    Mesh* mesh = render_data->mesh();
-
-#if _GVRF_USE_GLES3_
-    glUseProgram(program_->id());
-
-    for (auto it = attribute_float_keys_.begin();
-            it != attribute_float_keys_.end(); ++it) {
-        mesh->setVertexAttribLocF(it->first, it->second);
-    }
-
-    for (auto it = attribute_vec2_keys_.begin();
-            it != attribute_vec2_keys_.end(); ++it) {
-        mesh->setVertexAttribLocV2(it->first, it->second);
+static void addAttributes(const std::map<int, std::string>& keys, int size,
+        Mesh::AttributeLayout& layout) {
+    for (auto it = keys.begin(); it != keys.end(); ++it) {
+        if (it->first < 0) {
+            continue;
+        }
+        Mesh::Attribute attribute;
+        attribute.location = it->first;
+        attribute.size = size;
+        attribute.key = it->second;
+        layout.push_back(attribute);
     }
+}
 
-    for (auto it = attribute_vec3_keys_.begin();
-            it != attribute_vec3_keys_.end(); ++it) {
-        mesh->setVertexAttribLocV3(it->first, it->second);
-    }
+void CustomShader::updateAttributeLayout() {
+    attribute_layout_.clear();
+    addAttributes(attribute_float_keys_, 1, attribute_layout_);
+    addAttributes(attribute_vec2_keys_, 2, attribute_layout_);
+    addAttributes(attribute_vec3_keys_, 3, attribute_layout_);
+    addAttributes(attribute_vec4_keys_, 4, attribute_layout_);
+    std::sort(attribute_layout_.begin(), attribute_layout_.end());
+}
 
-    for (auto it = attribute_vec4_keys_.begin();
-            it != attribute_vec4_keys_.end(); ++it) {
-        mesh->setVertexAttribLocV4(it->first, it->second);
-    }
+void CustomShader::render(const glm::mat4& model_matrix,
+        const glm::mat4& mvp_matrix, RenderData* render_data,
+        Material* material, bool right) {
+#if _GVRF_USE_GLES3_
+    Mesh* mesh = render_data->mesh();
 
-    mesh->generateVAO();  // setup VAO
-
-    ///////////// uniform /////////
-    for (auto it = uniform_float_keys_.begin(); it != uniform_float_keys_.end();
-            ++it) {
-        glUniform1f(it->first, material->getFloat(it->second));
-    }
+    setUpProgram(render_data, material, right);
 
     if (u_mvp_ != -1) {
         glUniformMatrix4fv(u_mvp_, 1, GL_FALSE, glm::value_ptr(mvp_matrix));
     }
-    if (u_right_ != 0) {
-        glUniform1i(u_right_, right ? 1 : 0);
+    if (u_model_ != -1) {
+        glUniformMatrix4fv(u_model_, 1, GL_FALSE, glm::value_ptr(model_matrix));
     }
 
-    int texture_index = 0;
-    for (auto it = texture_keys_.begin(); it != texture_keys_.end(); ++it) {
-        glActiveTexture(getGLTexture(texture_index));
-        Texture* texture = material->getTexture(it->second);
-        glBindTexture(texture->getTarget(), texture->getId());
-        glUniform1i(it->first, texture_index++);
-    }
+    GLState::bindVertexArray(mesh->getVAOId(attribute_layout_));
+    glDrawElements(GL_TRIANGLES, mesh->getNumTriangles() * 3,
+            GL_UNSIGNED_SHORT, 0);
 
-    for (auto it = uniform_vec2_keys_.begin(); it != uniform_vec2_keys_.end();
-            ++it) {
-        glm::vec2 v = material->getVec2(it->second);
-        glUniform2f(it->first, v.x, v.y);
-    }
+    checkGlError("CustomShader::render");
+#else
+    std::string error = "CustomShader::render : needs GLES3.";
+    throw error;
+#endif
+}
 
-    for (auto it = uniform_vec3_keys_.begin(); it != uniform_vec3_keys_.end();
-            ++it) {
-        glm::vec3 v = material->getVec3(it->second);
-        glUniform3f(it->first, v.x, v.y, v.z);
-    }
+void CustomShader::renderInstanced(const glm::mat4& vp_matrix,
+        RenderData* render_data, Material* material, bool right,
+        const GLInstanceBuffer* instance_buffer) {
+#if _GVRF_USE_GLES3_
+    Mesh* mesh = render_data->mesh();
 
-    for (auto it = uniform_vec4_keys_.begin(); it != uniform_vec4_keys_.end();
-            ++it) {
-        glm::vec4 v = material->getVec4(it->second);
-        glUniform4f(it->first, v.x, v.y, v.z, v.w);
-    }
+    setUpProgram(render_data, material, right);
 
-    for (auto it = uniform_mat4_keys_.begin(); it != uniform_mat4_keys_.end();
-            ++it) {
-        glm::mat4 m = material->getMat4(it->second);
-        glUniformMatrix4fv(it->first, 1, GL_FALSE, glm::value_ptr(m));
+    if (u_vp_ != -1 && (!uploaded_vp_valid_ || uploaded_vp_ != vp_matrix)) {
+        glUniformMatrix4fv(u_vp_, 1, GL_FALSE, glm::value_ptr(vp_matrix));
+        uploaded_vp_ = vp_matrix;
+        uploaded_vp_valid_ = true;
     }
 
-    glBindVertexArray(mesh->getVAOId(material->shader_type()));
-    glDrawElements(GL_TRIANGLES, mesh->triangles().size(), GL_UNSIGNED_SHORT,
-            0);
-    glBindVertexArray(0);
-#else
-    glUseProgram(program_->id());
+    GLState::bindVertexArray(mesh->getVAOId(attribute_layout_));
+    instance_buffer->bindModelMatrixAttribute();
+    glDrawElementsInstanced(GL_TRIANGLES, mesh->getNumTriangles() * 3,
+            GL_UNSIGNED_SHORT, 0, instance_buffer->instance_count());
 
-    if (a_position_ != -1) {
-        glVertexAttribPointer(a_position_, 3, GL_FLOAT, GL_FALSE, 0,
-                mesh->vertices().data());
-        glEnableVertexAttribArray(a_position_);
-    }
-
-    if (a_normal_ != -1) {
-        glVertexAttribPointer(a_normal_, 3, GL_FLOAT, GL_FALSE, 0,
-                mesh->normals().data());
-        glEnableVertexAttribArray(a_normal_);
-    }
+    checkGlError("CustomShader::renderInstanced");
+#else
+    std::string error = "CustomShader::renderInstanced : needs GLES3.";
+    throw error;
+#endif
+}
 
-    if (a_tex_coord_ != -1) {
-        glVertexAttribPointer(a_tex_coord_, 2, GL_FLOAT, GL_FALSE, 0,
-                mesh->tex_coords().data());
-        glEnableVertexAttribArray(a_tex_coord_);
-    }
+#if _GVRF_USE_GLES3_
+void CustomShader::setUpProgram(RenderData* render_data, Material* material,
+        bool right) {
+    GLState::useProgram(program_->id());
 
-    if (u_mvp_ != -1) {
-        glUniformMatrix4fv(u_mvp_, 1, GL_FALSE, glm::value_ptr(mvp_matrix));
+    if (u_right_ != -1 && uploaded_right_ != right) {
+        glUniform1i(u_right_, right ? 1 : 0);
+        uploaded_right_ = right;
     }
 
-    if (u_right_ != 0) {
-        glUniform1i(u_right_, right ? 1 : 0);
+    // each texture key keeps its unit, so the samplers are set once
+    if (!samplers_set_) {
+        int texture_index = 0;
+        for (auto it = texture_keys_.begin(); it != texture_keys_.end(); ++it) {
+            glUniform1i(it->first, texture_index++);
+        }
+        samplers_set_ = true;
     }
 
+    // other programs use the units in between, so the textures are bound on
+    // every draw; GLState drops the binds that are already in place
     int texture_index = 0;
-
     for (auto it = texture_keys_.begin(); it != texture_keys_.end(); ++it) {
-        glActiveTexture(getGLTexture(texture_index));
-        Texture* texture = render_data->material()->getTexture(
-                it->second);
-        glBindTexture(texture->getTarget(), texture->getId());
-        glUniform1i(it->first, texture_index++);
-    }
-
-    for (auto it = attribute_float_keys_.begin();
-            it != attribute_float_keys_.end(); ++it) {
-        glVertexAttribPointer(it->first, 1, GL_FLOAT, GL_FALSE, 0,
-                mesh->getFloatVector(it->second).data());
-        glEnableVertexAttribArray(it->first);
-    }
-
-    for (auto it = attribute_vec2_keys_.begin();
-            it != attribute_vec2_keys_.end(); ++it) {
-        glVertexAttribPointer(it->first, 2, GL_FLOAT, GL_FALSE, 0,
-                mesh->getVec2Vector(it->second).data());
-        glEnableVertexAttribArray(it->first);
+        GLState::activeTexture(getGLTexture(texture_index++));
+        Texture* texture = material->getTexture(it->second);
+        if (texture == 0) {
+            std::string error = "CustomShader::render : texture not set";
+            throw error;
+        }
+        GLState::bindTexture(texture->getTarget(), texture->getId());
     }
 
-    for (auto it = attribute_vec3_keys_.begin();
-            it != attribute_vec3_keys_.end(); ++it) {
-        glVertexAttribPointer(it->first, 3, GL_FLOAT, GL_FALSE, 0,
-                mesh->getVec3Vector(it->second).data());
-        glEnableVertexAttribArray(it->first);
+    if (material == uploaded_material_
+            && material->version() == uploaded_version_) {
+        return;
     }
 
-    for (auto it = attribute_vec4_keys_.begin();
-            it != attribute_vec4_keys_.end(); ++it) {
-        glVertexAttribPointer(it->first, 4, GL_FLOAT, GL_FALSE, 0,
-                mesh->getVec4Vector(it->second).data());
-        glEnableVertexAttribArray(it->first);
-    }
+    // a missing property fails the draw half way through, leaving the
+    // uniforms of no material in particular
+    uploaded_material_ = 0;
 
+    ///////////// uniform /////////
+    bool found = true;
     for (auto it = uniform_float_keys_.begin(); it != uniform_float_keys_.end();
             ++it) {
-        glUniform1f(it->first, render_data->material()->getFloat(it->second));
+        float value;
+        if (material->getFloat(it->second, value)) {
+            glUniform1f(it->first, value);
+        } else {
+            found = false;
+        }
     }
 
     for (auto it = uniform_vec2_keys_.begin(); it != uniform_vec2_keys_.end();
             ++it) {
-        glm::vec2 v = render_data->material()->getVec2(it->second);
-        glUniform2f(it->first, v.x, v.y);
+        glm::vec2 v;
+        if (material->getVec2(it->second, v)) {
+            glUniform2f(it->first, v.x, v.y);
+        } else {
+            found = false;
+        }
     }
 
     for (auto it = uniform_vec3_keys_.begin(); it != uniform_vec3_keys_.end();
             ++it) {
-        glm::vec3 v = render_data->material()->getVec3(it->second);
-        glUniform3f(it->first, v.x, v.y, v.z);
+        glm::vec3 v;
+        if (material->getVec3(it->second, v)) {
+            glUniform3f(it->first, v.x, v.y, v.z);
+        } else {
+            found = false;
+        }
     }
 
     for (auto it = uniform_vec4_keys_.begin(); it != uniform_vec4_keys_.end();
             ++it) {
-        glm::vec4 v = render_data->material()->getVec4(it->second);
-        glUniform4f(it->first, v.x, v.y, v.z, v.w);
+        glm::vec4 v;
+        if (material->getVec4(it->second, v)) {
+            glUniform4f(it->first, v.x, v.y, v.z, v.w);
+        } else {
+            found = false;
+        }
     }
 
     for (auto it = uniform_mat4_keys_.begin(); it != uniform_mat4_keys_.end();
             ++it) {
-        glm::mat4 m = render_data->material()->getMat4(it->second);
-        glUniformMatrix4fv(it->first, 1, GL_FALSE, glm::value_ptr(m));
+        glm::mat4 m;
+        if (material->getMat4(it->second, m)) {
+            glUniformMatrix4fv(it->first, 1, GL_FALSE, glm::value_ptr(m));
+        } else {
+            found = false;
+        }
     }
 
-    glDrawElements(GL_TRIANGLES, mesh->triangles().size(), GL_UNSIGNED_SHORT,
-            mesh->triangles().data());
-#endif
+    if (!found) {
+        std::string error = "CustomShader::render : material property not set";
+        throw error;
+    }
 
-    checkGlError("CustomShader::render");
+    uploaded_material_ = material;
+    uploaded_version_ = material->version();
 }
+#endif
 
 int CustomShader::getGLTexture(int n) {
     switch (n) {
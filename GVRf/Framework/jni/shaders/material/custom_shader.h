@@ -30,10 +30,12 @@
 #include "glm/gtc/type_ptr.hpp"
 
 #include "objects/eye_type.h"
+#include "objects/mesh.h"
 #include "objects/recyclable_object.h"
 
 namespace gvr {
 
+class GLInstanceBuffer;
 class GLProgram;
 class RenderData;
 class Material;
@@ -54,7 +56,16 @@ public:
     void addUniformVec3Key(std::string variable_name, std::string key);
     void addUniformVec4Key(std::string variable_name, std::string key);
     void addUniformMat4Key(std::string variable_name, std::string key);
-    void render(const glm::mat4& mvp_matrix, RenderData* render_data, Material* material, bool right);
+    void render(const glm::mat4& model_matrix, const glm::mat4& mvp_matrix,
+            RenderData* render_data, Material* material, bool right);
+    // programs that declare "attribute mat4 a_model", and "uniform mat4 u_vp"
+    // or the FrameUniforms block, are always drawn through renderInstanced()
+    bool instanced() const {
+        return instanced_;
+    }
+    void renderInstanced(const glm::mat4& vp_matrix, RenderData* render_data,
+            Material* material, bool right,
+            const GLInstanceBuffer* instance_buffer);
     static int getGLTexture(int n);
 
 private:
@@ -63,20 +74,45 @@ private:
     CustomShader& operator=(const CustomShader& custom_shader);
     CustomShader& operator=(CustomShader&& custom_shader);
 
+    void setUpProgram(RenderData* render_data, Material* material, bool right);
+    void updateAttributeLayout();
+    void invalidateUniforms() {
+        uploaded_material_ = 0;
+        samplers_set_ = false;
+    }
+
 private:
     GLProgram* program_;
-    GLuint u_mvp_;
-    GLuint u_right_;
-    std::map<int, std::string> texture_keys_;
+    // -1 for the uniforms the program does not declare; programs that read
+    // the eye's matrices from FrameUniforms only need u_model
+    GLint u_mvp_;
+    GLint u_model_;
+    GLint u_right_;
+    GLint u_vp_;
+    bool instanced_;
+
+    // What the program's uniforms were last set to. Uniforms live in the
+    // program, so they only need setting again when the material, or its
+    // version, or the eye differs from the last draw.
+    const Material* uploaded_material_;
+    unsigned int uploaded_version_;
+    int uploaded_right_;
+    bool samplers_set_;
+    bool uploaded_vp_valid_;
+    glm::mat4 uploaded_vp_;
+    // uniform locations to material property ids, resolved as they are added
+    std::map<int, int> texture_keys_;
     std::map<int, std::string> attribute_float_keys_;
     std::map<int, std::string> attribute_vec2_keys_;
     std::map<int, std::string> attribute_vec3_keys_;
     std::map<int, std::string> attribute_vec4_keys_;
-    std::map<int, std::string> uniform_float_keys_;
-    std::map<int, std::string> uniform_vec2_keys_;
-    std::map<int, std::string> uniform_vec3_keys_;
-    std::map<int, std::string> uniform_vec4_keys_;
-    std::map<int, std::string> uniform_mat4_keys_;
+    // the attribute keys above, as the mesh keys its vertex arrays
+    Mesh::AttributeLayout attribute_layout_;
+    std::map<int, int> uniform_float_keys_;
+    std::map<int, int> uniform_vec2_keys_;
+    std::map<int, int> uniform_vec3_keys_;
+    std::map<int, int> uniform_vec4_keys_;
+    std::map<int, int> uniform_mat4_keys_;
 };
 
 }
@@ -20,6 +20,7 @@
 #include "error_shader.h"
 
 #include "gl/gl_program.h"
+#include "gl/gl_state.h"
 #include "objects/material.h"
 #include "objects/mesh.h"
 #include "objects/components/render_data.h"
@@ -65,20 +66,16 @@ void ErrorShader::render(const glm::mat4& mvp_matrix, RenderData* render_data) {
     float a = 1.0f;
 
 #if _GVRF_USE_GLES3_
-    Material* material = render_data->pass(0)->material();
-    mesh->generateVAO();
-
-    glUseProgram(program_->id());
+    GLState::useProgram(program_->id());
 
     glUniformMatrix4fv(u_mvp_, 1, GL_FALSE, glm::value_ptr(mvp_matrix));
     glUniform4f(u_color_, r, g, b, a);
 
-    glBindVertexArray(mesh->getVAOId(material->shader_type()));
-    glDrawElements(GL_TRIANGLES, mesh->triangles().size(), GL_UNSIGNED_SHORT,
-            0);
-    glBindVertexArray(0);
+    GLState::bindVertexArray(mesh->getVAOId());
+    glDrawElements(GL_TRIANGLES, mesh->getNumTriangles() * 3,
+            GL_UNSIGNED_SHORT, 0);
 #else
-    glUseProgram(program_->id());
+    GLState::useProgram(program_->id());
 
     glVertexAttribPointer(a_position_, 3, GL_FLOAT, GL_FALSE, 0,
             mesh->vertices().data());
@@ -20,6 +20,7 @@
 #include "oes_shader.h"
 
 #include "gl/gl_program.h"
+#include "gl/gl_state.h"
 #include "objects/material.h"
 #include "objects/mesh.h"
 #include "objects/components/render_data.h"
@@ -71,9 +72,15 @@ void OESShader::recycle() {
 
 void OESShader::render(const glm::mat4& mvp_matrix, RenderData* render_data, Material* material) {
     Mesh* mesh = render_data->mesh();
-    Texture* texture = material->getTexture("main_texture");
-    glm::vec3 color = material->getVec3("color");
-    float opacity = material->getFloat("opacity");
+    Texture* texture = material->getTexture(PropertyBlock::MAIN_TEXTURE);
+    glm::vec3 color;
+    float opacity;
+    if (texture == 0 || !material->getVec3(PropertyBlock::COLOR, color)
+            || !material->getFloat(PropertyBlock::OPACITY, opacity)) {
+        std::string error =
+                "OESShader::render : material property not set";
+        throw error;
+    }
 
     if (texture->getTarget() != GL_TEXTURE_EXTERNAL_OES) {
         std::string error = "OESShader::render : texture with wrong target";
@@ -81,24 +88,21 @@ void OESShader::render(const glm::mat4& mvp_matrix, RenderData* render_data, Mat
     }
 
 #if _GVRF_USE_GLES3_
-    mesh->generateVAO();
-
-    glUseProgram(program_->id());
+    GLState::useProgram(program_->id());
 
     glUniformMatrix4fv(u_mvp_, 1, GL_FALSE, glm::value_ptr(mvp_matrix));
-    glActiveTexture (GL_TEXTURE0);
-    glBindTexture(texture->getTarget(), texture->getId());
+    GLState::activeTexture(GL_TEXTURE0);
+    GLState::bindTexture(texture->getTarget(), texture->getId());
     glUniform1i(u_texture_, 0);
     glUniform3f(u_color_, color.r, color.g, color.b);
     glUniform1f(u_opacity_, opacity);
 
-    glBindVertexArray(mesh->getVAOId(Material::OES_SHADER));
-    glDrawElements(GL_TRIANGLES, mesh->triangles().size(), GL_UNSIGNED_SHORT,
-            0);
-    glBindVertexArray(0);
+    GLState::bindVertexArray(mesh->getVAOId());
+    glDrawElements(GL_TRIANGLES, mesh->getNumTriangles() * 3,
+            GL_UNSIGNED_SHORT, 0);
 #else
 
-    glUseProgram(program_->id());
+    GLState::useProgram(program_->id());
 
     glVertexAttribPointer(a_position_, 3, GL_FLOAT, GL_FALSE, 0,
             mesh->vertices().data());
@@ -110,8 +114,8 @@ void OESShader::render(const glm::mat4& mvp_matrix, RenderData* render_data, Mat
 
     glUniformMatrix4fv(u_mvp_, 1, GL_FALSE, glm::value_ptr(mvp_matrix));
 
-    glActiveTexture (GL_TEXTURE0);
-    glBindTexture(texture->getTarget(), texture->getId());
+    GLState::activeTexture(GL_TEXTURE0);
+    GLState::bindTexture(texture->getTarget(), texture->getId());
     glUniform1i(u_texture_, 0);
 
     glUniform3f(u_color_, color.r, color.g, color.b);
@@ -20,6 +20,7 @@
 #include "oes_vertical_stereo_shader.h"
 
 #include "gl/gl_program.h"
+#include "gl/gl_state.h"
 #include "objects/material.h"
 #include "objects/mesh.h"
 #include "objects/components/render_data.h"
@@ -76,10 +77,15 @@ void OESVerticalStereoShader::recycle() {
 void OESVerticalStereoShader::render(const glm::mat4& mvp_matrix,
         RenderData* render_data, Material* material, bool right) {
     Mesh* mesh = render_data->mesh();
-    Texture* texture = material->getTexture("main_texture");
-    glm::vec3 color = material->getVec3("color");
-    float opacity = material->getFloat("opacity");
-    bool mono_rendering;
+    Texture* texture = material->getTexture(PropertyBlock::MAIN_TEXTURE);
+    glm::vec3 color;
+    float opacity;
+    if (texture == 0 || !material->getVec3(PropertyBlock::COLOR, color)
+            || !material->getFloat(PropertyBlock::OPACITY, opacity)) {
+        std::string error =
+                "OESVerticalStereoShader::render : material property not set";
+        throw error;
+    }
 
     if (texture->getTarget() != GL_TEXTURE_EXTERNAL_OES) {
         std::string error =
@@ -87,31 +93,27 @@ void OESVerticalStereoShader::render(const glm::mat4& mvp_matrix,
         throw error;
     }
 
-    try {
-        mono_rendering = material->getFloat("mono_rendering") == 1;
-    } catch (std::string& error) {
-        mono_rendering = false;
-    }
+    const float* mono_rendering_value = material->properties().findFloat(
+            PropertyBlock::MONO_RENDERING);
+    bool mono_rendering = mono_rendering_value != 0
+            && *mono_rendering_value == 1;
 
 #if _GVRF_USE_GLES3_
-    mesh->generateVAO();
-
-    glUseProgram(program_->id());
+    GLState::useProgram(program_->id());
 
     glUniformMatrix4fv(u_mvp_, 1, GL_FALSE, glm::value_ptr(mvp_matrix));
-    glActiveTexture (GL_TEXTURE0);
-    glBindTexture(texture->getTarget(), texture->getId());
+    GLState::activeTexture(GL_TEXTURE0);
+    GLState::bindTexture(texture->getTarget(), texture->getId());
     glUniform1i(u_texture_, 0);
     glUniform3f(u_color_, color.r, color.g, color.b);
     glUniform1f(u_opacity_, opacity);
     glUniform1i(u_right_, mono_rendering || right ? 1 : 0);
 
-    glBindVertexArray(mesh->getVAOId(Material::OES_VERTICAL_STEREO_SHADER));
-    glDrawElements(GL_TRIANGLES, mesh->triangles().size(), GL_UNSIGNED_SHORT,
-            0);
-    glBindVertexArray(0);
+    GLState::bindVertexArray(mesh->getVAOId());
+    glDrawElements(GL_TRIANGLES, mesh->getNumTriangles() * 3,
+            GL_UNSIGNED_SHORT, 0);
 #else
-    glUseProgram(program_->id());
+    GLState::useProgram(program_->id());
 
     glVertexAttribPointer(a_position_, 3, GL_FLOAT, GL_FALSE, 0,
             mesh->vertices().data());
@@ -123,8 +125,8 @@ void OESVerticalStereoShader::render(const glm::mat4& mvp_matrix,
 
     glUniformMatrix4fv(u_mvp_, 1, GL_FALSE, glm::value_ptr(mvp_matrix));
 
-    glActiveTexture (GL_TEXTURE0);
-    glBindTexture(texture->getTarget(), texture->getId());
+    GLState::activeTexture(GL_TEXTURE0);
+    GLState::bindTexture(texture->getTarget(), texture->getId());
     glUniform1i(u_texture_, 0);
 
     glUniform3f(u_color_, color.r, color.g, color.b);
@@ -19,7 +19,10 @@
 
 #include "texture_shader.h"
 
+#include "gl/gl_frame_uniforms.h"
+#include "gl/gl_instance_buffer.h"
 #include "gl/gl_program.h"
+#include "gl/gl_state.h"
 #include "objects/material.h"
 #include "objects/light.h"
 #include "objects/mesh.h"
@@ -104,8 +107,33 @@ static const char FRAGMENT_SHADER[] =
                 "  gl_FragColor = vec4(color.r * u_color.r * u_opacity, color.g * u_color.g * u_opacity, color.b * u_color.b * u_opacity, color.a * u_opacity);\n"
                 "}\n";
 
+#if _GVRF_USE_GLES3_
+// the instanced program, without light, reads the eye's matrices from
+// FrameUniforms
+static const char VERTEX_SHADER_INSTANCED[] = "in vec4 a_position;\n"
+        "in vec4 a_tex_coord;\n"
+        "in mat4 a_model;\n"
+        "out vec2 v_tex_coord;\n"
+        "void main() {\n"
+        "  v_tex_coord = a_tex_coord.xy;\n"
+        "  gl_Position = u_view_projection * (a_model * a_position);\n"
+        "}\n";
+
+static const char FRAGMENT_SHADER_INSTANCED[] = "precision highp float;\n"
+        "uniform sampler2D u_texture;\n"
+        "uniform vec3 u_color;\n"
+        "uniform float u_opacity;\n"
+        "in vec2 v_tex_coord;\n"
+        "out vec4 frag_color;\n"
+        "void main() {\n"
+        "  vec4 color = texture(u_texture, v_tex_coord);\n"
+        "  frag_color = vec4(color.rgb * u_color * u_opacity, color.a * u_opacity);\n"
+        "}\n";
+#endif
+
 TextureShader::TextureShader() :
-        program_light_(0), program_no_light_(0),u_mv_(0), u_mv_it_(0), u_mvp_(0), u_light_pos_(
+        program_light_(0), program_no_light_(0), program_instanced_(0), u_texture_instanced_(
+                0), u_color_instanced_(0), u_opacity_instanced_(0), u_mv_(0), u_mv_it_(0), u_mvp_(0), u_light_pos_(
                 0), u_texture_(0), u_color_(0), u_opacity_(0), u_material_ambient_color_(
                 0), u_material_diffuse_color_(0), u_material_specular_color_(0), u_material_specular_exponent_(
                 0), u_light_ambient_intensity_(0), u_light_diffuse_intensity_(
@@ -142,6 +170,29 @@ TextureShader::TextureShader() :
     u_opacity_no_light_ = glGetUniformLocation(program_no_light_->id(),
             "u_opacity");
 
+#if _GVRF_USE_GLES3_
+    const char* vertex_shader_instanced_strings[2] = {
+            GLFrameUniforms::SHADER_HEADER, VERTEX_SHADER_INSTANCED };
+    GLint vertex_shader_instanced_string_lengths[2] = { (GLint) strlen(
+            GLFrameUniforms::SHADER_HEADER), (GLint) strlen(
+            VERTEX_SHADER_INSTANCED) };
+    const char* fragment_shader_instanced_strings[2] = {
+            GLFrameUniforms::SHADER_HEADER, FRAGMENT_SHADER_INSTANCED };
+    GLint fragment_shader_instanced_string_lengths[2] = { (GLint) strlen(
+            GLFrameUniforms::SHADER_HEADER), (GLint) strlen(
+            FRAGMENT_SHADER_INSTANCED) };
+    program_instanced_ = new GLProgram(vertex_shader_instanced_strings,
+            vertex_shader_instanced_string_lengths,
+            fragment_shader_instanced_strings,
+            fragment_shader_instanced_string_lengths, 2);
+    u_texture_instanced_ = glGetUniformLocation(program_instanced_->id(),
+            "u_texture");
+    u_color_instanced_ = glGetUniformLocation(program_instanced_->id(),
+            "u_color");
+    u_opacity_instanced_ = glGetUniformLocation(program_instanced_->id(),
+            "u_opacity");
+#endif
+
     u_mvp_ = glGetUniformLocation(program_light_->id(), "u_mvp");
     u_texture_ = glGetUniformLocation(program_light_->id(), "u_texture");
     u_color_ = glGetUniformLocation(program_light_->id(), "u_color");
@@ -167,7 +218,8 @@ TextureShader::TextureShader() :
 }
 
 TextureShader::~TextureShader() {
-    if (program_light_ != 0 || program_no_light_ != 0) {
+    if (program_light_ != 0 || program_no_light_ != 0
+            || program_instanced_ != 0) {
         recycle();
     }
 }
@@ -181,19 +233,40 @@ void TextureShader::recycle() {
         delete program_no_light_;
         program_no_light_ = 0;
     }
+    if (program_instanced_ != 0) {
+        delete program_instanced_;
+        program_instanced_ = 0;
+    }
 }
 
 void TextureShader::render(const glm::mat4& mv_matrix,
         const glm::mat4& mv_it_matrix, const glm::mat4& mvp_matrix,
         RenderData* render_data, Material* material) {
     Mesh* mesh = render_data->mesh();
-    Texture* texture = material->getTexture("main_texture");
-    glm::vec3 color = material->getVec3("color");
-    float opacity = material->getFloat("opacity");
-    glm::vec4 material_ambient_color = material->getVec4("ambient_color");
-    glm::vec4 material_diffuse_color = material->getVec4("diffuse_color");
-    glm::vec4 material_specular_color = material->getVec4("specular_color");
-    float material_specular_exponent = material->getFloat("specular_exponent");
+    Texture* texture = material->getTexture(PropertyBlock::MAIN_TEXTURE);
+    glm::vec3 color;
+    float opacity;
+    if (texture == 0 || !material->getVec3(PropertyBlock::COLOR, color)
+            || !material->getFloat(PropertyBlock::OPACITY, opacity)) {
+        std::string error =
+                "TextureShader::render : material property not set";
+        throw error;
+    }
+    glm::vec4 material_ambient_color;
+    glm::vec4 material_diffuse_color;
+    glm::vec4 material_specular_color;
+    float material_specular_exponent;
+    if (!material->getVec4(PropertyBlock::AMBIENT_COLOR, material_ambient_color)
+            || !material->getVec4(PropertyBlock::DIFFUSE_COLOR,
+                    material_diffuse_color)
+            || !material->getVec4(PropertyBlock::SPECULAR_COLOR,
+                    material_specular_color)
+            || !material->getFloat(PropertyBlock::SPECULAR_EXPONENT,
+                    material_specular_exponent)) {
+        std::string error =
+                "TextureShader::render : material property not set";
+        throw error;
+    }
 
     if (texture->getTarget() != GL_TEXTURE_2D) {
         std::string error = "TextureShader::render : texture with wrong target.";
@@ -211,23 +284,31 @@ void TextureShader::render(const glm::mat4& mv_matrix,
 
 #if _GVRF_USE_GLES3_
 
-    mesh->generateVAO();
-
     if (use_light) {
-        glUseProgram(program_light_->id());
+        GLState::useProgram(program_light_->id());
     } else {
-        glUseProgram(program_no_light_->id());
+        GLState::useProgram(program_no_light_->id());
     }
 
-    glActiveTexture (GL_TEXTURE0);
-    glBindTexture(texture->getTarget(), texture->getId());
+    GLState::activeTexture(GL_TEXTURE0);
+    GLState::bindTexture(texture->getTarget(), texture->getId());
 
     if (use_light) {
-        glm::vec3 light_position = light->getVec3("position");
-        glm::vec4 light_ambient_intensity = light->getVec4("ambient_intensity");
-        glm::vec4 light_diffuse_intensity = light->getVec4("diffuse_intensity");
-        glm::vec4 light_specular_intensity = light->getVec4(
-                "specular_intensity");
+        glm::vec3 light_position;
+        glm::vec4 light_ambient_intensity;
+        glm::vec4 light_diffuse_intensity;
+        glm::vec4 light_specular_intensity;
+        if (!light->getVec3(PropertyBlock::POSITION, light_position)
+                || !light->getVec4(PropertyBlock::AMBIENT_INTENSITY,
+                        light_ambient_intensity)
+                || !light->getVec4(PropertyBlock::DIFFUSE_INTENSITY,
+                        light_diffuse_intensity)
+                || !light->getVec4(PropertyBlock::SPECULAR_INTENSITY,
+                        light_specular_intensity)) {
+            std::string error =
+                    "TextureShader::render : light property not set";
+            throw error;
+        }
 
         glUniformMatrix4fv(u_mvp_, 1, GL_FALSE, glm::value_ptr(mvp_matrix));
         glUniformMatrix4fv(u_mv_, 1, GL_FALSE, glm::value_ptr(mv_matrix));
@@ -259,7 +340,7 @@ void TextureShader::render(const glm::mat4& mv_matrix,
                 light_specular_intensity.g, light_specular_intensity.b,
                 light_specular_intensity.a);
 
-        glBindVertexArray(mesh->getVAOId(Material::TEXTURE_SHADER));
+        GLState::bindVertexArray(mesh->getVAOId());
     } else {
         glUniformMatrix4fv(u_mvp_no_light_, 1, GL_FALSE,
                 glm::value_ptr(mvp_matrix));
@@ -268,15 +349,14 @@ void TextureShader::render(const glm::mat4& mv_matrix,
         glUniform3f(u_color_no_light_, color.r, color.g, color.b);
         glUniform1f(u_opacity_no_light_, opacity);
 
-        glBindVertexArray(mesh->getVAOId(Material::TEXTURE_SHADER_NOLIGHT));
+        GLState::bindVertexArray(mesh->getVAOId());
     }
 
-    glDrawElements(GL_TRIANGLES, mesh->triangles().size(), GL_UNSIGNED_SHORT,
-            0);
-    glBindVertexArray(0);
+    glDrawElements(GL_TRIANGLES, mesh->getNumTriangles() * 3,
+            GL_UNSIGNED_SHORT, 0);
 
 #else
-    glUseProgram(program_->id());
+    GLState::useProgram(program_->id());
 
     glVertexAttribPointer(a_position_, 3, GL_FLOAT, GL_FALSE, 0,
             mesh->vertices().data());
@@ -286,8 +366,8 @@ void TextureShader::render(const glm::mat4& mv_matrix,
     glUniformMatrix4fv(u_mv_it_, 1, GL_FALSE, glm::value_ptr(mv_it_matrix));
     glUniformMatrix4fv(u_mvp_, 1, GL_FALSE, glm::value_ptr(mvp_matrix));
 
-    glActiveTexture (GL_TEXTURE0);
-    glBindTexture(texture->getTarget(), texture->getId());
+    GLState::activeTexture(GL_TEXTURE0);
+    GLState::bindTexture(texture->getTarget(), texture->getId());
     glUniform1i(u_texture_, 0);
 
     glUniform3f(u_color_, color.r, color.g, color.b);
@@ -301,5 +381,47 @@ void TextureShader::render(const glm::mat4& mv_matrix,
     checkGlError("TextureShader::render");
 }
 
+void TextureShader::renderInstanced(RenderData* render_data,
+        Material* material, const GLInstanceBuffer* instance_buffer) {
+#if _GVRF_USE_GLES3_
+    Mesh* mesh = render_data->mesh();
+    Texture* texture = material->getTexture(PropertyBlock::MAIN_TEXTURE);
+    glm::vec3 color;
+    float opacity;
+    if (texture == 0 || !material->getVec3(PropertyBlock::COLOR, color)
+            || !material->getFloat(PropertyBlock::OPACITY, opacity)) {
+        std::string error =
+                "TextureShader::renderInstanced : material property not set";
+        throw error;
+    }
+
+    if (texture->getTarget() != GL_TEXTURE_2D) {
+        std::string error =
+                "TextureShader::renderInstanced : texture with wrong target.";
+        throw error;
+    }
+
+    GLState::useProgram(program_instanced_->id());
+
+    GLState::activeTexture(GL_TEXTURE0);
+    GLState::bindTexture(texture->getTarget(), texture->getId());
+
+    glUniform1i(u_texture_instanced_, 0);
+    glUniform3f(u_color_instanced_, color.r, color.g, color.b);
+    glUniform1f(u_opacity_instanced_, opacity);
+
+    GLState::bindVertexArray(mesh->getVAOId());
+    instance_buffer->bindModelMatrixAttribute();
+
+    glDrawElementsInstanced(GL_TRIANGLES, mesh->getNumTriangles() * 3,
+            GL_UNSIGNED_SHORT, 0, instance_buffer->instance_count());
+
+    checkGlError("TextureShader::renderInstanced");
+#else
+    std::string error = "TextureShader::renderInstanced : needs GLES3.";
+    throw error;
+#endif
+}
+
 }
 ;
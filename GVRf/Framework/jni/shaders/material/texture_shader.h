@@ -29,6 +29,7 @@
 #include "objects/recyclable_object.h"
 
 namespace gvr {
+class GLInstanceBuffer;
 class GLProgram;
 class RenderData;
 class Material;
@@ -40,6 +41,10 @@ public:
     void recycle();
     void render(const glm::mat4& model_matrix, const glm::mat4& model_it_matrix,
             const glm::mat4& mvp_matrix, RenderData* render_data, Material* material);
+    // draws one instance per model matrix in the instance buffer, without
+    // light; the eye's matrices come from GLFrameUniforms
+    void renderInstanced(RenderData* render_data, Material* material,
+            const GLInstanceBuffer* instance_buffer);
 
 private:
     TextureShader(const TextureShader& texture_shader);
@@ -50,12 +55,17 @@ private:
 private:
     GLProgram* program_light_;
     GLProgram* program_no_light_;
+    GLProgram* program_instanced_;
 
     GLuint u_mvp_no_light_;
     GLuint u_texture_no_light_;
     GLuint u_color_no_light_;
     GLuint u_opacity_no_light_;
 
+    GLuint u_texture_instanced_;
+    GLuint u_color_instanced_;
+    GLuint u_opacity_instanced_;
+
     GLuint u_mv_;
     GLuint u_mv_it_;
     GLuint u_mvp_;
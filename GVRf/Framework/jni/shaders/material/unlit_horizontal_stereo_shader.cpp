@@ -19,7 +19,10 @@
 
 #include "unlit_horizontal_stereo_shader.h"
 
+#include "gl/gl_frame_uniforms.h"
+#include "gl/gl_instance_buffer.h"
 #include "gl/gl_program.h"
+#include "gl/gl_state.h"
 #include "objects/material.h"
 #include "objects/mesh.h"
 #include "objects/components/render_data.h"
@@ -50,15 +53,68 @@ static const char FRAGMENT_SHADER[] =
                 "  gl_FragColor = vec4(color.r * u_color.r * u_opacity, color.g * u_color.g * u_opacity, color.b * u_color.b * u_opacity, color.a * u_opacity);\n"
                 "}\n";
 
+#if _GVRF_USE_GLES3_
+// the instanced program reads the eye's matrices from FrameUniforms
+static const char VERTEX_SHADER_INSTANCED[] = "in vec4 a_position;\n"
+        "in vec4 a_tex_coord;\n"
+        "in mat4 a_model;\n"
+        "out vec2 v_tex_coord;\n"
+        "void main() {\n"
+        "  v_tex_coord = a_tex_coord.xy;\n"
+        "  gl_Position = u_view_projection * (a_model * a_position);\n"
+        "}\n";
+
+static const char FRAGMENT_SHADER_INSTANCED[] = "precision highp float;\n"
+        "uniform sampler2D u_texture;\n"
+        "uniform vec3 u_color;\n"
+        "uniform float u_opacity;\n"
+        "uniform int u_mono_rendering;\n"
+        "in vec2 v_tex_coord;\n"
+        "out vec4 frag_color;\n"
+        "void main() {\n"
+        "  int right = max(u_eye, u_mono_rendering);\n"
+        "  vec2 tex_coord = vec2(0.5 * (v_tex_coord.x + float(right)), v_tex_coord.y);\n"
+        "  vec4 color = texture(u_texture, tex_coord);\n"
+        "  frag_color = vec4(color.rgb * u_color * u_opacity, color.a * u_opacity);\n"
+        "}\n";
+#endif
+
 UnlitHorizontalStereoShader::UnlitHorizontalStereoShader() :
         program_(0), u_mvp_(0), u_texture_(0), u_color_(
-                0), u_opacity_(0), u_right_(0) {
+                0), u_opacity_(0), u_right_(0), program_instanced_(0), u_texture_instanced_(
+                0), u_color_instanced_(0), u_opacity_instanced_(0), u_mono_rendering_instanced_(
+                0) {
     program_ = new GLProgram(VERTEX_SHADER, FRAGMENT_SHADER);
     u_mvp_ = glGetUniformLocation(program_->id(), "u_mvp");
     u_texture_ = glGetUniformLocation(program_->id(), "u_texture");
     u_color_ = glGetUniformLocation(program_->id(), "u_color");
     u_opacity_ = glGetUniformLocation(program_->id(), "u_opacity");
     u_right_ = glGetUniformLocation(program_->id(), "u_right");
+
+#if _GVRF_USE_GLES3_
+    const char* vertex_shader_instanced_strings[2] = {
+            GLFrameUniforms::SHADER_HEADER, VERTEX_SHADER_INSTANCED };
+    GLint vertex_shader_instanced_string_lengths[2] = { (GLint) strlen(
+            GLFrameUniforms::SHADER_HEADER), (GLint) strlen(
+            VERTEX_SHADER_INSTANCED) };
+    const char* fragment_shader_instanced_strings[2] = {
+            GLFrameUniforms::SHADER_HEADER, FRAGMENT_SHADER_INSTANCED };
+    GLint fragment_shader_instanced_string_lengths[2] = { (GLint) strlen(
+            GLFrameUniforms::SHADER_HEADER), (GLint) strlen(
+            FRAGMENT_SHADER_INSTANCED) };
+    program_instanced_ = new GLProgram(vertex_shader_instanced_strings,
+            vertex_shader_instanced_string_lengths,
+            fragment_shader_instanced_strings,
+            fragment_shader_instanced_string_lengths, 2);
+    u_texture_instanced_ = glGetUniformLocation(program_instanced_->id(),
+            "u_texture");
+    u_color_instanced_ = glGetUniformLocation(program_instanced_->id(),
+            "u_color");
+    u_opacity_instanced_ = glGetUniformLocation(program_instanced_->id(),
+            "u_opacity");
+    u_mono_rendering_instanced_ = glGetUniformLocation(
+            program_instanced_->id(), "u_mono_rendering");
+#endif
 }
 
 UnlitHorizontalStereoShader::~UnlitHorizontalStereoShader() {
@@ -70,15 +126,22 @@ UnlitHorizontalStereoShader::~UnlitHorizontalStereoShader() {
 void UnlitHorizontalStereoShader::recycle() {
     delete program_;
     program_ = 0;
+    delete program_instanced_;
+    program_instanced_ = 0;
 }
 
 void UnlitHorizontalStereoShader::render(const glm::mat4& mvp_matrix,
         RenderData* render_data, Material* material, bool right) {
     Mesh* mesh = render_data->mesh();
-    Texture* texture = material->getTexture("main_texture");
-    glm::vec3 color = material->getVec3("color");
-    float opacity = material->getFloat("opacity");
-    bool mono_rendering;
+    Texture* texture = material->getTexture(PropertyBlock::MAIN_TEXTURE);
+    glm::vec3 color;
+    float opacity;
+    if (texture == 0 || !material->getVec3(PropertyBlock::COLOR, color)
+            || !material->getFloat(PropertyBlock::OPACITY, opacity)) {
+        std::string error =
+                "UnlitHorizontalStereoShader::render : material property not set";
+        throw error;
+    }
 
     if (texture->getTarget() != GL_TEXTURE_2D) {
         std::string error =
@@ -86,31 +149,27 @@ void UnlitHorizontalStereoShader::render(const glm::mat4& mvp_matrix,
         throw error;
     }
 
-    try {
-        mono_rendering = material->getFloat("mono_rendering") == 1;
-    } catch (std::string& error) {
-        mono_rendering  = false;
-    }
+    const float* mono_rendering_value = material->properties().findFloat(
+            PropertyBlock::MONO_RENDERING);
+    bool mono_rendering = mono_rendering_value != 0
+            && *mono_rendering_value == 1;
 
 #if _GVRF_USE_GLES3_
-    mesh->generateVAO();
-
-    glUseProgram(program_->id());
+    GLState::useProgram(program_->id());
 
     glUniformMatrix4fv(u_mvp_, 1, GL_FALSE, glm::value_ptr(mvp_matrix));
-    glActiveTexture (GL_TEXTURE0);
-    glBindTexture(texture->getTarget(), texture->getId());
+    GLState::activeTexture(GL_TEXTURE0);
+    GLState::bindTexture(texture->getTarget(), texture->getId());
     glUniform1i(u_texture_, 0);
     glUniform3f(u_color_, color.r, color.g, color.b);
     glUniform1f(u_opacity_, opacity);
     glUniform1i(u_right_, mono_rendering || right ? 1 : 0);
 
-    glBindVertexArray(mesh->getVAOId(Material::UNLIT_HORIZONTAL_STEREO_SHADER));
-    glDrawElements(GL_TRIANGLES, mesh->triangles().size(), GL_UNSIGNED_SHORT,
-            0);
-    glBindVertexArray(0);
+    GLState::bindVertexArray(mesh->getVAOId());
+    glDrawElements(GL_TRIANGLES, mesh->getNumTriangles() * 3,
+            GL_UNSIGNED_SHORT, 0);
 #else
-    glUseProgram(program_->id());
+    GLState::useProgram(program_->id());
 
     glVertexAttribPointer(a_position_, 3, GL_FLOAT, GL_FALSE, 0,
             mesh->vertices().data());
@@ -122,8 +181,8 @@ void UnlitHorizontalStereoShader::render(const glm::mat4& mvp_matrix,
 
     glUniformMatrix4fv(u_mvp_, 1, GL_FALSE, glm::value_ptr(mvp_matrix));
 
-    glActiveTexture (GL_TEXTURE0);
-    glBindTexture(texture->getTarget(), texture->getId());
+    GLState::activeTexture(GL_TEXTURE0);
+    GLState::bindTexture(texture->getTarget(), texture->getId());
     glUniform1i(u_texture_, 0);
 
     glUniform3f(u_color_, color.r, color.g, color.b);
@@ -138,4 +197,51 @@ void UnlitHorizontalStereoShader::render(const glm::mat4& mvp_matrix,
     checkGlError("HorizontalStereoUnlitShader::render");
 }
 
+void UnlitHorizontalStereoShader::renderInstanced(RenderData* render_data,
+        Material* material, const GLInstanceBuffer* instance_buffer) {
+#if _GVRF_USE_GLES3_
+    Mesh* mesh = render_data->mesh();
+    Texture* texture = material->getTexture(PropertyBlock::MAIN_TEXTURE);
+    glm::vec3 color;
+    float opacity;
+    if (texture == 0 || !material->getVec3(PropertyBlock::COLOR, color)
+            || !material->getFloat(PropertyBlock::OPACITY, opacity)) {
+        std::string error =
+                "UnlitHorizontalStereoShader::renderInstanced : material property not set";
+        throw error;
+    }
+
+    if (texture->getTarget() != GL_TEXTURE_2D) {
+        std::string error =
+                "UnlitHorizontalStereoShader::renderInstanced : texture with wrong target";
+        throw error;
+    }
+
+    const float* mono_rendering_value = material->properties().findFloat(
+            PropertyBlock::MONO_RENDERING);
+    bool mono_rendering = mono_rendering_value != 0
+            && *mono_rendering_value == 1;
+
+    GLState::useProgram(program_instanced_->id());
+
+    GLState::activeTexture(GL_TEXTURE0);
+    GLState::bindTexture(texture->getTarget(), texture->getId());
+    glUniform1i(u_texture_instanced_, 0);
+    glUniform3f(u_color_instanced_, color.r, color.g, color.b);
+    glUniform1f(u_opacity_instanced_, opacity);
+    glUniform1i(u_mono_rendering_instanced_, mono_rendering ? 1 : 0);
+
+    GLState::bindVertexArray(mesh->getVAOId());
+    instance_buffer->bindModelMatrixAttribute();
+
+    glDrawElementsInstanced(GL_TRIANGLES, mesh->getNumTriangles() * 3,
+            GL_UNSIGNED_SHORT, 0, instance_buffer->instance_count());
+
+    checkGlError("UnlitHorizontalStereoShader::renderInstanced");
+#else
+    std::string error = "UnlitHorizontalStereoShader::renderInstanced : needs GLES3.";
+    throw error;
+#endif
+}
+
 }
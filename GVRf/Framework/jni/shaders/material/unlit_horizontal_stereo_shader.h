@@ -31,6 +31,7 @@
 #include "objects/recyclable_object.h"
 
 namespace gvr {
+class GLInstanceBuffer;
 class GLProgram;
 class RenderData;
 class Material;
@@ -41,6 +42,9 @@ public:
     ~UnlitHorizontalStereoShader();
     void recycle();
     void render(const glm::mat4& mvp_matrix, RenderData* render_data, Material* material, bool right);
+    // the eye and its matrices come from GLFrameUniforms
+    void renderInstanced(RenderData* render_data, Material* material,
+            const GLInstanceBuffer* instance_buffer);
 
 private:
     UnlitHorizontalStereoShader(
@@ -58,6 +62,12 @@ private:
     GLuint u_color_;
     GLuint u_opacity_;
     GLuint u_right_;
+
+    GLProgram* program_instanced_;
+    GLuint u_texture_instanced_;
+    GLuint u_color_instanced_;
+    GLuint u_opacity_instanced_;
+    GLuint u_mono_rendering_instanced_;
 };
 
 }
@@ -21,6 +21,7 @@
 #include "color_blend_post_effect_shader.h"
 
 #include "gl/gl_program.h"
+#include "gl/gl_state.h"
 #include "objects/post_effect_data.h"
 #include "objects/textures/render_texture.h"
 #include "util/gvr_gl.h"
@@ -79,12 +80,21 @@ void ColorBlendPostEffectShader::render(
         PostEffectData* post_effect_data,
         std::vector<glm::vec3>& vertices, std::vector<glm::vec2>& tex_coords,
         std::vector<unsigned short>& triangles) {
-    float r = post_effect_data->getFloat("r");
-    float g = post_effect_data->getFloat("g");
-    float b = post_effect_data->getFloat("b");
-    float factor = post_effect_data->getFloat("factor");
+    float r;
+    float g;
+    float b;
+    float factor;
+    if (!post_effect_data->getFloat(PropertyBlock::BLEND_R, r)
+            || !post_effect_data->getFloat(PropertyBlock::BLEND_G, g)
+            || !post_effect_data->getFloat(PropertyBlock::BLEND_B, b)
+            || !post_effect_data->getFloat(PropertyBlock::BLEND_FACTOR,
+                    factor)) {
+        std::string error =
+                "ColorBlendPostEffectShader::render : property not set";
+        throw error;
+    }
 
-    glUseProgram(program_->id());
+    GLState::useProgram(program_->id());
 
 #if _GVRF_USE_GLES3_
     GLuint tmpID;
@@ -92,7 +102,7 @@ void ColorBlendPostEffectShader::render(
     if(vaoID_ == 0)
     {
         glGenVertexArrays(1, &vaoID_);
-        glBindVertexArray(vaoID_);
+        GLState::bindVertexArray(vaoID_);
 
         glGenBuffers(1, &tmpID);
         glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, tmpID);
@@ -117,16 +127,16 @@ void ColorBlendPostEffectShader::render(
         }
     }
 
-    glActiveTexture (GL_TEXTURE0);
-    glBindTexture(GL_TEXTURE_2D, render_texture->getId());
+    GLState::activeTexture(GL_TEXTURE0);
+    GLState::bindTexture(GL_TEXTURE_2D, render_texture->getId());
     glUniform1i(u_texture_, 0);
 
     glUniform3f(u_color_, r, g, b);
     glUniform1f(u_factor_, factor);
 
-    glBindVertexArray(vaoID_);
+    GLState::bindVertexArray(vaoID_);
     glDrawElements(GL_TRIANGLES, triangles.size(), GL_UNSIGNED_SHORT, 0);
-    glBindVertexArray(0);
+    GLState::bindVertexArray(0);
 
 #else
     glVertexAttribPointer(a_position_, 3, GL_FLOAT, GL_FALSE, 0,
@@ -137,8 +147,8 @@ void ColorBlendPostEffectShader::render(
             tex_coords.data());
     glEnableVertexAttribArray(a_tex_coord_);
 
-    glActiveTexture (GL_TEXTURE0);
-    glBindTexture(GL_TEXTURE_2D, render_texture->getId());
+    GLState::activeTexture(GL_TEXTURE0);
+    GLState::bindTexture(GL_TEXTURE_2D, render_texture->getId());
     glUniform1i(u_texture_, 0);
 
     glUniform3f(u_color_, r, g, b);
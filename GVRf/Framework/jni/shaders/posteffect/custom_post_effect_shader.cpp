@@ -21,6 +21,7 @@
 #include "custom_post_effect_shader.h"
 
 #include "gl/gl_program.h"
+#include "gl/gl_state.h"
 #include "objects/post_effect_data.h"
 #include "objects/components/render_data.h"
 #include "objects/textures/render_texture.h"
@@ -67,36 +68,36 @@ void CustomPostEffectShader::recycle() {
 void CustomPostEffectShader::addTextureKey(std::string variable_name,
         std::string key) {
     int location = glGetUniformLocation(program_->id(), variable_name.c_str());
-    texture_keys_[location] = key;
+    texture_keys_[location] = PropertyBlock::id(key);
 }
 
 void CustomPostEffectShader::addFloatKey(std::string variable_name,
         std::string key) {
     int location = glGetUniformLocation(program_->id(), variable_name.c_str());
-    float_keys_[location] = key;
+    float_keys_[location] = PropertyBlock::id(key);
 }
 void CustomPostEffectShader::addVec2Key(std::string variable_name,
         std::string key) {
     int location = glGetUniformLocation(program_->id(), variable_name.c_str());
-    vec2_keys_[location] = key;
+    vec2_keys_[location] = PropertyBlock::id(key);
 }
 
 void CustomPostEffectShader::addVec3Key(std::string variable_name,
         std::string key) {
     int location = glGetUniformLocation(program_->id(), variable_name.c_str());
-    vec3_keys_[location] = key;
+    vec3_keys_[location] = PropertyBlock::id(key);
 }
 
 void CustomPostEffectShader::addVec4Key(std::string variable_name,
         std::string key) {
     int location = glGetUniformLocation(program_->id(), variable_name.c_str());
-    vec4_keys_[location] = key;
+    vec4_keys_[location] = PropertyBlock::id(key);
 }
 
 void CustomPostEffectShader::addMat4Key(std::string variable_name,
         std::string key) {
     int location = glGetUniformLocation(program_->id(), variable_name.c_str());
-    mat4_keys_[location] = key;
+    mat4_keys_[location] = PropertyBlock::id(key);
 }
 
 void CustomPostEffectShader::render(Camera* camera,
@@ -104,7 +105,7 @@ void CustomPostEffectShader::render(Camera* camera,
         PostEffectData* post_effect_data,
         std::vector<glm::vec3>& vertices, std::vector<glm::vec2>& tex_coords,
         std::vector<unsigned short>& triangles) {
-    glUseProgram(program_->id());
+    GLState::useProgram(program_->id());
 
 #if _GVRF_USE_GLES3_
     GLuint tmpID;
@@ -112,7 +113,7 @@ void CustomPostEffectShader::render(Camera* camera,
     if(vaoID_ == 0)
     {
         glGenVertexArrays(1, &vaoID_);
-        glBindVertexArray(vaoID_);
+        GLState::bindVertexArray(vaoID_);
 
         glGenBuffers(1, &tmpID);
         glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, tmpID);
@@ -139,8 +140,8 @@ void CustomPostEffectShader::render(Camera* camera,
 
     int texture_index = 0;
     if (u_texture_ != -1) {
-        glActiveTexture(getGLTexture(texture_index));
-        glBindTexture(GL_TEXTURE_2D, render_texture->getId());
+        GLState::activeTexture(getGLTexture(texture_index));
+        GLState::bindTexture(GL_TEXTURE_2D, render_texture->getId());
         glUniform1i(u_texture_, texture_index++);
     }
 
@@ -154,40 +155,73 @@ void CustomPostEffectShader::render(Camera* camera,
         glUniform1i(u_right_eye_, right ? 1 : 0);
     }
 
+    // the draw is skipped if the effect lacks a value the shader reads
+    bool found = true;
     for (auto it = texture_keys_.begin(); it != texture_keys_.end(); ++it) {
-        glActiveTexture(getGLTexture(texture_index));
+        GLState::activeTexture(getGLTexture(texture_index));
         Texture* texture = post_effect_data->getTexture(it->second);
-        glBindTexture(texture->getTarget(), texture->getId());
+        if (texture != 0) {
+            GLState::bindTexture(texture->getTarget(), texture->getId());
+        } else {
+            found = false;
+        }
         glUniform1i(it->first, texture_index++);
     }
 
     for (auto it = float_keys_.begin(); it != float_keys_.end(); ++it) {
-        glUniform1f(it->first, post_effect_data->getFloat(it->second));
+        float value;
+        if (post_effect_data->getFloat(it->second, value)) {
+            glUniform1f(it->first, value);
+        } else {
+            found = false;
+        }
     }
 
     for (auto it = vec2_keys_.begin(); it != vec2_keys_.end(); ++it) {
-        glm::vec2 v = post_effect_data->getVec2(it->second);
-        glUniform2f(it->first, v.x, v.y);
+        glm::vec2 v;
+        if (post_effect_data->getVec2(it->second, v)) {
+            glUniform2f(it->first, v.x, v.y);
+        } else {
+            found = false;
+        }
     }
 
     for (auto it = vec3_keys_.begin(); it != vec3_keys_.end(); ++it) {
-        glm::vec3 v = post_effect_data->getVec3(it->second);
-        glUniform3f(it->first, v.x, v.y, v.z);
+        glm::vec3 v;
+        if (post_effect_data->getVec3(it->second, v)) {
+            glUniform3f(it->first, v.x, v.y, v.z);
+        } else {
+            found = false;
+        }
     }
 
     for (auto it = vec4_keys_.begin(); it != vec4_keys_.end(); ++it) {
-        glm::vec4 v = post_effect_data->getVec4(it->second);
-        glUniform4f(it->first, v.x, v.y, v.z, v.w);
+        glm::vec4 v;
+        if (post_effect_data->getVec4(it->second, v)) {
+            glUniform4f(it->first, v.x, v.y, v.z, v.w);
+        } else {
+            found = false;
+        }
     }
 
     for (auto it = mat4_keys_.begin(); it != mat4_keys_.end(); ++it) {
-        glm::mat4 m = post_effect_data->getMat4(it->second);
-        glUniformMatrix4fv(it->first, 1, GL_FALSE, glm::value_ptr(m));
+        glm::mat4 m;
+        if (post_effect_data->getMat4(it->second, m)) {
+            glUniformMatrix4fv(it->first, 1, GL_FALSE, glm::value_ptr(m));
+        } else {
+            found = false;
+        }
+    }
+
+    if (!found) {
+        std::string error =
+                "CustomPostEffectShader::render : property not set";
+        throw error;
     }
 
-    glBindVertexArray(vaoID_);
+    GLState::bindVertexArray(vaoID_);
     glDrawElements(GL_TRIANGLES, triangles.size(), GL_UNSIGNED_SHORT, 0);
-    glBindVertexArray(0);
+    GLState::bindVertexArray(0);
 
 #else
 
@@ -206,8 +240,8 @@ void CustomPostEffectShader::render(Camera* camera,
     int texture_index = 0;
 
     if (u_texture_ != -1) {
-        glActiveTexture(getGLTexture(texture_index));
-        glBindTexture(GL_TEXTURE_2D, render_texture->getId());
+        GLState::activeTexture(getGLTexture(texture_index));
+        GLState::bindTexture(GL_TEXTURE_2D, render_texture->getId());
         glUniform1i(u_texture_, texture_index++);
     }
 
@@ -221,35 +255,68 @@ void CustomPostEffectShader::render(Camera* camera,
         glUniform1i(u_right_eye_, right ? 1 : 0);
     }
 
+    // the draw is skipped if the effect lacks a value the shader reads
+    bool found = true;
     for (auto it = texture_keys_.begin(); it != texture_keys_.end(); ++it) {
-        glActiveTexture(getGLTexture(texture_index));
+        GLState::activeTexture(getGLTexture(texture_index));
         Texture* texture = post_effect_data->getTexture(it->second);
-        glBindTexture(texture->getTarget(), texture->getId());
+        if (texture != 0) {
+            GLState::bindTexture(texture->getTarget(), texture->getId());
+        } else {
+            found = false;
+        }
         glUniform1i(it->first, texture_index++);
     }
 
     for (auto it = float_keys_.begin(); it != float_keys_.end(); ++it) {
-        glUniform1f(it->first, post_effect_data->getFloat(it->second));
+        float value;
+        if (post_effect_data->getFloat(it->second, value)) {
+            glUniform1f(it->first, value);
+        } else {
+            found = false;
+        }
     }
 
     for (auto it = vec2_keys_.begin(); it != vec2_keys_.end(); ++it) {
-        glm::vec2 v = post_effect_data->getVec2(it->second);
-        glUniform2f(it->first, v.x, v.y);
+        glm::vec2 v;
+        if (post_effect_data->getVec2(it->second, v)) {
+            glUniform2f(it->first, v.x, v.y);
+        } else {
+            found = false;
+        }
     }
 
     for (auto it = vec3_keys_.begin(); it != vec3_keys_.end(); ++it) {
-        glm::vec3 v = post_effect_data->getVec3(it->second);
-        glUniform3f(it->first, v.x, v.y, v.z);
+        glm::vec3 v;
+        if (post_effect_data->getVec3(it->second, v)) {
+            glUniform3f(it->first, v.x, v.y, v.z);
+        } else {
+            found = false;
+        }
     }
 
     for (auto it = vec4_keys_.begin(); it != vec4_keys_.end(); ++it) {
-        glm::vec4 v = post_effect_data->getVec4(it->second);
-        glUniform4f(it->first, v.x, v.y, v.z, v.w);
+        glm::vec4 v;
+        if (post_effect_data->getVec4(it->second, v)) {
+            glUniform4f(it->first, v.x, v.y, v.z, v.w);
+        } else {
+            found = false;
+        }
     }
 
     for (auto it = mat4_keys_.begin(); it != mat4_keys_.end(); ++it) {
-        glm::mat4 m = post_effect_data->getMat4(it->second);
-        glUniformMatrix4fv(it->first, 1, GL_FALSE, glm::value_ptr(m));
+        glm::mat4 m;
+        if (post_effect_data->getMat4(it->second, m)) {
+            glUniformMatrix4fv(it->first, 1, GL_FALSE, glm::value_ptr(m));
+        } else {
+            found = false;
+        }
+    }
+
+    if (!found) {
+        std::string error =
+                "CustomPostEffectShader::render : property not set";
+        throw error;
     }
 
     glDrawElements(GL_TRIANGLES, triangles.size(), GL_UNSIGNED_SHORT,
@@ -74,12 +74,13 @@ private:
     GLuint u_texture_;
     GLuint u_projection_matrix_;
     GLuint u_right_eye_;
-    std::map<int, std::string> texture_keys_;
-    std::map<int, std::string> float_keys_;
-    std::map<int, std::string> vec2_keys_;
-    std::map<int, std::string> vec3_keys_;
-    std::map<int, std::string> vec4_keys_;
-    std::map<int, std::string> mat4_keys_;
+    // uniform locations to post effect property ids
+    std::map<int, int> texture_keys_;
+    std::map<int, int> float_keys_;
+    std::map<int, int> vec2_keys_;
+    std::map<int, int> vec3_keys_;
+    std::map<int, int> vec4_keys_;
+    std::map<int, int> mat4_keys_;
 
     // add vertex array object
     GLuint vaoID_;
@@ -21,6 +21,7 @@
 #include "horizontal_flip_post_effect_shader.h"
 
 #include "gl/gl_program.h"
+#include "gl/gl_state.h"
 #include "objects/post_effect_data.h"
 #include "objects/textures/render_texture.h"
 #include "util/gvr_gl.h"
@@ -71,7 +72,7 @@ void HorizontalFlipPostEffectShader::render(
         PostEffectData* post_effect_data,
         std::vector<glm::vec3>& vertices, std::vector<glm::vec2>& tex_coords,
         std::vector<unsigned short>& triangles) {
-    glUseProgram(program_->id());
+    GLState::useProgram(program_->id());
 
 #if _GVRF_USE_GLES3_
     GLuint tmpID;
@@ -79,7 +80,7 @@ void HorizontalFlipPostEffectShader::render(
     if(vaoID_ == 0)
     {
         glGenVertexArrays(1, &vaoID_);
-        glBindVertexArray(vaoID_);
+        GLState::bindVertexArray(vaoID_);
 
         glGenBuffers(1, &tmpID);
         glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, tmpID);
@@ -104,13 +105,13 @@ void HorizontalFlipPostEffectShader::render(
         }
     }
 
-    glActiveTexture (GL_TEXTURE0);
-    glBindTexture(GL_TEXTURE_2D, render_texture->getId());
+    GLState::activeTexture(GL_TEXTURE0);
+    GLState::bindTexture(GL_TEXTURE_2D, render_texture->getId());
     glUniform1i(u_texture_, 0);
 
-    glBindVertexArray(vaoID_);
+    GLState::bindVertexArray(vaoID_);
     glDrawElements(GL_TRIANGLES, triangles.size(), GL_UNSIGNED_SHORT, 0);
-    glBindVertexArray(0);
+    GLState::bindVertexArray(0);
 #else
     glVertexAttribPointer(a_position_, 3, GL_FLOAT, GL_FALSE, 0,
             vertices.data());
@@ -120,8 +121,8 @@ void HorizontalFlipPostEffectShader::render(
             tex_coords.data());
     glEnableVertexAttribArray(a_tex_coord_);
 
-    glActiveTexture (GL_TEXTURE0);
-    glBindTexture(GL_TEXTURE_2D, render_texture->getId());
+    GLState::activeTexture(GL_TEXTURE0);
+    GLState::bindTexture(GL_TEXTURE_2D, render_texture->getId());
     glUniform1i(u_texture_, 0);
 
     glDrawElements(GL_TRIANGLES, triangles.size(), GL_UNSIGNED_SHORT,
@@ -20,6 +20,8 @@
 #ifndef SHADER_MANAGER_H_
 #define SHADER_MANAGER_H_
 
+#include "gl/gl_frame_uniforms.h"
+#include "gl/gl_instance_buffer.h"
 #include "objects/hybrid_object.h"
 #include "shaders/material/bounding_box_shader.h"
 #include "shaders/material/custom_shader.h"
@@ -45,7 +47,7 @@ public:
             oes_shader_(), oes_horizontal_stereo_shader_(), oes_vertical_stereo_shader_(),
             cubemap_shader_(), cubemap_reflection_shader_(), texture_shader_(), assimp_shader_(),
             external_renderer_shader_(), error_shader_(), latest_custom_shader_id_(
-                    INITIAL_CUSTOM_SHADER_INDEX), custom_shaders_() {
+                    INITIAL_CUSTOM_SHADER_INDEX), custom_shaders_(), instance_buffer_(), frame_uniforms_() {
     }
     ~ShaderManager() {
         delete unlit_horizontal_stereo_shader_;
@@ -59,6 +61,8 @@ public:
         delete external_renderer_shader_;
         delete assimp_shader_;
         delete error_shader_;
+        delete instance_buffer_;
+        delete frame_uniforms_;
         // We don't delete the custom shaders, as their Java owner-objects will do that for us.
     }
     BoundingBoxShader* getBoundingBoxShader() {
@@ -150,6 +154,18 @@ public:
             throw "ShaderManager::getCustomShader()";
         }
     }
+    GLInstanceBuffer* getInstanceBuffer() {
+        if (!instance_buffer_) {
+            instance_buffer_ = new GLInstanceBuffer();
+        }
+        return instance_buffer_;
+    }
+    GLFrameUniforms* getFrameUniforms() {
+        if (!frame_uniforms_) {
+            frame_uniforms_ = new GLFrameUniforms();
+        }
+        return frame_uniforms_;
+    }
 
 private:
     ShaderManager(const ShaderManager& shader_manager);
@@ -173,6 +189,8 @@ private:
     ErrorShader* error_shader_;
     int latest_custom_shader_id_;
     std::map<int, CustomShader*> custom_shaders_;
+    GLInstanceBuffer* instance_buffer_;
+    GLFrameUniforms* frame_uniforms_;
 };
 
 }
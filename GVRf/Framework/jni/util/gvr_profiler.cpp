@@ -0,0 +1,479 @@
+/* Copyright 2015 Samsung Electronics Co., LTD
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/***************************************************************************
+ * CPU and GPU timings of named scopes, per frame.
+ ***************************************************************************/
+
+#include "gvr_profiler.h"
+
+#include <algorithm>
+#include <map>
+#include <mutex>
+#include <vector>
+
+#include <pthread.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/prctl.h>
+#include <sys/syscall.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "gl/gl_query_pool.h"
+#include "util/gvr_gl.h"
+
+#ifndef GL_TIME_ELAPSED_EXT
+#define GL_TIME_ELAPSED_EXT 0x88BF
+#endif
+#ifndef GL_GPU_DISJOINT_EXT
+#define GL_GPU_DISJOINT_EXT 0x8FBB
+#endif
+
+namespace gvr {
+
+std::atomic<bool> Profiler::enabled_(false);
+
+enum EventType {
+    BEGIN_EVENT, END_EVENT, COMPLETE_EVENT, FRAME_EVENT
+};
+
+// times in nanoseconds; duration is the GPU time of a complete event and
+// the frame number of a frame event
+struct ProfileEvent {
+    const char* name;
+    long long time;
+    long long duration;
+    int type;
+};
+
+/*
+ * The events of one thread. Only the owning thread writes: it fills the
+ * event, then publishes it by bumping the count. Readers copy what the
+ * count covers and drop whatever the writer may have overwritten since.
+ */
+struct ThreadBuffer {
+    static const unsigned int CAPACITY = 16384;
+
+    ProfileEvent events[CAPACITY];
+    std::atomic<unsigned int> write_count;
+    int thread_id;
+    char thread_name[17];
+    // set once the owning thread exits, for the next new thread to take
+    // over; guarded by buffers_mutex
+    bool released;
+};
+
+static std::mutex buffers_mutex;
+static std::vector<ThreadBuffer*> buffers;
+static pthread_key_t buffer_key;
+static pthread_once_t buffer_key_once = PTHREAD_ONCE_INIT;
+static std::atomic<long long> clear_time(0);
+static const int MAX_THREAD_BUFFERS = 32;
+static unsigned int frame_number = 0;
+
+// GPU passes are written to a buffer of their own, shown as a thread
+static ThreadBuffer* gpu_buffer = 0;
+static const int GPU_THREAD_ID = 0;
+
+struct GpuPass {
+    GLuint query;
+    const char* name;
+    long long cpu_time;
+};
+
+static GLQueryPool gpu_query_pool;
+static std::vector<GpuPass> gpu_passes;
+static GpuPass active_gpu_pass;
+static bool gpu_pass_active = false;
+// -1 until checked on the GL thread
+static int timer_query_supported = -1;
+static const int MAX_GPU_PASSES_IN_FLIGHT = 64;
+
+static long long now() {
+    timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return static_cast<long long>(ts.tv_sec) * 1000000000LL + ts.tv_nsec;
+}
+
+static void releaseBuffer(void* buffer) {
+    std::lock_guard<std::mutex> lock(buffers_mutex);
+    static_cast<ThreadBuffer*>(buffer)->released = true;
+}
+
+static void createBufferKey() {
+    pthread_key_create(&buffer_key, releaseBuffer);
+}
+
+/*
+ * Makes a buffer for a new thread. Buffers of threads that exited keep their
+ * events until there are MAX_THREAD_BUFFERS buffers; from then on new
+ * threads take them over, and their events are lost.
+ */
+static ThreadBuffer* acquireBuffer(int thread_id, const char* thread_name) {
+    std::lock_guard<std::mutex> lock(buffers_mutex);
+    ThreadBuffer* buffer = 0;
+    if (buffers.size() >= MAX_THREAD_BUFFERS) {
+        for (auto it = buffers.begin(); it != buffers.end(); ++it) {
+            if ((*it)->released) {
+                buffer = *it;
+                break;
+            }
+        }
+    }
+    if (buffer == 0) {
+        buffer = new ThreadBuffer();
+        buffers.push_back(buffer);
+    }
+    buffer->write_count.store(0, std::memory_order_relaxed);
+    buffer->thread_id = thread_id;
+    strncpy(buffer->thread_name, thread_name, sizeof(buffer->thread_name) - 1);
+    buffer->thread_name[sizeof(buffer->thread_name) - 1] = '\0';
+    buffer->released = false;
+    return buffer;
+}
+
+static ThreadBuffer* threadBuffer() {
+    pthread_once(&buffer_key_once, createBufferKey);
+    ThreadBuffer* buffer = static_cast<ThreadBuffer*>(pthread_getspecific(
+            buffer_key));
+    if (buffer == 0) {
+        char thread_name[17] = { };
+        prctl(PR_GET_NAME, thread_name);
+        buffer = acquireBuffer(syscall(__NR_gettid), thread_name);
+        pthread_setspecific(buffer_key, buffer);
+    }
+    return buffer;
+}
+
+static void record(ThreadBuffer* buffer, int type, const char* name,
+        long long time, long long duration) {
+    unsigned int count = buffer->write_count.load(std::memory_order_relaxed);
+    ProfileEvent& event = buffer->events[count & (ThreadBuffer::CAPACITY - 1)];
+    event.name = name;
+    event.time = time;
+    event.duration = duration;
+    event.type = type;
+    buffer->write_count.store(count + 1, std::memory_order_release);
+}
+
+/*
+ * Copies the events of a buffer recorded since the last clear. Called with
+ * buffers_mutex held, so the buffer is not handed to another thread.
+ */
+static void snapshot(ThreadBuffer* buffer, std::vector<ProfileEvent>& events) {
+    events.clear();
+    unsigned int end = buffer->write_count.load(std::memory_order_acquire);
+    unsigned int begin =
+            end > ThreadBuffer::CAPACITY ? end - ThreadBuffer::CAPACITY : 0;
+    for (unsigned int i = begin; i < end; ++i) {
+        events.push_back(buffer->events[i & (ThreadBuffer::CAPACITY - 1)]);
+    }
+
+    std::atomic_thread_fence(std::memory_order_acquire);
+    unsigned int after = buffer->write_count.load(std::memory_order_relaxed);
+    unsigned int overwritten =
+            after > ThreadBuffer::CAPACITY ? after - ThreadBuffer::CAPACITY : 0;
+    if (overwritten > begin) {
+        events.erase(events.begin(),
+                events.begin() + std::min(overwritten - begin, end - begin));
+    }
+
+    long long cleared = clear_time.load(std::memory_order_relaxed);
+    auto first = events.begin();
+    while (first != events.end() && first->time < cleared) {
+        ++first;
+    }
+    events.erase(events.begin(), first);
+}
+
+static void appendJsonString(std::string& json, const char* text) {
+    json += '"';
+    for (const char* c = text; *c != '\0'; ++c) {
+        if (*c == '"' || *c == '\\') {
+            json += '\\';
+            json += *c;
+        } else if (static_cast<unsigned char>(*c) < 0x20) {
+            json += ' ';
+        } else {
+            json += *c;
+        }
+    }
+    json += '"';
+}
+
+void Profiler::set_enabled(bool enabled) {
+    pthread_once(&buffer_key_once, createBufferKey);
+    enabled_.store(enabled, std::memory_order_release);
+}
+
+void Profiler::clear() {
+    clear_time.store(now(), std::memory_order_relaxed);
+}
+
+void Profiler::begin(const char* name) {
+    record(threadBuffer(), BEGIN_EVENT, name, now(), 0);
+}
+
+void Profiler::end() {
+    record(threadBuffer(), END_EVENT, 0, now(), 0);
+}
+
+/*
+ * GPU results come in the order their passes were issued; only the ready
+ * ones are read, and none of them if the GPU timer was disturbed, as by a
+ * change of clocks, while they ran.
+ */
+void Profiler::beginFrame() {
+    if (!enabled()) {
+        return;
+    }
+    record(threadBuffer(), FRAME_EVENT, "frame", now(), ++frame_number);
+
+    int ready = 0;
+    int pass_count = gpu_passes.size();
+    while (ready < pass_count) {
+        GLuint available = GL_FALSE;
+        glGetQueryObjectuiv(gpu_passes[ready].query, GL_QUERY_RESULT_AVAILABLE,
+                &available);
+        if (!available) {
+            break;
+        }
+        ++ready;
+    }
+    if (ready == 0) {
+        return;
+    }
+
+    GLint disjoint = 0;
+    glGetIntegerv(GL_GPU_DISJOINT_EXT, &disjoint);
+    if (gpu_buffer == 0) {
+        gpu_buffer = acquireBuffer(GPU_THREAD_ID, "GPU");
+    }
+    for (int i = 0; i < ready; ++i) {
+        GpuPass& pass = gpu_passes[i];
+        if (!disjoint) {
+            GLuint elapsed = 0;
+            glGetQueryObjectuiv(pass.query, GL_QUERY_RESULT, &elapsed);
+            record(gpu_buffer, COMPLETE_EVENT, pass.name, pass.cpu_time,
+                    elapsed);
+        }
+        gpu_query_pool.release(pass.query);
+    }
+    gpu_passes.erase(gpu_passes.begin(), gpu_passes.begin() + ready);
+}
+
+bool Profiler::beginGpu(const char* name) {
+    if (gpu_pass_active || gpu_passes.size() >= MAX_GPU_PASSES_IN_FLIGHT) {
+        return false;
+    }
+    if (timer_query_supported < 0) {
+        const char* extensions =
+                reinterpret_cast<const char*>(glGetString(GL_EXTENSIONS));
+        timer_query_supported = extensions != 0
+                && strstr(extensions, "GL_EXT_disjoint_timer_query") != 0;
+    }
+    if (!timer_query_supported) {
+        return false;
+    }
+
+    active_gpu_pass.query = gpu_query_pool.acquire();
+    active_gpu_pass.name = name;
+    active_gpu_pass.cpu_time = now();
+    glBeginQuery(GL_TIME_ELAPSED_EXT, active_gpu_pass.query);
+    gpu_pass_active = true;
+    return true;
+}
+
+void Profiler::endGpu() {
+    glEndQuery(GL_TIME_ELAPSED_EXT);
+    gpu_passes.push_back(active_gpu_pass);
+    gpu_pass_active = false;
+}
+
+/*
+ * Scopes become B and E events on the thread that ran them, GPU passes X
+ * events on the GPU thread, and frames global instant events. Ends left
+ * without their begin, by the ring wrapping around or a clear, are
+ * dropped.
+ */
+std::string Profiler::chromeTrace() {
+    std::string json("{\"displayTimeUnit\":\"ms\",\"traceEvents\":[");
+    char line[256];
+    int pid = getpid();
+    bool first = true;
+    std::vector<ProfileEvent> events;
+
+    std::lock_guard<std::mutex> lock(buffers_mutex);
+    for (auto it = buffers.begin(); it != buffers.end(); ++it) {
+        ThreadBuffer* buffer = *it;
+        snapshot(buffer, events);
+        if (events.empty()) {
+            continue;
+        }
+
+        snprintf(line, sizeof(line),
+                "%s\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":%d,\"tid\":%d,\"args\":{\"name\":",
+                first ? "" : ",", pid, buffer->thread_id);
+        json += line;
+        appendJsonString(json, buffer->thread_name);
+        json += "}}";
+        first = false;
+
+        int depth = 0;
+        for (auto event = events.begin(); event != events.end(); ++event) {
+            double ts = event->time / 1000.0;
+            switch (event->type) {
+            case BEGIN_EVENT:
+                ++depth;
+                json += ",\n{\"name\":";
+                appendJsonString(json, event->name);
+                snprintf(line, sizeof(line),
+                        ",\"ph\":\"B\",\"ts\":%.3f,\"pid\":%d,\"tid\":%d}", ts,
+                        pid, buffer->thread_id);
+                json += line;
+                break;
+            case END_EVENT:
+                if (depth == 0) {
+                    break;
+                }
+                --depth;
+                snprintf(line, sizeof(line),
+                        ",\n{\"ph\":\"E\",\"ts\":%.3f,\"pid\":%d,\"tid\":%d}",
+                        ts, pid, buffer->thread_id);
+                json += line;
+                break;
+            case COMPLETE_EVENT:
+                json += ",\n{\"name\":";
+                appendJsonString(json, event->name);
+                snprintf(line, sizeof(line),
+                        ",\"ph\":\"X\",\"ts\":%.3f,\"dur\":%.3f,\"pid\":%d,\"tid\":%d}",
+                        ts, event->duration / 1000.0, pid, buffer->thread_id);
+                json += line;
+                break;
+            case FRAME_EVENT:
+                snprintf(line, sizeof(line),
+                        ",\n{\"name\":\"frame %lld\",\"ph\":\"i\",\"s\":\"g\",\"ts\":%.3f,\"pid\":%d,\"tid\":%d}",
+                        event->duration, ts, pid, buffer->thread_id);
+                json += line;
+                break;
+            }
+        }
+    }
+    json += "\n]}";
+    return json;
+}
+
+struct ScopeTotal {
+    long long time;
+    int count;
+};
+
+static void appendTotals(std::string& json,
+        const std::map<std::string, ScopeTotal>& totals) {
+    char line[64];
+    json += '{';
+    for (auto it = totals.begin(); it != totals.end(); ++it) {
+        if (it != totals.begin()) {
+            json += ',';
+        }
+        appendJsonString(json, it->first.c_str());
+        snprintf(line, sizeof(line), ":{\"ms\":%.3f,\"count\":%d}",
+                it->second.time / 1000000.0, it->second.count);
+        json += line;
+    }
+    json += '}';
+}
+
+/*
+ * Sums, per name, the time scopes spent in the last frame that has ended,
+ * over all threads, clipping scopes that straddle the frame. Scopes are
+ * counted in the frame they begin in. GPU passes are counted in the frame
+ * they were issued in, whenever their results arrived.
+ */
+std::string Profiler::frameSummary() {
+    std::lock_guard<std::mutex> lock(buffers_mutex);
+    std::vector<std::vector<ProfileEvent> > snapshots(buffers.size());
+    long long frame_start = 0;
+    long long frame_end = 0;
+    long long frame = 0;
+    for (size_t i = 0; i < buffers.size(); ++i) {
+        snapshot(buffers[i], snapshots[i]);
+    }
+    for (size_t i = 0; i < snapshots.size(); ++i) {
+        std::vector<ProfileEvent>& events = snapshots[i];
+        int frames_found = 0;
+        for (auto event = events.rbegin();
+                event != events.rend() && frames_found < 2; ++event) {
+            if (event->type != FRAME_EVENT) {
+                continue;
+            }
+            if (frames_found++ == 0) {
+                frame_end = event->time;
+            } else {
+                frame_start = event->time;
+                frame = event->duration;
+            }
+        }
+        if (frames_found == 2) {
+            break;
+        }
+        frame_start = frame_end = 0;
+    }
+    if (frame_end == 0) {
+        return "{}";
+    }
+
+    std::map<std::string, ScopeTotal> cpu_totals;
+    std::map<std::string, ScopeTotal> gpu_totals;
+    std::vector<const ProfileEvent*> open_scopes;
+    for (auto it = snapshots.begin(); it != snapshots.end(); ++it) {
+        open_scopes.clear();
+        for (auto event = it->begin(); event != it->end(); ++event) {
+            if (event->type == BEGIN_EVENT) {
+                open_scopes.push_back(&*event);
+            } else if (event->type == END_EVENT && !open_scopes.empty()) {
+                const ProfileEvent* begin = open_scopes.back();
+                open_scopes.pop_back();
+                long long start = std::max(begin->time, frame_start);
+                long long end = std::min(event->time, frame_end);
+                if (start < end) {
+                    ScopeTotal& total = cpu_totals[begin->name];
+                    total.time += end - start;
+                    if (begin->time >= frame_start) {
+                        ++total.count;
+                    }
+                }
+            } else if (event->type == COMPLETE_EVENT
+                    && event->time >= frame_start && event->time < frame_end) {
+                ScopeTotal& total = gpu_totals[event->name];
+                total.time += event->duration;
+                ++total.count;
+            }
+        }
+    }
+
+    char line[64];
+    snprintf(line, sizeof(line), "{\"frame\":%lld,\"ms\":%.3f,\"cpu\":", frame,
+            (frame_end - frame_start) / 1000000.0);
+    std::string json(line);
+    appendTotals(json, cpu_totals);
+    json += ",\"gpu\":";
+    appendTotals(json, gpu_totals);
+    json += '}';
+    return json;
+}
+
+}
@@ -0,0 +1,145 @@
+/* Copyright 2015 Samsung Electronics Co., LTD
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/***************************************************************************
+ * CPU and GPU timings of named scopes, per frame.
+ ***************************************************************************/
+
+#ifndef GVR_PROFILER_H_
+#define GVR_PROFILER_H_
+
+#include <atomic>
+#include <string>
+
+namespace gvr {
+
+/*
+ * Records when named scopes begin and end, on any thread, and how long
+ * passes take on the GPU, while enabled.
+ *
+ * Each thread writes its events to a ring buffer of its own, without locks;
+ * once a buffer is full the oldest events are overwritten. Scope names must
+ * be string literals, or otherwise outlive the profiler, as only their
+ * pointers are kept. While disabled, a scope costs one relaxed load.
+ *
+ * GPU passes are timed with EXT_disjoint_timer_query where the driver has
+ * it. They may not nest, and their results are collected a few frames
+ * later, when beginFrame() finds them ready.
+ *
+ * The events can be exported as Chrome trace events, for chrome://tracing,
+ * and the last complete frame summed up per scope name.
+ */
+class Profiler {
+private:
+    Profiler();
+
+public:
+    static bool enabled() {
+        return enabled_.load(std::memory_order_relaxed);
+    }
+
+    static void set_enabled(bool enabled);
+
+    // drops all events recorded so far
+    static void clear();
+
+    static void begin(const char* name);
+    static void end();
+
+    // Marks the start of a frame and collects the GPU timings that are
+    // ready. Called on the GL thread.
+    static void beginFrame();
+
+    // Times a pass on the GPU; returns false, without timing it, if the
+    // driver cannot or another pass is being timed. Called on the GL
+    // thread.
+    static bool beginGpu(const char* name);
+    static void endGpu();
+
+    // the events still in the buffers, as Chrome trace event JSON
+    static std::string chromeTrace();
+
+    // the time spent in each scope during the last complete frame, as JSON
+    static std::string frameSummary();
+
+private:
+    Profiler(const Profiler& profiler);
+    Profiler(Profiler&& profiler);
+    Profiler& operator=(const Profiler& profiler);
+    Profiler& operator=(Profiler&& profiler);
+
+private:
+    static std::atomic<bool> enabled_;
+};
+
+// profiles the enclosing scope, if enabled when it was entered
+class ProfileScope {
+public:
+    explicit ProfileScope(const char* name) :
+            active_(Profiler::enabled()) {
+        if (active_) {
+            Profiler::begin(name);
+        }
+    }
+
+    ~ProfileScope() {
+        if (active_) {
+            Profiler::end();
+        }
+    }
+
+private:
+    ProfileScope(const ProfileScope& profile_scope);
+    ProfileScope(ProfileScope&& profile_scope);
+    ProfileScope& operator=(const ProfileScope& profile_scope);
+    ProfileScope& operator=(ProfileScope&& profile_scope);
+
+private:
+    bool active_;
+};
+
+// times the GPU work issued in the enclosing scope
+class GpuProfileScope {
+public:
+    explicit GpuProfileScope(const char* name) :
+            active_(Profiler::enabled() && Profiler::beginGpu(name)) {
+    }
+
+    ~GpuProfileScope() {
+        if (active_) {
+            Profiler::endGpu();
+        }
+    }
+
+private:
+    GpuProfileScope(const GpuProfileScope& gpu_profile_scope);
+    GpuProfileScope(GpuProfileScope&& gpu_profile_scope);
+    GpuProfileScope& operator=(const GpuProfileScope& gpu_profile_scope);
+    GpuProfileScope& operator=(GpuProfileScope&& gpu_profile_scope);
+
+private:
+    bool active_;
+};
+
+}
+
+#define GVR_PROFILE_JOIN_(a, b) a##b
+#define GVR_PROFILE_JOIN(a, b) GVR_PROFILE_JOIN_(a, b)
+#define GVR_PROFILE(name) \
+    gvr::ProfileScope GVR_PROFILE_JOIN(profile_scope_, __LINE__)(name)
+#define GVR_PROFILE_GPU(name) \
+    gvr::GpuProfileScope GVR_PROFILE_JOIN(gpu_profile_scope_, __LINE__)(name)
+
+#endif
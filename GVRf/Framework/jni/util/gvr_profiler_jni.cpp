@@ -0,0 +1,75 @@
+/* Copyright 2015 Samsung Electronics Co., LTD
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/***************************************************************************
+ * JNI
+ ***************************************************************************/
+
+#include "gvr_profiler.h"
+
+#include "util/gvr_jni.h"
+
+namespace gvr {
+
+extern "C" {
+JNIEXPORT void JNICALL
+Java_org_gearvrf_NativeProfiler_setEnabled(JNIEnv * env,
+        jobject obj, jboolean enabled);
+JNIEXPORT jboolean JNICALL
+Java_org_gearvrf_NativeProfiler_isEnabled(JNIEnv * env,
+        jobject obj);
+JNIEXPORT void JNICALL
+Java_org_gearvrf_NativeProfiler_clear(JNIEnv * env,
+        jobject obj);
+JNIEXPORT jstring JNICALL
+Java_org_gearvrf_NativeProfiler_getChromeTrace(JNIEnv * env,
+        jobject obj);
+JNIEXPORT jstring JNICALL
+Java_org_gearvrf_NativeProfiler_getFrameSummary(JNIEnv * env,
+        jobject obj);
+}
+;
+
+JNIEXPORT void JNICALL
+Java_org_gearvrf_NativeProfiler_setEnabled(JNIEnv * env,
+        jobject obj, jboolean enabled) {
+    Profiler::set_enabled(enabled);
+}
+
+JNIEXPORT jboolean JNICALL
+Java_org_gearvrf_NativeProfiler_isEnabled(JNIEnv * env,
+        jobject obj) {
+    return Profiler::enabled();
+}
+
+JNIEXPORT void JNICALL
+Java_org_gearvrf_NativeProfiler_clear(JNIEnv * env,
+        jobject obj) {
+    Profiler::clear();
+}
+
+JNIEXPORT jstring JNICALL
+Java_org_gearvrf_NativeProfiler_getChromeTrace(JNIEnv * env,
+        jobject obj) {
+    return env->NewStringUTF(Profiler::chromeTrace().c_str());
+}
+
+JNIEXPORT jstring JNICALL
+Java_org_gearvrf_NativeProfiler_getFrameSummary(JNIEnv * env,
+        jobject obj) {
+    return env->NewStringUTF(Profiler::frameSummary().c_str());
+}
+
+}
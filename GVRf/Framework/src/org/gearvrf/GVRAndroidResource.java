@@ -436,4 +436,28 @@ public class GVRAndroidResource {
     /** Callback for asynchronous mesh loads */
     public interface MeshCallback extends CancelableCallback<GVRMesh> {
     }
+
+    /**
+     * Callback for asynchronous model loads, with
+     * {@link GVRContext#loadModel(GVRAndroidResource.ModelCallback, GVRAndroidResource)}.
+     * 
+     * {@link #stillWanted(GVRAndroidResource) stillWanted()} is called between
+     * the stages of the load, so returning {@code false} can cancel it part
+     * way through.
+     */
+    public interface ModelCallback extends CancelableCallback<GVRSceneObject> {
+        /**
+         * Some more of the model is ready. Called on the GL thread, each time
+         * a mesh has been made ready to draw.
+         * 
+         * @param meshesLoaded
+         *            How many meshes are ready to draw
+         * @param meshCount
+         *            How many meshes the model has
+         * @param androidResource
+         *            The model being loaded
+         */
+        void progress(int meshesLoaded, int meshCount,
+                GVRAndroidResource androidResource);
+    }
 }
@@ -15,8 +15,14 @@
 
 package org.gearvrf;
 
+import java.io.IOException;
+
+import org.gearvrf.jassimp.AiColor;
 import org.gearvrf.jassimp.AiMaterial;
+import org.gearvrf.jassimp.AiMatrix4f;
+import org.gearvrf.jassimp.AiNode;
 import org.gearvrf.jassimp.AiScene;
+import org.gearvrf.jassimp.AiWrapperProvider;
 
 /**
  * Provides access to the {@link GVRMesh meshes} contained in 3D models that
@@ -40,18 +46,50 @@ class GVRAssimpImporter extends GVRHybridObject {
      * 
      * @param index
      *            Index of the mesh to get
-     * @return The mesh, encapsulated as a {@link GVRMesh}.
+     * @return The mesh, encapsulated as a {@link GVRMesh}, or {@code null} if
+     *         it cannot be converted.
      */
     GVRMesh getMesh(int index) {
-        return new GVRMesh(getGVRContext(), NativeAssimpImporter.getMesh(
-                getNative(), index));
+        long mesh = NativeAssimpImporter.getMesh(getNative(), index);
+        return mesh != 0 ? new GVRMesh(getGVRContext(), mesh) : null;
+    }
+
+    /**
+     * Retrieves all the meshes from the imported 3D model.
+     * 
+     * @return The meshes, in the model's order.
+     * @throws IOException
+     *             A mesh cannot be converted
+     */
+    GVRMesh[] getMeshes() throws IOException {
+        int meshCount = getNumberOfMeshes();
+        GVRMesh[] meshes = new GVRMesh[meshCount];
+        for (int i = 0; i < meshCount; ++i) {
+            meshes[i] = getMesh(i);
+            if (meshes[i] == null) {
+                throw new IOException("Cannot convert mesh " + i);
+            }
+        }
+        return meshes;
+    }
+
+    /**
+     * Writes the mesh cache of a model that was not in it yet, from the
+     * meshes {@link #getMesh(int)} converted. Does nothing for models read
+     * from the cache, or if not every mesh was converted.
+     * 
+     * @return {@code true} if the cache was written
+     */
+    boolean writeMeshCache() {
+        return NativeAssimpImporter.writeMeshCache(getNative());
     }
 
     /**
      * Retrieves the complete scene from the imported 3D model.
      * 
      * @return The scene, encapsulated as a {@link AiScene}, which is a
-     *         component of the Jassimp integration.
+     *         component of the Jassimp integration, or {@code null} if the
+     *         model was read from the mesh cache, which has no Assimp scene.
      */
     AiScene getAssimpScene() {
         return NativeAssimpImporter.getAssimpScene(getNative());
@@ -77,6 +115,68 @@ class GVRAssimpImporter extends GVRHybridObject {
                 meshIndex);
     }
 
+    /**
+     * Builds the scene graph of the imported 3D model under an unnamed root.
+     * 
+     * The scene objects, transforms and render data are all made natively in
+     * one call; only the materials, whose textures are loaded from Java, are
+     * made here. The imported material of each mesh is fetched once, however
+     * many nodes draw the mesh.
+     * 
+     * @param meshes
+     *            The model's meshes, as {@link #getMeshes()} returns them.
+     * @return The root of the model.
+     * @throws IOException
+     *             A texture file cannot be read
+     */
+    GVRSceneObject createSceneGraph(GVRMesh[] meshes) throws IOException {
+        GVRContext gvrContext = getGVRContext();
+        long[] meshPointers = new long[meshes.length];
+        for (int i = 0; i < meshes.length; ++i) {
+            meshPointers[i] = meshes[i].getNative();
+        }
+        long[] nodes = NativeAssimpImporter.createSceneGraph(getNative(),
+                meshPointers);
+
+        AiWrapperProvider<byte[], AiMatrix4f, AiColor, AiNode, byte[]> wrapperProvider = gvrContext
+                .getAssimpWrapperProvider();
+        AiMaterial[] materials = new AiMaterial[meshes.length];
+        GVRSceneObject[] sceneObjects = new GVRSceneObject[nodes.length
+                / SCENE_NODE_STRIDE];
+        for (int i = 0; i < sceneObjects.length; ++i) {
+            int node = i * SCENE_NODE_STRIDE;
+            GVRSceneObject sceneObject = new GVRSceneObject(gvrContext,
+                    nodes[node], new GVRTransform(gvrContext, nodes[node + 1]));
+            sceneObjects[i] = sceneObject;
+
+            int parent = (int) nodes[node + 2];
+            if (parent >= 0) {
+                sceneObjects[parent].wrapChildObject(sceneObject);
+            }
+
+            if (nodes[node + 3] != 0) {
+                int meshIndex = (int) nodes[node + 4];
+                GVRRenderData renderData = new GVRRenderData(gvrContext,
+                        nodes[node + 3], meshes[meshIndex]);
+                if (materials[meshIndex] == null) {
+                    materials[meshIndex] = NativeAssimpImporter.getMaterial(
+                            getNative(), meshIndex);
+                }
+                renderData.setMaterial(gvrContext.createAssimpMaterial(
+                        materials[meshIndex], wrapperProvider));
+                sceneObject.wrapRenderData(renderData);
+            }
+        }
+        return sceneObjects[0];
+    }
+
+    /*
+     * Each node of the table NativeAssimpImporter.createSceneGraph() returns
+     * is: scene object, transform, parent node index (-1 for the root),
+     * render data (0 for none) and mesh index.
+     */
+    private static final int SCENE_NODE_STRIDE = 5;
+
 }
 
 class NativeAssimpImporter {
@@ -91,4 +191,10 @@ class NativeAssimpImporter {
 
     static native AiMaterial getMeshMaterial(long assimpImporter,
             String nodeName, int meshIndex);
+
+    static native AiMaterial getMaterial(long assimpImporter, int meshIndex);
+
+    static native long[] createSceneGraph(long assimpImporter, long[] meshes);
+
+    static native boolean writeMeshCache(long assimpImporter);
 }
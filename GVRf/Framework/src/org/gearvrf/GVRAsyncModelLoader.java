@@ -0,0 +1,296 @@
+/* Copyright 2015 Samsung Electronics Co., LTD
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+package org.gearvrf;
+
+import java.io.IOException;
+import java.util.ArrayList;
+import java.util.EnumSet;
+import java.util.List;
+import java.util.Queue;
+import java.util.concurrent.Callable;
+import java.util.concurrent.CancellationException;
+import java.util.concurrent.ConcurrentLinkedQueue;
+import java.util.concurrent.CountDownLatch;
+import java.util.concurrent.ExecutionException;
+import java.util.concurrent.Future;
+import java.util.concurrent.TimeUnit;
+import java.util.concurrent.TimeoutException;
+import java.util.concurrent.atomic.AtomicBoolean;
+
+import org.gearvrf.GVRAndroidResource.ModelCallback;
+import org.gearvrf.utility.Log;
+import org.gearvrf.utility.Threads;
+
+/**
+ * Loads a 3D model without holding up the GL thread.
+ *
+ * <ul>
+ * <li>The file is read and imported on a background thread.
+ * <li>Each mesh is converted by a job of its own on the thread pool; the
+ * importing thread then writes the mesh cache, if the model was not in it,
+ * and builds the scene graph and materials. Textures are decoded by the
+ * asynchronous texture loader.
+ * <li>On the GL thread, the buffers of the converted meshes are made a few at
+ * a time, for at most {@link #GL_BUDGET_NANOS} a frame, so that the model is
+ * ready to draw before it is handed over and its first draw does not make
+ * them all at once.
+ * </ul>
+ *
+ * The loader is the {@link Future} of the model: {@link #cancel(boolean)}
+ * stops the load at the next stage, as does the callback's
+ * {@link ModelCallback#stillWanted(GVRAndroidResource) stillWanted()}
+ * returning {@code false}.
+ */
+class GVRAsyncModelLoader implements Future<GVRSceneObject>,
+        GVRDrawFrameListener {
+
+    private static final String TAG = Log.tag(GVRAsyncModelLoader.class);
+
+    /** GL thread time spent making mesh buffers per frame */
+    static final long GL_BUDGET_NANOS = 2000000L;
+
+    private final GVRContext mGVRContext;
+    private final ModelCallback mCallback;
+    private final GVRAndroidResource mResource;
+    private final EnumSet<GVRImportSettings> mSettings;
+
+    private final List<Future<GVRMesh>> mMeshJobs = new ArrayList<Future<GVRMesh>>();
+    private final Queue<GVRMesh> mUploads = new ConcurrentLinkedQueue<GVRMesh>();
+    private volatile int mMeshCount = -1;
+    private int mMeshesUploaded;
+
+    private Future<?> mImport;
+    private volatile GVRSceneObject mModel;
+    private volatile Throwable mFailure;
+    private volatile boolean mCancelled;
+    private final AtomicBoolean mSettled = new AtomicBoolean();
+    private final CountDownLatch mDone = new CountDownLatch(1);
+
+    /**
+     * Starts loading a model.
+     *
+     * @param callback
+     *            Told of progress and the result, or {@code null}
+     */
+    static Future<GVRSceneObject> load(GVRContext gvrContext,
+            ModelCallback callback, GVRAndroidResource resource,
+            EnumSet<GVRImportSettings> settings) {
+        GVRAsyncModelLoader loader = new GVRAsyncModelLoader(gvrContext,
+                callback, resource, settings);
+        loader.start();
+        return loader;
+    }
+
+    private GVRAsyncModelLoader(GVRContext gvrContext, ModelCallback callback,
+            GVRAndroidResource resource, EnumSet<GVRImportSettings> settings) {
+        mGVRContext = gvrContext;
+        mCallback = callback;
+        mResource = resource;
+        mSettings = settings;
+    }
+
+    private void start() {
+        mGVRContext.registerDrawFrameListener(this);
+        mImport = Threads.spawnLow(new Runnable() {
+
+            @Override
+            public void run() {
+                try {
+                    importModel();
+                } catch (Throwable t) {
+                    fail(t);
+                }
+            }
+        });
+    }
+
+    /*
+     * The importing thread
+     */
+
+    private void importModel() throws Throwable {
+        if (!stillWanted()) {
+            return;
+        }
+        final GVRAssimpImporter importer = GVRImporter.readFileFromResources(
+                mGVRContext, mResource, mSettings);
+        if (importer == null) {
+            throw new IOException("Cannot import " + mResource);
+        }
+
+        int meshCount = importer.getNumberOfMeshes();
+        mMeshCount = meshCount;
+        synchronized (mMeshJobs) {
+            for (int i = 0; i < meshCount && !mCancelled; ++i) {
+                final int index = i;
+                mMeshJobs.add(Threads.spawn(new Callable<GVRMesh>() {
+
+                    @Override
+                    public GVRMesh call() throws IOException {
+                        if (mCancelled) {
+                            return null;
+                        }
+                        GVRMesh mesh = importer.getMesh(index);
+                        if (mesh == null) {
+                            throw new IOException("Cannot convert mesh "
+                                    + index + " of " + mResource);
+                        }
+                        mUploads.add(mesh);
+                        return mesh;
+                    }
+                }));
+            }
+        }
+
+        GVRMesh[] meshes = new GVRMesh[meshCount];
+        for (int i = 0; i < meshCount; ++i) {
+            try {
+                meshes[i] = mMeshJobs.get(i).get();
+            } catch (CancellationException e) {
+                return;
+            } catch (ExecutionException e) {
+                throw e.getCause();
+            }
+        }
+        if (!stillWanted()) {
+            return;
+        }
+
+        // from the copies the jobs kept, so nothing is converted twice
+        importer.writeMeshCache();
+        mModel = importer.createSceneGraph(meshes);
+    }
+
+    private boolean stillWanted() {
+        if (mCallback != null && !mCallback.stillWanted(mResource)) {
+            cancel(false);
+        }
+        return !mCancelled;
+    }
+
+    /*
+     * The GL thread
+     */
+
+    @Override
+    public void onDrawFrame(float frameTime) {
+        long start = System.nanoTime();
+        GVRMesh mesh;
+        while (!mCancelled && (mesh = mUploads.poll()) != null) {
+            mesh.upload();
+            ++mMeshesUploaded;
+            if (mCallback != null) {
+                mCallback.progress(mMeshesUploaded, mMeshCount, mResource);
+            }
+            if (System.nanoTime() - start > GL_BUDGET_NANOS) {
+                return;
+            }
+        }
+
+        GVRSceneObject model = mModel;
+        if (model != null && mMeshesUploaded == mMeshCount
+                && mSettled.compareAndSet(false, true)) {
+            mGVRContext.unregisterDrawFrameListener(this);
+            mDone.countDown();
+            if (mCallback != null) {
+                mCallback.loaded(model, mResource);
+            }
+        }
+    }
+
+    private void fail(Throwable t) {
+        if (!mSettled.compareAndSet(false, true)) {
+            return;
+        }
+        Log.e(TAG, "Cannot load %s: %s", mResource, t);
+        mFailure = t;
+        mGVRContext.unregisterDrawFrameListener(this);
+        cancelJobs(true);
+        mDone.countDown();
+        if (mCallback != null) {
+            mCallback.failed(t, mResource);
+        }
+    }
+
+    private void cancelJobs(boolean mayInterruptIfRunning) {
+        synchronized (mMeshJobs) {
+            for (Future<GVRMesh> job : mMeshJobs) {
+                job.cancel(mayInterruptIfRunning);
+            }
+        }
+        mUploads.clear();
+    }
+
+    /*
+     * Future<GVRSceneObject>
+     */
+
+    /**
+     * Stops the load. As with
+     * {@link ModelCallback#stillWanted(GVRAndroidResource) stillWanted()},
+     * the callback is not told.
+     */
+    @Override
+    public boolean cancel(boolean mayInterruptIfRunning) {
+        if (!mSettled.compareAndSet(false, true)) {
+            return false;
+        }
+        mCancelled = true;
+        mGVRContext.unregisterDrawFrameListener(this);
+        if (mImport != null) {
+            mImport.cancel(mayInterruptIfRunning);
+        }
+        cancelJobs(mayInterruptIfRunning);
+        mDone.countDown();
+        return true;
+    }
+
+    @Override
+    public boolean isCancelled() {
+        return mCancelled;
+    }
+
+    @Override
+    public boolean isDone() {
+        return mDone.getCount() == 0;
+    }
+
+    @Override
+    public GVRSceneObject get() throws InterruptedException,
+            ExecutionException {
+        mDone.await();
+        return result();
+    }
+
+    @Override
+    public GVRSceneObject get(long timeout, TimeUnit unit)
+            throws InterruptedException, ExecutionException, TimeoutException {
+        if (!mDone.await(timeout, unit)) {
+            throw new TimeoutException();
+        }
+        return result();
+    }
+
+    private GVRSceneObject result() throws ExecutionException {
+        if (mCancelled) {
+            throw new CancellationException();
+        }
+        if (mFailure != null) {
+            throw new ExecutionException(mFailure);
+        }
+        return mModel;
+    }
+}
@@ -27,6 +27,7 @@ import java.util.EnumSet;
 import org.gearvrf.GVRAndroidResource.BitmapTextureCallback;
 import org.gearvrf.GVRAndroidResource.CompressedTextureCallback;
 import org.gearvrf.GVRAndroidResource.MeshCallback;
+import org.gearvrf.GVRAndroidResource.ModelCallback;
 import org.gearvrf.GVRAndroidResource.TextureCallback;
 import org.gearvrf.GVRImportSettings;
 import org.gearvrf.GVRMaterial.GVRShaderType;
@@ -39,7 +40,6 @@ import org.gearvrf.jassimp.AiColor;
 import org.gearvrf.jassimp.AiMaterial;
 import org.gearvrf.jassimp.AiMatrix4f;
 import org.gearvrf.jassimp.AiNode;
-import org.gearvrf.jassimp.AiScene;
 import org.gearvrf.jassimp.AiTextureType;
 import org.gearvrf.jassimp.AiWrapperProvider;
 import org.gearvrf.periodic.GVRPeriodicEngine;
@@ -231,7 +231,9 @@ public abstract class GVRContext {
             GVRAssimpImporter assimpImporter = GVRImporter
                     .readFileFromResources(this, androidResource, settings);
             mesh = assimpImporter.getMesh(0);
-            sMeshCache.put(androidResource, mesh);
+            if (mesh != null) {
+                sMeshCache.put(androidResource, mesh);
+            }
         }
         return mesh;
     }
@@ -511,12 +513,60 @@ public abstract class GVRContext {
         GVRAssimpImporter assimpImporter = GVRImporter.readFileFromResources(
                 this, new GVRAndroidResource(this, assetRelativeFilename),
                 settings);
+        GVRMesh[] meshes = assimpImporter.getMeshes();
+        assimpImporter.writeMeshCache();
+        return assimpImporter.createSceneGraph(meshes);
+    }
 
-        GVRSceneObject wholeSceneObject = new GVRSceneObject(this);
+    /**
+     * Loads a 3D model as a {@link GVRSceneObject}, like
+     * {@link #getAssimpModel(String)}, but in the background.
+     * 
+     * <p>
+     * The model is imported on a background thread and its meshes converted
+     * in parallel; their GL buffers are then made a few at a time, a couple
+     * of milliseconds a frame, so the frame rate holds while the model loads.
+     * When {@link GVRAndroidResource.ModelCallback#loaded(GVRHybridObject, GVRAndroidResource)
+     * loaded()} is called, on the GL thread, every mesh is ready to draw and
+     * the model can be added to the scene; its textures may still be
+     * loading.
+     * 
+     * @param callback
+     *            Told of progress and the result, or {@code null}
+     * @param resource
+     *            The model file
+     * @return A {@link Future} of the model, which can also cancel the load
+     */
+    public Future<GVRSceneObject> loadModel(ModelCallback callback,
+            GVRAndroidResource resource) {
+        return loadModel(callback, resource,
+                GVRImportSettings.getRecommendedSettings());
+    }
 
-        AiScene assimpScene = assimpImporter.getAssimpScene();
+    /**
+     * Loads a 3D model as a {@link GVRSceneObject} in the background, like
+     * {@link #loadModel(GVRAndroidResource.ModelCallback, GVRAndroidResource)}
+     * but with some import settings.
+     * 
+     * @param callback
+     *            Told of progress and the result, or {@code null}
+     * @param resource
+     *            The model file
+     * @param settings
+     *            Additional import {@link GVRImportSettings settings}
+     * @return A {@link Future} of the model, which can also cancel the load
+     */
+    public Future<GVRSceneObject> loadModel(ModelCallback callback,
+            GVRAndroidResource resource, EnumSet<GVRImportSettings> settings) {
+        return GVRAsyncModelLoader.load(this, callback, resource, settings);
+    }
 
-        AiWrapperProvider<byte[], AiMatrix4f, AiColor, AiNode, byte[]> wrapperProvider = new AiWrapperProvider<byte[], AiMatrix4f, AiColor, AiNode, byte[]>() {
+    /**
+     * The wrapper provider Jassimp unwraps the properties of imported models
+     * with.
+     */
+    AiWrapperProvider<byte[], AiMatrix4f, AiColor, AiNode, byte[]> getAssimpWrapperProvider() {
+        return new AiWrapperProvider<byte[], AiMatrix4f, AiColor, AiNode, byte[]>() {
 
             /**
              * Wraps a RGBA color.
@@ -631,144 +681,27 @@ public abstract class GVRContext {
                 return warpedVector;
             }
         };
-
-        AiNode rootNode = assimpScene.getSceneRoot(wrapperProvider);
-
-        // Recurse through the entire hierarchy to attache all the meshes as
-        // Scene Object
-        this.recurseAssimpNodes(assetRelativeFilename, wholeSceneObject,
-                rootNode, wrapperProvider);
-
-        return wholeSceneObject;
     }
 
     /**
-     * Helper method to recurse through all the assimp nodes and get all their
-     * meshes that can be used to create {@link GVRSceneObject} to be attached
-     * to the set of complete scene objects for the assimp model.
-     * 
-     * @param assetRelativeFilename
-     *            A filename, relative to the {@code assets} directory. The file
-     *            can be in a sub-directory of the {@code assets} directory:
-     *            {@code "foo/bar.png"} will open the file
-     *            {@code assets/foo/bar.png}
-     * 
-     * @param wholeSceneObject
-     *            A reference of the {@link GVRSceneObject}, to which all other
-     *            scene objects are attached.
-     * 
-     * @param node
-     *            A reference to the AiNode for which we want to recurse all its
-     *            children and meshes.
-     * 
-     * @param wrapperProvider
-     *            AiWrapperProvider for unwrapping Jassimp properties.
-     * 
-     */
-    @SuppressWarnings("resource")
-    private void recurseAssimpNodes(
-            String assetRelativeFilename,
-            GVRSceneObject parentSceneObject,
-            AiNode node,
-            AiWrapperProvider<byte[], AiMatrix4f, AiColor, AiNode, byte[]> wrapperProvider) {
-        try {
-            GVRSceneObject newParentSceneObject = new GVRSceneObject(this);
-            if (node.getNumMeshes() == 0) {
-                parentSceneObject.addChildObject(newParentSceneObject);
-                parentSceneObject = newParentSceneObject;
-            } else if (node.getNumMeshes() == 1) {
-                // add the scene object to the scene graph
-                GVRSceneObject sceneObject = createSceneObject(
-                        assetRelativeFilename, node, 0, wrapperProvider);
-                parentSceneObject.addChildObject(sceneObject);
-                parentSceneObject = sceneObject;
-            } else {
-                for (int i = 0; i < node.getNumMeshes(); i++) {
-                    GVRSceneObject sceneObject = createSceneObject(
-                            assetRelativeFilename, node, i, wrapperProvider);
-                    newParentSceneObject.addChildObject(sceneObject);
-                }
-                parentSceneObject.addChildObject(newParentSceneObject);
-                parentSceneObject = newParentSceneObject;
-            }
-            if(node.getTransform(wrapperProvider) != null) {
-                float[] data = node.getTransform(wrapperProvider).m_data;
-                parentSceneObject.getTransform().setModelMatrix(transpose(data));
-                parentSceneObject.setName(node.getName());
-            }
-            for (int i = 0; i < node.getNumChildren(); i++) {
-                this.recurseAssimpNodes(assetRelativeFilename,
-                        parentSceneObject, node.getChildren().get(i),
-                        wrapperProvider);
-            }
-        } catch (Exception e) {
-            // Error while recursing the Scene Graph
-            e.printStackTrace();
-        }
-    }
-    
-    private float[] transpose(float[] modelMatrix){
-        float[] transposed = new float[16];
-        transposed[0] = modelMatrix[0];
-        transposed[4] = modelMatrix[1];
-        transposed[8] = modelMatrix[2];
-        transposed[12] = modelMatrix[3];
-        transposed[1] = modelMatrix[4];
-        transposed[5] = modelMatrix[5];
-        transposed[9] = modelMatrix[6];
-        transposed[13] = modelMatrix[7];
-        transposed[2] = modelMatrix[8];
-        transposed[6] = modelMatrix[9];
-        transposed[10] = modelMatrix[10];
-        transposed[14] = modelMatrix[11];
-        transposed[3] = modelMatrix[12];
-        transposed[7] = modelMatrix[13];
-        transposed[11] = modelMatrix[14];
-        transposed[15] = modelMatrix[15];
-        return transposed;
-    }
-
-    /**
-     * Helper method to create a new {@link GVRSceneObject} with the mesh at the
-     * index {@link index} of the node mesh array with a color or texture
+     * Helper method to create a color or texture material from an imported
      * material.
      * 
-     * @param assetRelativeFilename
-     *            A filename, relative to the {@code assets} directory. The file
-     *            can be in a sub-directory of the {@code assets} directory:
-     *            {@code "foo/bar.png"} will open the file
-     *            {@code assets/foo/bar.png}
-     * 
-     * @param node
-     *            A reference to the AiNode for which we want to recurse all its
-     *            children and meshes.
-     * 
-     * @param index
-     *            The index of the mesh in the array of meshes for that node.
+     * @param material
+     *            The imported material.
      * 
      * @param wrapperProvider
      *            AiWrapperProvider for unwrapping Jassimp properties.
      * 
-     * @return The new {@link GVRSceneObject} with the mesh at the index
-     *         {@link index} for the node {@link node}
+     * @return The new {@link GVRMaterial}
      * 
      * @throws IOException
-     *             File does not exist or cannot be read
+     *             A texture file cannot be read
      */
-    private GVRSceneObject createSceneObject(
-            String assetRelativeFilename,
-            AiNode node,
-            int index,
+    GVRMaterial createAssimpMaterial(
+            AiMaterial material,
             AiWrapperProvider<byte[], AiMatrix4f, AiColor, AiNode, byte[]> wrapperProvider)
             throws IOException {
-
-        FutureWrapper<GVRMesh> futureMesh = new FutureWrapper<GVRMesh>(
-                this.getNodeMesh(new GVRAndroidResource(this,
-                        assetRelativeFilename), node.getName(), index));
-
-        AiMaterial material = this.getMeshMaterial(new GVRAndroidResource(this,
-                assetRelativeFilename), node.getName(), index);
-        
         GVRMaterial meshMaterial = new GVRMaterial(this,
                 GVRShaderType.Assimp.ID);
         
@@ -823,14 +756,7 @@ public abstract class GVRContext {
 
         /* Apply feature set to the material */
         meshMaterial.setShaderFeatureSet(assimpFeatureSet);
-
-        GVRSceneObject sceneObject = new GVRSceneObject(this);
-        sceneObject.setName(node.getName());
-        GVRRenderData sceneObjectRenderData = new GVRRenderData(this);
-        sceneObjectRenderData.setMesh(futureMesh);
-        sceneObjectRenderData.setMaterial(meshMaterial);
-        sceneObject.attachRenderData(sceneObjectRenderData);
-        return sceneObject;
+        return meshMaterial;
     }
 
     /**
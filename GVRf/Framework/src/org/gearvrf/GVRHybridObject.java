@@ -20,6 +20,7 @@ import java.io.IOException;
 import java.lang.ref.PhantomReference;
 import java.lang.ref.ReferenceQueue;
 import java.util.ArrayList;
+import java.util.Collections;
 import java.util.HashMap;
 import java.util.HashSet;
 import java.util.List;
@@ -208,9 +209,12 @@ public abstract class GVRHybridObject implements Closeable {
     /**
      * We need hard references to {@linkplain GVRReference our references} -
      * otherwise, the references get garbage collected (usually before their
-     * objects) and never get enqueued.
+     * objects) and never get enqueued. Objects are made on loader threads
+     * as well as the GL thread, and freed on the finalize thread, so the set
+     * is synchronized.
      */
-    private static final Set<GVRReference> sReferenceSet = new HashSet<GVRReference>();
+    private static final Set<GVRReference> sReferenceSet = Collections
+            .synchronizedSet(new HashSet<GVRReference>());
 
     static {
         new GVRFinalizeThread();
@@ -15,6 +15,7 @@
 
 package org.gearvrf;
 
+import java.io.File;
 import java.io.IOException;
 import java.io.InputStream;
 import java.util.EnumSet;
@@ -30,11 +31,31 @@ import org.gearvrf.GVRImportSettings;
  * Supports importing models from an application's resources (both
  * {@code assets} and {@code res/raw}) and from directories on the device's SD
  * card that the application has permission to read.
+ * <p>
+ * The meshes, node hierarchy and materials of models imported from resources
+ * are kept in a cache in the application's cache directory, so importing the
+ * same model again with the same settings skips parsing it. Android may clear
+ * that directory at any time; the cache is written again on the next import.
  */
 class GVRImporter {
+    private static final String MESH_CACHE_DIRECTORY = "gvrf_meshes";
+
     private GVRImporter() {
     }
 
+    /**
+     * The directory the mesh cache goes in, or {@code null} if it cannot be
+     * created, which imports without a cache.
+     */
+    private static String getMeshCacheDir(GVRContext gvrContext) {
+        File cacheDir = new File(gvrContext.getContext().getCacheDir(),
+                MESH_CACHE_DIRECTORY);
+        if (!cacheDir.isDirectory() && !cacheDir.mkdirs()) {
+            return null;
+        }
+        return cacheDir.getAbsolutePath();
+    }
+
     /**
      * Imports a 3D model from the specified file in the application's
      * {@code asset} directory.
@@ -49,7 +70,8 @@ class GVRImporter {
     static GVRAssimpImporter readFileFromAssets(GVRContext gvrContext,
             String filename, EnumSet<GVRImportSettings> settings) { 
         long nativeValue = NativeImporter.readFileFromAssets(gvrContext
-                .getContext().getAssets(), filename, GVRImportSettings.getAssimpImportFlags(settings));
+                .getContext().getAssets(), filename, GVRImportSettings.getAssimpImportFlags(settings),
+                getMeshCacheDir(gvrContext));
         return nativeValue == 0 ? null : new GVRAssimpImporter(gvrContext,
                 nativeValue);
     }
@@ -77,7 +99,8 @@ class GVRImporter {
                 resourceFilename = ""; // Passing null causes JNI exception.
             }
             long nativeValue = NativeImporter.readFromByteArray(bytes,
-                    resourceFilename, GVRImportSettings.getAssimpImportFlags(settings));
+                    resourceFilename, GVRImportSettings.getAssimpImportFlags(settings),
+                    getMeshCacheDir(gvrContext));
             return new GVRAssimpImporter(gvrContext, nativeValue);
         } catch (IOException e) {
             e.printStackTrace();
@@ -107,9 +130,10 @@ class GVRImporter {
 
 class NativeImporter {
     static native long readFileFromAssets(AssetManager assetManager,
-            String filename, int settings);
+            String filename, int settings, String cacheDir);
 
     static native long readFileFromSDCard(String filename, int settings);
 
-    static native long readFromByteArray(byte[] bytes, String filename, int settings);
+    static native long readFromByteArray(byte[] bytes, String filename, int settings,
+            String cacheDir);
 }
@@ -22,6 +22,27 @@ import java.util.Map;
  * Manages custom shaders, for rendering scene objects.
  * 
  * Get the singleton from {@link GVRContext#getMaterialShaderManager()}.
+ * 
+ * A vertex shader that declares {@code attribute mat4 a_model} and
+ * {@code uniform mat4 u_vp}, in place of {@code uniform mat4 u_mvp}, is drawn
+ * instanced: scene objects sharing its material and mesh are drawn with a
+ * single draw call, {@code a_model} being the model matrix of each of them.
+ * 
+ * GLSL ES 3.00 shaders can instead read the view and projection of the eye
+ * from a uniform block, set once per eye rather than for every draw:
+ * 
+ * <pre>
+ * layout(std140) uniform FrameUniforms {
+ *     highp mat4 u_view;
+ *     highp mat4 u_projection;
+ *     highp mat4 u_view_projection;
+ *     highp int u_eye; // 0 for the left eye, 1 for the right
+ * };
+ * </pre>
+ * 
+ * Such a shader takes the model matrix from {@code uniform mat4 u_model}, or
+ * from {@code attribute mat4 a_model} to be drawn instanced without
+ * {@code u_vp}.
  */
 public class GVRMaterialShaderManager extends
         GVRBaseShaderManager<GVRMaterialMap, GVRCustomMaterialShaderId>
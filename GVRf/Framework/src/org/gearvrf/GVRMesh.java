@@ -17,6 +17,8 @@ package org.gearvrf;
 
 import static org.gearvrf.utility.Assert.*;
 
+import java.util.concurrent.CountDownLatch;
+
 import org.gearvrf.utility.Exceptions;
 
 /**
@@ -25,6 +27,41 @@ import org.gearvrf.utility.Exceptions;
  * A GL mesh is a net of triangles that define an object's surface geometry.
  */
 public class GVRMesh extends GVRHybridObject {
+    /**
+     * Lets each mesh pick the smallest vertex types that keep its data
+     * intact: half float positions if the mesh is about centered on its
+     * origin and small enough for them to stay within the
+     * {@linkplain #setPositionTolerance(float) position tolerance}, 10-bit
+     * normals if they are unit length, and 16-bit texture
+     * coordinates if they are between 0 and 1. The default.
+     */
+    public static final int VERTEX_FORMAT_AUTO = 0;
+    /** Uploads positions, normals and texture coordinates as floats. */
+    public static final int VERTEX_FORMAT_FLOAT = 1;
+    /**
+     * Uploads half float positions, 10-bit normals and 16-bit texture
+     * coordinates whatever the data is, trading precision for memory and
+     * bandwidth.
+     */
+    public static final int VERTEX_FORMAT_PACKED = 2;
+
+    /** For meshes that do not change once drawn. The default. */
+    public static final int BUFFER_USAGE_STATIC = 0;
+    /** For meshes changed now and then, a few vertices at a time. */
+    public static final int BUFFER_USAGE_DYNAMIC = 1;
+    /** For meshes changed about every frame, mostly all at once. */
+    public static final int BUFFER_USAGE_STREAM = 2;
+
+    /** Keeps all vertex data in memory after upload. The default. */
+    public static final int RESIDENCY_KEEP_ALL = 0;
+    /**
+     * Keeps only the positions and triangles in memory after upload, enough
+     * for picking and occlusion.
+     */
+    public static final int RESIDENCY_KEEP_POSITIONS = 1;
+    /** Keeps only the bounds in memory after upload. */
+    public static final int RESIDENCY_GPU_ONLY = 2;
+
     public GVRMesh(GVRContext gvrContext) {
         super(gvrContext, NativeMesh.ctor());
     }
@@ -44,6 +81,7 @@ public class GVRMesh extends GVRHybridObject {
      * @return Array with the packed vertex data.
      */
     public float[] getVertices() {
+        ensureCpuData();
         return NativeMesh.getVertices(getNative());
     }
 
@@ -70,6 +108,7 @@ public class GVRMesh extends GVRHybridObject {
      * @return Array with the packed normal data.
      */
     public float[] getNormals() {
+        ensureCpuData();
         return NativeMesh.getNormals(getNative());
     }
 
@@ -96,6 +135,7 @@ public class GVRMesh extends GVRHybridObject {
      * @return Array with the packed texture coordinate data.
      */
     public float[] getTexCoords() {
+        ensureCpuData();
         return NativeMesh.getTexCoords(getNative());
     }
 
@@ -125,6 +165,7 @@ public class GVRMesh extends GVRHybridObject {
      * @return Array with the packed triangle index data.
      */
     public char[] getTriangles() {
+        ensureCpuData();
         return NativeMesh.getTriangles(getNative());
     }
 
@@ -154,6 +195,7 @@ public class GVRMesh extends GVRHybridObject {
      * @return Array of {@code float} scalars.
      */
     public float[] getFloatVector(String key) {
+        ensureCpuData();
         return NativeMesh.getFloatVector(getNative(), key);
     }
 
@@ -180,6 +222,7 @@ public class GVRMesh extends GVRHybridObject {
      * @return Array of two-component {@code float} vectors.
      */
     public float[] getVec2Vector(String key) {
+        ensureCpuData();
         return NativeMesh.getVec2Vector(getNative(), key);
     }
 
@@ -207,6 +250,7 @@ public class GVRMesh extends GVRHybridObject {
      * @return Array of three-component {@code float} vectors.
      */
     public float[] getVec3Vector(String key) {
+        ensureCpuData();
         return NativeMesh.getVec3Vector(getNative(), key);
     }
 
@@ -234,6 +278,7 @@ public class GVRMesh extends GVRHybridObject {
      * @return Array of four-component {@code float} vectors.
      */
     public float[] getVec4Vector(String key) {
+        ensureCpuData();
         return NativeMesh.getVec4Vector(getNative(), key);
     }
 
@@ -252,6 +297,162 @@ public class GVRMesh extends GVRHybridObject {
         NativeMesh.setVec4Vector(getNative(), key, vec4Vector);
     }
 
+    /**
+     * Sets how the vertices of this mesh are stored on the GPU. Positions,
+     * normals and texture coordinates go interleaved into one buffer, in the
+     * types the format picks; shaders read them as floats either way. Only
+     * the copy the GPU draws is affected: {@link #getVertices()} and the
+     * other getters return what was set.
+     * 
+     * @param format
+     *            {@link #VERTEX_FORMAT_AUTO}, {@link #VERTEX_FORMAT_FLOAT} or
+     *            {@link #VERTEX_FORMAT_PACKED}.
+     */
+    public void setVertexFormat(int format) {
+        if (format < VERTEX_FORMAT_AUTO || format > VERTEX_FORMAT_PACKED) {
+            throw Exceptions.IllegalArgument("Unknown vertex format %d.",
+                    format);
+        }
+        NativeMesh.setVertexFormat(getNative(), format);
+    }
+
+    /**
+     * Sets how far {@link #VERTEX_FORMAT_AUTO} lets positions move when it
+     * stores them as half floats. Half floats are off by up to 1/2048 of the
+     * largest coordinate, so with the default of 0.001 (a millimeter, in
+     * meters) only meshes within about two units of their origin are packed;
+     * larger ones keep float positions. {@link #VERTEX_FORMAT_PACKED} packs
+     * them regardless.
+     * 
+     * @param tolerance
+     *            The largest acceptable error, in the mesh's units.
+     */
+    public void setPositionTolerance(float tolerance) {
+        NativeMesh.setPositionTolerance(getNative(), tolerance);
+    }
+
+    /**
+     * Sets how often this mesh is expected to change. A static mesh
+     * uploads all of its data again whenever any of it is set. Dynamic and
+     * stream meshes keep their GPU buffers as long as the number of
+     * vertices and triangles stays the same, and upload only the vertices
+     * that changed, so they can be deformed every frame. Dynamic and stream
+     * meshes keep their vertices in floats whatever the
+     * {@linkplain #setVertexFormat(int) vertex format} is, unless it is
+     * {@link #VERTEX_FORMAT_PACKED}.
+     * 
+     * @param usage
+     *            {@link #BUFFER_USAGE_STATIC}, {@link #BUFFER_USAGE_DYNAMIC}
+     *            or {@link #BUFFER_USAGE_STREAM}.
+     */
+    public void setBufferUsage(int usage) {
+        if (usage < BUFFER_USAGE_STATIC || usage > BUFFER_USAGE_STREAM) {
+            throw Exceptions.IllegalArgument("Unknown buffer usage %d.",
+                    usage);
+        }
+        NativeMesh.setBufferUsage(getNative(), usage);
+    }
+
+    /**
+     * Sets which vertex data this mesh keeps in memory once the GPU has a
+     * copy, so that large static models do not take their size twice. The
+     * getters, and the methods that need the vertices, read what was
+     * dropped back from the GPU, waiting for the GL thread if called from
+     * another; data read back stays in memory until the mesh is uploaded
+     * again. Read back from a {@linkplain #setVertexFormat(int) packed}
+     * mesh, the data has the precision of the packed types. Dynamic and
+     * stream meshes keep everything.
+     * 
+     * <p>
+     * A mesh that dropped its vertices is not batched with others. Meshes
+     * picked through a {@link GVRMeshEyePointee}, or drawn as occluders,
+     * keep their positions and triangles whatever their residency, since
+     * those are tested on the CPU.
+     * 
+     * @param residency
+     *            {@link #RESIDENCY_KEEP_ALL},
+     *            {@link #RESIDENCY_KEEP_POSITIONS} or
+     *            {@link #RESIDENCY_GPU_ONLY}. Takes effect on the next
+     *            upload.
+     */
+    public void setResidency(int residency) {
+        if (residency < RESIDENCY_KEEP_ALL || residency > RESIDENCY_GPU_ONLY) {
+            throw Exceptions.IllegalArgument("Unknown residency %d.",
+                    residency);
+        }
+        NativeMesh.setResidency(getNative(), residency);
+    }
+
+    /**
+     * Replaces some of the vertices of the mesh, leaving the others as they
+     * are. On a {@linkplain #setBufferUsage(int) dynamic} mesh, only those
+     * are uploaded on the next draw.
+     * 
+     * @param firstVertex
+     *            Index of the first vertex replaced.
+     * @param vertices
+     *            Packed {@code float} triplets, as in
+     *            {@link #setVertices(float[])}.
+     */
+    public void updateVertices(int firstVertex, float[] vertices) {
+        checkValidFloatArray("vertices", vertices, 3);
+        ensureCpuData();
+        NativeMesh.updateVertices(getNative(), firstVertex, vertices);
+    }
+
+    /**
+     * Replaces some of the normals of the mesh, like
+     * {@link #updateVertices(int, float[])}.
+     * 
+     * @param firstVertex
+     *            Index of the first normal replaced.
+     * @param normals
+     *            Packed {@code float} triplets, as in
+     *            {@link #setNormals(float[])}.
+     */
+    public void updateNormals(int firstVertex, float[] normals) {
+        checkValidFloatArray("normals", normals, 3);
+        ensureCpuData();
+        NativeMesh.updateNormals(getNative(), firstVertex, normals);
+    }
+
+    /**
+     * Replaces some of the texture coordinates of the mesh, like
+     * {@link #updateVertices(int, float[])}.
+     * 
+     * @param firstVertex
+     *            Index of the first texture coordinate pair replaced.
+     * @param texCoords
+     *            Packed {@code float} pairs, as in
+     *            {@link #setTexCoords(float[])}.
+     */
+    public void updateTexCoords(int firstVertex, float[] texCoords) {
+        checkValidFloatArray("texCoords", texCoords, 2);
+        ensureCpuData();
+        NativeMesh.updateTexCoords(getNative(), firstVertex, texCoords);
+    }
+
+    /**
+     * Reorders the triangles and vertices of this mesh so it draws faster:
+     * triangles that share vertices are drawn together, so the GPU
+     * transforms fewer vertices, and the outer surfaces first, so less is
+     * drawn over. What is drawn does not change, but the vertices are
+     * renumbered, so arrays from {@link #getVertices()} and the other
+     * getters are in the new order.
+     * 
+     * <p>
+     * Meshes from {@link GVRContext#loadMesh(GVRAndroidResource)} and the
+     * other importing methods are already optimized; this is for meshes
+     * built in Java that are drawn often and changed seldom.
+     * 
+     * @return The average number of vertices transformed per triangle,
+     *         before and after: between 3 and about 0.5, lower is better.
+     */
+    public float[] optimize() {
+        ensureCpuData();
+        return NativeMesh.optimize(getNative());
+    }
+
     /**
      * Constructs a {@link GVRMesh mesh} that contains this mesh.
      * 
@@ -271,6 +472,104 @@ public class GVRMesh extends GVRHybridObject {
                 NativeMesh.getBoundingBox(getNative()));
     }
 
+    /**
+     * Builds simplified copies of this mesh, with fewer triangles, for use as
+     * {@linkplain GVRSceneObject#generateLODs(int, float) levels of detail.}
+     * 
+     * <p>
+     * Edges are collapsed into one of their vertices, the collapses that move
+     * the surface the least first. Normal and texture coordinate seams and
+     * open borders are kept whole, so a level may keep more triangles than
+     * asked for.
+     * 
+     * @param triangleRatios
+     *            The fraction of the triangles of this mesh each copy should
+     *            keep, between 0 and 1 and in decreasing order.
+     * @return One mesh per ratio.
+     */
+    public GVRMesh[] simplify(float... triangleRatios) {
+        return simplify(triangleRatios, null);
+    }
+
+    /**
+     * Like {@link #simplify(float...)}, also filling {@code errors}, if not
+     * null, with how far each copy strays from this mesh, as a fraction of
+     * the diameter of its bounds.
+     */
+    GVRMesh[] simplify(float[] triangleRatios, float[] errors) {
+        if (errors != null && errors.length < triangleRatios.length) {
+            throw Exceptions.IllegalArgument(
+                    "errors has %d elements for %d triangleRatios",
+                    errors.length, triangleRatios.length);
+        }
+        for (int i = 0; i < triangleRatios.length; ++i) {
+            if (triangleRatios[i] < 0.0f || triangleRatios[i] > 1.0f
+                    || (i > 0 && triangleRatios[i] > triangleRatios[i - 1])) {
+                throw Exceptions
+                        .IllegalArgument(
+                                "triangleRatios should be between 0 and 1 and decreasing; %f at index %d is not.",
+                                triangleRatios[i], i);
+            }
+        }
+
+        ensureCpuData();
+        long[] levels = NativeMesh.simplify(getNative(), triangleRatios,
+                errors);
+        GVRMesh[] meshes = new GVRMesh[levels.length];
+        for (int i = 0; i < levels.length; ++i) {
+            meshes[i] = new GVRMesh(getGVRContext(), levels[i]);
+        }
+        return meshes;
+    }
+
+    /**
+     * Reads back the vertex data dropped after upload, on the GL thread.
+     */
+    void ensureCpuData() {
+        if (!NativeMesh.hasCpuData(getNative())) {
+            readBack();
+        }
+    }
+
+    /**
+     * Keeps the positions and triangles of this mesh in memory from now on,
+     * for picking, reading them back on the GL thread if they were dropped.
+     */
+    void keepPositions() {
+        if (!NativeMesh.keepPositions(getNative())) {
+            readBack();
+        }
+    }
+
+    private void readBack() {
+        if (getGVRContext().isCurrentThreadGLThread()) {
+            NativeMesh.readBack(getNative());
+            return;
+        }
+
+        final CountDownLatch readBack = new CountDownLatch(1);
+        getGVRContext().runOnGlThread(new Runnable() {
+            @Override
+            public void run() {
+                NativeMesh.readBack(getNative());
+                readBack.countDown();
+            }
+        });
+        try {
+            readBack.await();
+        } catch (InterruptedException e) {
+            Thread.currentThread().interrupt();
+        }
+    }
+
+    /**
+     * Makes the GL buffers and vertex array of this mesh now, rather than on
+     * its first draw. Called on the GL thread.
+     */
+    void upload() {
+        NativeMesh.upload(getNative());
+    }
+
     private void checkValidFloatVector(String keyName, String key,
             String vectorName, float[] vector, int expectedComponents) {
         checkStringNotNullOrEmpty(keyName, key);
@@ -333,5 +632,32 @@ class NativeMesh {
 
     static native void setVec4Vector(long mesh, String key, float[] vec4Vector);
 
+    static native void setVertexFormat(long mesh, int format);
+
+    static native void setPositionTolerance(long mesh, float tolerance);
+
+    static native float[] optimize(long mesh);
+
+    static native void setBufferUsage(long mesh, int usage);
+
+    static native void setResidency(long mesh, int residency);
+
+    static native boolean hasCpuData(long mesh);
+
+    static native boolean keepPositions(long mesh);
+
+    static native void readBack(long mesh);
+
+    static native void upload(long mesh);
+
+    static native void updateVertices(long mesh, int first, float[] vertices);
+
+    static native void updateNormals(long mesh, int first, float[] normals);
+
+    static native void updateTexCoords(long mesh, int first, float[] texCoords);
+
     static native long getBoundingBox(long mesh);
+
+    static native long[] simplify(long mesh, float[] triangleRatios,
+            float[] errors);
 }
@@ -46,6 +46,7 @@ public class GVRMeshEyePointee extends GVREyePointee {
      */
     public GVRMeshEyePointee(GVRContext gvrContext, GVRMesh mesh) {
         super(gvrContext, NativeMeshEyePointee.ctor(mesh.getNative()));
+        mesh.keepPositions();
         mMesh = mesh;
     }
 
@@ -106,6 +107,7 @@ public class GVRMeshEyePointee extends GVREyePointee {
     public void setMesh(GVRMesh mesh) {
         mMesh = mesh;
         NativeMeshEyePointee.setMesh(getNative(), mesh.getNative());
+        mesh.keepPositions();
     }
 }
 
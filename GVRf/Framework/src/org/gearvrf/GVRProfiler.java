@@ -0,0 +1,91 @@
+/* Copyright 2015 Samsung Electronics Co., LTD
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+package org.gearvrf;
+
+/**
+ * Times the native frame: culling, sorting, drawing per shader, post
+ * effects, occlusion queries, sensor processing and picking, on whichever
+ * thread runs them, and the GPU time of each pass where the driver has
+ * {@code EXT_disjoint_timer_query}.
+ *
+ * The profiler is off by default; while off it costs next to nothing. Each
+ * thread keeps its last few thousand events, so a trace covers the last
+ * few dozen frames.
+ */
+public final class GVRProfiler {
+    private GVRProfiler() {
+    }
+
+    /**
+     * Starts or stops recording.
+     *
+     * @param enabled
+     *            {@code true} to record.
+     */
+    public static void setEnabled(boolean enabled) {
+        NativeProfiler.setEnabled(enabled);
+    }
+
+    /**
+     * @return {@code true} while recording.
+     */
+    public static boolean isEnabled() {
+        return NativeProfiler.isEnabled();
+    }
+
+    /**
+     * Drops everything recorded so far.
+     */
+    public static void clear() {
+        NativeProfiler.clear();
+    }
+
+    /**
+     * Gets what was recorded as Chrome trace events, to be saved to a file
+     * and loaded in {@code chrome://tracing}. GPU passes show up on a thread
+     * named GPU, at the time they were issued.
+     *
+     * @return The trace, in JSON.
+     */
+    public static String getChromeTrace() {
+        return NativeProfiler.getChromeTrace();
+    }
+
+    /**
+     * Gets the time spent in each scope during the last complete frame,
+     * summed over all threads, as a JSON object like
+     * {@code {"frame":12,"ms":15.2,"cpu":{"cull":{"ms":1.4,"count":1},...},"gpu":{...}}}.
+     * GPU results take a few frames to arrive, so the GPU times of the last
+     * frames may be missing.
+     *
+     * @return The summary, or {@code {}} if no frame was recorded.
+     */
+    public static String getFrameSummary() {
+        return NativeProfiler.getFrameSummary();
+    }
+}
+
+class NativeProfiler {
+    static native void setEnabled(boolean enabled);
+
+    static native boolean isEnabled();
+
+    static native void clear();
+
+    static native String getChromeTrace();
+
+    static native String getFrameSummary();
+}
@@ -20,6 +20,7 @@ import java.util.concurrent.Future;
 import java.util.concurrent.TimeUnit;
 import java.util.concurrent.TimeoutException;
 import java.util.ArrayList;
+import java.util.Set;
 
 import org.gearvrf.GVRRenderPass;
 import org.gearvrf.GVRRenderPass.GVRCullFaceEnum;
@@ -116,6 +117,16 @@ public class GVRRenderData extends GVRComponent {
         addPass(basePass);
     }
 
+    /**
+     * Wraps native render data that already draws {@code mesh}, as made by
+     * the importer's scene graph builder.
+     */
+    GVRRenderData(GVRContext gvrContext, long ptr, GVRMesh mesh) {
+        this(gvrContext, ptr);
+        mMesh = mesh;
+        isLightEnabled = false;
+    }
+
     /**
      * @return The {@link GVRMesh mesh} being rendered.
      */
@@ -286,6 +297,21 @@ public class GVRRenderData extends GVRComponent {
     public void addPass(GVRRenderPass pass) {
         mRenderPassList.add(pass);
         NativeRenderData.addPass(getNative(), pass.getNative());
+        GVRSceneObject owner = getOwnerObject();
+        if (owner != null) {
+            owner.keepStaticMaterials(owner);
+        }
+    }
+
+    /**
+     * Adds the materials of all passes to {@code materials}.
+     */
+    void getMaterials(Set<GVRMaterial> materials) {
+        for (GVRRenderPass pass : mRenderPassList) {
+            if (pass.getMaterial() != null) {
+                materials.add(pass.getMaterial());
+            }
+        }
     }
     
     /**
@@ -346,6 +372,10 @@ public class GVRRenderData extends GVRComponent {
     public void setMaterial(GVRMaterial material, int passIndex) {
         if (passIndex < mRenderPassList.size()) {
             mRenderPassList.get(passIndex).setMaterial(material);
+            GVRSceneObject owner = getOwnerObject();
+            if (owner != null) {
+                owner.keepStaticMaterials(owner);
+            }
         } else {
             Log.e(TAG, "Trying to set material from invalid pass. Pass " + passIndex + " was not created.");
         }
@@ -676,6 +706,38 @@ public class GVRRenderData extends GVRComponent {
         NativeRenderData.setDrawMode(getNative(), drawMode);
     }
 
+    /**
+     * A render data drawing another mesh with the render state of this one.
+     * The first pass gets the material and cull face of the first pass of
+     * this one, the other passes are shared.
+     */
+    GVRRenderData copyForMesh(GVRMesh mesh) {
+        GVRRenderData copy = new GVRRenderData(getGVRContext());
+        copy.setMesh(mesh);
+        if (getMaterial() != null) {
+            copy.setMaterial(getMaterial());
+        }
+        copy.setCullFace(getCullFace());
+        for (int i = 1; i < mRenderPassList.size(); ++i) {
+            copy.addPass(mRenderPassList.get(i));
+        }
+        if (mLight != null) {
+            copy.setLight(mLight);
+            if (!isLightEnabled) {
+                copy.disableLight();
+            }
+        }
+        copy.setRenderMask(getRenderMask());
+        copy.setRenderingOrder(getRenderingOrder());
+        copy.setOffset(getOffset());
+        copy.setOffsetFactor(getOffsetFactor());
+        copy.setOffsetUnits(getOffsetUnits());
+        copy.setDepthTest(getDepthTest());
+        copy.setAlphaBlend(getAlphaBlend());
+        copy.setDrawMode(getDrawMode());
+        return copy;
+    }
+
     private boolean isLightEnabled;
 }
 
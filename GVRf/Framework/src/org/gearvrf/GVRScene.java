@@ -34,7 +34,7 @@ public class GVRScene extends GVRHybridObject {
 
     /**
      * Constructs a scene with a camera rig holding left & right cameras in it.
-     * 
+     *
      * @param gvrContext
      *            {@link GVRContext} the app is using.
      */
@@ -66,7 +66,7 @@ public class GVRScene extends GVRHybridObject {
 
     /**
      * Add an {@linkplain GVRSceneObject scene object}
-     * 
+     *
      * @param sceneObject
      *            The {@linkplain GVRSceneObject scene object} to add.
      */
@@ -77,7 +77,7 @@ public class GVRScene extends GVRHybridObject {
 
     /**
      * Remove a {@linkplain GVRSceneObject scene object}
-     * 
+     *
      * @param sceneObject
      *            The {@linkplain GVRSceneObject scene object} to remove.
      */
@@ -88,10 +88,10 @@ public class GVRScene extends GVRHybridObject {
 
     /**
      * The top-level scene objects.
-     * 
+     *
      * @return A read-only list containing all the 'root' scene objects (those
      *         that were added directly to the scene).
-     * 
+     *
      * @since 2.0.0
      */
     public List<GVRSceneObject> getSceneObjects() {
@@ -109,7 +109,7 @@ public class GVRScene extends GVRHybridObject {
     /**
      * Set the {@link GVRCameraRig camera rig} used for rendering the scene on
      * the screen.
-     * 
+     *
      * @param cameraRig
      *            The {@link GVRCameraRig camera rig} to render with.
      */
@@ -157,13 +157,40 @@ public class GVRScene extends GVRHybridObject {
         NativeScene.setOcclusionQuery(getNative(), flag);
     }
 
+    /**
+     * Sets whether the {@link GVRScene} is culled against the scene objects
+     * marked with {@link GVRSceneObject#setOccluder(boolean)}.
+     * 
+     * The occluders in view are rasterized on the CPU into a small depth
+     * buffer every frame, and objects whose bounds are entirely behind them
+     * are not drawn. Unlike occlusion queries this takes effect in the same
+     * frame and needs no GPU round trip; when enabled, occlusion queries are
+     * not used. It only works together with frustum culling.
+     */
+    public void setOccluderCulling(boolean flag) {
+        NativeScene.setOccluderCulling(getNative(), flag);
+    }
+
+    /**
+     * Sets the number of threads the frustum culling of the {@link GVRScene}
+     * is split across, the GL thread included. The render list does not
+     * depend on this number.
+     *
+     * @param count
+     *            Number of cull threads; 0, the default, uses one thread per
+     *            core and 1 culls on the GL thread only.
+     */
+    public void setCullThreadCount(int count) {
+        NativeScene.setCullThreadCount(getNative(), count);
+    }
+
     private GVRConsole mStatsConsole = null;
     private boolean mStatsEnabled = false;
     private boolean pendingStats = false;
 
     /**
      * Returns whether displaying of stats is enabled for this scene.
-     * 
+     *
      * @return whether displaying of stats is enabled for this scene.
      */
     public boolean getStatsEnabled() {
@@ -172,7 +199,7 @@ public class GVRScene extends GVRHybridObject {
 
     /**
      * Set whether to enable display of stats for this scene.
-     * 
+     *
      * @param enabled
      *            Flag to indicate whether to enable display of stats.
      */
@@ -213,9 +240,13 @@ public class GVRScene extends GVRHybridObject {
         if (mStatsEnabled) {
             int numberDrawCalls = NativeScene.getNumberDrawCalls(getNative());
             int numberTriangles = NativeScene.getNumberTriangles(getNative());
+            int numberSkippedGLCalls = NativeScene
+                    .getNumberSkippedGLCalls(getNative());
 
             mStatsConsole.writeLine("Draw Calls: %d", numberDrawCalls);
             mStatsConsole.writeLine("Triangles: %d", numberTriangles);
+            mStatsConsole.writeLine("Skipped GL Calls: %d",
+                    numberSkippedGLCalls);
 
             if (mStatMessage.length() > 0)
                 mStatsConsole.writeLine("%s", mStatMessage.toString());
@@ -224,7 +255,7 @@ public class GVRScene extends GVRHybridObject {
 
     /**
      * Add an additional string to stats message for this scene.
-     * 
+     *
      * @param message
      *            String to add to stats message.
      */
@@ -237,7 +268,7 @@ public class GVRScene extends GVRHybridObject {
 
     /**
      * Remove the stats message from this scene.
-     * 
+     *
      */
     public void killStatMessage() {
         mStatMessage.delete(0, mStatMessage.length());
@@ -255,6 +286,10 @@ class NativeScene {
 
     public static native void setOcclusionQuery(long scene, boolean flag);
 
+    public static native void setOccluderCulling(long scene, boolean flag);
+
+    public static native void setCullThreadCount(long scene, int count);
+
     static native void setMainCameraRig(long scene, long cameraRig);
 
     public static native void resetStats(long scene);
@@ -262,4 +297,6 @@ class NativeScene {
     public static native int getNumberDrawCalls(long scene);
 
     public static native int getNumberTriangles(long scene);
+
+    public static native int getNumberSkippedGLCalls(long scene);
 }
@@ -17,8 +17,10 @@ package org.gearvrf;
 
 import java.util.ArrayList;
 import java.util.Collections;
+import java.util.HashSet;
 import java.util.Iterator;
 import java.util.List;
+import java.util.Set;
 import java.util.concurrent.Future;
 
 import org.gearvrf.GVRMaterial.GVRShaderType;
@@ -47,6 +49,14 @@ public class GVRSceneObject extends GVRHybridObject {
     private GVREyePointeeHolder mEyePointeeHolder;
     private GVRSceneObject mParent;
     private final List<GVRSceneObject> mChildren = new ArrayList<GVRSceneObject>();
+    private final List<GVRSceneObject> mLODLevels = new ArrayList<GVRSceneObject>();
+    private final List<GVRSceneObject> mGeneratedLODLevels = new ArrayList<GVRSceneObject>();
+    /*
+     * Every material seen in the subtree while it is static. The merged
+     * meshes are drawn with them natively until the subtree is baked again,
+     * so one swapped or removed from the subtree must not be freed before.
+     */
+    private Set<GVRMaterial> mStaticMaterials;
 
     /**
      * Constructs an empty scene object with a default {@link GVRTransform
@@ -60,6 +70,15 @@ public class GVRSceneObject extends GVRHybridObject {
         attachTransform(new GVRTransform(getGVRContext()));
     }
 
+    /**
+     * Wraps a native scene object that already has {@code transform}
+     * attached, as made by the importer's scene graph builder.
+     */
+    GVRSceneObject(GVRContext gvrContext, long ptr, GVRTransform transform) {
+        super(gvrContext, ptr);
+        mTransform = transform;
+    }
+
     /**
      * Constructs a scene object with an arbitrarily complex mesh.
      * 
@@ -313,6 +332,16 @@ public class GVRSceneObject extends GVRHybridObject {
         mRenderData = renderData;
         renderData.setOwnerObject(this);
         NativeSceneObject.attachRenderData(getNative(), renderData.getNative());
+        keepStaticMaterials(this);
+    }
+
+    /**
+     * Records {@code renderData} as this object's rendering data on the Java
+     * side only, for render data the native scene object already has.
+     */
+    void wrapRenderData(GVRRenderData renderData) {
+        mRenderData = renderData;
+        renderData.setOwnerObject(this);
     }
 
     /**
@@ -547,6 +576,16 @@ public class GVRSceneObject extends GVRHybridObject {
         mChildren.add(child);
         child.mParent = this;
         NativeSceneObject.addChildObject(getNative(), child.getNative());
+        keepStaticMaterials(child);
+    }
+
+    /**
+     * Records {@code child} as a child of this object on the Java side only,
+     * for children the native scene object already has.
+     */
+    void wrapChildObject(GVRSceneObject child) {
+        mChildren.add(child);
+        child.mParent = this;
     }
 
     /**
@@ -613,6 +652,237 @@ public class GVRSceneObject extends GVRHybridObject {
         return NativeSceneObject.getLODMaxRange(getNative());
     }
 
+    /**
+     * Makes this object or one of its children a level of detail of this
+     * object.
+     * 
+     * Of the levels of an object, only the one for its current size on
+     * screen is shown: the level with the largest minimum size the bounds
+     * of this object and its children still cover, measured in pixels
+     * across the eye buffer. Below the smallest minimum
+     * nothing is shown. The levels are picked once per frame, whatever the
+     * field of view and resolution; unlike {@link #setLODRange(float, float)
+     * LOD ranges}, they do not need to be tuned for either.
+     * 
+     * @param level
+     *            This object, for its own render data, or a child of it,
+     *            for the child's subtree.
+     * @param minScreenSize
+     *            The size on screen, in pixels, from which the level is
+     *            shown.
+     */
+    public void addLODLevel(GVRSceneObject level, float minScreenSize) {
+        if (level != this && level.getParent() != this) {
+            throw new IllegalArgumentException(
+                    "an LOD level must be the object itself or one of its children");
+        }
+        if (minScreenSize < 0) {
+            throw new IllegalArgumentException(
+                    "minScreenSize must not be negative");
+        }
+        if (!mLODLevels.contains(level)) {
+            mLODLevels.add(level);
+        }
+        NativeSceneObject.addLODLevel(getNative(), level.getNative(),
+                minScreenSize);
+    }
+
+    /**
+     * Removes all the levels added with
+     * {@link #addLODLevel(GVRSceneObject, float)}, which are all shown
+     * again.
+     */
+    public void clearLODLevels() {
+        mLODLevels.clear();
+        NativeSceneObject.clearLODLevels(getNative());
+    }
+
+    /**
+     * Sets how far past the minimum size of a level the size on screen has
+     * to go before another level is picked, as a fraction of that minimum.
+     * This keeps an object about at a minimum from switching levels back and
+     * forth. The default is 0.1.
+     * 
+     * @param hysteresis
+     *            The fraction, between 0 and 1.
+     */
+    public void setLODHysteresis(float hysteresis) {
+        if (hysteresis < 0 || hysteresis >= 1) {
+            throw new IllegalArgumentException(
+                    "hysteresis must be between 0 and 1");
+        }
+        NativeSceneObject.setLODHysteresis(getNative(), hysteresis);
+    }
+
+    /**
+     * Sets the number of frames over which the level left is faded out as
+     * the new one fades in. The two are dithered together through the
+     * sample coverage of a multisampled eye buffer; without multisampling
+     * the levels switch halfway. The default of 0 switches at once.
+     * 
+     * @param fadeFrames
+     *            The length of the fade, in frames.
+     */
+    public void setLODFadeFrames(int fadeFrames) {
+        if (fadeFrames < 0) {
+            throw new IllegalArgumentException(
+                    "fadeFrames must not be negative");
+        }
+        NativeSceneObject.setLODFadeFrames(getNative(), fadeFrames);
+    }
+
+    /**
+     * Adds simplified levels of detail of the mesh of this object, shown in
+     * its place when it is small on screen.
+     * 
+     * Each level keeps about half of the triangles of the one before it. The
+     * levels are {@linkplain GVRMesh#simplify(float...) simplified} from the
+     * mesh of this object and added as its children, with its materials and
+     * render state, and made {@linkplain #addLODLevel(GVRSceneObject, float)
+     * levels of detail} of this object along with it, replacing any levels
+     * it had. Levels from an earlier call are removed from the children
+     * first. Each level takes over once the surface it leaves out would be
+     * off by at most {@code maxPixelError} pixels; the last level is shown
+     * at any size.
+     * 
+     * @param levelCount
+     *            The number of levels to add.
+     * @param maxPixelError
+     *            How far, in pixels on screen, a level may stray from the
+     *            surface of the full mesh.
+     * @return The scene objects of the levels, most detailed first.
+     */
+    public GVRSceneObject[] generateLODs(int levelCount, float maxPixelError) {
+        GVRRenderData renderData = getRenderData();
+        if (renderData == null || renderData.getMesh() == null) {
+            throw new IllegalStateException(
+                    "generateLODs needs a scene object with a mesh");
+        }
+        if (levelCount < 1 || maxPixelError <= 0) {
+            throw new IllegalArgumentException(
+                    "levelCount and maxPixelError must be positive");
+        }
+
+        float[] triangleRatios = new float[levelCount];
+        float triangleRatio = 1.0f;
+        for (int i = 0; i < levelCount; ++i) {
+            triangleRatio *= 0.5f;
+            triangleRatios[i] = triangleRatio;
+        }
+        float[] errors = new float[levelCount];
+        GVRMesh[] meshes = renderData.getMesh().simplify(triangleRatios,
+                errors);
+
+        // a level is shown down to the size at which the next one, off by
+        // a fraction of the size, is off by the largest error allowed
+        clearLODLevels();
+        for (GVRSceneObject level : mGeneratedLODLevels) {
+            if (level.getParent() == this) {
+                removeChildObject(level);
+            }
+        }
+        mGeneratedLODLevels.clear();
+        addLODLevel(this, minScreenSize(maxPixelError, errors[0]));
+        GVRSceneObject[] levels = new GVRSceneObject[levelCount];
+        for (int i = 0; i < levelCount; ++i) {
+            GVRSceneObject level = new GVRSceneObject(getGVRContext());
+            level.attachRenderData(renderData.copyForMesh(meshes[i]));
+            addChildObject(level);
+            addLODLevel(level, i == levelCount - 1 ? 0.0f : minScreenSize(
+                    maxPixelError, errors[i + 1]));
+            levels[i] = level;
+            mGeneratedLODLevels.add(level);
+        }
+        return levels;
+    }
+
+    private static float minScreenSize(float maxPixelError, float nextError) {
+        return nextError > 0 ? maxPixelError / nextError : Float.MAX_VALUE;
+    }
+
+    /**
+     * Marks this object and its descendants as static, or not.
+     * 
+     * The meshes of a static subtree are merged, per material, into a few
+     * large meshes in world space, which are culled and drawn in place of
+     * the original objects. Objects with several render passes, extra vertex
+     * attributes, an LOD range or a transparent rendering order are drawn as
+     * before, and so are objects with LOD levels, along with their children.
+     * 
+     * The subtree is baked when it is marked, and baked again before the next
+     * frame whenever objects, render data, meshes or materials are added to,
+     * removed from or changed in it. Moving objects in it is not shown until
+     * it is marked static again. The materials of a static subtree are kept
+     * until the flag is cleared. Clearing the flag drops the merged meshes.
+     * 
+     * @param isStatic
+     *            {@code true} to bake the subtree, {@code false} to draw the
+     *            original objects again.
+     */
+    public void setStatic(boolean isStatic) {
+        if (isStatic) {
+            mStaticMaterials = new HashSet<GVRMaterial>();
+            getMaterials(this, mStaticMaterials);
+        } else {
+            mStaticMaterials = null;
+        }
+        NativeSceneObject.setStatic(getNative(), isStatic);
+    }
+
+    /**
+     * Keeps the materials of {@code subtree}, which is in this object's
+     * subtree, for every static object this one is in.
+     */
+    void keepStaticMaterials(GVRSceneObject subtree) {
+        for (GVRSceneObject sceneObject = this; sceneObject != null;
+                sceneObject = sceneObject.mParent) {
+            if (sceneObject.mStaticMaterials != null) {
+                getMaterials(subtree, sceneObject.mStaticMaterials);
+            }
+        }
+    }
+
+    private static void getMaterials(GVRSceneObject sceneObject,
+            Set<GVRMaterial> materials) {
+        if (sceneObject.mRenderData != null) {
+            sceneObject.mRenderData.getMaterials(materials);
+        }
+        for (GVRSceneObject child : sceneObject.mChildren) {
+            getMaterials(child, materials);
+        }
+    }
+
+    /**
+     * @return {@code true} if this object was marked static with
+     *         {@link #setStatic(boolean)}
+     */
+    public boolean isStatic() {
+        return NativeSceneObject.isStatic(getNative());
+    }
+
+    /**
+     * Marks the mesh of this object as an occluder, or not.
+     * 
+     * When the scene culls against occluders (see
+     * {@link GVRScene#setOccluderCulling(boolean)}), the triangles of
+     * occluders in view hide the objects behind them. Large, simple,
+     * opaque objects like walls and floors make the best occluders.
+     * 
+     * @param occluder
+     *            {@code true} to use the mesh of this object as an occluder.
+     */
+    public void setOccluder(boolean occluder) {
+        NativeSceneObject.setOccluder(getNative(), occluder);
+    }
+
+    /**
+     * @return {@code true} if this object was marked as an occluder with
+     *         {@link #setOccluder(boolean)}
+     */
+    public boolean isOccluder() {
+        return NativeSceneObject.isOccluder(getNative());
+    }
+
     /**
      * Get the number of child objects.
      * 
@@ -779,4 +1049,21 @@ class NativeSceneObject {
     static native void setLODRange(long sceneObject, float minRange, float maxRange);
     static native float getLODMinRange(long sceneObject);
     static native float getLODMaxRange(long sceneObject);
+
+    static native void addLODLevel(long sceneObject, long level,
+            float minScreenSize);
+
+    static native void clearLODLevels(long sceneObject);
+
+    static native void setLODHysteresis(long sceneObject, float hysteresis);
+
+    static native void setLODFadeFrames(long sceneObject, int fadeFrames);
+
+    static native void setStatic(long sceneObject, boolean isStatic);
+
+    static native boolean isStatic(long sceneObject);
+
+    static native void setOccluder(long sceneObject, boolean occluder);
+
+    static native boolean isOccluder(long sceneObject);
 }
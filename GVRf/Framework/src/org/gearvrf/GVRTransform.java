@@ -30,7 +30,7 @@ public class GVRTransform extends GVRComponent {
         super(gvrContext, NativeTransform.ctor());
     }
 
-    private GVRTransform(GVRContext gvrContext, long ptr) {
+    GVRTransform(GVRContext gvrContext, long ptr) {
         super(gvrContext, ptr);
     }
 